@@ -0,0 +1,34 @@
+//
+//  AllocationCounter.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace ac {
+
+	std::atomic<bool> allocationsCounted(false);
+	std::atomic<long> allocationCount(0);
+}
+
+
+void *operator new(std::size_t size)
+{
+	if (ac::allocationsCounted.load(std::memory_order_relaxed)) ac::allocationCount++;
+	void *p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+
+// what code built as C++14 or later (Boost's own libraries, say) deletes with
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,30 @@
+//
+//  AllocationCounter.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Every heap allocation in the test target goes through the operator new in AllocationCounter.cpp, so a test can tell
+//	whether some stretch of code allocated at all. Counting is off except inside an AllocationCounter's lifetime, and
+//	covers every thread while it's on.
+
+#pragma once
+
+#include <atomic>
+
+namespace ac {
+
+	extern std::atomic<bool> allocationsCounted;
+	extern std::atomic<long> allocationCount;
+
+	struct AllocationCounter
+	{
+		AllocationCounter() : countAtStart(allocationCount) { allocationsCounted = true; }
+		~AllocationCounter() { allocationsCounted = false; }
+
+		long allocations() const { return allocationCount - countAtStart; }
+
+		const long countAtStart;
+	};
+}
@@ -7,6 +7,7 @@
 //
 
 #include <boost/test/unit_test.hpp>
+#include "AllocationCounter.h"
 #include "BlockChain.h"
 #include "BlockModel.h"
 #include "BlockCanvas.h"
@@ -21,9 +22,12 @@
 #include "StatsHUDModel.h"
 #include "StatsHUDView.h"
 #include "Notif.h"
+#include "ScoreKeeper.h"
+#include "DebugSettingsHelper.h"
+
 
 namespace ac {
-	
+
 	struct BlockModelTestFixture
 	{
 		BlockModelTestFixture() :
@@ -389,5 +393,80 @@ namespace ac {
 		BOOST_REQUIRE_EQUAL(ct().getVisibleString(), gs2);
 	}
 
+
+	BOOST_AUTO_TEST_CASE(ResetGeneratesOnlyTheStartOfTheCopyText)
+	{
+		// the fixture has reset the copy text
+		const size_t length = DebugSettingsHelper::sharedHelper().intValueForProperty("glyphs_to_generate");
+		BOOST_REQUIRE_EQUAL(ct().length(), length);
+		BOOST_REQUIRE_EQUAL(ct().copyString().droppedFromFront(), 0);
+
+		// the visible row plus a couple of chunks of lookahead, not the whole thing
+		BOOST_REQUIRE_GE(ct().copyString().size(), ct().getVisibleString().size());
+		BOOST_REQUIRE_LT(ct().copyString().size(), ct().getBlocksPerLine() + 1024);
+		BOOST_REQUIRE_EQUAL(ct().remainingCharCount(false), length - ct().getVisibleString().size());
+	}
+
+
+	BOOST_AUTO_TEST_CASE(AdvancingTheVisibleRowDoesNotAllocate)
+	{
+		const size_t blocksPerLine = 10;
+		const size_t copyStringLength = 500;
+		const size_t warmUpAdvances = 20;
+
+		// only a block canvas model listens: the views' animations and floating labels aren't what's measured
+		Notif::unsubscribeAll();
+		BlockCanvasModel model;
+
+		GlyphString gs;
+		for (size_t i = 0; i < copyStringLength; i++) {
+			gs.append(Glyph(12 + i % 20));
+		}
+
+		ct().setCopyString(gs);
+		ct().setBlocksPerLine(blocksPerLine);
+
+		// types the glyph under the cursor, which moves it and the model's row along by one. Levelling up would
+		// generate the copy text ahead again, so the player is kept from it.
+		ScoreKeeper &scoreKeeper(GameState::getInstance().scoreKeeper());
+		auto typeNextGlyph = [&] {
+			scoreKeeper.setLevelProgress(0);
+			const Glyph glyph(ct().getVisibleString()[0]);
+			ct().keyEventTriggered(InvalidKeyID, KeyPressState::Down, glyph);
+			ct().keyEventTriggered(InvalidKeyID, KeyPressState::Up, glyph);
+		};
+
+		// logging allocates, and isn't what's being measured
+		const TLogLevel savedLogLevel = FILELog::ReportingLevel();
+		FILELog::ReportingLevel() = logWARNING;
+
+		// the first advances size the rows and the entered string; after that every advance reuses them
+		for (size_t i = 0; i < warmUpAdvances; i++) typeNextGlyph();
+
+		BlockChain &chain(model.getBlockChain());
+		size_t advances = 0;
+		long allocations = 0;
+		{
+			AllocationCounter counter;
+			for (size_t offset = warmUpAdvances; offset + blocksPerLine < copyStringLength; offset++) {
+				const int firstBefore = chain.itemAt(0).getGlyph().getCode();
+				typeNextGlyph();
+
+				// the row now starts one glyph further along
+				if (ct().curOffset() == offset + 1 && chain.size() == blocksPerLine &&
+					chain.itemAt(0).getGlyph().getCode() == gs[offset + 1].getCode() &&
+					chain.itemAt(0).getGlyph().getCode() != firstBefore) {
+					advances++;
+				}
+			}
+			allocations = counter.allocations();
+		}
+
+		FILELog::ReportingLevel() = savedLogLevel;
+
+		BOOST_REQUIRE_EQUAL(advances, copyStringLength - blocksPerLine - warmUpAdvances);
+		BOOST_REQUIRE_EQUAL(allocations, 0);
+	}
+
 	BOOST_AUTO_TEST_SUITE_END()
 }
@@ -0,0 +1,190 @@
+//
+//  BlockTweenerTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/26/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include "AllocationCounter.h"
+#include "BlockTweener.h"
+
+namespace ac {
+
+	// has what the tweener needs of a CCSprite
+	struct FakeSprite
+	{
+		float x, y, scaleX, scaleY;
+		unsigned char opacity;
+
+		FakeSprite() : x(0), y(0), scaleX(1), scaleY(1), opacity(255) {}
+
+		inline float getPositionX() { return x; }
+		inline float getPositionY() { return y; }
+		inline float getScaleX() { return scaleX; }
+		inline float getScaleY() { return scaleY; }
+		inline unsigned char getOpacity() { return opacity; }
+		inline void setPositionX(float x) { this->x = x; }
+		inline void setPositionY(float y) { this->y = y; }
+		inline void setScaleX(float scaleX) { this->scaleX = scaleX; }
+		inline void setScaleY(float scaleY) { this->scaleY = scaleY; }
+		inline void setOpacity(unsigned char opacity) { this->opacity = opacity; }
+	};
+
+	typedef BlockTweener<FakeSprite> Tweener;
+
+	enum { Done = 1, Settled };
+
+
+	BOOST_AUTO_TEST_SUITE(BlockTweenerTests)
+
+	BOOST_AUTO_TEST_CASE(TweensEaseFromWhereTheyStart)
+	{
+		Tweener tweener;
+		FakeSprite linear, in, out, delayed;
+
+		tweener.tween(&linear, TweenProperty::PositionX, 100, 1);
+		tweener.tween(&in, TweenProperty::PositionX, 100, 1, 0, TweenEase::In);
+		tweener.tween(&out, TweenProperty::PositionX, 100, 1, 0, TweenEase::Out);
+		tweener.tween(&delayed, TweenProperty::PositionX, 100, 1, 0.5f);
+
+		tweener.update(0.25f);
+		delayed.x = 50; // moved by something else before the tween starts
+		tweener.update(0.25f);
+
+		BOOST_CHECK_CLOSE(linear.x, 50, 0.01);
+		BOOST_CHECK_CLOSE(in.x, 25, 0.01);
+		BOOST_CHECK_CLOSE(out.x, 70.71, 0.01);
+		BOOST_CHECK_CLOSE(delayed.x, 50, 0.01); // just started, from 50
+
+		tweener.update(0.5f);
+		BOOST_CHECK_EQUAL(linear.x, 100);
+		BOOST_CHECK_EQUAL(in.x, 100);
+		BOOST_CHECK_CLOSE(delayed.x, 75, 0.01);
+		BOOST_CHECK_EQUAL(tweener.size(), 1);
+
+		tweener.update(10);
+		BOOST_CHECK_EQUAL(delayed.x, 100);
+		BOOST_CHECK_EQUAL(tweener.size(), 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(FinishedTweensSendTheirEvents)
+	{
+		Tweener tweener;
+		FakeSprite a, b;
+
+		tweener.tween(&a, TweenProperty::ScaleY, 0.01f, 0.1f, 0, TweenEase::In);
+		tweener.tween(&a, TweenProperty::ScaleY, 0.01f, 0.5f, 0.3f, 0.1f, TweenEase::Out, Done);
+		tweener.wait(&a, 0.5f, Settled);
+		tweener.wait(&b, 0.5f, Settled);
+		BOOST_CHECK_EQUAL(tweener.pending(Settled), 2);
+
+		tweener.update(0.2f);
+		BOOST_CHECK(tweener.events().empty());
+		BOOST_CHECK_LT(a.scaleY, 0.5f);
+		BOOST_CHECK_GT(a.scaleY, 0.01f);
+
+		tweener.update(0.2f);
+		BOOST_REQUIRE_EQUAL(tweener.events().size(), 1);
+		BOOST_CHECK_EQUAL(tweener.events()[0].event, Done);
+		BOOST_CHECK_EQUAL(tweener.events()[0].target, &a);
+		BOOST_CHECK_EQUAL(a.scaleY, 0.5f);
+
+		// stopped tweens don't send theirs
+		tweener.stop(&b);
+		BOOST_CHECK_EQUAL(tweener.pending(Settled), 1);
+
+		tweener.update(0.2f);
+		BOOST_REQUIRE_EQUAL(tweener.events().size(), 1);
+		BOOST_CHECK_EQUAL(tweener.events()[0].event, Settled);
+		BOOST_CHECK_EQUAL(tweener.pending(Settled), 0);
+
+		tweener.update(0.2f);
+		BOOST_CHECK(tweener.events().empty());
+	}
+
+
+	BOOST_AUTO_TEST_CASE(BlinkingEndsVisible)
+	{
+		Tweener tweener;
+		FakeSprite glyph;
+
+		tweener.tween(&glyph, TweenProperty::Blink, 2, 0.15f);
+		const unsigned char expected[] = { 0, 255, 0 };
+		for (unsigned char opacity : expected) {
+			tweener.update(0.025f);
+			BOOST_CHECK_EQUAL(glyph.opacity, opacity);
+			tweener.update(0.025f);
+		}
+		tweener.update(0.025f);
+		BOOST_CHECK_EQUAL(glyph.opacity, 255);
+		BOOST_CHECK_EQUAL(tweener.size(), 0);
+
+		// stopping only the blink leaves the rest going
+		tweener.tween(&glyph, TweenProperty::Blink, 2, 0.15f);
+		tweener.tween(&glyph, TweenProperty::ScaleX, 1.3f, 0.15f);
+		tweener.stop(&glyph, TweenProperty::Blink);
+		BOOST_CHECK_EQUAL(tweener.size(), 1);
+	}
+
+
+	// A fast typist: four keystrokes a frame, each popping a block (six tweens) and blinking or sliding another one,
+	// at 60 frames a second. There are enough blocks that each one has settled before it's popped again.
+	BOOST_AUTO_TEST_CASE(TenThousandFramesOfFastTyping)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t Frames = 10000, KeystrokesPerFrame = 4, MaxTweens = 2048;
+		const float FrameTime = 1.0f / 60;
+
+		std::vector<FakeSprite> blocks(40 * KeystrokesPerFrame); // 0.66s worth
+		Tweener tweener;
+		tweener.reserve(MaxTweens);
+
+		size_t tweensUpdated = 0, events = 0, next = 0;
+		long allocations;
+		clock::duration elapsed;
+		{
+			AllocationCounter counter;
+			const clock::time_point start = clock::now();
+			for (size_t frame = 0; frame < Frames; frame++) {
+				for (size_t k = 0; k < KeystrokesPerFrame; k++) {
+					FakeSprite *popped = &blocks[next++ % blocks.size()];
+					tweener.stop(popped);
+					tweener.tween(popped, TweenProperty::ScaleY, 0.01f, 0.1f, 0, TweenEase::In);
+					tweener.tween(popped, TweenProperty::PositionX, 40, 0.3f, 0.1f, TweenEase::In, Done);
+					tweener.tween(popped, TweenProperty::PositionY, 300, 0.3f, 0.1f, TweenEase::In);
+					tweener.tween(popped, TweenProperty::ScaleX, 0.4f, 0.3f, 0.1f, TweenEase::Out);
+					tweener.tween(popped, TweenProperty::ScaleY, 0.01f, 0.4f, 0.3f, 0.1f, TweenEase::Out);
+					tweener.wait(popped, 0.5f, Settled);
+
+					FakeSprite *other = &blocks[(next + 5) % blocks.size()];
+					if (frame % 2) {
+						tweener.tween(other, TweenProperty::Blink, 2, 0.15f);
+					} else {
+						tweener.tween(other, TweenProperty::PositionX, 20, 0.2f, 0, TweenEase::In);
+					}
+				}
+				tweensUpdated += tweener.size();
+				tweener.update(FrameTime);
+				events += tweener.events().size();
+			}
+			elapsed = clock::now() - start;
+			allocations = counter.allocations();
+		}
+
+		const double nsPerTween = std::chrono::duration<double, std::nano>(elapsed).count() / tweensUpdated;
+		BOOST_TEST_MESSAGE(boost::format("Block tweens: %.1f ns per tween per frame, %d at a time on average") %
+						   nsPerTween % (tweensUpdated / Frames));
+
+		BOOST_CHECK_EQUAL(allocations, 0);
+		// every pop flew off and settled, but for those of the last half a second
+		BOOST_CHECK_GE(events, 2 * (Frames - 31) * KeystrokesPerFrame);
+		BOOST_CHECK_LE(events, 2 * Frames * KeystrokesPerFrame);
+		BOOST_CHECK_LE(tweener.size(), MaxTweens);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
@@ -0,0 +1,192 @@
+//
+//  BlockViewPoolTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/26/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "AllocationCounter.h"
+#include "BlockViewPool.h"
+
+namespace ac {
+
+	// has what the pool needs of a BlockView
+	struct FakeBlock
+	{
+		int index;
+		bool recycled;
+		int glyph;
+
+		FakeBlock() : index(-1), recycled(false), glyph(0) {}
+
+		inline int getIndex() { return index; }
+		inline void setIndex(int index) { this->index = index; }
+		inline bool isRecycled() const { return recycled; }
+		inline void setRecycled(bool recycled) { this->recycled = recycled; }
+	};
+
+
+	// drives the pool the way BlockCanvasView does: pop the front blocks, then once they're done popping, recycle
+	// them and fill the back of the row with reused blocks (or new ones while there aren't enough)
+	struct BlockRow
+	{
+		static const size_t RowLength = 12;
+
+		BlockViewPool<FakeBlock> pool;
+		std::vector<FakeBlock> storage; // stands in for the sprite batch node
+		std::vector<FakeBlock *> popping;
+		size_t created;
+		int nextGlyph;
+
+		BlockRow() : storage(2 * RowLength), created(0), nextGlyph(0)
+		{
+			pool.reserve(RowLength, RowLength);
+			popping.reserve(RowLength);
+			fill();
+		}
+
+		void fill()
+		{
+			for (size_t i = pool.countOnRow(); i < RowLength; i++) {
+				FakeBlock *block = pool.reuse();
+				if (!block) {
+					BOOST_REQUIRE_LT(created, storage.size());
+					block = &storage[created++];
+					pool.adopt(block);
+				}
+				block->glyph = nextGlyph++;
+				pool.place(block, (int) i);
+			}
+		}
+
+		void advance(size_t units)
+		{
+			for (size_t i = 0; i < units; i++) {
+				popping.push_back(pool.viewAt((int) i));
+			}
+			pool.advance(units);
+		}
+
+		void finishPopping()
+		{
+			for (FakeBlock *block : popping) {
+				pool.recycle(block);
+			}
+			popping.clear();
+		}
+	};
+
+	const size_t BlockRow::RowLength;
+
+
+	BOOST_AUTO_TEST_SUITE(BlockViewPoolTests)
+
+	BOOST_AUTO_TEST_CASE(AdvancingMovesTheRowDown)
+	{
+		BlockRow row;
+		FakeBlock *third = row.pool.viewAt(2);
+		FakeBlock *first = row.pool.viewAt(0);
+
+		row.advance(2);
+		BOOST_REQUIRE_EQUAL(row.pool.viewAt(0), third);
+		BOOST_REQUIRE_EQUAL(third->getIndex(), 0);
+		BOOST_REQUIRE_EQUAL(first->getIndex(), -1);
+		BOOST_REQUIRE_EQUAL(row.pool.countOnRow(), BlockRow::RowLength - 2);
+
+		// the slots at the back are empty until they're filled again
+		BOOST_REQUIRE(!row.pool.viewAt(BlockRow::RowLength - 1));
+		BOOST_REQUIRE(!row.pool.viewAt(BlockRow::RowLength - 2));
+		BOOST_REQUIRE(!row.pool.viewAt(-1));
+		BOOST_REQUIRE(!row.pool.viewAt(BlockRow::RowLength));
+
+		row.finishPopping();
+		BOOST_REQUIRE(first->isRecycled());
+		BOOST_REQUIRE_EQUAL(row.pool.spareCount(), 2);
+
+		// recycling twice (as a reload in the middle of a pop does) doesn't hand the block out twice
+		row.pool.recycle(first);
+		BOOST_REQUIRE_EQUAL(row.pool.spareCount(), 2);
+
+		row.fill();
+		BOOST_REQUIRE_EQUAL(row.pool.countOnRow(), BlockRow::RowLength);
+		BOOST_REQUIRE_EQUAL(row.pool.spareCount(), 0);
+		BOOST_REQUIRE_EQUAL(row.created, BlockRow::RowLength); // the popped ones were reused
+	}
+
+
+	BOOST_AUTO_TEST_CASE(RecyclingAllEmptiesTheRow)
+	{
+		BlockRow row;
+		row.advance(3); // still popping when the next text is loaded
+		row.pool.recycleAll();
+		row.finishPopping();
+
+		BOOST_REQUIRE_EQUAL(row.pool.countOnRow(), 0);
+		BOOST_REQUIRE_EQUAL(row.pool.spareCount(), BlockRow::RowLength);
+		for (size_t i = 0; i < BlockRow::RowLength; i++) {
+			BOOST_REQUIRE(!row.pool.viewAt((int) i));
+		}
+
+		row.fill();
+		BOOST_REQUIRE_EQUAL(row.created, BlockRow::RowLength);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(TenThousandAdvancesDoNotAllocate)
+	{
+		BlockRow row;
+
+		// blocks from one advance are still popping during the next one, so the pool grows a little past a row
+		// before it settles
+		for (size_t i = 0; i < 10; i++) {
+			row.advance(1 + i % 3);
+			row.fill();
+			row.finishPopping();
+		}
+		const size_t createdBeforeCounting = row.created;
+
+		size_t lookups = 0;
+		long allocations;
+		{
+			AllocationCounter counter;
+			for (size_t i = 0; i < 10000; i++) {
+				const size_t units = 1 + i % 3;
+				row.advance(units);
+
+				// every keystroke looks up the front of the row (to blink, highlight or pop it)
+				for (size_t j = 0; j < BlockRow::RowLength - units; j++) {
+					FakeBlock *block = row.pool.viewAt((int) j);
+					if (!block || block->getIndex() != (int) j) break;
+					lookups++;
+				}
+
+				if (i % 2) {
+					row.finishPopping(); // the pops finish before the row is filled again, or after
+				}
+				row.fill();
+				if (!(i % 2)) {
+					row.finishPopping();
+				}
+			}
+			allocations = counter.allocations();
+		}
+
+		BOOST_REQUIRE_EQUAL(allocations, 0);
+		BOOST_REQUIRE_EQUAL(row.created, createdBeforeCounting);
+		BOOST_REQUIRE_LE(row.created, 2 * BlockRow::RowLength);
+
+		// every block looked up was where the pool said it was, and the row is still in glyph order
+		size_t expectedLookups = 0;
+		for (size_t i = 0; i < 10000; i++) {
+			expectedLookups += BlockRow::RowLength - (1 + i % 3);
+		}
+		BOOST_REQUIRE_EQUAL(lookups, expectedLookups);
+		for (size_t i = 1; i < BlockRow::RowLength; i++) {
+			BOOST_REQUIRE_EQUAL(row.pool.viewAt((int) i)->glyph, row.pool.viewAt((int) i - 1)->glyph + 1);
+		}
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
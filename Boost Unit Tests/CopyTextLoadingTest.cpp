@@ -7,8 +7,16 @@
 //
 
 #include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/tokenizer.hpp>
+#include <boost/algorithm/string.hpp>
 #include "CopyTextLoader.h"
 #include "DebugSettingsHelper.h"
+#include "Utilities.h"
 
 namespace ac {
 	
@@ -30,6 +38,47 @@ namespace ac {
 	};
 	
 	
+	// How lines were produced before the loader was made to stream: the whole file parsed into a property tree,
+	// then each line re-tokenized. Kept here to check the streaming loader against, and to benchmark it.
+	static std::vector<string> legacyLoadLines(const string &fullPath, size_t maxCharsPerLine)
+	{
+		std::vector<string> lines;
+		boost::property_tree::ptree pt;
+		boost::property_tree::read_json(fullPath, pt);
+		string content(pt.get<string>("content", ""));
+
+		std::stringstream ss(content);
+		string to;
+		while (std::getline(ss, to, '\n')) {
+			boost::char_separator<char> sep(" ");
+			boost::tokenizer<boost::char_separator<char>> tokens(to, sep);
+			std::ostringstream os;
+			for (const auto& t : tokens) {
+				if (maxCharsPerLine != 0 && t.size() + os.str().size() > maxCharsPerLine) {
+					if (!os.str().empty()) {
+						lines.push_back(boost::trim_copy(os.str()));
+					}
+					os.str("");
+				}
+				os << t << " ";
+			}
+			if (!os.str().empty()) {
+				lines.push_back(boost::trim_copy(os.str()));
+			}
+		}
+		return lines;
+	}
+
+
+	static string writeScratchFile(const string &name, const string &contents)
+	{
+		string path(cocos2d::CCFileUtils::sharedFileUtils()->getWritablePath() + name);
+		std::ofstream out(path.c_str(), std::ios::binary);
+		out << contents;
+		return path;
+	}
+
+
 	BOOST_FIXTURE_TEST_SUITE(CopyTextLoadingTests, CopyTextLoadingFixture)
 	
 	
@@ -45,11 +94,165 @@ namespace ac {
 	BOOST_AUTO_TEST_CASE(CopyTextLoadedHasNonEmptyLines)
 	{
 		loader.loadTextFile(filename); // use default params
-		const string &firstLine(loader.getLine(0));
+		boost::string_ref firstLine(loader.getLine(0));
 		BOOST_REQUIRE(!firstLine.empty());
 	}
 	
 	
+	BOOST_AUTO_TEST_CASE(StreamedLinesMatchTheOldParser)
+	{
+		// (lorem-ipsum.json has raw newlines inside its content, which newer property tree parsers reject)
+		for (const string &file : { "text/dante-canto-1.json", "text/mary-had-a-little-lamb.json" }) {
+			for (size_t maxChars : { 0, 10, 27, 40 }) {
+				std::vector<string> expected(legacyLoadLines(utilities::getFullPathForFilename(file), maxChars));
+
+				loader.setMaxCharsPerLine(maxChars);
+				loader.loadTextFile(file);
+				BOOST_REQUIRE(!loader.hasError());
+				BOOST_REQUIRE_EQUAL(loader.getNumberOfLines(), expected.size());
+				for (size_t i = 0; i < expected.size(); i++) {
+					BOOST_REQUIRE_EQUAL(loader.getLine(i), expected[i]);
+				}
+			}
+		}
+		loader.setMaxCharsPerLine(0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(EscapedContentIsDecoded)
+	{
+		const string path(writeScratchFile("escaped-copy.json",
+			"{ \"author\": \"a \\\"quoted\\\" {name}\", \"meta\": { \"content\": \"not this\" },\n"
+			"  \"content\": \"first line\\nsecond \\\"line\\\"\\n\\u00e9t\\u00e9\" }"));
+
+		loader.setMaxCharsPerLine(0);
+		loader.loadTextFile(path);
+		BOOST_REQUIRE(!loader.hasError());
+		BOOST_REQUIRE_EQUAL(loader.getNumberOfLines(), 3);
+		BOOST_REQUIRE_EQUAL(loader.getLine(0), "first line");
+		BOOST_REQUIRE_EQUAL(loader.getLine(1), "second \"line\"");
+		BOOST_REQUIRE_EQUAL(loader.getLine(2), "\xC3\xA9t\xC3\xA9");
+		BOOST_REQUIRE(loader.getLine(3).empty());
+
+		// a surrogate pair is one character
+		loader.loadTextFile(writeScratchFile("astral-copy.json", "{ \"content\": \"a \\ud83d\\ude00 b\" }"));
+		BOOST_REQUIRE(!loader.hasError());
+		BOOST_REQUIRE_EQUAL(loader.getLine(0), "a \xF0\x9F\x98\x80 b");
+
+		// malformed escapes fail the load, as they did with the property tree
+		for (const char *bad : { "\\u00zz", "\\u12", "\\ud83d alone", "\\ude00", "\\q" }) {
+			loader.loadTextFile(writeScratchFile("bad-escape-copy.json", string("{ \"content\": \"") + bad + "\" }"));
+			BOOST_REQUIRE(loader.hasError());
+		}
+
+		loader.loadTextFile(writeScratchFile("not-json-copy.txt", "just some words"));
+		BOOST_REQUIRE(loader.hasError());
+		BOOST_REQUIRE_EQUAL(loader.getNumberOfLines(), 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(CompiledCorporaLoadTheSameLines)
+	{
+		const size_t MaxChars = 30;
+		loader.setMaxCharsPerLine(MaxChars);
+		loader.loadTextFile("text/dante-canto-1.json");
+		BOOST_REQUIRE(!loader.hasError());
+
+		std::vector<string> lines;
+		std::vector<CopyTextLine> summaries;
+		for (size_t i = 0; i < loader.getNumberOfLines(); i++) {
+			lines.push_back(string(loader.getLine(i)));
+			summaries.push_back(loader.corpus().getLineSummary(i));
+		}
+
+		const string path(cocos2d::CCFileUtils::sharedFileUtils()->getWritablePath() + "dante-canto-1.tgc");
+		BOOST_REQUIRE(loader.corpus().write(path));
+
+		loader.setMaxCharsPerLine(0); // compiled corpora keep their own width
+		loader.loadTextFile(path);
+		BOOST_REQUIRE(!loader.hasError());
+		BOOST_REQUIRE_EQUAL(loader.corpus().getMaxCharsPerLine(), MaxChars);
+		BOOST_REQUIRE_EQUAL(loader.getNumberOfLines(), lines.size());
+		for (size_t i = 0; i < lines.size(); i++) {
+			BOOST_REQUIRE_EQUAL(loader.getLine(i), lines[i]);
+			const CopyTextLine &summary(loader.corpus().getLineSummary(i));
+			BOOST_REQUIRE_EQUAL(summary.glyphMask, summaries[i].glyphMask);
+			BOOST_REQUIRE_EQUAL(summary.rareGlyphs, summaries[i].rareGlyphs);
+			BOOST_REQUIRE_EQUAL(summary.difficulty, summaries[i].difficulty);
+		}
+
+		// a truncated file is rejected rather than read past its end
+		std::ifstream in(path.c_str(), std::ios::binary);
+		const string compiled((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		loader.loadTextFile(writeScratchFile("truncated.tgc", compiled.substr(0, compiled.size() - 1)));
+		BOOST_REQUIRE(loader.hasError());
+		BOOST_REQUIRE_EQUAL(loader.corpus().getLineSummary(0).length, 0);
+
+		// and so is one whose difficulty index points outside it
+		const size_t indexAt = sizeof(CopyTextCorpusHeader) + lines.size() * sizeof(CopyTextLine);
+		string badIndex(compiled);
+		badIndex.replace(indexAt, sizeof(uint32_t), string(sizeof(uint32_t), '\xFF'));
+		loader.loadTextFile(writeScratchFile("bad-index.tgc", badIndex));
+		BOOST_REQUIRE(loader.hasError());
+
+		string badStarts(compiled);
+		const uint32_t backwards = (uint32_t) lines.size() + 1;
+		badStarts.replace(offsetof(CopyTextCorpusHeader, difficultyStarts) + sizeof(uint32_t), sizeof(uint32_t),
+						  reinterpret_cast<const char *>(&backwards), sizeof(uint32_t));
+		loader.loadTextFile(writeScratchFile("bad-starts.tgc", badStarts));
+		BOOST_REQUIRE(loader.hasError());
+	}
+
+
+	BOOST_AUTO_TEST_CASE(LinesAreSummarizedAndIndexedByDifficulty)
+	{
+		loader.setMaxCharsPerLine(25);
+		loader.loadTextFile("text/dante-canto-1.json");
+		loader.setMaxCharsPerLine(0);
+		const CopyTextCorpus &corpus(loader.corpus());
+
+		for (size_t i = 0; i < corpus.getNumberOfLines(); i++) {
+			uint32_t mask = 0;
+			for (char c : loader.getLine(i)) {
+				if (!std::isspace((unsigned char) c)) mask |= 1u << copytext::glyphClass(c);
+			}
+			BOOST_REQUIRE_EQUAL(corpus.getLineSummary(i).glyphMask, mask);
+		}
+
+		// every line shows up under exactly one difficulty, the one in its summary
+		std::vector<int> seen(corpus.getNumberOfLines(), 0);
+		size_t total = 0;
+		for (size_t d = 0; d < NumberOfCopyTextDifficulties; d++) {
+			const CopyTextDifficulty difficulty = (CopyTextDifficulty) d;
+			BOOST_REQUIRE_GT(corpus.getNumberOfLines(difficulty), 0);
+			for (size_t nth = 0; nth < corpus.getNumberOfLines(difficulty); nth++) {
+				const size_t lineNumber = corpus.getLineNumber(difficulty, nth);
+				BOOST_REQUIRE_EQUAL(corpus.getLineSummary(lineNumber).difficulty, d);
+				seen[lineNumber]++;
+			}
+			total += corpus.getNumberOfLines(difficulty);
+
+			// lines are views into the corpus, so the random pick can be identified by where it points
+			const boost::string_ref line(loader.getRandomLine(difficulty));
+			size_t lineNumber = 0;
+			while (lineNumber < corpus.getNumberOfLines() && corpus.getLine(lineNumber).data() != line.data()) {
+				lineNumber++;
+			}
+			BOOST_REQUIRE_LT(lineNumber, corpus.getNumberOfLines());
+			BOOST_REQUIRE_EQUAL(corpus.getLineSummary(lineNumber).difficulty, d);
+		}
+		BOOST_REQUIRE_EQUAL(total, corpus.getNumberOfLines());
+		BOOST_REQUIRE(std::all_of(seen.begin(), seen.end(), [](int n) { return n == 1; }));
+
+		// past the end, or with nothing loaded, there's no such line
+		const size_t easyLines = corpus.getNumberOfLines(CopyTextDifficulty::Easy);
+		BOOST_REQUIRE_EQUAL(corpus.getLineNumber(CopyTextDifficulty::Easy, easyLines), corpus.getNumberOfLines());
+		const CopyTextCorpus empty;
+		BOOST_REQUIRE_EQUAL(empty.getLineNumber(CopyTextDifficulty::Hard, 0), 0);
+		BOOST_REQUIRE(empty.getLine(empty.getLineNumber(CopyTextDifficulty::Hard, 0)).empty());
+	}
+
+
 	BOOST_AUTO_TEST_CASE(ShortenedCopyTextWorks)
 	{
 		string mary(getFirstNChars("Mary had a little lamb", 3));
@@ -57,5 +260,52 @@ namespace ac {
 	}
 	
 	
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Loading Benchmark
+
+	BOOST_FIXTURE_TEST_SUITE(CopyTextLoadingBenchmark, CopyTextLoadingFixture)
+
+	// the dante canto repeated into a corpus of a few megabytes, one paragraph per repetition
+	BOOST_AUTO_TEST_CASE(LoadingAMultiMegabyteCorpus)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t CorpusSize = 4 * 1024 * 1024;
+		const size_t MaxCharsPerLine = 40;
+
+		boost::property_tree::ptree pt;
+		boost::property_tree::read_json(utilities::getFullPathForFilename("text/dante-canto-1.json"), pt);
+		const string canto(pt.get<string>("content", ""));
+		BOOST_REQUIRE(!canto.empty());
+
+		string corpus("{ \"author\": \"unknown\", \"content\": \"");
+		while (corpus.size() < CorpusSize) {
+			corpus += canto;
+			corpus += "\\n";
+		}
+		corpus += "\" }";
+		const string path(writeScratchFile("benchmark-corpus.json", corpus));
+
+		const clock::time_point beforeStart = clock::now();
+		std::vector<string> expected(legacyLoadLines(path, MaxCharsPerLine));
+		const clock::duration before = clock::now() - beforeStart;
+
+		loader.setMaxCharsPerLine(MaxCharsPerLine);
+		const clock::time_point afterStart = clock::now();
+		loader.loadTextFile(path);
+		const clock::duration after = clock::now() - afterStart;
+		loader.setMaxCharsPerLine(0);
+
+		BOOST_REQUIRE_EQUAL(loader.getNumberOfLines(), expected.size());
+		BOOST_REQUIRE_EQUAL(loader.getLine(expected.size() / 2), expected[expected.size() / 2]);
+
+		const double msBefore = std::chrono::duration<double, std::milli>(before).count();
+		const double msAfter = std::chrono::duration<double, std::milli>(after).count();
+		BOOST_TEST_MESSAGE(boost::format("Copy text loading: %.1f ms with the property tree, %.1f ms streamed "
+										 "(%d bytes, %d lines)") % msBefore % msAfter % corpus.size() % expected.size());
+		BOOST_WARN_LT(msAfter, msBefore);
+	}
+
 	BOOST_AUTO_TEST_SUITE_END()
 }
\ No newline at end of file
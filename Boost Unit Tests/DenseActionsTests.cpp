@@ -0,0 +1,262 @@
+//
+//  DenseActionsTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/28/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CCDenseActions.h"
+#include "CCPooledAllocation.h"
+
+namespace ac {
+
+	namespace {
+
+		// has what the action manager needs of a CCNode
+		struct ActionTarget
+		{
+			float x;
+			int retains;
+
+			ActionTarget() : x(0), retains(0) {}
+
+			inline void retain() { retains++; }
+			inline void release() { retains--; }
+		};
+
+
+		// reference counted like a CCAction, deleting itself on the last release
+		class TestAction
+		{
+		public:
+			TestAction(ActionTarget *target, float duration, int tag = -1) : target(target), duration(duration),
+			elapsed(0), tag(tag), references(1), stopped(false) {}
+			virtual ~TestAction() {}
+
+			inline void retain() { references++; }
+			inline void release() { if (--references == 0) delete this; }
+			inline int getTag() const { return tag; }
+
+			void step(float dt)
+			{
+				elapsed += dt;
+				update(std::min(1.0f, elapsed / duration));
+				if (onStep) onStep();
+			}
+
+			inline bool isDone() const { return elapsed >= duration; }
+			inline void stop() { stopped = true; }
+
+			virtual void update(float t) {}
+
+			ActionTarget *target;
+			float duration;
+			float elapsed;
+			int tag;
+			int references;
+			bool stopped;
+			std::function<void()> onStep;
+		};
+
+
+		// a CCMoveTo, along x
+		class TestMoveTo : public TestAction
+		{
+			CC_POOLED_ALLOCATION(TestMoveTo)
+
+			TestMoveTo(ActionTarget *target, float duration, float to) : TestAction(target, duration), from(target->x),
+			to(to) {}
+
+			virtual void update(float t) { target->x = from + (to - from) * t; }
+
+			float from;
+			float to;
+		};
+
+
+		// the same, without a pool of its own
+		class TestHeapMoveTo : public TestMoveTo
+		{
+		public:
+			TestHeapMoveTo(ActionTarget *target, float duration, float to) : TestMoveTo(target, duration, to), unused(0) {}
+
+			long unused;
+		};
+
+		typedef cocos2d::CCDenseActions<ActionTarget, TestAction> Actions;
+		typedef cocos2d::CCPooledAllocation<TestMoveTo> MoveToPool;
+
+		// as CCNode::runAction does with a new, autoreleased action
+		template <class Action>
+		Action *run(Actions &actions, ActionTarget *target, Action *action, bool paused = false)
+		{
+			actions.add(action, target, paused);
+			action->release();
+			return action;
+		}
+	}
+
+
+	BOOST_AUTO_TEST_SUITE(DenseActionsTests)
+
+	BOOST_AUTO_TEST_CASE(ActionsStepUntilTheyreDone)
+	{
+		std::vector<ActionTarget> targets(3);
+		Actions actions;
+
+		TestAction *first = run(actions, &targets[2], new TestAction(&targets[2], 0.5f, 7));
+		TestAction *second = run(actions, &targets[2], new TestAction(&targets[2], 1, 7));
+		TestMoveTo *move = run(actions, &targets[0], new TestMoveTo(&targets[0], 1, 100));
+		TestAction *paused = run(actions, &targets[1], new TestAction(&targets[1], 0.5f), true);
+		first->retain(); // to look at after it's done
+
+		BOOST_CHECK_EQUAL(actions.size(), 4);
+		BOOST_CHECK_EQUAL(actions.count(&targets[2]), 2);
+		BOOST_CHECK_EQUAL(actions.getByTag(7, &targets[2]), first);
+		BOOST_CHECK_EQUAL(targets[2].retains, 2);
+
+		actions.update(0.25f);
+		BOOST_CHECK_EQUAL(targets[0].x, 25);
+		actions.update(0.25f);
+		BOOST_CHECK(first->stopped);
+		BOOST_CHECK_EQUAL(first->references, 1);
+		BOOST_CHECK_EQUAL(actions.getByTag(7, &targets[2]), second);
+		BOOST_CHECK_EQUAL(paused->elapsed, 0);
+		first->release();
+
+		// added to a paused target, so paused too
+		TestAction *alsoPaused = run(actions, &targets[1], new TestAction(&targets[1], 0.5f));
+		actions.update(0.25f);
+		BOOST_CHECK_EQUAL(alsoPaused->elapsed, 0);
+		actions.setPaused(&targets[1], false);
+
+		// one that stops another target's actions (which haven't been stepped yet) and itself from its step
+		move->onStep = [&] {
+			actions.removeAllFromTarget(&targets[2]);
+			actions.remove(move, &targets[0]);
+		};
+		actions.update(0.25f);
+		BOOST_CHECK_EQUAL(targets[0].x, 100);
+		BOOST_CHECK_EQUAL(second->elapsed, 0.75f);
+		BOOST_CHECK_EQUAL(targets[0].retains, 0);
+		BOOST_CHECK_EQUAL(targets[2].retains, 0);
+		BOOST_CHECK_EQUAL(actions.size(), 2);
+
+		actions.removeByTag(-1, &targets[1]);
+		BOOST_CHECK_EQUAL(actions.count(&targets[1]), 1);
+		actions.removeAll();
+		BOOST_CHECK_EQUAL(actions.size(), 0);
+		BOOST_CHECK_EQUAL(targets[1].retains, 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(PooledActionsReuseTheirMemory)
+	{
+		ActionTarget target;
+		MoveToPool::reserve(4);
+		const size_t liveAtStart = MoveToPool::live();
+
+		long allocations;
+		void *first, *again;
+		{
+			AllocationCounter counter;
+			TestMoveTo *move = new TestMoveTo(&target, 1, 10);
+			first = move;
+			BOOST_CHECK_EQUAL(MoveToPool::live(), liveAtStart + 1);
+			move->release();
+			BOOST_CHECK_EQUAL(MoveToPool::live(), liveAtStart);
+
+			move = new TestMoveTo(&target, 1, 20);
+			again = move;
+			move->release();
+			allocations = counter.allocations();
+		}
+		BOOST_CHECK_EQUAL(first, again);
+		BOOST_CHECK_EQUAL(allocations, 0);
+
+		// a subclass that's a different size goes to the heap
+		{
+			AllocationCounter counter;
+			TestAction *heap = new TestHeapMoveTo(&target, 1, 10);
+			BOOST_CHECK_EQUAL(MoveToPool::live(), liveAtStart);
+			heap->release();
+			allocations = counter.allocations();
+		}
+		BOOST_CHECK_EQUAL(allocations, 1);
+	}
+
+
+	// Five thousand actions at a time over a thousand targets, each running for a quarter to three quarters of a
+	// second and replaced by a new one as it finishes, once with the actions coming out of their pool and once from
+	// the heap as CCActions used to.
+	template <class MoveTo>
+	void runConcurrentActions(const char *name, long &allocations)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t Targets = 1000, Concurrent = 5000, Frames = 600;
+		const float FrameTime = 1.0f / 60;
+
+		std::vector<ActionTarget> targets(Targets);
+		Actions actions;
+		actions.reserve(Concurrent * 2);
+		MoveToPool::reserve(Concurrent * 2);
+
+		size_t started = 0, stepped = 0;
+		std::vector<TestAction *> running(Concurrent);
+		clock::duration elapsed;
+		{
+			AllocationCounter counter;
+			const clock::time_point start = clock::now();
+			for (size_t frame = 0; frame < Frames; frame++) {
+				for (size_t i = 0; i < Concurrent; i++) {
+					if (running[i] && !running[i]->isDone()) continue;
+					if (running[i]) running[i]->release();
+
+					ActionTarget *target = &targets[(started * 7) % Targets];
+					const float duration = 0.25f + (started % 32) / 64.0f;
+					running[i] = run(actions, target, new MoveTo(target, duration, (float) (started % 100)));
+					running[i]->retain();
+					started++;
+				}
+				stepped += actions.size();
+				actions.update(FrameTime);
+			}
+			elapsed = clock::now() - start;
+			allocations = counter.allocations();
+		}
+
+		const double nsPerAction = std::chrono::duration<double, std::nano>(elapsed).count() / stepped;
+		BOOST_TEST_MESSAGE(boost::format("%s: %.1f ns per action per frame, %d actions started, %d allocations") %
+						   name % nsPerAction % started % allocations);
+
+		BOOST_CHECK_LE(actions.size(), Concurrent);
+		BOOST_CHECK_GT(started, Concurrent * 10);
+
+		for (TestAction *action : running) action->release();
+		actions.removeAll();
+		for (const ActionTarget &target : targets) {
+			BOOST_REQUIRE_EQUAL(target.retains, 0);
+		}
+	}
+
+
+	BOOST_AUTO_TEST_CASE(FiveThousandConcurrentActions)
+	{
+		const size_t liveAtStart = MoveToPool::live();
+		long pooled, heap;
+		runConcurrentActions<TestMoveTo>("Pooled dense actions", pooled);
+		runConcurrentActions<TestHeapMoveTo>("Heap allocated dense actions", heap);
+
+		BOOST_CHECK_EQUAL(pooled, 0);
+		BOOST_CHECK_GT(heap, 0);
+		BOOST_CHECK_EQUAL(MoveToPool::live(), liveAtStart);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
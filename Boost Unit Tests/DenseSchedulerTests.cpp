@@ -0,0 +1,245 @@
+//
+//  DenseSchedulerTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/28/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CCDenseScheduler.h"
+
+namespace ac {
+
+	// has what the scheduler needs of a CCObject
+	struct FakeNode
+	{
+		int id;
+		int retains;
+		int updates;
+		int ticks;
+		float lastTick;
+		std::vector<int> *calls;
+		std::function<void()> onUpdate;
+
+		FakeNode(int id = 0, std::vector<int> *calls = nullptr) : id(id), retains(0), updates(0), ticks(0), lastTick(0),
+		calls(calls) {}
+
+		inline void retain() { retains++; }
+		inline void release() { retains--; }
+
+		void update(float dt)
+		{
+			updates++;
+			if (calls) calls->push_back(id);
+			if (onUpdate) onUpdate();
+		}
+
+		void tick(float elapsed)
+		{
+			ticks++;
+			lastTick = elapsed;
+		}
+
+		void tock(float elapsed) {}
+	};
+
+	typedef cocos2d::CCDenseScheduler<FakeNode> Scheduler;
+
+
+	BOOST_AUTO_TEST_SUITE(DenseSchedulerTests)
+
+	BOOST_AUTO_TEST_CASE(UpdatesGoInOrderOfPriority)
+	{
+		std::vector<int> calls;
+		FakeNode a(1, &calls), b(2, &calls), c(3, &calls), d(4, &calls), e(5, &calls), late(6, &calls);
+		Scheduler scheduler;
+
+		scheduler.scheduleUpdate(&a, 0, false);
+		scheduler.scheduleUpdate(&b, 5, false);
+		scheduler.scheduleUpdate(&c, -5, false);
+		scheduler.scheduleUpdate(&d, 0, false);
+		scheduler.scheduleUpdate(&e, 0, true);
+		scheduler.scheduleUpdate(&a, 10, false); // already there, stays at 0
+		BOOST_CHECK_EQUAL(a.retains, 1);
+
+		scheduler.update(0.1f);
+		BOOST_CHECK((calls == std::vector<int> { 3, 1, 4, 2 }));
+
+		// d unschedules b, which was to come after it (so b doesn't get to schedule anything), and schedules one that
+		// goes before it
+		d.onUpdate = [&] {
+			scheduler.unscheduleUpdate(&b);
+			scheduler.scheduleUpdate(&late, -10, false);
+			scheduler.scheduleUpdate(&e, 0, false); // still paused
+		};
+		b.onUpdate = [&] { scheduler.scheduleUpdate(&late, 20, false); };
+		calls.clear();
+		scheduler.update(0.1f);
+		BOOST_CHECK((calls == std::vector<int> { 3, 1, 4 }));
+		BOOST_CHECK_EQUAL(b.retains, 0); // released at the end
+
+		d.onUpdate = nullptr;
+		scheduler.setPaused(&e, false);
+		calls.clear();
+		scheduler.update(0.1f);
+		BOOST_CHECK((calls == std::vector<int> { 6, 3, 1, 4, 5 }));
+
+		scheduler.unscheduleAllWithMinPriority(0);
+		BOOST_CHECK_EQUAL(scheduler.updateCount(), 2);
+		BOOST_CHECK_EQUAL(a.retains, 0);
+		BOOST_CHECK_EQUAL(c.retains, 1);
+		scheduler.unscheduleAllWithMinPriority(-100);
+		BOOST_CHECK_EQUAL(scheduler.targetCount(), 0);
+		BOOST_CHECK_EQUAL(late.retains, 0);
+	}
+
+
+	// the same as CCTimer's: the first frame only starts the clock, and the selector is passed the time since it was
+	// last called
+	BOOST_AUTO_TEST_CASE(SelectorsKeepCCTimersTiming)
+	{
+		FakeNode forever, twice, delayed;
+		Scheduler scheduler;
+
+		scheduler.scheduleSelector(&forever, &FakeNode::tick, 0.25f, Scheduler::RepeatForever, 0, false);
+		scheduler.scheduleSelector(&twice, &FakeNode::tick, 0.25f, 1, 0, false);
+		scheduler.scheduleSelector(&delayed, &FakeNode::tick, 0.5f, 1, 1, false);
+		scheduler.scheduleSelector(&delayed, &FakeNode::tock, 0, Scheduler::RepeatForever, 0, false);
+		BOOST_CHECK_EQUAL(delayed.retains, 1);
+
+		scheduler.update(0.125f); // starting
+		scheduler.update(0.125f);
+		BOOST_CHECK_EQUAL(forever.ticks, 0);
+		scheduler.update(0.125f);
+		BOOST_CHECK_EQUAL(forever.ticks, 1);
+		BOOST_CHECK_EQUAL(forever.lastTick, 0.25f);
+		BOOST_CHECK_EQUAL(twice.ticks, 1);
+
+		for (int i = 0; i < 6; i++) scheduler.update(0.125f);
+		BOOST_CHECK_EQUAL(forever.ticks, 4);
+		BOOST_CHECK_EQUAL(twice.ticks, 2);
+		BOOST_CHECK_EQUAL(twice.retains, 0);
+		BOOST_CHECK_EQUAL(delayed.ticks, 1); // after a second, then once more
+		BOOST_CHECK_EQUAL(delayed.lastTick, 1);
+
+		for (int i = 0; i < 4; i++) scheduler.update(0.125f);
+		BOOST_CHECK_EQUAL(delayed.ticks, 2);
+		BOOST_CHECK(!scheduler.isScheduled(scheduler.selectorHandle(&delayed, &FakeNode::tick)));
+		BOOST_CHECK(scheduler.isScheduled(scheduler.selectorHandle(&delayed, &FakeNode::tock)));
+		BOOST_CHECK_EQUAL(scheduler.selectorCount(), 2);
+
+		// rescheduling only changes the interval
+		scheduler.scheduleSelector(&forever, &FakeNode::tick, 10, Scheduler::RepeatForever, 0, false);
+		scheduler.setPaused(&delayed, true);
+		BOOST_CHECK(scheduler.isPaused(&delayed));
+		scheduler.update(1);
+		BOOST_CHECK_EQUAL(forever.ticks, 6);
+		BOOST_CHECK_EQUAL(scheduler.selectorCount(), 2);
+
+		scheduler.unscheduleAllForTarget(&delayed);
+		scheduler.unscheduleAllForTarget(&forever);
+		BOOST_CHECK_EQUAL(delayed.retains, 0);
+		BOOST_CHECK_EQUAL(forever.retains, 0);
+		BOOST_CHECK_EQUAL(scheduler.targetCount(), 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(HandlesOutliveTheEntriesMoving)
+	{
+		std::vector<FakeNode> nodes(100);
+		std::vector<Scheduler::Handle> handles;
+		Scheduler scheduler;
+
+		for (FakeNode &node : nodes) {
+			handles.push_back(scheduler.scheduleSelector(&node, &FakeNode::tick, 0, Scheduler::RepeatForever, 0, false));
+			scheduler.scheduleUpdate(&node, (int) handles.size() % 3, false);
+		}
+
+		// every other one, which moves the rest about
+		for (size_t i = 0; i < nodes.size(); i += 2) {
+			scheduler.unschedule(handles[i]);
+			scheduler.unscheduleUpdate(&nodes[i]);
+		}
+		for (size_t i = 0; i < nodes.size(); i++) {
+			BOOST_CHECK_EQUAL(scheduler.isScheduled(handles[i]), i % 2 == 1);
+			BOOST_CHECK_EQUAL(nodes[i].retains, (int) i % 2);
+		}
+
+		// a slot that's reused gets a new handle
+		const Scheduler::Handle reused(scheduler.scheduleSelector(&nodes[0], &FakeNode::tock, 0, 0, 0, false));
+		BOOST_CHECK(scheduler.isScheduled(reused));
+		BOOST_CHECK(!scheduler.isScheduled(handles[0]) && !scheduler.isScheduled(handles[98]));
+
+		scheduler.update(0.1f);
+		scheduler.update(0.1f);
+		for (size_t i = 1; i < nodes.size(); i += 2) {
+			scheduler.unschedule(handles[i]);
+			BOOST_CHECK_EQUAL(nodes[i].ticks, 1);
+			BOOST_CHECK_EQUAL(nodes[i].updates, 2);
+		}
+		BOOST_CHECK_EQUAL(scheduler.selectorCount(), 0); // the one that reused a slot only went once
+		BOOST_CHECK_EQUAL(scheduler.updateCount(), 50);
+	}
+
+
+	// Ten thousand targets, each with a custom selector and every other one with an update as well, while every frame
+	// a hundred of them have theirs unscheduled and scheduled again (as the stats HUD's timer and the blocks' touch
+	// holds do).
+	BOOST_AUTO_TEST_CASE(TenThousandScheduledSelectors)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t Targets = 10000, Frames = 600, ChurnPerFrame = 100;
+
+		std::vector<FakeNode> nodes(Targets);
+		Scheduler scheduler;
+		scheduler.reserve(Targets, Targets * 2);
+
+		long allocations;
+		clock::duration elapsed;
+		{
+			AllocationCounter counter;
+			const clock::time_point start = clock::now();
+			for (size_t i = 0; i < Targets; i++) {
+				scheduler.scheduleSelector(&nodes[i], &FakeNode::tick, (i % 4) / 60.0f, Scheduler::RepeatForever, 0,
+										   false);
+				if (i % 2) scheduler.scheduleUpdate(&nodes[i], (int) (i % 3), false);
+			}
+
+			size_t next = 0;
+			for (size_t frame = 0; frame < Frames; frame++) {
+				for (size_t k = 0; k < ChurnPerFrame; k++) {
+					FakeNode *node = &nodes[next++ % Targets];
+					scheduler.unscheduleSelector(node, &FakeNode::tick);
+					scheduler.scheduleSelector(node, &FakeNode::tick, 0, Scheduler::RepeatForever, 0, false);
+				}
+				scheduler.update(1.0f / 60);
+			}
+			elapsed = clock::now() - start;
+			allocations = counter.allocations();
+		}
+
+		const size_t selectors = Targets + Targets / 2;
+		const double nsPerSelector = std::chrono::duration<double, std::nano>(elapsed).count() / (selectors * Frames);
+		BOOST_TEST_MESSAGE(boost::format("Dense scheduler: %.1f ns per scheduled selector per frame, %d selectors") %
+						   nsPerSelector % selectors);
+
+		BOOST_CHECK_EQUAL(allocations, 0);
+		BOOST_CHECK_EQUAL(scheduler.selectorCount(), Targets);
+		BOOST_CHECK_EQUAL(scheduler.updateCount(), Targets / 2);
+		BOOST_CHECK_EQUAL(nodes[1].updates, Frames);
+		BOOST_CHECK_GT(nodes[Targets - 1].ticks, 0);
+
+		scheduler.unscheduleAllWithMinPriority(INT_MIN);
+		for (const FakeNode &node : nodes) {
+			BOOST_REQUIRE_EQUAL(node.retains, 0);
+		}
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
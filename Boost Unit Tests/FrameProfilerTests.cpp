@@ -0,0 +1,147 @@
+//
+//  FrameProfilerTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/27/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <sstream>
+#include "FrameProfiler.h"
+
+namespace ac {
+
+	typedef FrameProfiler::Section Section;
+
+	struct FrameProfilerFixture
+	{
+		FrameProfilerFixture() : profiler(FrameProfiler::getInstance())
+		{
+			profiler.reset();
+			profiler.setEnabled(true);
+		}
+
+		~FrameProfilerFixture()
+		{
+			profiler.setEnabled(false);
+			profiler.reset();
+		}
+
+		FrameProfiler &profiler;
+	};
+
+
+	BOOST_FIXTURE_TEST_SUITE(FrameProfilerTests, FrameProfilerFixture)
+
+	BOOST_AUTO_TEST_CASE(SectionsAddUpWithinAFrame)
+	{
+		profiler.beginSection(Section::Visit, 0); // outside a frame
+		profiler.endSection(Section::Visit, 500);
+
+		profiler.beginFrame(1000);
+		profiler.beginSection(Section::SchedulerUpdate, 1000);
+		profiler.beginSection(Section::ActionManager, 1100);
+		profiler.endSection(Section::ActionManager, 1300);
+		profiler.beginSection(Section::ActionManager, 1400);
+		profiler.endSection(Section::ActionManager, 1450);
+		profiler.endSection(Section::SchedulerUpdate, 1500);
+
+		// re-entered within itself: only the outermost counts
+		profiler.beginSection(Section::Visit, 1500);
+		profiler.beginSection(Section::Visit, 1600);
+		profiler.endSection(Section::Visit, 1700);
+		profiler.endSection(Section::Visit, 1900);
+		profiler.endFrame(2000);
+
+		BOOST_REQUIRE_EQUAL(profiler.frameCount(), 1);
+		const FrameProfiler::Frame &frame(profiler.frameAt(0));
+		BOOST_CHECK_EQUAL(frame.begin, 1000);
+		BOOST_CHECK_EQUAL(frame.duration, 1000);
+		BOOST_CHECK_EQUAL(frame.sections[(size_t) Section::SchedulerUpdate], 500);
+		BOOST_CHECK_EQUAL(frame.sections[(size_t) Section::ActionManager], 250);
+		BOOST_CHECK_EQUAL(frame.sections[(size_t) Section::Visit], 400);
+		BOOST_CHECK_EQUAL(frame.sections[(size_t) Section::SortChildren], 0);
+
+		// nothing is kept while disabled
+		profiler.setEnabled(false);
+		profiler.beginFrame(3000);
+		profiler.endFrame(4000);
+		BOOST_CHECK_EQUAL(profiler.frameCount(), 1);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(ScopesTimeTheRealClock)
+	{
+		profiler.beginFrame();
+		{
+			FrameProfiler::Scope scope(Section::NotifDispatch);
+			volatile int sink = 0;
+			for (int i = 0; i < 10000; i++) sink += i;
+		}
+		profiler.endFrame();
+
+		BOOST_REQUIRE_EQUAL(profiler.frameCount(), 1);
+		const FrameProfiler::Frame &frame(profiler.frameAt(0));
+		BOOST_CHECK_GT(frame.sections[(size_t) Section::NotifDispatch], 0);
+		BOOST_CHECK_LE(frame.sections[(size_t) Section::NotifDispatch], frame.duration);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(StatsRollOverTheLastFrames)
+	{
+		// frame i takes i microseconds, a tenth of which is sorting
+		const size_t Frames = 1000;
+		uint64_t now = 0;
+		for (size_t i = 1; i <= Frames; i++) {
+			profiler.beginFrame(now);
+			profiler.beginSection(Section::SortChildren, now);
+			profiler.endSection(Section::SortChildren, now + i * 100);
+			profiler.endFrame(now + i * 1000);
+			now += i * 1000;
+		}
+
+		const size_t kept = FrameProfiler::FrameCapacity;
+		BOOST_REQUIRE_EQUAL(profiler.frameCount(), kept);
+		BOOST_CHECK_EQUAL(profiler.framesRecorded(), Frames);
+		BOOST_CHECK_EQUAL(profiler.frameAt(0).duration, (Frames - kept + 1) * 1000);
+
+		const FrameProfiler::Stats frames(profiler.frameStats());
+		BOOST_CHECK_EQUAL(frames.frames, kept);
+		BOOST_CHECK_EQUAL(frames.min, (Frames - kept + 1) * 1000);
+		BOOST_CHECK_EQUAL(frames.max, Frames * 1000);
+		BOOST_CHECK_EQUAL(frames.avg, (Frames - kept + 1 + Frames) * 1000 / 2);
+		BOOST_CHECK_EQUAL(frames.p99, (Frames - 6) * 1000); // 594 of the 600 are at or under it
+
+		const FrameProfiler::Stats sorting(profiler.sectionStats(Section::SortChildren));
+		BOOST_CHECK_EQUAL(sorting.max, Frames * 100);
+		BOOST_CHECK_EQUAL(profiler.sectionStats(Section::Visit).max, 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(CSVHasARowPerFrame)
+	{
+		for (uint64_t i = 0; i < 3; i++) {
+			profiler.beginFrame(i * 16000000);
+			profiler.beginSection(Section::Visit, i * 16000000 + 1000);
+			profiler.endSection(Section::Visit, i * 16000000 + 3500);
+			profiler.endFrame(i * 16000000 + 8000000);
+		}
+
+		std::ostringstream csv;
+		profiler.writeCSV(csv);
+		const std::string text(csv.str());
+
+		BOOST_CHECK_EQUAL(std::count(text.begin(), text.end(), '\n'), 4);
+		BOOST_CHECK_EQUAL(text.substr(0, text.find('\n')), "frame,begin_us,frame_us,SchedulerUpdate_us,"
+						  "ActionManager_us,ParticleUpdate_us,Visit_us,SortChildren_us,NotifDispatch_us");
+		BOOST_CHECK(text.find("\n2,32000.000,8000.000,0.000,0.000,0.000,2.500,0.000,0.000\n") != std::string::npos);
+
+		std::ostringstream summary;
+		profiler.writeSummary(summary);
+		BOOST_CHECK(summary.str().find("Visit") != std::string::npos);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
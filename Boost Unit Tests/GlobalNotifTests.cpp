@@ -7,6 +7,9 @@
 //
 
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <boost/thread.hpp>
 #include "Notif.h"
 
 namespace ac {
@@ -46,6 +49,39 @@ namespace ac {
 	};
 	
 	
+	// The same, but only for the topics it asks for and with typed payloads
+	class SampleTopicListener : public NotifListener
+	{
+	public:
+
+		SampleTopicListener() : i(0), f(0), callCount(0)
+		{
+			listenTo({ Notif::topic("GlobalNotifTests_SampleEvent1"), Notif::topic("GlobalNotifTests_SampleEvent3") });
+		}
+
+		void topicCallback(notif_topic_t topic, const NotifData &data)
+		{
+			callCount++;
+			if (Notif::topic("GlobalNotifTests_SampleEvent1") == topic) {
+				const SampleStruct1 *ss = data.get<SampleStruct1>();
+				if (ss) {
+					this->i = ss->i;
+					this->f = ss->f;
+				}
+			}
+		}
+
+		inline int getI() const { return i; }
+		inline float getF() const { return f; }
+		inline int getCallCount() const { return callCount; }
+
+	private:
+		int i;
+		float f;
+		int callCount;
+	};
+
+
 	struct GlobalNotifTestFixture
 	{
 		GlobalNotifTestFixture() {
@@ -87,5 +123,363 @@ namespace ac {
 		BOOST_REQUIRE_EQUAL(listener.getI(), 0);
 	}
 	
+	BOOST_AUTO_TEST_CASE(TopicsAreInternedOnce)
+	{
+		const notif_topic_t topic = Notif::topic("GlobalNotifTests_SampleEvent1");
+		BOOST_REQUIRE_EQUAL(topic, Notif::topic("GlobalNotifTests_SampleEvent1"));
+		BOOST_REQUIRE_GE(topic, notif::NumberOfPredefinedTopics);
+		BOOST_REQUIRE_EQUAL(Notif::topicName(topic), "GlobalNotifTests_SampleEvent1");
+
+		// predefined codes resolve to their enum values
+		BOOST_REQUIRE_EQUAL(Notif::topic("CopyText_Advance"), notif::CopyText_Advance);
+		BOOST_REQUIRE_EQUAL(Notif::topicName(notif::StatsHUDView_TimerExpired), "StatsHUDView_TimerExpired");
+	}
+
+
+	BOOST_AUTO_TEST_CASE(TypedPayloadsReachOnlyTopicSubscribers)
+	{
+		SampleTopicListener topicListener;
+
+		SampleStruct1 ss = { 7, 1.5f };
+		Notif::send(Notif::topic("GlobalNotifTests_SampleEvent2"), ss); // not subscribed
+		BOOST_REQUIRE_EQUAL(topicListener.getCallCount(), 0);
+
+		Notif::send(Notif::topic("GlobalNotifTests_SampleEvent1"), ss);
+		BOOST_REQUIRE_EQUAL(topicListener.getCallCount(), 1);
+		BOOST_REQUIRE_EQUAL(topicListener.getI(), 7);
+		BOOST_REQUIRE_EQUAL(topicListener.getF(), 1.5f);
+
+		// the catch-all listener still gets it, by code
+		BOOST_REQUIRE_EQUAL(listener.getI(), 7);
+		BOOST_REQUIRE_EQUAL(listener.getF(), 1.5f);
+
+		// a payload of the wrong type is not handed out
+		int notAStruct = 3;
+		NotifData data(notAStruct);
+		BOOST_REQUIRE(data.get<SampleStruct1>() == nullptr);
+		BOOST_REQUIRE_EQUAL(*data.get<int>(), 3);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(StringSendsReachTopicSubscribers)
+	{
+		SampleTopicListener topicListener;
+
+		std::shared_ptr<SampleStruct1> sap(new SampleStruct1);
+		sap->i = 5;
+		sap->f = 2.5;
+		Notif::send("GlobalNotifTests_SampleEvent1", sap);
+
+		BOOST_REQUIRE_EQUAL(topicListener.getI(), 5);
+		BOOST_REQUIRE_EQUAL(topicListener.getF(), 2.5f);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(SubscribersCanLeaveDuringDispatch)
+	{
+		const notif_topic_t topic = Notif::topic("GlobalNotifTests_SampleEvent4");
+		int firstCount = 0, secondCount = 0;
+
+		NotifSubscription second = { topic, 0 };
+		NotifSubscription first = Notif::subscribe(topic, [&](notif_topic_t, const NotifData &) {
+			firstCount++;
+			Notif::unsubscribe(second);
+		});
+		second = Notif::subscribe(topic, [&](notif_topic_t, const NotifData &) {
+			secondCount++;
+		});
+
+		Notif::send(topic);
+		Notif::send(topic);
+		Notif::unsubscribe(first);
+		Notif::send(topic);
+
+		BOOST_REQUIRE_EQUAL(firstCount, 2);
+		BOOST_REQUIRE_EQUAL(secondCount, 0);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Deferred Dispatch
+
+	struct DeferredNotifTestFixture
+	{
+		DeferredNotifTestFixture() : topicA(Notif::topic("DeferredNotifTests_A")), topicB(Notif::topic("DeferredNotifTests_B"))
+		{
+			Notif::setDeferredDispatch(true);
+			for (notif_topic_t topic : { topicA, topicB }) {
+				subscriptions.push_back(Notif::subscribe(topic, [this](notif_topic_t topic, const NotifData &data) {
+					const SampleStruct1 *ss = data.get<SampleStruct1>();
+					received.push_back(std::make_pair(topic, ss ? ss->i : -1));
+				}));
+			}
+		}
+
+		~DeferredNotifTestFixture()
+		{
+			Notif::setDeferredDispatch(false);
+			for (const auto &subscription : subscriptions) Notif::unsubscribe(subscription);
+			Notif::setCoalesced(topicA, false);
+		}
+
+		notif_topic_t topicA, topicB;
+		std::vector<NotifSubscription> subscriptions;
+		std::vector<std::pair<notif_topic_t, int>> received;
+	};
+
+
+	BOOST_FIXTURE_TEST_SUITE(DeferredNotifTests, DeferredNotifTestFixture)
+
+	BOOST_AUTO_TEST_CASE(PostsWaitForTheDrain)
+	{
+		SampleStruct1 ss = { 4, 0 };
+		Notif::post(topicA, ss);
+		Notif::post(topicB);
+		BOOST_REQUIRE(received.empty());
+
+		BOOST_REQUIRE_EQUAL(Notif::dispatchDeferred(), 2);
+		BOOST_REQUIRE_EQUAL(received.size(), 2);
+		BOOST_REQUIRE_EQUAL(received[0].first, topicA);
+		BOOST_REQUIRE_EQUAL(received[0].second, 4); // the payload was copied, not referenced
+		BOOST_REQUIRE_EQUAL(received[1].first, topicB);
+
+		BOOST_REQUIRE_EQUAL(Notif::dispatchDeferred(), 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(CoalescedTopicsDeliverOnlyTheLastPost)
+	{
+		Notif::setCoalesced(topicA);
+		for (int i = 1; i <= 5; i++) {
+			SampleStruct1 ss = { i, 0 };
+			Notif::post(topicA, ss);
+			if (i == 2) Notif::post(topicB);
+		}
+
+		BOOST_REQUIRE_EQUAL(Notif::dispatchDeferred(), 2);
+		BOOST_REQUIRE_EQUAL(received.size(), 2);
+		BOOST_REQUIRE_EQUAL(received[0].first, topicB);
+		BOOST_REQUIRE_EQUAL(received[1].first, topicA);
+		BOOST_REQUIRE_EQUAL(received[1].second, 5);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(PostsFromCallbacksWaitForTheNextDrain)
+	{
+		NotifSubscription chain = Notif::subscribe(topicA, [this](notif_topic_t, const NotifData &) {
+			Notif::post(topicB);
+		});
+
+		Notif::post(topicA);
+		BOOST_REQUIRE_EQUAL(Notif::dispatchDeferred(), 1);
+		BOOST_REQUIRE_EQUAL(received.size(), 1);
+		BOOST_REQUIRE_EQUAL(Notif::dispatchDeferred(), 1);
+		BOOST_REQUIRE_EQUAL(received.back().first, topicB);
+
+		Notif::unsubscribe(chain);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(PostsFromSeveralThreadsAllArrive)
+	{
+		const int PerThread = 20000;
+		const notif_topic_t topic = Notif::topic("DeferredNotifTests_C");
+
+		// a full ring falls back to sending on the producer's thread, so the subscriber has to be thread safe
+		std::atomic<int> count(0);
+		std::atomic<long> sum(0);
+		NotifSubscription counter = Notif::subscribe(topic, [&](notif_topic_t, const NotifData &data) {
+			count++;
+			sum += data.get<SampleStruct1>()->i;
+		});
+
+		std::atomic<int> producersDone(0);
+		auto producer = [&](int base) {
+			for (int i = 0; i < PerThread; i++) {
+				SampleStruct1 ss = { base + i, 0 };
+				Notif::post(topic, ss);
+			}
+			producersDone++;
+		};
+		boost::thread first(producer, 0), second(producer, PerThread);
+
+		while (producersDone < 2) {
+			Notif::dispatchDeferred();
+		}
+		first.join();
+		second.join();
+		Notif::dispatchDeferred();
+		Notif::unsubscribe(counter);
+
+		const long n = 2 * PerThread;
+		BOOST_REQUIRE_EQUAL(count, n);
+		BOOST_REQUIRE_EQUAL(sum, n * (n - 1) / 2);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Dispatch Benchmark
+
+	// Notification sequence logged from one correct keystroke followed by one mistaken one, each as a press and a
+	// release. The replay is flat (the original was nested in the callbacks), which doesn't matter for dispatch cost.
+	static const char *RecordedKeypressSession[] = {
+		"KeyboardView_KeyPress", "KeypressTracker_RequiresUIRefresh", "CopyText_Preadvance", "BlockCanvasModel_Highlight",
+		"KeyboardView_KeyPress", "KeypressTracker_RequiresUIRefresh", "ScoreKeeper_LevelProgressUpdate",
+		"StatsHUDModel_LevelProgressUpdate", "ScoreKeeper_Score", "BlockCanvasModel_PerBlockScoreDelta",
+		"StatsHUDModel_ScoreOrAccuracyUpdate", "CopyText_Advance", "BlockCanvasModel_Advance",
+		"BlockCanvasView_FinishedPopAnimation", "BlockCanvasModel_DoneAnimation", "StatsHUDModel_UpdateProgress",
+		"KeyboardView_KeyPress", "KeypressTracker_RequiresUIRefresh", "ScoreKeeper_StreakFinished",
+		"StatsHUDModel_StreakFinished", "ScoreKeeper_Mistake", "StatsHUDModel_Mistake", "GameState_Timer_DeductTime",
+		"CopyText_Mistake", "BlockCanvasModel_Mistake",
+		"KeyboardView_KeyPress", "KeypressTracker_RequiresUIRefresh"
+	};
+
+	// what each of the game's listeners responds to, in the order its callback tests for them
+	static const std::vector<std::vector<string>> ListenerInterests = {
+		{ "BlockCanvasModel_Load", "BlockCanvasModel_Advance", "BlockCanvasModel_AdvanceWithSpace", "BlockCanvasModel_Mistake",
+			"BlockCanvasModel_Highlight", "BlockCanvasModel_EndTimer", "BlockCanvasModel_PerBlockScoreDelta" },
+		{ "StatsHUDModel_EndTimer", "ScoreKeeper_Score", "BlockCanvasView_FinishedPopAnimation",
+			"BlockCanvasView_EncasementDowngraded", "BlockCanvasView_ObstructionRemoved", "CopyText_LoadedString",
+			"CopyText_Advance", "CopyText_AdvanceWithSpace", "CopyText_Preadvance", "CopyText_Mistake" },
+		{ "StatsHUDView_TimerExpired", "StatsHUDView_PostGameSubheadlineShown", "CopyText_FirstPress", "CopyText_AllCleared",
+			"CopyText_Blocked", "BlockCanvasModel_DoneAnimation", "BlockCanvasModel_CurrencyCollected", "MainLayer_AddTime",
+			"ScoreKeeper_LevelProgressUpdate", "ScoreKeeper_NewLevelUpdate", "ScoreKeeper_Mistake", "ScoreKeeper_Score",
+			"ScoreKeeper_StreakFinished", "GameState_Timer_StartTimer", "GameState_Timer_StopTimer", "GameState_Timer_AddTime" },
+		{ "StatsHUDModel_AddTime", "StatsHUDModel_AllCleared", "StatsHUDModel_Blocked", "StatsHUDModel_CurrencyCollected",
+			"StatsHUDModel_CurrencyConsumed", "StatsHUDModel_EndTimer", "StatsHUDModel_LevelProgressUpdate",
+			"StatsHUDModel_Mistake", "StatsHUDModel_NewLevel", "StatsHUDModel_ScoreOrAccuracyUpdate",
+			"StatsHUDModel_StartTimer", "StatsHUDModel_StreakFinished", "StatsHUDModel_UpdateProgress",
+			"GameState_Timer_DeductTime" },
+		{ "KeyboardModel_NewLevel", "KeypressTracker_RequiresUIRefresh", "CopyText_Mistake", "KeyboardModel_AltModeToggled" },
+		{ "KeyboardView_KeyPress", "ScoreKeeper_NewLevelUpdate", "KeypressTracker_ModKeyPressed",
+			"KeypressTracker_ModKeyReleased", "CopyText_TriggerAltKey" },
+		{ "ScoreKeeper_Mistake" },
+		{ "CopyText_TriggerAltKey" },
+		{ "AppDelegate_EnteringForeground", "AppDelegate_EnteredBackground", "AppDelegate_FinishLaunch",
+			"KeypressTracker_RequiresUIRefresh" },
+		{ }
+	};
+
+	// benchmark codes are prefixed so that the game's own (singleton) listeners don't react to the replay
+	static string benchmarkCode(const string &code) { return "NotifBenchmark_" + code; }
+
+	struct BenchmarkPayload
+	{
+		int value;
+		float delta;
+	};
+
+	// how listeners were written before topics: see everything, compare codes one after the other
+	class StringChainListener : public NotifListener
+	{
+	public:
+		StringChainListener(const std::vector<string> &interests) : handled(0)
+		{
+			for (const string &code : interests) codes.push_back(benchmarkCode(code));
+		}
+
+		void notifCallback(const string &code, std::shared_ptr<void> data)
+		{
+			for (const string &candidate : codes) {
+				if (candidate == code) {
+					handled += std::static_pointer_cast<BenchmarkPayload>(data)->value;
+					break;
+				}
+			}
+		}
+
+		std::vector<string> codes;
+		long handled;
+	};
+
+	class TopicSwitchListener : public NotifListener
+	{
+	public:
+		TopicSwitchListener(const std::vector<string> &interests) : handled(0)
+		{
+			std::vector<notif_topic_t> topics;
+			for (const string &code : interests) topics.push_back(Notif::topic(benchmarkCode(code)));
+			for (notif_topic_t topic : topics) listenTo({ topic });
+		}
+
+		void topicCallback(notif_topic_t topic, const NotifData &data)
+		{
+			handled += data.get<BenchmarkPayload>()->value;
+		}
+
+		long handled;
+	};
+
+
+	BOOST_AUTO_TEST_SUITE(NotifDispatchBenchmark)
+
+	BOOST_AUTO_TEST_CASE(ReplayedKeypressSessionDispatchesFasterByTopic)
+	{
+		typedef std::chrono::steady_clock clock;
+		const int Repetitions = 20000;
+		const size_t SessionLength = sizeof(RecordedKeypressSession) / sizeof(RecordedKeypressSession[0]);
+		const long eventsSent = (long) Repetitions * SessionLength;
+
+		std::vector<string> codes;
+		std::vector<notif_topic_t> topics;
+		for (const char *code : RecordedKeypressSession) {
+			codes.push_back(benchmarkCode(code));
+			topics.push_back(Notif::topic(codes.back()));
+		}
+
+		// before: string codes broadcast to every listener, payloads on the heap
+		long handledBefore = 0;
+		clock::duration before;
+		{
+			std::vector<std::unique_ptr<StringChainListener>> listeners;
+			for (const auto &interests : ListenerInterests) {
+				listeners.emplace_back(new StringChainListener(interests));
+			}
+
+			const clock::time_point start = clock::now();
+			for (int r = 0; r < Repetitions; r++) {
+				for (const string &code : codes) {
+					std::shared_ptr<BenchmarkPayload> pInfo(new BenchmarkPayload);
+					pInfo->value = 1;
+					Notif::send(code, pInfo);
+				}
+			}
+			before = clock::now() - start;
+
+			for (const auto &listener : listeners) handledBefore += listener->handled;
+		}
+
+		// after: interned topics, per-topic subscribers, payloads on the stack
+		long handledAfter = 0;
+		clock::duration after;
+		{
+			std::vector<std::unique_ptr<TopicSwitchListener>> listeners;
+			for (const auto &interests : ListenerInterests) {
+				listeners.emplace_back(new TopicSwitchListener(interests));
+			}
+
+			const clock::time_point start = clock::now();
+			for (int r = 0; r < Repetitions; r++) {
+				for (notif_topic_t topic : topics) {
+					BenchmarkPayload info = { 1, 0 };
+					Notif::send(topic, info);
+				}
+			}
+			after = clock::now() - start;
+
+			for (const auto &listener : listeners) handledAfter += listener->handled;
+		}
+
+		const double nsBefore = std::chrono::duration<double, std::nano>(before).count() / eventsSent;
+		const double nsAfter = std::chrono::duration<double, std::nano>(after).count() / eventsSent;
+		BOOST_TEST_MESSAGE(boost::format("Notif dispatch: %.1f ns/event with string codes, %.1f ns/event with topics "
+										 "(%d events, %d listeners)") % nsBefore % nsAfter % eventsSent % ListenerInterests.size());
+
+		BOOST_REQUIRE_EQUAL(handledBefore, handledAfter); // same work done either way
+		BOOST_WARN_LT(nsAfter, nsBefore);
+	}
+
 	BOOST_AUTO_TEST_SUITE_END()
 }
@@ -0,0 +1,426 @@
+//
+//  GlyphGeneratorTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/14/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <set>
+#include <boost/format.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include "AliasTable.h"
+#include "Glyph.h"
+#include "GlyphDifficulty.h"
+#include "GlyphGenerator.h"
+#include "PlayerLevel.h"
+
+namespace ac {
+
+	using std::string;
+
+	// GlyphString::generateRandom as it was before GlyphGenerator, drawing from the given engine instead of the
+	// global one.
+	static void legacyGenerateRandom(std::vector<int> &codes, size_t requiredSize, const std::vector<Glyph> &glyphsUsed,
+									 const std::vector<float> &repeatChances, boost::random::mt19937 &rng)
+	{
+		boost::random::uniform_real_distribution<> rChance(0, 1);
+		auto randomChance = [&](float probability) { return rChance(rng) < probability; };
+		auto intVecIsAllTheSame = [](const std::vector<int> &vec) {
+			return std::set<int>(vec.begin(), vec.end()).size() == 1;
+		};
+
+		codes.clear();
+		bool spaceWillBeUsed(false);
+		std::vector<Glyph> actualGlyphsUsed;
+		for (const Glyph &g : glyphsUsed) {
+			if (g.getCode() == 0) {
+				spaceWillBeUsed = true;
+			} else {
+				actualGlyphsUsed.push_back(g);
+			}
+		}
+
+		boost::random::uniform_int_distribution<> rGlyphCode(0, actualGlyphsUsed.size() - 1);
+		const float chanceOfSpace = 0.2f;
+		bool spaceLastAdded = false;
+		size_t lastRepeatOrdinal = 0;
+
+		while (codes.size() < requiredSize) {
+			if (spaceWillBeUsed && !spaceLastAdded && randomChance(chanceOfSpace)) {
+				codes.push_back(0);
+				spaceLastAdded = true;
+			} else {
+				int nextGlyphCode = actualGlyphsUsed[rGlyphCode(rng)].getCode();
+
+				bool hasRepeated = false;
+				for (size_t i = 0; i < repeatChances.size(); i++) {
+					bool spaceFoundInRepeat = false;
+					if (codes.size() > i) {
+						for (int j = i+1; j >= 0; j--) {
+							if (0 ==  codes[codes.size() - (i + 1)]) {
+								spaceFoundInRepeat = true;
+								break;
+							}
+						}
+					}
+
+					if (!spaceFoundInRepeat && codes.size() > i && randomChance(repeatChances[i]) &&
+						i >= lastRepeatOrdinal) {
+						std::vector<int> glyphCodesToAdd;
+						for (size_t j = 0; j < i + 1; j++) {
+							nextGlyphCode = codes[codes.size() - (i + 1)];
+							glyphCodesToAdd.push_back(nextGlyphCode);
+						}
+						if (i == 0 || !intVecIsAllTheSame(glyphCodesToAdd)) {
+							for (int glyphCode : glyphCodesToAdd) {
+								codes.push_back(glyphCode);
+							}
+							hasRepeated = true;
+							lastRepeatOrdinal = i + 1;
+							break;
+						}
+					}
+				}
+
+				if (!hasRepeated) {
+					if (codes.size() == 0 || codes.back() != nextGlyphCode) {
+						codes.push_back(nextGlyphCode);
+						lastRepeatOrdinal = 0;
+					}
+				}
+				spaceLastAdded = false;
+			}
+		}
+		codes.resize(requiredSize);
+	}
+
+
+	static std::vector<Glyph> glyphsFromCodes(std::initializer_list<int> codes)
+	{
+		std::vector<Glyph> glyphs;
+		for (int g : codes) {
+			glyphs.push_back(Glyph(g));
+		}
+		return glyphs;
+	}
+
+
+	// What a stretch of generated glyphs looks like, in proportions: how often each of the given codes comes up, then
+	// how often a glyph is the same as the one 1, 2 and 3 places before it (which is what the repeat chances control).
+	static std::vector<double> glyphStatistics(const int *codes, size_t length, const std::vector<int> &codeSet)
+	{
+		std::vector<double> stats(codeSet.size() + 3);
+		for (size_t i = 0; i < length; i++) {
+			stats[std::find(codeSet.begin(), codeSet.end(), codes[i]) - codeSet.begin()]++;
+			for (size_t d = 1; d <= 3; d++) {
+				if (i >= d && codes[i] == codes[i - d]) stats[codeSet.size() + d - 1]++;
+			}
+		}
+		for (double &s : stats) s /= length;
+		return stats;
+	}
+
+
+	// Welch's t for each statistic, over the statistics of equal batches of two long strings. Neighbouring glyphs
+	// aren't independent (that's what repeats are), so the variance comes from batches long enough to be nearly
+	// independent of each other instead of being taken as binomial.
+	static std::vector<double> batchTStatistics(const std::vector<int> &a, const std::vector<int> &b, size_t batches,
+												const std::vector<int> &codeSet)
+	{
+		const size_t batchLength = std::min(a.size(), b.size()) / batches;
+		const size_t n = codeSet.size() + 3;
+		std::vector<double> sumA(n), sumSqA(n), sumB(n), sumSqB(n);
+		for (size_t k = 0; k < batches; k++) {
+			const std::vector<double> sa(glyphStatistics(a.data() + k * batchLength, batchLength, codeSet));
+			const std::vector<double> sb(glyphStatistics(b.data() + k * batchLength, batchLength, codeSet));
+			for (size_t i = 0; i < n; i++) {
+				sumA[i] += sa[i]; sumSqA[i] += sa[i] * sa[i];
+				sumB[i] += sb[i]; sumSqB[i] += sb[i] * sb[i];
+			}
+		}
+
+		std::vector<double> t(n);
+		for (size_t i = 0; i < n; i++) {
+			const double meanA = sumA[i] / batches, meanB = sumB[i] / batches;
+			const double varA = (sumSqA[i] - batches * meanA * meanA) / (batches - 1);
+			const double varB = (sumSqB[i] - batches * meanB * meanB) / (batches - 1);
+			const double se = std::sqrt((varA + varB) / batches);
+			t[i] = se > 0 ? (meanA - meanB) / se : (meanA == meanB ? 0 : INFINITY);
+		}
+		return t;
+	}
+
+
+	BOOST_AUTO_TEST_SUITE(GlyphGeneratorTests)
+
+	BOOST_AUTO_TEST_CASE(AliasTablesDrawWithTheGivenWeights)
+	{
+		const std::vector<double> weights = { 1, 0, 3, 6, 0.5, 1.5 };
+		AliasTable table(weights);
+		BOOST_REQUIRE_EQUAL(table.size(), weights.size());
+
+		for (size_t i = 0; i < weights.size(); i++) {
+			BOOST_CHECK_CLOSE_FRACTION(table.probability(i) + 1, weights[i] / 12 + 1, 1e-9);
+		}
+
+		boost::random::mt19937 engine(7);
+		std::vector<double> counts(weights.size());
+		const int draws = 600000;
+		for (int i = 0; i < draws; i++) {
+			counts[table.sample(engine)]++;
+		}
+		BOOST_CHECK_EQUAL(counts[1], 0);
+		for (size_t i = 0; i < weights.size(); i++) {
+			BOOST_CHECK_SMALL(counts[i] / draws - weights[i] / 12, 0.005);
+		}
+
+		// all zero is uniform
+		AliasTable uniform(std::vector<double>(4, 0.0));
+		BOOST_CHECK_CLOSE(uniform.probability(3), 0.25, 1e-9);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(TheSameSeedGeneratesTheSameString)
+	{
+		GlyphGenerator generator;
+		generator.configure(glyphsFromCodes({ 3, 4, 5, 6, 7, 8, 9, 0 }), PlayerLevel::glyphRepeatChances(1));
+
+		GlyphString first, second, third;
+		generator.seed(1234);
+		first.generateRandom(5000, generator);
+		generator.seed(1234);
+		second.generateRandom(5000, generator);
+		generator.seed(4321);
+		third.generateRandom(5000, generator);
+
+		BOOST_REQUIRE_EQUAL(first.size(), 5000);
+		BOOST_CHECK(first == second);
+		BOOST_CHECK(first != third);
+
+		// no space twice in a row, and no space first
+		BOOST_CHECK_NE(first.codeAtIndex(0), 0);
+		for (size_t i = 1; i < first.size(); i++) {
+			BOOST_REQUIRE(first.codeAtIndex(i) != 0 || first.codeAtIndex(i - 1) != 0);
+		}
+	}
+
+
+	BOOST_AUTO_TEST_CASE(NothingIsGeneratedWithoutGlyphs)
+	{
+		GlyphGenerator generator;
+		generator.configure(glyphsFromCodes({ 0 }), PlayerLevel::glyphRepeatChances(1));
+		BOOST_CHECK(!generator.isConfigured());
+
+		GlyphString gs;
+		gs.generateRandom(100, generator);
+		BOOST_CHECK_EQUAL(gs.size(), 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(OutputMatchesTheOldGeneratorStatistically)
+	{
+		const size_t Length = 400000;
+		const size_t Batches = 40;
+		// far out for a t statistic with ~78 degrees of freedom; the seeds are fixed, so this is deterministic anyway
+		const double Critical = 5;
+
+		const std::vector<std::vector<int>> codeSets = {
+			{ 3, 4, 5, 6, 7, 8, 9, 0 },
+			{ 3, 3, 3, 4, 5, 0 }, // repeated entries weigh their glyph more
+			{ 10, 11, 12 },
+		};
+
+		boost::random::mt19937 legacyEngine(99);
+		for (size_t level : { 1, 6, 11 }) {
+			const std::vector<float> repeatChances(PlayerLevel::glyphRepeatChances(level));
+			for (const std::vector<int> &codeSet : codeSets) {
+				std::vector<Glyph> glyphs;
+				for (int g : codeSet) {
+					glyphs.push_back(Glyph(g));
+				}
+
+				std::vector<int> legacy;
+				legacyGenerateRandom(legacy, Length, glyphs, repeatChances, legacyEngine);
+
+				GlyphGenerator generator;
+				generator.configure(glyphs, repeatChances);
+				generator.seed((uint32_t) (level * 31 + codeSet.size()));
+				std::vector<int> generated(Length);
+				BOOST_REQUIRE_EQUAL(generator.generate(generated.data(), Length), Length);
+
+				const std::vector<double> t(batchTStatistics(legacy, generated, Batches, codeSet));
+				for (size_t i = 0; i < t.size(); i++) {
+					const string what = i < codeSet.size() ? (boost::format("code %d") % codeSet[i]).str() :
+										(boost::format("same as %d back") % (i - codeSet.size() + 1)).str();
+					BOOST_CHECK_MESSAGE(std::fabs(t[i]) < Critical, boost::format("level %d, %s: t = %.2f") %
+										level % what % t[i]);
+				}
+			}
+		}
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+#pragma mark - Glyph Difficulty
+
+	BOOST_AUTO_TEST_SUITE(GlyphDifficultyTests)
+
+	BOOST_AUTO_TEST_CASE(MistakesAndSlowGlyphsWeighMore)
+	{
+		GlyphDifficulty difficulty;
+		BOOST_CHECK_EQUAL(difficulty.weight(3), 1);
+		BOOST_CHECK_EQUAL(difficulty.weightCeiling(), 1);
+
+		// glyph 5 is often missed and glyph 6 is slow; the rest are typed at an even pace
+		for (int round = 0; round < 20; round++) {
+			for (int code = 3; code <= 9; code++) {
+				if (code == 5 && round % 2 == 0) difficulty.recordMistake(code);
+				difficulty.recordCorrect(code, code == 6 ? 600 : 200);
+			}
+		}
+
+		BOOST_CHECK_SMALL(difficulty.mistakeRate(3), 1e-6f);
+		BOOST_CHECK_GT(difficulty.mistakeRate(5), 0.25f);
+		BOOST_CHECK_CLOSE(difficulty.latencyMillis(3), 200, 1e-3);
+		BOOST_CHECK_CLOSE(difficulty.latencyMillis(6), 600, 1e-3);
+
+		BOOST_CHECK_LT(difficulty.weight(3), 1.2f);
+		BOOST_CHECK_GT(difficulty.weight(5), 2.5f);
+		BOOST_CHECK_GT(difficulty.weight(6), 2);
+		BOOST_CHECK_EQUAL(difficulty.weight(42), 1); // never typed
+		BOOST_CHECK_GE(difficulty.weightCeiling(), difficulty.weight(5));
+		BOOST_CHECK_LE(difficulty.weightCeiling(), GlyphDifficulty::MaxWeight);
+
+		// once the player stops missing it, it decays back
+		for (int i = 0; i < 40; i++) {
+			difficulty.recordCorrect(5, 200);
+		}
+		BOOST_CHECK_LT(difficulty.weight(5), 1.2f);
+
+		// pauses and codes out of range don't count
+		difficulty.recordCorrect(3, 60000);
+		BOOST_CHECK_CLOSE(difficulty.latencyMillis(3), 200, 1e-3);
+		difficulty.recordMistake(-1);
+		difficulty.recordMistake(1 << 20);
+		BOOST_CHECK_EQUAL(difficulty.weight(-1), 1);
+
+		difficulty.reset();
+		BOOST_CHECK_EQUAL(difficulty.weight(6), 1);
+		BOOST_CHECK_EQUAL(difficulty.weightCeiling(), 1);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(GeneratorDrawsTroubleGlyphsMoreOften)
+	{
+		const size_t Length = 200000;
+		const std::vector<Glyph> glyphs(glyphsFromCodes({ 3, 4, 5, 6, 7, 8, 9 }));
+		const std::vector<float> repeatChances(PlayerLevel::glyphRepeatChances(1));
+
+		GlyphDifficulty difficulty;
+		GlyphGenerator generator;
+		generator.configure(glyphs, repeatChances);
+		generator.setDifficulty(&difficulty);
+
+		// with no weights past 1 the difficulty changes nothing, not even the draws
+		std::vector<int> plain(Length), weighed(Length);
+		generator.seed(77);
+		generator.generate(plain.data(), Length);
+		generator.setDifficulty(nullptr);
+		generator.seed(77);
+		generator.generate(weighed.data(), Length);
+		BOOST_CHECK(plain == weighed);
+
+		for (int i = 0; i < 10; i++) {
+			difficulty.recordMistake(5);
+		}
+		BOOST_REQUIRE_GT(difficulty.weight(5), 3.5f);
+
+		generator.setDifficulty(&difficulty);
+		generator.seed(77);
+		generator.generate(weighed.data(), Length);
+
+		const std::vector<double> before(glyphStatistics(plain.data(), Length, { 3, 4, 5, 6, 7, 8, 9 }));
+		const std::vector<double> after(glyphStatistics(weighed.data(), Length, { 3, 4, 5, 6, 7, 8, 9 }));
+		BOOST_CHECK_CLOSE(before[2], 1.0 / 7, 5);
+		BOOST_CHECK_GT(after[2], 2.5 * after[0]);
+		for (size_t i = 0; i < 7; i++) {
+			if (i != 2) BOOST_CHECK_CLOSE(after[i], after[0], 5);
+		}
+
+		// and for a fixed seed and the same keystrokes, the same string every time
+		std::vector<int> again(Length);
+		generator.seed(77);
+		generator.generate(again.data(), Length);
+		BOOST_CHECK(again == weighed);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Generation Benchmark
+
+	BOOST_AUTO_TEST_SUITE(GlyphGeneratorBenchmark)
+
+	BOOST_AUTO_TEST_CASE(GeneratingAMillionGlyphs)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t Length = 1000000;
+		const std::vector<Glyph> glyphs(glyphsFromCodes({ 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0 }));
+		const std::vector<float> repeatChances(PlayerLevel::glyphRepeatChances(1));
+
+		boost::random::mt19937 legacyEngine(5);
+		std::vector<int> legacy;
+		const clock::time_point beforeStart = clock::now();
+		legacyGenerateRandom(legacy, Length, glyphs, repeatChances, legacyEngine);
+		const clock::duration before = clock::now() - beforeStart;
+
+		GlyphGenerator generator;
+		GlyphString gs;
+		const clock::time_point afterStart = clock::now();
+		generator.configure(glyphs, repeatChances);
+		generator.seed(5);
+		gs.generateRandom(Length, generator);
+		const clock::duration after = clock::now() - afterStart;
+
+		const double msBefore = std::chrono::duration<double, std::milli>(before).count();
+		const double msAfter = std::chrono::duration<double, std::milli>(after).count();
+		BOOST_TEST_MESSAGE(boost::format("Generating %d glyphs: %.1f ms before, %.1f ms with alias tables")
+						   % Length % msBefore % msAfter);
+
+		BOOST_REQUIRE_EQUAL(gs.size(), Length);
+		BOOST_WARN_LT(msAfter, msBefore);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(AMillionDifficultyUpdates)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t Updates = 1000000;
+
+		GlyphDifficulty difficulty;
+		Random engine(3);
+		const clock::time_point start = clock::now();
+		for (size_t i = 0; i < Updates; i++) {
+			const int code = 3 + (int) engine.upTo(39);
+			if (engine.chance(0.1)) {
+				difficulty.recordMistake(code);
+			} else {
+				difficulty.recordCorrect(code, 150 + engine.upTo(299));
+			}
+		}
+		const clock::duration elapsed = clock::now() - start;
+
+		const double nsPerUpdate = std::chrono::duration<double, std::nano>(elapsed).count() / Updates;
+		BOOST_TEST_MESSAGE(boost::format("Glyph difficulty: %.1f ns per keystroke") % nsPerUpdate);
+		BOOST_CHECK_LE(difficulty.weightCeiling(), GlyphDifficulty::MaxWeight);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
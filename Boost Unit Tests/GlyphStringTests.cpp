@@ -7,7 +7,12 @@
 //
 
 #include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <map>
+#include <set>
+#include <boost/format.hpp>
 #include "Glyph.h"
+#include "GlyphGenerator.h"
 
 namespace ac {
 	
@@ -18,6 +23,41 @@ namespace ac {
 	};
 	
 	
+	// random glyphs with obstructions and encasements, like CopyText generates
+	static GlyphString generatedCopyString(size_t size)
+	{
+		std::vector<Glyph> glyphs;
+		for (int g : { 3, 4, 5, 6, 7, 8, 9, 0 }) {
+			glyphs.push_back(Glyph(g));
+		}
+
+		GlyphString gs;
+		gs.generateRandom(size, glyphs, { 0.7, 0.5, 0.3 });
+		gs.generateObstructions(0, size);
+		gs.generateEncasements(0, size);
+		return gs;
+	}
+
+
+	// What CopyText::reComposeCopyText does on a level up: everything past the right edge of the visible row is
+	// replaced by newly generated glyphs. wholeString regenerates the obstructions the way it used to.
+	static void recomposeTail(GlyphString &gs, size_t rightEdge, size_t tailLength, bool wholeString = false)
+	{
+		std::vector<Glyph> glyphs;
+		for (int g : { 3, 4, 5, 6, 7, 8, 9, 10, 0 }) {
+			glyphs.push_back(Glyph(g));
+		}
+
+		GlyphString appendee;
+		appendee.generateRandom(tailLength, glyphs, { 0.3, 0.3, 0.2 });
+		gs.resize(rightEdge);
+		gs.append(appendee);
+
+		gs.generateObstructions(wholeString ? 0 : rightEdge, gs.size());
+		gs.generateEncasements(rightEdge, gs.size());
+	}
+
+
 	BOOST_FIXTURE_TEST_SUITE(GlyphStringTests, GlyphStringTestFixture)
 		
 	BOOST_AUTO_TEST_CASE(GlyphCodeRetrievalAndModification)
@@ -159,7 +199,327 @@ namespace ac {
 		return;
 	}
 
+
+	BOOST_AUTO_TEST_CASE(ObstructionsAndEncasementsTravelWithTheGlyphs)
+	{
+		// with thousands of glyphs some are bound to get both
+		GlyphString gs(generatedCopyString(5000));
+		size_t obstructions = 0, encasements = 0;
+		for (size_t i = 0; i < gs.size(); i++) {
+			if (gs.hasObstructionAtIndex(i)) obstructions++;
+			if (gs.encasementLevelAtIndex(i) > 0) encasements++;
+			BOOST_REQUIRE(!(gs.hasObstructionAtIndex(i) && gs.encasementLevelAtIndex(i) > 0));
+		}
+		BOOST_REQUIRE_GT(obstructions, 0);
+		BOOST_REQUIRE_GT(encasements, 0);
+
+		// past the end there's nothing
+		BOOST_REQUIRE(!gs.hasObstructionAtIndex(gs.size()));
+		BOOST_REQUIRE_EQUAL(gs.encasementLevelAtIndex(gs.size()), 0);
+
+		GlyphString copied(gs);
+		GlyphString assigned;
+		assigned = gs;
+		for (size_t i = 0; i < gs.size(); i++) {
+			BOOST_REQUIRE_EQUAL(copied.hasObstructionAtIndex(i), gs.hasObstructionAtIndex(i));
+			BOOST_REQUIRE_EQUAL(copied.encasementLevelAtIndex(i), gs.encasementLevelAtIndex(i));
+			BOOST_REQUIRE_EQUAL(assigned.encasementLevelAtIndex(i), gs.encasementLevelAtIndex(i));
+		}
+
+		GlyphString moved(std::move(copied));
+		BOOST_REQUIRE(moved == gs);
+		BOOST_REQUIRE_EQUAL(moved.encasementLevelAtIndex(100), gs.encasementLevelAtIndex(100));
+
+		// encasements are peeled away, but never below zero
+		for (size_t i = 0; i < gs.size(); i++) {
+			if (gs.encasementLevelAtIndex(i) > 0) {
+				gs.reduceEncasementLevelAtIndex(i, 1);
+				BOOST_REQUIRE_EQUAL(gs.encasementLevelAtIndex(i), 1);
+				gs.reduceEncasementLevelAtIndex(i, 5);
+				BOOST_REQUIRE_EQUAL(gs.encasementLevelAtIndex(i), 0);
+				break;
+			}
+		}
+	}
+
+
+	BOOST_AUTO_TEST_CASE(SubstringsAreViewsIntoTheSource)
+	{
+		GlyphString gs(generatedCopyString(1000));
+
+		GlyphStringView view = gs.substr(300, 50);
+		BOOST_REQUIRE_EQUAL(view.size(), 50);
+		BOOST_REQUIRE_EQUAL(view.offsetInSource(), 300);
+		for (size_t i = 0; i < view.size(); i++) {
+			BOOST_REQUIRE_EQUAL(view[i], gs[300 + i]);
+			BOOST_REQUIRE_EQUAL(view.hasObstructionAtIndex(i), gs.hasObstructionAtIndex(300 + i));
+			BOOST_REQUIRE_EQUAL(view.encasementLevelAtIndex(i), gs.encasementLevelAtIndex(300 + i));
+		}
+		BOOST_REQUIRE_THROW(view[50], std::out_of_range);
+
+		// views of views, clamped to the end like GlyphString::substr
+		GlyphStringView inner = view.substr(40, 20);
+		BOOST_REQUIRE_EQUAL(inner.size(), 10);
+		BOOST_REQUIRE_EQUAL(inner.offsetInSource(), 340);
+		BOOST_REQUIRE(inner == gs.substr(340, 10));
+		BOOST_REQUIRE_THROW(view.substr(50, 1), std::out_of_range);
+
+		// copying a view out keeps the block properties too
+		GlyphString copied(view);
+		BOOST_REQUIRE(copied == view);
+		for (size_t i = 0; i < copied.size(); i++) {
+			BOOST_REQUIRE_EQUAL(copied.encasementLevelAtIndex(i), gs.encasementLevelAtIndex(300 + i));
+		}
+
+		// changes to the source show through
+		for (size_t i = 0; i < view.size(); i++) {
+			gs.reduceEncasementLevelAtIndex(300 + i, 10);
+			BOOST_REQUIRE_EQUAL(view.encasementLevelAtIndex(i), 0);
+		}
+	}
 	
 	
+	BOOST_AUTO_TEST_CASE(RecomposingTheTailKeepsWhatComesBefore)
+	{
+		GlyphString gs(generatedCopyString(3000));
+		const GlyphString before(gs);
+		const size_t rightEdge = 1200;
+
+		recomposeTail(gs, rightEdge, 4000);
+		BOOST_REQUIRE_EQUAL(gs.size(), rightEdge + 4000);
+
+		size_t tailObstructions = 0, tailEncasements = 0;
+		for (size_t i = 0; i < gs.size(); i++) {
+			if (i < rightEdge) {
+				BOOST_REQUIRE_EQUAL(gs.codeAtIndex(i), before.codeAtIndex(i));
+				BOOST_REQUIRE_EQUAL(gs.hasObstructionAtIndex(i), before.hasObstructionAtIndex(i));
+				BOOST_REQUIRE_EQUAL(gs.encasementLevelAtIndex(i), before.encasementLevelAtIndex(i));
+			} else {
+				if (gs.hasObstructionAtIndex(i)) tailObstructions++;
+				if (gs.encasementLevelAtIndex(i) > 0) tailEncasements++;
+				BOOST_REQUIRE(!(gs.hasObstructionAtIndex(i) && gs.encasementLevelAtIndex(i) > 0));
+			}
+		}
+		// the tail is far enough in for the highest chances of both
+		BOOST_CHECK_GT(tailObstructions, 0);
+		BOOST_CHECK_GT(tailEncasements, 0);
+
+		// ranges past the end are clamped
+		gs.generateObstructions(gs.size() - 10, gs.size() + 100);
+		gs.generateEncasements(gs.size() + 5, gs.size() + 100);
+	}
+
+
+	// What CopyText does with a generated copy string: chunks are added as the cursor moves along and the ones that
+	// have been typed are dropped. The result should be the same as generating the whole thing at once.
+	BOOST_AUTO_TEST_CASE(ChunkedGenerationMatchesGeneratingAtOnce)
+	{
+		const size_t Length = 3000, ChunkSize = 256;
+		std::vector<Glyph> glyphs;
+		for (int g : { 3, 4, 5, 6, 7, 8, 9, 0 }) {
+			glyphs.push_back(Glyph(g));
+		}
+
+		GlyphGenerator generator;
+		generator.configure(glyphs, { 0.3, 0.3, 0.2, 0.2, 0.2 });
+
+		generator.seed(77);
+		Random obstructions(1), encasements(2);
+		GlyphString atOnce;
+		atOnce.generateRandom(Length, generator);
+		atOnce.generateObstructions(0, Length, obstructions);
+		atOnce.generateEncasements(0, Length, encasements);
+
+		generator.seed(77);
+		obstructions.seed(1);
+		encasements.seed(2);
+		GlyphString chunked;
+		size_t largest = 0;
+		for (size_t cursor = 0; cursor < Length; cursor += 100) {
+			const size_t consumed = cursor - chunked.droppedFromFront();
+			if (consumed >= ChunkSize) chunked.dropFront(consumed - consumed % ChunkSize);
+
+			while (chunked.droppedFromFront() + chunked.size() < std::min(Length, cursor + 2 * ChunkSize)) {
+				const size_t from = chunked.size();
+				chunked.appendRandom(std::min(ChunkSize, Length - chunked.droppedFromFront() - from), generator);
+				chunked.generateObstructions(from, chunked.size(), obstructions);
+				chunked.generateEncasements(from, chunked.size(), encasements);
+			}
+			largest = std::max(largest, chunked.size());
+
+			for (size_t i = 0; i < chunked.size(); i++) {
+				const size_t position = chunked.droppedFromFront() + i;
+				BOOST_REQUIRE_EQUAL(chunked.codeAtIndex(i), atOnce.codeAtIndex(position));
+				BOOST_REQUIRE_EQUAL(chunked.hasObstructionAtIndex(i), atOnce.hasObstructionAtIndex(position));
+				BOOST_REQUIRE_EQUAL(chunked.encasementLevelAtIndex(i), atOnce.encasementLevelAtIndex(position));
+			}
+		}
+
+		BOOST_CHECK_EQUAL(chunked.droppedFromFront() + chunked.size(), Length);
+		BOOST_CHECK_LE(largest, 3 * ChunkSize);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(IdenticalSeedsGiveIdenticalCopyStrings)
+	{
+		RandomService &random(RandomService::getInstance());
+
+		random.seed(2014);
+		const GlyphString first(generatedCopyString(3000));
+
+		// other streams being drawn from in between doesn't change anything
+		random.seed(2014);
+		for (int i = 0; i < 100; i++) {
+			RandomService::get(RandomStream::Colors)();
+			RandomService::get(RandomStream::General)();
+		}
+		const GlyphString second(generatedCopyString(3000));
+
+		random.seed(2015);
+		const GlyphString third(generatedCopyString(3000));
+
+		BOOST_REQUIRE(first == second);
+		for (size_t i = 0; i < first.size(); i++) {
+			BOOST_REQUIRE_EQUAL(first.hasObstructionAtIndex(i), second.hasObstructionAtIndex(i));
+			BOOST_REQUIRE_EQUAL(first.encasementLevelAtIndex(i), second.encasementLevelAtIndex(i));
+		}
+		BOOST_CHECK(first != third);
+
+		// engines can also be passed in explicitly
+		Random a(5), b(5);
+		std::vector<Glyph> glyphs;
+		for (int g : { 3, 4, 5, 0 }) {
+			glyphs.push_back(Glyph(g));
+		}
+		GlyphString fromA, fromB;
+		fromA.generateRandom(500, glyphs, { 0.3, 0.3 }, a);
+		fromB.generateRandom(500, glyphs, { 0.3, 0.3 }, b);
+		BOOST_CHECK(fromA == fromB);
+	}
+
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Keypress Check Benchmark
+
+	// The layout GlyphString had before: glyphs in one array, block properties in node-based containers on the
+	// side, and substrings copied out glyph by glyph.
+	struct LegacyGlyphString
+	{
+		std::vector<Glyph> vec;
+		std::set<size_t> indicesWithObstructions;
+		std::map<size_t, size_t> indicesWithEncasements;
+
+		explicit LegacyGlyphString(const GlyphString &gs)
+		{
+			for (size_t i = 0; i < gs.size(); i++) {
+				vec.push_back(gs[i]);
+				if (gs.hasObstructionAtIndex(i)) indicesWithObstructions.insert(i);
+				indicesWithEncasements[i] = gs.encasementLevelAtIndex(i);
+			}
+		}
+
+		LegacyGlyphString() {}
+
+		LegacyGlyphString substr(size_t idx, size_t len) const
+		{
+			LegacyGlyphString ret;
+			len = std::min(len, vec.size() - idx);
+			for (size_t i = idx; i < idx + len; i++) {
+				ret.vec.push_back(vec[i]);
+			}
+			return ret;
+		}
+
+		bool sameCodes(const LegacyGlyphString &other) const
+		{
+			if (vec.size() != other.vec.size()) return false;
+			for (size_t i = 0; i < vec.size(); i++) {
+				if (vec[i].getCode() != other.vec[i].getCode()) return false;
+			}
+			return true;
+		}
+	};
+
+
+	BOOST_AUTO_TEST_SUITE(GlyphStringBenchmark)
+
+	// What CopyText::performCheck does with the copy string on every keypress: take the substring at the cursor,
+	// compare it with what was typed, and look up the encasement under the cursor.
+	BOOST_AUTO_TEST_CASE(KeypressChecksOnLongCopyStrings)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t CopyStringLength = 20000;
+		const int Passes = 20;
+
+		GlyphString gs(generatedCopyString(CopyStringLength));
+		LegacyGlyphString legacy(gs);
+		const long checks = (long) Passes * CopyStringLength;
+
+		long matchedBefore = 0;
+		const clock::time_point beforeStart = clock::now();
+		for (int p = 0; p < Passes; p++) {
+			for (size_t offset = 0; offset < CopyStringLength; offset++) {
+				const LegacyGlyphString entered(legacy.substr(offset, 1));
+				const LegacyGlyphString toBeCompared(legacy.substr(offset, entered.vec.size()));
+				if (toBeCompared.sameCodes(entered) && legacy.indicesWithEncasements.at(offset) == 0) matchedBefore++;
+			}
+		}
+		const clock::duration before = clock::now() - beforeStart;
+
+		long matchedAfter = 0;
+		GlyphString entered;
+		const clock::time_point afterStart = clock::now();
+		for (int p = 0; p < Passes; p++) {
+			for (size_t offset = 0; offset < CopyStringLength; offset++) {
+				entered.clear();
+				entered.append(gs[offset]);
+				const GlyphStringView toBeCompared(gs.substr(offset, entered.size()));
+				if (toBeCompared == entered && gs.encasementLevelAtIndex(offset) == 0) matchedAfter++;
+			}
+		}
+		const clock::duration after = clock::now() - afterStart;
+
+		const double nsBefore = std::chrono::duration<double, std::nano>(before).count() / checks;
+		const double nsAfter = std::chrono::duration<double, std::nano>(after).count() / checks;
+		BOOST_TEST_MESSAGE(boost::format("GlyphString keypress check: %.1f ns/keypress with copied substrings, "
+										 "%.1f ns/keypress with views (%d glyphs)") % nsBefore % nsAfter % CopyStringLength);
+
+		BOOST_REQUIRE_EQUAL(matchedBefore, matchedAfter);
+		BOOST_WARN_LT(nsAfter, nsBefore);
+	}
+
+
+	// The level-up cost should only depend on the length of the tail being replaced, not on how far into the copy
+	// string the player already is.
+	BOOST_AUTO_TEST_CASE(LevelUpRecompositionDoesNotDependOnTheConsumedPrefix)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t TailLength = 2000;
+		const int Passes = 20;
+
+		double usPerLevelUp[2][3];
+		const size_t prefixes[3] = { 10000, 100000, 1000000 };
+		for (size_t p = 0; p < 3; p++) {
+			GlyphString gs(generatedCopyString(prefixes[p] + TailLength));
+			for (int wholeString = 0; wholeString < 2; wholeString++) {
+				const clock::time_point start = clock::now();
+				for (int i = 0; i < Passes; i++) {
+					recomposeTail(gs, prefixes[p], TailLength, wholeString);
+				}
+				usPerLevelUp[wholeString][p] = std::chrono::duration<double, std::micro>(clock::now() - start).count() / Passes;
+			}
+		}
+
+		BOOST_TEST_MESSAGE(boost::format("Level-up recomposition (%d glyph tail) after 10k/100k/1M glyphs: "
+										 "%.0f/%.0f/%.0f us for the whole string, %.0f/%.0f/%.0f us for the tail only")
+						   % TailLength % usPerLevelUp[1][0] % usPerLevelUp[1][1] % usPerLevelUp[1][2]
+						   % usPerLevelUp[0][0] % usPerLevelUp[0][1] % usPerLevelUp[0][2]);
+
+		BOOST_WARN_LT(usPerLevelUp[0][2], usPerLevelUp[0][0] * 3);
+		BOOST_WARN_LT(usPerLevelUp[0][2], usPerLevelUp[1][2]);
+	}
+
 	BOOST_AUTO_TEST_SUITE_END()
 }
\ No newline at end of file
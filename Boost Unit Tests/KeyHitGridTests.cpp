@@ -0,0 +1,226 @@
+//
+//  KeyHitGridTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <map>
+#include <boost/format.hpp>
+#include "ACTypes.h"
+#include "DefaultKeyboardConfiguration.h"
+#include "Keyboard.h"
+#include "KeyboardModel.h"
+#include "KeyHitGrid.h"
+#include "Random.h"
+
+namespace ac {
+
+	using std::string;
+	using std::vector;
+
+	// loads one of the device layouts instead of the one picked for the current device
+	class DeviceKeyboardConfiguration : public DefaultKeyboardConfiguration
+	{
+	public:
+		explicit DeviceKeyboardConfiguration(const string &device) : device(device) {}
+		virtual const string configFileName() const { return "keyboard/" + device + "/default-keyboard-configuration.json"; }
+	private:
+		string device;
+	};
+
+
+	// the key bounds in key label order, the way KeyboardView lays them out
+	static vector<CCRect> keyBoundsForLayout(const string &device)
+	{
+		DeviceKeyboardConfiguration config(device);
+		BOOST_REQUIRE(config.initialize(Keyboard::getInstance()));
+
+		const shared_ptr<KeyboardModel> &model = Keyboard::getInstance().model();
+		vector<CCRect> bounds;
+		for (const string &label : model->getKeyLabels()) {
+			const KeyboardPoint &origin = model->getKeyPosition(label);
+			const KeySize size = model->getKeySize(label);
+			bounds.push_back(CCRect(origin.x, origin.y, size.width, size.height));
+		}
+
+		// put back the layout the other tests expect
+		DefaultKeyboardConfiguration().initialize(Keyboard::getInstance());
+		return bounds;
+	}
+
+
+	static KeyHitGrid gridFromBounds(const vector<CCRect> &bounds)
+	{
+		KeyHitGrid grid;
+		for (const CCRect &b : bounds) {
+			const KeyboardPoint origin = { b.origin.x, b.origin.y };
+			const KeySize size = { b.size.width, b.size.height };
+			grid.addKey(origin, size);
+		}
+		grid.build();
+		return grid;
+	}
+
+
+	// what KeyboardView used to do, minus the key views: the first key (in label order) whose bounds contain the point
+	static int firstKeyContaining(const vector<CCRect> &bounds, const CCPoint &point)
+	{
+		for (size_t i = 0; i < bounds.size(); i++) {
+			if (bounds[i].containsPoint(point)) return (int) i;
+		}
+		return KeyHitGrid::NoKey;
+	}
+
+
+	// Touch locations as registerTouchEvents would see them: up to four fingers at once, each landing near a key
+	// (sometimes between keys or off the keyboard) and sliding a little before lifting, interleaved.
+	static vector<CCPoint> syntheticTouchTrace(const vector<CCRect> &bounds, size_t numberOfTouches, uint64_t seed)
+	{
+		Random random(seed);
+		CCRect area = bounds.front();
+		for (const CCRect &b : bounds) {
+			area = CCRect(MIN(area.getMinX(), b.getMinX()), MIN(area.getMinY(), b.getMinY()),
+						  MAX(area.getMaxX(), b.getMaxX()) - MIN(area.getMinX(), b.getMinX()),
+						  MAX(area.getMaxY(), b.getMaxY()) - MIN(area.getMinY(), b.getMinY()));
+		}
+
+		struct Finger { CCPoint location; int movesLeft; };
+		vector<Finger> fingers;
+		vector<CCPoint> trace;
+		while (trace.size() < numberOfTouches) {
+			if (fingers.empty() || (fingers.size() < 4 && random.chance(0.3))) {
+				CCPoint location;
+				if (random.chance(0.9)) {
+					const CCRect &key = bounds[random.upTo((uint32_t) bounds.size() - 1)];
+					location = ccp(key.getMidX() + random.between(-0.7f, 0.7f) * key.size.width,
+								   key.getMidY() + random.between(-0.7f, 0.7f) * key.size.height);
+				} else {
+					location = ccp(random.between(area.getMinX() - 20, area.getMaxX() + 20),
+								   random.between(area.getMinY() - 20, area.getMaxY() + 20));
+				}
+				fingers.push_back({ location, (int) random.upTo(3) });
+				trace.push_back(location);
+				continue;
+			}
+
+			const size_t f = random.upTo((uint32_t) fingers.size() - 1);
+			if (fingers[f].movesLeft-- > 0) {
+				fingers[f].location = ccpAdd(fingers[f].location, ccp(random.between(-12, 12), random.between(-12, 12)));
+			}
+			trace.push_back(fingers[f].location);
+			if (fingers[f].movesLeft < 0) {
+				fingers.erase(fingers.begin() + f);
+			}
+		}
+		return trace;
+	}
+
+
+#pragma mark - Key Hit Grid
+
+	BOOST_AUTO_TEST_SUITE(KeyHitGridTests)
+
+	BOOST_AUTO_TEST_CASE(EmptyGridHitsNothing)
+	{
+		KeyHitGrid grid;
+		grid.build();
+		BOOST_REQUIRE_EQUAL(grid.keyAt(0, 0), KeyHitGrid::NoKey);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(FirstKeyWinsOnSharedEdgesAndOverlaps)
+	{
+		const vector<CCRect> bounds = {
+			CCRect(0, 0, 40, 40), CCRect(40, 0, 40, 40), CCRect(0, 40, 80, 40), // touching
+			CCRect(100, 0, 40, 40), CCRect(120, 20, 40, 40),					// overlapping
+			CCRect(300, 300, 0, 0)												// zero sized
+		};
+		const KeyHitGrid grid(gridFromBounds(bounds));
+
+		BOOST_REQUIRE_EQUAL(grid.keyAt(20, 20), 0);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(40, 20), 0);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(40.5f, 20), 1);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(60, 40), 1);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(60, 41), 2);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(130, 30), 3);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(150, 50), 4);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(300, 300), 5);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(90, 20), KeyHitGrid::NoKey);
+		BOOST_REQUIRE_EQUAL(grid.keyAt(-1, 20), KeyHitGrid::NoKey);
+
+		// and everywhere else agrees with checking every key
+		for (float x = -10; x <= 310; x += 0.5f) {
+			for (float y = -10; y <= 310; y += 0.5f) {
+				BOOST_REQUIRE_EQUAL(grid.keyAt(x, y), firstKeyContaining(bounds, ccp(x, y)));
+			}
+		}
+	}
+
+
+	BOOST_AUTO_TEST_CASE(DeviceLayoutsAgreeWithCheckingEveryKey)
+	{
+		for (const string &device : { "phone", "tablet" }) {
+			const vector<CCRect> bounds(keyBoundsForLayout(device));
+			BOOST_REQUIRE(!bounds.empty());
+			const KeyHitGrid grid(gridFromBounds(bounds));
+
+			for (const CCPoint &p : syntheticTouchTrace(bounds, 100000, 3)) {
+				BOOST_REQUIRE_EQUAL(grid.keyAt(p.x, p.y), firstKeyContaining(bounds, p));
+			}
+		}
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Hit Testing Benchmark
+
+	BOOST_AUTO_TEST_SUITE(KeyHitGridBenchmark)
+
+	BOOST_AUTO_TEST_CASE(ReplayingMultiTouchTraces)
+	{
+		typedef std::chrono::steady_clock clock;
+		const size_t Lookups = 1000000;
+
+		for (const string &device : { "phone", "tablet" }) {
+			const vector<CCRect> bounds(keyBoundsForLayout(device));
+			const vector<CCPoint> trace(syntheticTouchTrace(bounds, Lookups, 7));
+
+			// the old lookup walked a map of key views to bounds, looking each one up again to test it
+			std::map<size_t, CCRect> keyBounds;
+			for (size_t i = 0; i < bounds.size(); i++) keyBounds[i] = bounds[i];
+
+			size_t hitsBefore = 0;
+			const clock::time_point beforeStart = clock::now();
+			for (const CCPoint &p : trace) {
+				for (auto &kv : keyBounds) {
+					if (keyBounds[kv.first].containsPoint(p)) { hitsBefore++; break; }
+				}
+			}
+			const clock::duration before = clock::now() - beforeStart;
+
+			const KeyHitGrid grid(gridFromBounds(bounds));
+			size_t hitsAfter = 0;
+			const clock::time_point afterStart = clock::now();
+			for (const CCPoint &p : trace) {
+				if (grid.keyAt(p.x, p.y) != KeyHitGrid::NoKey) hitsAfter++;
+			}
+			const clock::duration after = clock::now() - afterStart;
+
+			const double perSecondBefore = Lookups / std::chrono::duration<double>(before).count();
+			const double perSecondAfter = Lookups / std::chrono::duration<double>(after).count();
+			BOOST_TEST_MESSAGE(boost::format("%s layout (%d keys, %d cells): %.1fM lookups/s before, %.1fM with the grid")
+							   % device % bounds.size() % grid.numberOfCells() % (perSecondBefore / 1e6)
+							   % (perSecondAfter / 1e6));
+
+			BOOST_REQUIRE_EQUAL(hitsBefore, hitsAfter);
+			BOOST_WARN_GT(perSecondAfter, perSecondBefore);
+		}
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
@@ -14,6 +14,9 @@
 #include "ScreenResolutionHelper.h"
 #include "TextureHelper.h"
 #include "KeyboardView.h"
+#include "KeyRegistry.h"
+#include "GlyphMap.h"
+#include "GameState.h"
 
 namespace ac {
 	
@@ -163,6 +166,85 @@ namespace ac {
 		// position.x + 1/2 of width = midpoint of the screen, but note that since anchorPoint.x is 0.5
 		BOOST_REQUIRE_EQUAL(kbPosition.x, sz.width / 2);
 	}
+
+
+	BOOST_AUTO_TEST_CASE(KeyIDLookupsAgreeWithLabelLookups)
+	{
+		const shared_ptr<KeyboardModel> &model(Keyboard::getInstance().model());
+		const GlyphMap &gm(GameState::getInstance().glyphMap());
+
+		for (const std::string &label : model->getKeyLabels()) {
+			const KeyID key = model->keyIDForLabel(label);
+			BOOST_REQUIRE(key != InvalidKeyID);
+			BOOST_REQUIRE_EQUAL(model->getKeyLabel(key), label);
+			BOOST_REQUIRE_EQUAL(model->isModifierKey(key), utilities::keyIsAModifier(label));
+
+			BOOST_REQUIRE_EQUAL(model->hasGlyphForKey(key), model->hasGlyphForKeyLabel(label));
+			if (model->hasGlyphForKey(key)) {
+				BOOST_REQUIRE(model->getGlyphForKey(key) == model->getGlyphForKeyLabel(label));
+			}
+
+			BOOST_REQUIRE_EQUAL(gm.hasMapping(key), gm.hasMapping(label));
+			if (gm.hasMapping(key)) {
+				const Glyph &glyph(gm.glyphForKey(key));
+				BOOST_REQUIRE(glyph == gm.glyphForKeyLabel(label));
+				BOOST_REQUIRE_EQUAL(gm.keyLabelForGlyph(glyph), KeyRegistry::getInstance().label(gm.keyForGlyph(glyph)));
+			}
+		}
+
+		BOOST_REQUIRE_EQUAL(model->keyIDForLabel("key:none"), InvalidKeyID);
+		BOOST_REQUIRE_EQUAL(model->getKeyLabel(InvalidKeyID), "");
+		BOOST_REQUIRE(!model->hasGlyphForKey(InvalidKeyID));
+		BOOST_REQUIRE_THROW(model->getGlyphForKey(InvalidKeyID), std::out_of_range);
+	}
 		
 	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Key Registry
+
+	BOOST_AUTO_TEST_SUITE(KeyRegistryTests)
+
+	BOOST_AUTO_TEST_CASE(LabelsKeepTheirIDs)
+	{
+		KeyRegistry &registry(KeyRegistry::getInstance());
+		const KeyID shift = registry.intern("mod:registry-test");
+		const KeyID key = registry.intern("key:registry-test");
+
+		BOOST_REQUIRE(shift != key);
+		BOOST_REQUIRE_EQUAL(registry.intern("mod:registry-test"), shift);
+		BOOST_REQUIRE_EQUAL(registry.find("key:registry-test"), key);
+		BOOST_REQUIRE_EQUAL(registry.label(key), "key:registry-test");
+		BOOST_REQUIRE(registry.isModifier(shift));
+		BOOST_REQUIRE(!registry.isModifier(key));
+		BOOST_REQUIRE_EQUAL(registry.find("key:never-seen"), InvalidKeyID);
+		BOOST_REQUIRE(!registry.isModifier(InvalidKeyID));
+	}
+
+
+	// the reverse lookup used to walk the map and take the first label with the glyph, and still has to
+	BOOST_AUTO_TEST_CASE(GlyphMapReverseLookupFindsTheFirstLabel)
+	{
+		GlyphMap gm;
+		gm.clear();
+		gm.setGlyphToKeyLabel(Glyph(5), "key:102");
+		gm.setGlyphToKeyLabel(Glyph(5), "key:101");
+		gm.setGlyphToKeyLabel(Glyph(6), "key:103");
+
+		const KeyID first = KeyRegistry::getInstance().find("key:101");
+		BOOST_REQUIRE_EQUAL(gm.keyForGlyph(Glyph(5)), first);
+		BOOST_REQUIRE_EQUAL(gm.keyLabelForGlyph(Glyph(5)), "key:101");
+		BOOST_REQUIRE_EQUAL(gm.keyLabelForGlyph(Glyph(6)), "key:103");
+		BOOST_REQUIRE_EQUAL(gm.keyForGlyph(Glyph(7)), InvalidKeyID);
+		BOOST_REQUIRE_EQUAL(gm.keyForGlyph(Glyph()), InvalidKeyID);
+		BOOST_REQUIRE(gm.glyphForKey(first) == Glyph(5));
+		BOOST_REQUIRE(!gm.hasAltMapping(first));
+		BOOST_REQUIRE_THROW(gm.specialAbilityForKey(first), std::out_of_range);
+
+		gm.clear();
+		BOOST_REQUIRE(!gm.hasMapping(first));
+		BOOST_REQUIRE_EQUAL(gm.keyForGlyph(Glyph(5)), InvalidKeyID);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+//
+//  KeypressTrackerTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+#include <boost/format.hpp>
+#include "AllocationCounter.h"
+#include "ACTypes.h"
+#include "KeypressTracker.h"
+#include "Random.h"
+#include "SPSCRing.h"
+
+namespace ac {
+
+	// Touches are only told apart by address, and never looked into.
+	static CCTouch *fakeTouch(size_t finger)
+	{
+		return reinterpret_cast<CCTouch *>((finger + 1) * sizeof(void *));
+	}
+
+
+#pragma mark - Ring
+
+	BOOST_AUTO_TEST_SUITE(SPSCRingTests)
+
+	BOOST_AUTO_TEST_CASE(FullAndEmptyRingsRefuse)
+	{
+		SPSCRing<int, 4> ring;
+		int value = 0;
+		BOOST_REQUIRE(!ring.pop(value));
+
+		for (int i = 0; i < 4; i++) BOOST_REQUIRE(ring.push(i));
+		BOOST_REQUIRE(!ring.push(4));
+		BOOST_REQUIRE_EQUAL(ring.size(), 4);
+
+		BOOST_REQUIRE(ring.pop(value));
+		BOOST_REQUIRE_EQUAL(value, 0);
+		BOOST_REQUIRE(ring.push(4));
+
+		ring.clear();
+		BOOST_REQUIRE(ring.empty());
+		BOOST_REQUIRE(!ring.pop(value));
+	}
+
+
+	BOOST_AUTO_TEST_CASE(EventsCrossThreadsInOrder)
+	{
+		const size_t Events = 100000;
+		SPSCRing<KeyEvent, 64> ring; // small, so both sides keep running into each other
+
+		std::thread producer([&ring, Events]() {
+			for (size_t i = 0; i < Events; i++) {
+				const KeyEvent kev = { (KeyID) (i % 40), i % 2 ? TouchType::TouchEnded : TouchType::TouchBegan, i };
+				while (!ring.push(kev)) std::this_thread::yield();
+			}
+		});
+
+		size_t received = 0, outOfOrder = 0;
+		while (received < Events) {
+			KeyEvent kev;
+			if (!ring.pop(kev)) {
+				std::this_thread::yield();
+				continue;
+			}
+			const TouchType expectedType = received % 2 ? TouchType::TouchEnded : TouchType::TouchBegan;
+			if (kev.timestamp != received || kev.key != received % 40 || kev.type != expectedType) outOfOrder++;
+			received++;
+		}
+		producer.join();
+
+		BOOST_REQUIRE_EQUAL(outOfOrder, 0);
+		BOOST_REQUIRE(ring.empty());
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Keypress Tracker
+
+	BOOST_AUTO_TEST_SUITE(KeypressTrackerTests)
+
+	BOOST_AUTO_TEST_CASE(DraggingAcrossKeysReleasesThenPresses)
+	{
+		KeypressTracker tracker;
+		KeyEvent kev;
+
+		tracker.recordTouchEvent(fakeTouch(0), 3, TouchType::TouchBegan, true, 1);
+		tracker.recordTouchEvent(fakeTouch(1), 8, TouchType::TouchBegan, true, 2);
+		BOOST_REQUIRE_EQUAL(tracker.keysInDownState().count, 2);
+
+		const KeypressTrackerUpdateInfo info = tracker.recordTouchEvent(fakeTouch(0), 4, TouchType::TouchMoved, true, 3);
+		BOOST_REQUIRE_EQUAL(info.oldKeysSize, 1);
+		BOOST_REQUIRE_EQUAL(info.newKeysSize, 1);
+		tracker.recordTouchEvent(fakeTouch(1), InvalidKeyID, TouchType::TouchEnded, true, 4);
+
+		const KeyEvent expected[] = {
+			{ 3, TouchType::TouchBegan, 1 }, { 8, TouchType::TouchBegan, 2 },
+			{ 3, TouchType::TouchEnded, 3 }, { 4, TouchType::TouchBegan, 3 }, { 8, TouchType::TouchEnded, 4 }
+		};
+		for (const KeyEvent &e : expected) {
+			BOOST_REQUIRE(tracker.removeNextKeyEventFromBuffer(kev));
+			BOOST_REQUIRE_EQUAL(kev.key, e.key);
+			BOOST_REQUIRE(kev.type == e.type);
+			BOOST_REQUIRE_EQUAL(kev.timestamp, e.timestamp);
+		}
+		BOOST_REQUIRE(!tracker.removeNextKeyEventFromBuffer(kev));
+
+		const KeysDown down(tracker.keysInDownState());
+		BOOST_REQUIRE_EQUAL(down.count, 1);
+		BOOST_REQUIRE(down.contains(4));
+	}
+
+
+	// Up to four fingers at once landing on keys, sliding across a few and lifting, with the buffer drained every
+	// few touches the way CopyText would. Every event has to come out in the order it went in, and nothing may
+	// allocate on the way.
+	BOOST_AUTO_TEST_CASE(HundredThousandTouchesKeepOrderWithoutAllocating)
+	{
+		const size_t Touches = 100000;
+		const KeyID Keys = 33;
+
+		KeypressTracker tracker;
+		Random random(12);
+
+		std::vector<KeyEvent> expected;
+		expected.reserve(2 * Touches);
+		size_t checked = 0, mismatches = 0;
+
+		struct Finger { bool down; KeyID key; };
+		Finger fingers[4] = {};
+		KeyID lastKeyDown = InvalidKeyID;
+
+		// logging allocates, and isn't what's being measured
+		const TLogLevel savedLogLevel = FILELog::ReportingLevel();
+		FILELog::ReportingLevel() = logWARNING;
+
+		long allocations = 0;
+		{
+			AllocationCounter counter;
+			for (size_t t = 0; t < Touches; t++) {
+				const size_t f = random.upTo(3);
+				Finger &finger = fingers[f];
+				TouchType type = TouchType::TouchBegan;
+				if (finger.down) {
+					type = random.chance(0.3) ? TouchType::TouchEnded : TouchType::TouchMoved;
+				}
+				// now and then a touch lands or slides off the keys
+				const KeyID key = random.chance(0.05) ? InvalidKeyID : (KeyID) random.upTo(Keys - 1);
+
+				const KeypressTrackerUpdateInfo info(tracker.recordTouchEvent(fakeTouch(f), key, type, true, t));
+
+				// what the tracker should have done: lift the key the finger was on, then press the one under it
+				KeyID lifted = InvalidKeyID, pressed = InvalidKeyID;
+				if (type == TouchType::TouchBegan) {
+					pressed = lastKeyDown = finger.key = key;
+				} else if (type == TouchType::TouchEnded) {
+					lifted = finger.key != InvalidKeyID ? finger.key : key;
+					finger.key = InvalidKeyID;
+				} else if (key != lastKeyDown) {
+					if (finger.key != key) {
+						lifted = finger.key;
+						pressed = key;
+					}
+					finger.key = key;
+				}
+				finger.down = type != TouchType::TouchEnded;
+
+				if (lifted != InvalidKeyID) expected.push_back({ lifted, TouchType::TouchEnded, t });
+				if (pressed != InvalidKeyID) expected.push_back({ pressed, TouchType::TouchBegan, t });
+				if (info.key != key || info.touchType != type) mismatches++;
+
+				if (random.chance(0.25)) {
+					KeyEvent kev;
+					while (tracker.removeNextKeyEventFromBuffer(kev)) {
+						if (checked == expected.size()) {
+							mismatches++;
+							break;
+						}
+						const KeyEvent &e = expected[checked++];
+						if (kev.key != e.key || kev.type != e.type || kev.timestamp != e.timestamp) mismatches++;
+					}
+				}
+			}
+			allocations = counter.allocations();
+		}
+
+		FILELog::ReportingLevel() = savedLogLevel;
+
+		BOOST_TEST_MESSAGE(boost::format("%d touches made %d key events") % Touches % expected.size());
+		BOOST_REQUIRE_GT(checked, Touches / 2);
+		BOOST_REQUIRE_EQUAL(mismatches, 0);
+		BOOST_REQUIRE_EQUAL(allocations, 0);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
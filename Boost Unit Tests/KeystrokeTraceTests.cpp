@@ -0,0 +1,135 @@
+//
+//  KeystrokeTraceTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/18/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <thread>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include "KeystrokeTrace.h"
+
+namespace ac {
+
+	using namespace trace;
+
+	static SpanRecord span(Stage stage, uint64_t begin, uint64_t end, uint32_t keystroke)
+	{
+		const SpanRecord record = { begin, end, keystroke, 0, stage };
+		return record;
+	}
+
+
+	BOOST_AUTO_TEST_SUITE(KeystrokeTraceTests)
+
+	BOOST_AUTO_TEST_CASE(SpansFromEveryThreadAreCollected)
+	{
+		collect(); // whatever earlier tests left behind
+
+		const uint32_t keystroke = beginKeystroke();
+		{
+			Span touch(Stage::Touch);
+			Span check(Stage::CopyTextCheck);
+		}
+		std::thread([]() { Span animation(Stage::BlockAnimation); }).join();
+
+		const std::vector<SpanRecord> spans(collect());
+		BOOST_REQUIRE_EQUAL(spans.size(), 3);
+
+		// the inner span ends (and is recorded) first
+		BOOST_REQUIRE(spans[0].stage == Stage::CopyTextCheck);
+		BOOST_REQUIRE(spans[1].stage == Stage::Touch);
+		BOOST_REQUIRE(spans[2].stage == Stage::BlockAnimation);
+		BOOST_REQUIRE(spans[0].thread != spans[2].thread);
+		for (const SpanRecord &s : spans) {
+			BOOST_REQUIRE_EQUAL(s.keystroke, keystroke);
+			BOOST_REQUIRE_LE(s.begin, s.end);
+		}
+		BOOST_REQUIRE_LE(spans[1].begin, spans[0].begin);
+		BOOST_REQUIRE_GE(spans[1].end, spans[0].end);
+
+		BOOST_REQUIRE(collect().empty());
+	}
+
+
+	BOOST_AUTO_TEST_CASE(SpansKeepTheKeystrokeTheyBeganIn)
+	{
+		collect();
+
+		const uint32_t first = beginKeystroke();
+		{
+			Span animation(Stage::BlockAnimation);
+			BOOST_REQUIRE_EQUAL(beginKeystroke(), first + 1); // the next touch, before the animation's span ends
+		}
+
+		const std::vector<SpanRecord> spans(collect());
+		BOOST_REQUIRE_EQUAL(spans.size(), 1);
+		BOOST_REQUIRE_EQUAL(spans[0].keystroke, first);
+		BOOST_REQUIRE_EQUAL(currentKeystroke(), first + 1);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(SummaryHasPercentilesPerStageAndPerKeystroke)
+	{
+		std::vector<SpanRecord> spans;
+		for (uint32_t i = 1; i <= 100; i++) {
+			spans.push_back(span(Stage::Touch, i * 1000, i * 1000 + i * 10, i)); // 10 to 1000 ns
+			spans.push_back(span(Stage::BlockAnimation, i * 1000 + 500, i * 1000 + 600, i));
+		}
+
+		const std::vector<StageSummary> summary(summarize(spans));
+		BOOST_REQUIRE_EQUAL(summary.size(), 3);
+
+		BOOST_REQUIRE_EQUAL(summary[0].name, "Touch");
+		BOOST_REQUIRE_EQUAL(summary[0].count, 100);
+		BOOST_REQUIRE_EQUAL(summary[0].p50, 500);
+		BOOST_REQUIRE_EQUAL(summary[0].p99, 990);
+
+		BOOST_REQUIRE_EQUAL(summary[1].name, "BlockAnimation");
+		BOOST_REQUIRE_EQUAL(summary[1].p50, 100);
+
+		// from the touch beginning to the later of the two ends
+		BOOST_REQUIRE_EQUAL(summary[2].name, "Keystroke");
+		BOOST_REQUIRE_EQUAL(summary[2].count, 100);
+		BOOST_REQUIRE_EQUAL(summary[2].p50, 600);
+		BOOST_REQUIRE_EQUAL(summary[2].p99, 990);
+
+		std::ostringstream out;
+		writeSummary(summary, out);
+		BOOST_REQUIRE_NE(out.str().find("Keystroke"), std::string::npos);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(ChromeTraceIsValidJSON)
+	{
+		std::vector<SpanRecord> spans;
+		spans.push_back(span(Stage::Touch, 5000, 7250, 1));
+		spans.push_back(span(Stage::ScoreKeeper, 6000, 6001, 1));
+
+		std::stringstream json;
+		writeChromeTrace(spans, json);
+
+		boost::property_tree::ptree pt;
+		boost::property_tree::read_json(json, pt);
+
+		const boost::property_tree::ptree &events(pt.get_child("traceEvents"));
+		BOOST_REQUIRE_EQUAL(events.size(), 2);
+
+		const boost::property_tree::ptree &first(events.begin()->second);
+		BOOST_REQUIRE_EQUAL(first.get<std::string>("name"), "Touch");
+		BOOST_REQUIRE_EQUAL(first.get<std::string>("ph"), "X");
+		BOOST_REQUIRE_EQUAL(first.get<std::string>("ts"), "0.000");
+		BOOST_REQUIRE_EQUAL(first.get<std::string>("dur"), "2.250");
+		BOOST_REQUIRE_EQUAL(first.get<int>("args.keystroke"), 1);
+
+		const boost::property_tree::ptree &second((++events.begin())->second);
+		BOOST_REQUIRE_EQUAL(second.get<std::string>("ts"), "1.000");
+		BOOST_REQUIRE_EQUAL(second.get<std::string>("dur"), "0.001");
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
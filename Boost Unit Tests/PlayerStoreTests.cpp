@@ -0,0 +1,407 @@
+//
+//  PlayerStoreTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/22/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include "cocos2d.h"
+#include "sqlite3.h"
+#include "GameClock.h"
+#include "KeyRegistry.h"
+#include "PlayerStore.h"
+#include "Random.h"
+#include "SessionHistory.h"
+
+namespace ac {
+
+	USING_NS_CC;
+	using std::string;
+
+	// a database of its own for each test, starting empty
+	struct PlayerStoreFixture
+	{
+		PlayerStoreFixture() : path(CCFileUtils::sharedFileUtils()->getWritablePath() + "PlayerStoreTest.db")
+		{
+			removeDB();
+		}
+
+		~PlayerStoreFixture() { removeDB(); }
+
+		void removeDB()
+		{
+			for (const char *suffix : { "", "-wal", "-shm", "-journal" }) {
+				std::remove((path + suffix).c_str());
+			}
+		}
+
+		static PlayerRecord recordAtLevel(int64_t playerId, int level)
+		{
+			PlayerRecord record = {};
+			record.playerId = playerId;
+			record.playerName = "Unnamed";
+			record.currencyCollected = level / 3;
+			record.topScore = level * 100;
+			record.topLevel = level;
+			record.totalBlocksCleared = level * 30;
+			record.totalCorrectCount = level * 30;
+			record.totalMistakeCount = level * 2;
+			record.longestStreak = level + 5;
+			record.datePlayed = 1390000000 + level;
+			return record;
+		}
+
+		static void requireSameRecord(const PlayerRecord &a, const PlayerRecord &b)
+		{
+			BOOST_REQUIRE_EQUAL(a.playerId, b.playerId);
+			BOOST_REQUIRE_EQUAL(a.playerName, b.playerName);
+			BOOST_REQUIRE_EQUAL(a.currencyCollected, b.currencyCollected);
+			BOOST_REQUIRE_EQUAL(a.topScore, b.topScore);
+			BOOST_REQUIRE_EQUAL(a.topLevel, b.topLevel);
+			BOOST_REQUIRE_EQUAL(a.totalBlocksCleared, b.totalBlocksCleared);
+			BOOST_REQUIRE_EQUAL(a.totalCorrectCount, b.totalCorrectCount);
+			BOOST_REQUIRE_EQUAL(a.totalMistakeCount, b.totalMistakeCount);
+			BOOST_REQUIRE_EQUAL(a.longestStreak, b.longestStreak);
+			BOOST_REQUIRE_EQUAL(a.datePlayed, b.datePlayed);
+		}
+
+		// `keystrokes` keystrokes over `keys` keys, at random, with about one in ten a mistake
+		static SessionRecord randomSession(int64_t playerId, Random &random, size_t keystrokes, size_t keys)
+		{
+			SessionRecord session = {};
+			session.playerId = playerId;
+			session.startedAt = 1390000000;
+			session.durationMillis = 60000;
+			session.level = 3;
+			for (size_t key = 0; key < keys; key++) {
+				session.keyLabels.push_back(string(1, (char) ('!' + key)));
+			}
+			for (size_t i = 0; i < keystrokes; i++) {
+				const KeystrokeOutcome outcome = random.chance(0.1) ? KeystrokeOutcome::Mistake :
+					random.chance(0.05) ? KeystrokeOutcome::Space : KeystrokeOutcome::Correct;
+				const KeystrokeRecord keystroke = {
+					(KeyID) random.upTo((uint32_t) keys - 1), (int32_t) random.upTo(100), outcome, i ? 150 + random.upTo(200) : 0
+				};
+				session.keystrokes.push_back(keystroke);
+				if (outcome == KeystrokeOutcome::Correct) session.correctCount++;
+				if (outcome == KeystrokeOutcome::Mistake) session.mistakeCount++;
+			}
+			return session;
+		}
+
+		int64_t countRows(const char *table) const
+		{
+			sqlite3 *db = nullptr;
+			sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+			sqlite3_stmt *stmt = nullptr;
+			sqlite3_prepare_v2(db, (string("SELECT COUNT(*) FROM ") + table).c_str(), -1, &stmt, nullptr);
+			const int64_t count = SQLITE_ROW == sqlite3_step(stmt) ? sqlite3_column_int64(stmt, 0) : -1;
+			sqlite3_finalize(stmt);
+			sqlite3_close(db);
+			return count;
+		}
+
+		const string path;
+	};
+
+
+#pragma mark - Player Store
+
+	BOOST_FIXTURE_TEST_SUITE(PlayerStoreTests, PlayerStoreFixture)
+
+	BOOST_AUTO_TEST_CASE(SavedStatsSurviveReopening)
+	{
+		PlayerRecord saved = {};
+		{
+			PlayerStore store(path);
+			BOOST_REQUIRE(store.isOpen());
+
+			PlayerRecord loaded = {};
+			BOOST_REQUIRE(!store.loadLastPlayer(loaded));
+			const int64_t playerId = store.insertPlayer(recordAtLevel(0, 0));
+			BOOST_REQUIRE_GT(playerId, 0);
+
+			for (int level = 1; level <= 5; level++) {
+				saved = recordAtLevel(playerId, level);
+				store.save(saved);
+			}
+			store.flush();
+
+			BOOST_REQUIRE(store.loadLastPlayer(loaded));
+			requireSameRecord(loaded, saved);
+		}
+
+		// the database was left in WAL mode
+		sqlite3 *db = nullptr;
+		BOOST_REQUIRE_EQUAL(sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr), SQLITE_OK);
+		sqlite3_stmt *stmt = nullptr;
+		BOOST_REQUIRE_EQUAL(sqlite3_prepare_v2(db, "PRAGMA journal_mode", -1, &stmt, nullptr), SQLITE_OK);
+		BOOST_REQUIRE_EQUAL(sqlite3_step(stmt), SQLITE_ROW);
+		BOOST_REQUIRE_EQUAL(string((const char *) sqlite3_column_text(stmt, 0)), "wal");
+		sqlite3_finalize(stmt);
+		sqlite3_close(db);
+
+		PlayerStore reopened(path);
+		PlayerRecord loaded = {};
+		BOOST_REQUIRE(reopened.loadLastPlayer(loaded));
+		requireSameRecord(loaded, saved);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(QueuedSavesAreFoldedAndWrittenOnClose)
+	{
+		const int Saves = 2000;
+		int64_t playerId = 0, otherId = 0;
+		{
+			PlayerStore store(path);
+			playerId = store.insertPlayer(recordAtLevel(0, 0));
+			otherId = store.insertPlayer(recordAtLevel(0, 0));
+			for (int level = 1; level <= Saves; level++) {
+				store.save(recordAtLevel(level % 2 ? playerId : otherId, level));
+			}
+			store.flush();
+
+			const PlayerStore::Stats stats(store.stats());
+			BOOST_REQUIRE_EQUAL(stats.saves, Saves);
+			BOOST_REQUIRE_LE(stats.rowsWritten, stats.saves);
+			BOOST_REQUIRE_LE(stats.transactions, stats.rowsWritten);
+			BOOST_TEST_MESSAGE(stats.saves << " saves written as " << stats.rowsWritten << " rows in "
+							   << stats.transactions << " transactions");
+
+			store.save(recordAtLevel(otherId, Saves + 1)); // not flushed: the store writes it before it closes
+		}
+
+		PlayerStore reopened(path);
+		PlayerRecord loaded = {};
+		BOOST_REQUIRE(reopened.loadLastPlayer(loaded)); // the last one inserted
+		requireSameRecord(loaded, recordAtLevel(otherId, Saves + 1));
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Session History
+
+	BOOST_FIXTURE_TEST_SUITE(SessionHistoryTests, PlayerStoreFixture)
+
+	BOOST_AUTO_TEST_CASE(RecorderTimesKeystrokesAndSessions)
+	{
+		ManualClock clock;
+		FrameClock::getInstance().setSource(clock);
+
+		const KeyID a = KeyRegistry::getInstance().intern("a"), b = KeyRegistry::getInstance().intern("b");
+		SessionRecorder recorder;
+		recorder.recordKeystroke(a, 'a', KeystrokeOutcome::Correct, 1000000); // not recording yet
+		recorder.begin(7);
+		recorder.recordKeystroke(a, 'a', KeystrokeOutcome::Correct, 2000000);
+		recorder.recordKeystroke(b, 'c', KeystrokeOutcome::Mistake, 2250000);
+		recorder.recordKeystroke(b, 'b', KeystrokeOutcome::Correct, 2400500);
+		clock.advance(3000);
+		FrameClock::getInstance().tick();
+
+		SessionRecord session;
+		BOOST_REQUIRE(recorder.end(true, 1234, session));
+		BOOST_REQUIRE(!recorder.end(true, 1234, session)); // only once
+		FrameClock::getInstance().resetSource();
+
+		BOOST_REQUIRE_EQUAL(session.level, 7);
+		BOOST_REQUIRE_EQUAL(session.durationMillis, 3000);
+		BOOST_REQUIRE_EQUAL(session.score, 1234);
+		BOOST_REQUIRE(session.cleared);
+		BOOST_REQUIRE_EQUAL(session.correctCount, 2);
+		BOOST_REQUIRE_EQUAL(session.mistakeCount, 1);
+		BOOST_REQUIRE_EQUAL(session.keystrokes.size(), 3);
+		BOOST_REQUIRE_EQUAL(session.keystrokes[0].intervalMillis, 0);
+		BOOST_REQUIRE_EQUAL(session.keystrokes[1].intervalMillis, 250);
+		BOOST_REQUIRE_EQUAL(session.keystrokes[2].intervalMillis, 150);
+		BOOST_REQUIRE_EQUAL(session.keyLabels.at(a), "a");
+		BOOST_REQUIRE_EQUAL(session.keyLabels.at(b), "b");
+	}
+
+
+	BOOST_AUTO_TEST_CASE(SessionsAddUpPerKeyAndOverTime)
+	{
+		PlayerStore store(path);
+		const int64_t playerId = store.insertPlayer(recordAtLevel(0, 0));
+		const int64_t otherId = store.insertPlayer(recordAtLevel(0, 0));
+
+		// odd sizes, so some keystrokes go in a whole multi-row insert at a time and the rest one by one
+		Random random(18);
+		const size_t sizes[] = { 300, 1, 0, 128, 257 };
+		std::map<string, KeyAccuracy> expected;
+		std::map<string, uint64_t> timed;
+		size_t keystrokes = 0;
+		for (size_t i = 0; i < 5; i++) {
+			SessionRecord session(randomSession(playerId, random, sizes[i], 20));
+			session.durationMillis = (uint32_t) (i + 1) * 30000;
+			session.startedAt += i;
+			for (const KeystrokeRecord &keystroke : session.keystrokes) {
+				KeyAccuracy &key(expected[session.keyLabels[keystroke.key]]);
+				if (keystroke.outcome == KeystrokeOutcome::Space) continue;
+				(keystroke.outcome == KeystrokeOutcome::Correct ? key.correctCount : key.mistakeCount)++;
+				if (keystroke.intervalMillis) {
+					key.meanIntervalMillis += keystroke.intervalMillis;
+					timed[session.keyLabels[keystroke.key]]++;
+				}
+			}
+			keystrokes += session.keystrokes.size();
+			store.saveSession(std::move(session));
+		}
+		store.saveSession(randomSession(otherId, random, 50, 20)); // someone else's
+		store.flush();
+
+		BOOST_REQUIRE_EQUAL(countRows("Keystroke"), keystrokes + 50);
+		BOOST_REQUIRE_EQUAL(countRows("Session"), 6);
+
+		const std::vector<KeyAccuracy> keys(store.keyAccuracy(playerId));
+		BOOST_REQUIRE_EQUAL(keys.size(), expected.size());
+		for (const KeyAccuracy &key : keys) {
+			const KeyAccuracy &e(expected[key.label]);
+			BOOST_REQUIRE_EQUAL(key.correctCount, e.correctCount);
+			BOOST_REQUIRE_EQUAL(key.mistakeCount, e.mistakeCount);
+			BOOST_REQUIRE_CLOSE(key.meanIntervalMillis, e.meanIntervalMillis / timed[key.label], 0.0001);
+		}
+
+		const std::vector<SessionSpeed> trend(store.speedTrend(playerId, 3));
+		BOOST_REQUIRE_EQUAL(trend.size(), 3);
+		for (size_t i = 0; i < 3; i++) {
+			BOOST_REQUIRE_EQUAL(trend[i].startedAt, 1390000000 + 2 + i); // oldest first
+		}
+		BOOST_REQUIRE_EQUAL(trend[0].wordsPerMinute, 0);
+		BOOST_REQUIRE_EQUAL(store.speedTrend(playerId, 100).size(), 5);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Persistence Benchmark
+
+	BOOST_FIXTURE_TEST_SUITE(PlayerStoreBenchmark, PlayerStoreFixture)
+
+	// Time the game thread spends saving the player over 10k level-ups. Before: what syncStatsToDB used to do, an
+	// UPDATE prepared and run on the spot, each one its own transaction in the default rollback journal. After:
+	// queueing the record for the store's writer thread.
+	BOOST_AUTO_TEST_CASE(TenThousandLevelUps)
+	{
+		typedef std::chrono::steady_clock clock;
+		const int LevelUps = 10000;
+
+		clock::duration before;
+		{
+			sqlite3 *db = nullptr;
+			BOOST_REQUIRE_EQUAL(sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE, nullptr),
+								SQLITE_OK);
+			BOOST_REQUIRE_EQUAL(sqlite3_exec(db, "CREATE TABLE Player (PlayerName VARCHAR(15), CurrencyCollected INT, "
+											 "TopScore INT, TopLevel INT, TotalBlocksCleared INT, TotalCorrectCount INT, "
+											 "TotalMistakeCount INT, LongestStreak INT, DateLastPlayed DATETIME); "
+											 "INSERT INTO Player VALUES ('Unnamed', 0, 0, 0, 0, 0, 0, 0, NULL);",
+											 nullptr, nullptr, nullptr), SQLITE_OK);
+
+			const clock::time_point start = clock::now();
+			for (int level = 1; level <= LevelUps; level++) {
+				const PlayerRecord record(recordAtLevel(1, level));
+				sqlite3_stmt *stmt = nullptr;
+				sqlite3_prepare_v2(db, "UPDATE Player SET PlayerName = @PlayerName, CurrencyCollected = @CurrencyCollected, "
+								   "TopScore = @TopScore, TopLevel = @TopLevel, TotalBlocksCleared = @TotalBlocksCleared, "
+								   "TotalCorrectCount = @TotalCorrectCount, TotalMistakeCount = @TotalMistakeCount, "
+								   "LongestStreak = @LongestStreak, DateLastPlayed = @DateLastPlayed WHERE ROWID = @ROWID",
+								   -1, &stmt, nullptr);
+				sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@PlayerName"), record.playerName.c_str(), -1, nullptr);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@CurrencyCollected"), (int) record.currencyCollected);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@TopScore"), (int) record.topScore);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@TopLevel"), (int) record.topLevel);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@TotalBlocksCleared"), (int) record.totalBlocksCleared);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@TotalCorrectCount"), (int) record.totalCorrectCount);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@TotalMistakeCount"), (int) record.totalMistakeCount);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@LongestStreak"), (int) record.longestStreak);
+				sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@DateLastPlayed"), record.datePlayed);
+				sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, "@ROWID"), (int) record.playerId);
+				BOOST_REQUIRE_EQUAL(sqlite3_step(stmt), SQLITE_DONE);
+				sqlite3_finalize(stmt); // which it never did, but leaking them isn't the point here
+			}
+			before = clock::now() - start;
+			sqlite3_close(db);
+		}
+		removeDB();
+
+		clock::duration after, flushing;
+		PlayerStore::Stats stats;
+		{
+			PlayerStore store(path);
+			const int64_t playerId = store.insertPlayer(recordAtLevel(0, 0));
+
+			const clock::time_point start = clock::now();
+			for (int level = 1; level <= LevelUps; level++) {
+				store.save(recordAtLevel(playerId, level));
+			}
+			after = clock::now() - start;
+
+			store.flush();
+			flushing = clock::now() - start - after;
+			stats = store.stats();
+
+			PlayerRecord loaded = {};
+			BOOST_REQUIRE(store.loadLastPlayer(loaded));
+			requireSameRecord(loaded, recordAtLevel(playerId, LevelUps));
+		}
+
+		const double usBefore = std::chrono::duration<double, std::micro>(before).count() / LevelUps;
+		const double usAfter = std::chrono::duration<double, std::micro>(after).count() / LevelUps;
+		const double msFlushing = std::chrono::duration<double, std::milli>(flushing).count();
+		BOOST_TEST_MESSAGE(boost::format("Player persistence on the game thread: %.2f us/level-up saving synchronously, "
+										 "%.2f us/level-up queueing (%d level-ups; the writer committed %d rows in %d "
+										 "transactions, caught up %.1f ms after the last one)")
+						   % usBefore % usAfter % LevelUps % stats.rowsWritten % stats.transactions
+						   % msFlushing);
+
+		BOOST_WARN_LT(usAfter, usBefore);
+	}
+
+
+
+	// A million keystrokes over a thousand sessions, written the way a session's are at its end; then the history's
+	// questions, which should stay in the milliseconds however much has been recorded.
+	BOOST_AUTO_TEST_CASE(AMillionRecordedKeystrokes)
+	{
+		typedef std::chrono::steady_clock clock;
+		const int Sessions = 1000, KeystrokesPerSession = 1000, Keys = 40;
+
+		PlayerStore store(path);
+		const int64_t playerId = store.insertPlayer(recordAtLevel(0, 0));
+		Random random(1);
+
+		const clock::time_point start = clock::now();
+		for (int i = 0; i < Sessions; i++) {
+			store.saveSession(randomSession(playerId, random, KeystrokesPerSession, Keys));
+		}
+		store.flush();
+		const clock::duration writing = clock::now() - start;
+		const PlayerStore::Stats stats(store.stats());
+		BOOST_REQUIRE_EQUAL(stats.keystrokesWritten, Sessions * KeystrokesPerSession);
+
+		const clock::time_point queried = clock::now();
+		const std::vector<KeyAccuracy> keys(store.keyAccuracy(playerId));
+		const clock::duration keyQuery = clock::now() - queried;
+		const std::vector<SessionSpeed> trend(store.speedTrend(playerId, 100));
+		const clock::duration trendQuery = clock::now() - queried - keyQuery;
+		BOOST_REQUIRE_EQUAL(keys.size(), Keys);
+		BOOST_REQUIRE_EQUAL(trend.size(), 100);
+
+		const double msWriting = std::chrono::duration<double, std::milli>(writing).count();
+		const double msKeys = std::chrono::duration<double, std::milli>(keyQuery).count();
+		const double msTrend = std::chrono::duration<double, std::milli>(trendQuery).count();
+		BOOST_TEST_MESSAGE(boost::format("Session history: %d keystrokes written in %.0f ms (%d transactions); per-key "
+										 "accuracy in %.3f ms, speed over the last 100 sessions in %.3f ms")
+						   % stats.keystrokesWritten % msWriting % stats.transactions % msKeys % msTrend);
+
+		BOOST_WARN_LT(msKeys, 10.0);
+		BOOST_WARN_LT(msTrend, 10.0);
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
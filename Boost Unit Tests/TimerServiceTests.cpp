@@ -0,0 +1,357 @@
+//
+//  TimerServiceTests.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/19/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "CountdownTimer.h"
+#include "GameClock.h"
+#include "GameState.h"
+#include "Random.h"
+#include "TimerService.h"
+
+namespace ac {
+
+	// a service whose clock only moves when told to
+	struct ManualClockFixture
+	{
+		ManualClockFixture() : clock(1000), service(clock), time(clock.now()) {}
+
+		void advanceBy(uint64_t milliseconds)
+		{
+			clock.advance(milliseconds);
+			time = clock.now();
+			service.update();
+		}
+
+		ManualClock clock;
+		TimerService service;
+		uint64_t time;
+	};
+
+
+	struct Firing
+	{
+		size_t id;
+		uint64_t at;
+	};
+
+	inline bool operator<(const Firing &a, const Firing &b) { return a.at < b.at || (a.at == b.at && a.id < b.id); }
+
+
+#pragma mark - Timer Service
+
+	BOOST_FIXTURE_TEST_SUITE(TimerServiceTests, ManualClockFixture)
+
+	BOOST_AUTO_TEST_CASE(TimersFireOnTheirTickAtEveryLevel)
+	{
+		// within the first level, on its edges, further up, and past what the wheel reaches
+		const uint64_t delays[] = { 1, 2, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, 16777216, 20000000 };
+		std::vector<Firing> fired;
+		for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+			service.schedule(delays[i], [this, i, &fired]() { fired.push_back({ i, service.now() }); });
+		}
+		BOOST_REQUIRE_EQUAL(service.size(), 13);
+
+		// uneven steps, some of them much longer than a slot
+		Random random(4);
+		while (service.size() > 0) {
+			advanceBy(random.chance(0.1) ? random.upTo(5000000) : random.upTo(700));
+		}
+
+		BOOST_REQUIRE_EQUAL(fired.size(), 13);
+		for (size_t i = 0; i < fired.size(); i++) {
+			BOOST_REQUIRE_EQUAL(fired[i].id, i); // in deadline order
+			BOOST_REQUIRE_EQUAL(fired[i].at, 1000 + delays[i]);
+		}
+	}
+
+
+	BOOST_AUTO_TEST_CASE(PausedTimersKeepTheirRemainingTime)
+	{
+		bool fired = false;
+		const TimerHandle handle = service.schedule(500, [&fired]() { fired = true; });
+
+		advanceBy(200);
+		BOOST_REQUIRE(service.pause(handle));
+		BOOST_REQUIRE(!service.pause(handle));
+		advanceBy(10000);
+		BOOST_REQUIRE(!fired);
+		BOOST_REQUIRE_EQUAL(service.remaining(handle), 300);
+
+		BOOST_REQUIRE(service.setRemaining(handle, 400));
+		BOOST_REQUIRE(service.resume(handle));
+		advanceBy(399);
+		BOOST_REQUIRE(!fired);
+		advanceBy(1);
+		BOOST_REQUIRE(fired);
+		BOOST_REQUIRE(!service.isActive(handle));
+		BOOST_REQUIRE(!service.cancel(handle));
+	}
+
+
+	BOOST_AUTO_TEST_CASE(CallbacksCanRescheduleAndCancel)
+	{
+		std::vector<uint64_t> ticks;
+		std::function<void()> tick = [&]() {
+			ticks.push_back(service.now());
+			if (ticks.size() < 5) service.schedule(100, tick); // a repeating timer, by rescheduling
+		};
+		service.schedule(100, tick);
+
+		// due on the same tick, each cancelling the other: whichever goes first stops the other one
+		int ran = 0;
+		TimerHandle first = {}, second = {};
+		first = service.schedule(50, [&]() { ran++; BOOST_REQUIRE(service.cancel(second)); });
+		second = service.schedule(50, [&]() { ran++; BOOST_REQUIRE(service.cancel(first)); });
+
+		advanceBy(10000);
+		const uint64_t expected[] = { 1100, 1200, 1300, 1400, 1500 };
+		BOOST_REQUIRE_EQUAL_COLLECTIONS(ticks.begin(), ticks.end(), expected, expected + 5);
+		BOOST_REQUIRE_EQUAL(ran, 1);
+		BOOST_REQUIRE_EQUAL(service.size(), 0);
+	}
+
+
+	// Many timers at once, scheduled, moved, paused and cancelled at random while the clock jumps around, checked
+	// against keeping every deadline in a plain map.
+	BOOST_AUTO_TEST_CASE(AgreesWithAMapOfDeadlines)
+	{
+		Random random(9);
+		std::vector<Firing> fired, expected;
+
+		struct Expectation { TimerHandle handle; uint64_t deadline; bool paused; };
+		std::map<size_t, Expectation> live;
+		size_t nextID = 0;
+
+		for (int round = 0; round < 2000; round++) {
+			for (int op = random.upTo(8); op > 0; op--) {
+				const double dice = random.between(0, 1);
+				if (dice < 0.5 || live.empty()) {
+					const uint64_t delay = random.chance(0.05) ? random.upTo(30000000) : random.upTo(5000);
+					const size_t id = nextID++;
+					const TimerHandle handle = service.schedule(delay, [this, id, &fired, &live]() {
+						fired.push_back({ id, service.now() });
+						live.erase(id);
+					});
+					live[id] = { handle, std::max(time + delay, time + 1), false };
+					continue;
+				}
+
+				std::map<size_t, Expectation>::iterator it = live.begin();
+				std::advance(it, random.upTo((uint32_t) live.size() - 1));
+				Expectation &e(it->second);
+				if (dice < 0.65) {
+					BOOST_REQUIRE(service.cancel(e.handle));
+					live.erase(it);
+				} else if (dice < 0.8) {
+					const uint64_t remaining = random.upTo(8000);
+					BOOST_REQUIRE(service.setRemaining(e.handle, remaining));
+					e.deadline = e.paused ? remaining : std::max(time + remaining, time + 1);
+				} else if (!e.paused) {
+					BOOST_REQUIRE(service.pause(e.handle));
+					e.deadline = e.deadline - time;
+					e.paused = true;
+				} else {
+					BOOST_REQUIRE(service.resume(e.handle));
+					e.deadline = std::max(time + e.deadline, time + 1);
+					e.paused = false;
+				}
+			}
+
+			const uint64_t step = random.chance(0.02) ? random.upTo(20000000) : random.upTo(300);
+			for (const auto &kv : live) {
+				if (!kv.second.paused && kv.second.deadline <= time + step) {
+					expected.push_back({ kv.first, kv.second.deadline });
+				}
+			}
+			const size_t firedBefore = fired.size();
+			advanceBy(step);
+
+			std::sort(fired.begin() + firedBefore, fired.end());
+			std::sort(expected.begin() + firedBefore, expected.end());
+			BOOST_REQUIRE_EQUAL(fired.size(), expected.size());
+			for (size_t i = firedBefore; i < fired.size(); i++) {
+				BOOST_REQUIRE_EQUAL(fired[i].id, expected[i].id);
+				BOOST_REQUIRE_EQUAL(fired[i].at, expected[i].at);
+			}
+			BOOST_REQUIRE_EQUAL(service.size(), live.size());
+		}
+		BOOST_TEST_MESSAGE(fired.size() << " of " << nextID << " timers fired");
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Countdown Timer
+
+	BOOST_FIXTURE_TEST_SUITE(CountdownTimerTests, ManualClockFixture)
+
+	BOOST_AUTO_TEST_CASE(AddingAndDeductingMovesTheSameTimer)
+	{
+		int expiries = 0;
+		CountdownTimer countdown(service);
+		countdown.setExpiryCallbackFunc([&expiries]() { expiries++; });
+
+		countdown.startCountdown(60000, true);
+		advanceBy(10000);
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 50000);
+
+		countdown.deductTimeFromCountdown(5000);
+		countdown.addTimeToCountdown(1000);
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 46000);
+		countdown.addTimeToCountdown(100000); // no more than it started with
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 60000);
+		BOOST_REQUIRE_EQUAL(service.size(), 1);
+
+		countdown.pause();
+		advanceBy(100000);
+		BOOST_REQUIRE(countdown.paused());
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 60000);
+		countdown.resume();
+
+		countdown.deductTimeFromCountdown(70000);
+		BOOST_REQUIRE_EQUAL(expiries, 0);
+		advanceBy(1);
+		BOOST_REQUIRE_EQUAL(expiries, 1);
+		BOOST_REQUIRE(!countdown.running());
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 0);
+		BOOST_REQUIRE_EQUAL(service.size(), 0);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(ResetOrRestartedCountdownsNeverExpire)
+	{
+		int expiries = 0;
+		CountdownTimer countdown(service);
+		countdown.setExpiryCallbackFunc([&expiries]() { expiries++; });
+
+		countdown.startCountdown(1000, true);
+		countdown.reset();
+		advanceBy(5000);
+		BOOST_REQUIRE_EQUAL(expiries, 0);
+
+		countdown.startCountdown(1000, true);
+		advanceBy(900);
+		countdown.startCountdown(1000, true);
+		advanceBy(900);
+		BOOST_REQUIRE_EQUAL(expiries, 0);
+		advanceBy(100);
+		BOOST_REQUIRE_EQUAL(expiries, 1);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(ManyCountdownsAtOnce)
+	{
+		std::vector<int> expired;
+		std::vector<std::unique_ptr<CountdownTimer>> countdowns;
+		for (int i = 0; i < 100; i++) {
+			countdowns.emplace_back(new CountdownTimer(service));
+			countdowns.back()->setExpiryCallbackFunc([i, &expired]() { expired.push_back(i); });
+			countdowns.back()->startCountdown(10000 - i * 50, true);
+		}
+		for (int i = 0; i < 100; i += 2) {
+			countdowns[i]->deductTimeFromCountdown(9000);
+		}
+
+		advanceBy(1000);
+		BOOST_REQUIRE_EQUAL(expired.size(), 50);
+		advanceBy(9000);
+		BOOST_REQUIRE_EQUAL(expired.size(), 100);
+		for (int i = 0; i < 50; i++) {
+			BOOST_REQUIRE_EQUAL(expired[i] % 2, 0);
+			BOOST_REQUIRE_EQUAL(expired[50 + i], 99 - 2 * i); // the shortest odd ones first
+		}
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+
+
+#pragma mark - Game Clock
+
+	BOOST_AUTO_TEST_SUITE(GameClockTests)
+
+	BOOST_AUTO_TEST_CASE(FrameClockOnlyMovesOnTicks)
+	{
+		ManualClock clock(500);
+		FrameClock frameClock(clock);
+		BOOST_REQUIRE_EQUAL(frameClock.now(), 500);
+
+		clock.advance(16);
+		BOOST_REQUIRE_EQUAL(frameClock.now(), 500); // the same for the rest of the frame
+		frameClock.tick();
+		BOOST_REQUIRE_EQUAL(frameClock.now(), 516);
+		BOOST_REQUIRE_EQUAL(frameClock.frame(), 1);
+
+		// another clock takes over from where this one was, whatever it reads
+		ManualClock other(0);
+		frameClock.setSource(other);
+		BOOST_REQUIRE_EQUAL(frameClock.now(), 516);
+		other.advance(100);
+		frameClock.tick();
+		BOOST_REQUIRE_EQUAL(frameClock.now(), 616);
+
+		frameClock.setSource(clock); // reads 516 again, but the time never goes back
+		clock.advance(10);
+		frameClock.tick();
+		BOOST_REQUIRE_EQUAL(frameClock.now(), 626);
+	}
+
+
+	BOOST_AUTO_TEST_CASE(TimersAndCountdownsReadTheFrameTime)
+	{
+		ManualClock clock;
+		FrameClock frameClock(clock);
+		TimerService service(frameClock);
+		CountdownTimer countdown(service);
+		countdown.setExpiryCallbackFunc([]() {});
+		countdown.startCountdown(3000, true);
+
+		clock.advance(1000);
+		service.update(); // not ticked yet
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 3000);
+		frameClock.tick();
+		service.update();
+		BOOST_REQUIRE_EQUAL(countdown.timeRemaining(), 2000);
+		BOOST_REQUIRE_EQUAL(service.now(), frameClock.now());
+	}
+
+
+	// the game's own countdown, fast-forwarded through the app-wide frame clock
+	BOOST_AUTO_TEST_CASE(GameCountdownCanBeFastForwarded)
+	{
+		GameState &gs(GameState::getInstance());
+		ManualClock clock;
+		FrameClock::getInstance().setSource(clock);
+		TimerService::getInstance().update(); // caught up with the frame, as it is once per frame in the app
+		const uint64_t start = GameState::getTimeNow();
+
+		gs.resetGameState();
+		gs.tryStartTimer(10);
+
+		clock.advance(4000);
+		FrameClock::getInstance().tick();
+		TimerService::getInstance().update();
+		BOOST_REQUIRE_EQUAL(GameState::getTimeNow(), start + 4000);
+		BOOST_REQUIRE_EQUAL(gs.getTimeRemaining(), 6000);
+		BOOST_REQUIRE(!gs.isGameOver());
+
+		clock.advance(6000);
+		FrameClock::getInstance().tick();
+		TimerService::getInstance().update();
+		BOOST_REQUIRE(gs.isGameOver());
+		BOOST_REQUIRE(!gs.isGameStarted());
+		BOOST_REQUIRE_EQUAL(gs.getTimeRemaining(), 0);
+
+		FrameClock::getInstance().resetSource();
+		gs.resetGameState();
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
@@ -31,7 +31,7 @@ namespace ac {
 	BOOST_AUTO_TEST_CASE(RandomRGBByteReturnsValidRandomCCC3) {
 		RGBByte rgb = randomRGBByte();
 		
-		BOOST_MESSAGE("RGB(" << (unsigned int)rgb.r << ", " << (unsigned int)rgb.g << ", " << (unsigned int)rgb.b << ")");
+		BOOST_TEST_MESSAGE("RGB(" << (unsigned int)rgb.r << ", " << (unsigned int)rgb.g << ", " << (unsigned int)rgb.b << ")");
 		
 		BOOST_REQUIRE_GE(rgb.r, 0);
 		BOOST_REQUIRE_LT(rgb.r, 256);
@@ -49,14 +49,20 @@ namespace ac {
 		const std::string file = "debug-settings.json";
 		const std::string path = getFullPathForFilename(file);
 		
-		BOOST_MESSAGE("The path: " << path );
+		BOOST_TEST_MESSAGE("The path: " << path );
 		
-		BOOST_MESSAGE("Looking for 'iPhone Simulator'");
+#if AC_HEADLESS
+		// the stand-in looks in the source tree
+		BOOST_TEST_MESSAGE("Looking for 'resources/'");
+		size_t result = path.find("resources/");
+#else
+		BOOST_TEST_MESSAGE("Looking for 'iPhone Simulator'");
 		size_t result = path.find("iPhone Simulator");
+#endif
 		BOOST_REQUIRE_NE(result, string::npos);
 
 		// is the original file there
-		BOOST_MESSAGE("Looking for the original file name in the path");
+		BOOST_TEST_MESSAGE("Looking for the original file name in the path");
 		result = path.find(file);
 		BOOST_REQUIRE_NE(result, string::npos);
 	}
@@ -73,6 +79,43 @@ namespace ac {
 	}
 
 	
+	BOOST_AUTO_TEST_CASE(RandomEnginesAreReproducibleAndStayInRange) {
+
+		Random a(42), b(42), c(43);
+		bool differs = false;
+		for (int i = 0; i < 1000; i++) {
+			const uint32_t x = a();
+			BOOST_REQUIRE_EQUAL(x, b());
+			if (x != c()) differs = true;
+		}
+		BOOST_CHECK(differs);
+
+		std::vector<int> counts(7);
+		for (int i = 0; i < 70000; i++) {
+			const uint32_t r = a.upTo(6);
+			BOOST_REQUIRE_LE(r, 6);
+			counts[r]++;
+		}
+		for (int n : counts) {
+			BOOST_CHECK_CLOSE(n, 10000.0, 5); // percent
+		}
+
+		for (int i = 0; i < 1000; i++) {
+			const float f = randomFloat(2, 3);
+			BOOST_REQUIRE_GE(f, 2);
+			BOOST_REQUIRE_LT(f, 3);
+		}
+
+		// reseeding the service restarts every stream
+		RandomService::getInstance().seed(7);
+		const uint32_t first = RandomService::get(RandomStream::Colors)();
+		RandomService::get(RandomStream::Colors)();
+		RandomService::getInstance().seed(7);
+		BOOST_CHECK_EQUAL(RandomService::get(RandomStream::Colors)(), first);
+		BOOST_CHECK_EQUAL(RandomService::getInstance().getSeed(), 7);
+	}
+	
+	
 	BOOST_AUTO_TEST_SUITE_END()
 	
 	
@@ -0,0 +1,74 @@
+//
+//  main.cpp
+//  CopyTextCompiler
+//
+//  Created by Aldrich Co on 1/12/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Compiles a JSON copy file into the binary corpus format CopyTextLoader maps directly (see CopyTextCorpus.h):
+//	the lines are wrapped at the given width, summarized and indexed by difficulty ahead of time.
+//
+//	Build from the repository root (only needs the boost headers), as one command:
+//		c++ -std=c++11 -O2 -I "Typing Genius/classes/text" -I "Typing Genius/classes/helpers"
+//			Tools/CopyTextCompiler/main.cpp "Typing Genius/classes/text/CopyTextCorpus.cpp" -o copytext-compiler
+//
+//	Usage:
+//		copytext-compiler <copy file.json> <max chars per line, 0 for no wrapping> <output.tgc>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CopyTextCorpus.h"
+#include "MappedFile.h"
+
+using namespace ac;
+
+int main(int argc, const char *argv[])
+{
+	if (argc != 4) {
+		std::cerr << "usage: " << argv[0] << " <copy file.json> <max chars per line> <output.tgc>" << std::endl;
+		return 1;
+	}
+
+	const std::string input(argv[1]), output(argv[3]);
+	const size_t maxCharsPerLine = std::strtoul(argv[2], nullptr, 10);
+
+	MappedFile file;
+	if (!file.map(input)) {
+		std::cerr << "could not read " << input << std::endl;
+		return 1;
+	}
+
+	boost::string_ref content;
+	bool hasEscapes = false;
+	if (!copytext::findJSONContent(file.data, file.length, content, hasEscapes)) {
+		std::cerr << input << " is not a JSON object" << std::endl;
+		return 1;
+	}
+
+	std::string decoded;
+	if (hasEscapes) {
+		if (!copytext::decodeJSONEscapes(content, decoded)) {
+			std::cerr << input << " has a malformed escape in its content" << std::endl;
+			return 1;
+		}
+		content = decoded;
+	}
+
+	std::vector<CopyTextLine> lines;
+	copytext::wrapLines(content, maxCharsPerLine, lines);
+
+	CopyTextCorpus corpus;
+	corpus.build(content, std::move(lines), maxCharsPerLine);
+	if (!corpus.write(output)) {
+		std::cerr << "could not write " << output << std::endl;
+		return 1;
+	}
+
+	std::cout << output << ": " << corpus.getNumberOfLines() << " lines (easy " <<
+		corpus.getNumberOfLines(CopyTextDifficulty::Easy) << ", moderate " <<
+		corpus.getNumberOfLines(CopyTextDifficulty::Moderate) << ", hard " <<
+		corpus.getNumberOfLines(CopyTextDifficulty::Hard) << ")" << std::endl;
+	return 0;
+}
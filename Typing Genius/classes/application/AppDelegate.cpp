@@ -9,18 +9,77 @@
 #include "AppDelegate.h"
 #include "cocos2d.h"
 #include "SimpleAudioEngine.h"
+#include "support/CCProfiling.h"
 #include "MainScene.h"
 #include "IntroScene.h"
 #include "AppContext.h"
 #include "DebugSettingsHelper.h"
+#include "FrameProfiler.h"
+#include "GameClock.h"
 #include "ScreenResolutionHelper.h"
 #include "GameState.h"
+#include "KeystrokeTrace.h"
 #include "Notif.h"
+#include "Player.h"
+#include "Random.h"
+#include "TimerService.h"
 
 
 USING_NS_CC;
 using namespace CocosDenshion;
 
+
+namespace ac {
+
+	// Delivers what was queued with Notif::post, once per frame and ahead of the other scheduled updates.
+	class DeferredNotifDispatcher : public CCObject
+	{
+	public:
+		void update(float dt)
+		{
+			FrameProfiler::Scope profile(FrameProfiler::Section::NotifDispatch);
+			Notif::dispatchDeferred();
+		}
+	};
+
+
+	// Passes cocos2d-x's frames and the sections timed in them on to the FrameProfiler.
+	class FrameProfilerListener : public CCProfilingFrameListener
+	{
+	public:
+		static_assert((int) FrameProfiler::Section::SortChildren == kCCProfilingSectionSortChildren &&
+					  (int) FrameProfiler::Section::NotifDispatch == kCCProfilingSectionCount,
+					  "FrameProfiler's sections start with cocos2d-x's");
+
+		virtual void frameBegan() { FrameProfiler::getInstance().beginFrame(); }
+		virtual void frameEnded() { FrameProfiler::getInstance().endFrame(); }
+
+		virtual void sectionBegan(ccProfilingSection section)
+		{
+			FrameProfiler::getInstance().beginSection((FrameProfiler::Section) section);
+		}
+
+		virtual void sectionEnded(ccProfilingSection section)
+		{
+			FrameProfiler::getInstance().endSection((FrameProfiler::Section) section);
+		}
+	};
+
+
+	// Moves the game clock forward at the start of each frame, then fires the game's timers (the countdown among
+	// them) on the main thread, so everything updating in the frame goes by the same time.
+	class FrameClockDriver : public CCObject
+	{
+	public:
+		void update(float dt)
+		{
+			FrameClock::getInstance().tick();
+			TimerService::getInstance().update();
+		}
+	};
+}
+
+
 AppDelegate::AppDelegate()
 {
 }
@@ -42,6 +101,20 @@ bool AppDelegate::applicationDidFinishLaunching()
 	// turn on display FPS
 	bool shouldShowFPS = DebugSettingsHelper::sharedHelper().boolValueForProperty("show_fps_stats", false);
 	pDirector->setDisplayStats(shouldShowFPS);
+
+	// where the time in each of the last few hundred frames went, dumped when the app goes to the background
+	if (DebugSettingsHelper::sharedHelper().boolValueForProperty("profile_frames", false)) {
+		static FrameProfilerListener frameProfilerListener;
+		FrameProfiler::getInstance().setEnabled(true);
+		CCProfilingSetFrameListener(&frameProfilerListener);
+	}
+
+	// a fixed seed gives the same copy strings (and everything else picked at random) on every launch
+	const int randomSeed = DebugSettingsHelper::sharedHelper().intValueForProperty("random_seed", 0);
+	if (randomSeed != 0) {
+		RandomService::getInstance().seed(randomSeed);
+	}
+	LogI << "Random seed: " << RandomService::getInstance().getSeed();
 	
 	// set FPS. the default value is 1.0/60 if you don't call this
 	pDirector->setAnimationInterval(1.0 / 60);
@@ -56,12 +129,27 @@ bool AppDelegate::applicationDidFinishLaunching()
 	
 	// run
 	pDirector->runWithScene(pScene);
+
+	// ahead of every other scheduled update
+	CCObject *clockDriver = new FrameClockDriver;
+	pDirector->getScheduler()->scheduleUpdateForTarget(clockDriver, kCCPriorityNonSystemMin, false);
+	clockDriver->release(); // the scheduler keeps it
+
+#ifndef BOOST_TEST_TARGET
+	// non-critical notifications from touch handlers wait for the next frame (tests still expect them synchronously)
+	CCObject *notifDispatcher = new DeferredNotifDispatcher;
+	pDirector->getScheduler()->scheduleUpdateForTarget(notifDispatcher, kCCPriorityNonSystemMin, false);
+	notifDispatcher->release(); // the scheduler keeps it
+
+	Notif::setCoalesced(notif::ScoreKeeper_LevelProgressUpdate);
+	Notif::setDeferredDispatch(true);
+#endif
 	
 	// -- figure out ideal resolution and point asset lookup to right path
 	utilities::initializeScreenSizeParameters();
 	utilities::initializeSearchPathsAndResolutionOrder();
 
-	ac::Notif::send("AppDelegate_FinishLaunch");
+	ac::Notif::send(ac::notif::AppDelegate_FinishLaunch);
 
 	return true;
 }
@@ -73,7 +161,19 @@ void AppDelegate::applicationDidEnterBackground()
 	SimpleAudioEngine::sharedEngine()->pauseBackgroundMusic();
 	SimpleAudioEngine::sharedEngine()->pauseAllEffects();
 
-	ac::Notif::send("AppDelegate_EnteredBackground");
+	ac::Notif::send(ac::notif::AppDelegate_EnteredBackground);
+
+	// the stats are written in the background, and the app may not come back from here
+	ac::GameState::getInstance().player().flushStatsToDB();
+
+#if AC_TRACING
+	// whatever was typed since the last time, for chrome://tracing
+	ac::trace::dump(CCFileUtils::sharedFileUtils()->getWritablePath() + "keystroke-trace.json");
+#endif
+
+	if (ac::FrameProfiler::getInstance().isEnabled()) {
+		ac::FrameProfiler::getInstance().dump(CCFileUtils::sharedFileUtils()->getWritablePath() + "frame-profile.csv");
+	}
 }
 
 // this function will be called when the app is active again
@@ -83,7 +183,7 @@ void AppDelegate::applicationWillEnterForeground()
 	SimpleAudioEngine::sharedEngine()->resumeBackgroundMusic();
 	SimpleAudioEngine::sharedEngine()->resumeAllEffects();
 
-	ac::Notif::send("AppDelegate_EnteringForeground");
+	ac::Notif::send(ac::notif::AppDelegate_EnteringForeground);
 }
 
 
@@ -8,21 +8,14 @@
 
 #include "CountdownTimer.h"
 #include <boost/bind.hpp>
-#include <boost/function.hpp>
-#include "GameState.h"
+#include "Utilities.h"
 
 
 namespace ac {
 
-	const long long Million = 1000000LL;
-
-	CountdownTimer::CountdownTimer()
-	: countdownTimer(io), originalCountdownDuration(), work(io)
+	CountdownTimer::CountdownTimer(TimerService &service)
+	: service(service), countdown(), isStarted(false), originalCountdownDuration()
 	{
-		isStarted = false;
-
-		// 'work' prevents this io service from returning when there's no work to be done
-		boost::thread t(&CountdownTimer::startIOService, this);
 	}
 
 
@@ -34,6 +27,7 @@ namespace ac {
 
 	void CountdownTimer::reset()
 	{
+		service.cancel(countdown);
 		originalCountdownDuration = 0;
 		isStarted = false;
 	}
@@ -51,19 +45,17 @@ namespace ac {
 	}
 
 
-	long CountdownTimer::timeRemaining()
+	long CountdownTimer::timeRemaining() const
 	{
 		if (!isStarted) { return 0; }
-		boost::posix_time::time_duration duration = countdownTimer.expires_from_now();
-		long ms = duration.total_milliseconds();
-		return ms;
+		return (long) service.remaining(countdown);
 	}
 
 
 	void CountdownTimer::startCountdown(unsigned int milliseconds, bool justStarted)
 	{
 		if (!this->callbackFunc) {
-			string errorMessage("no callback specified in CountdownTimer!");
+			std::string errorMessage("no callback specified in CountdownTimer!");
 			LogE << errorMessage;
 			throw errorMessage;
 		}
@@ -71,22 +63,23 @@ namespace ac {
 		if (justStarted) {
 			originalCountdownDuration = milliseconds;
 			isStarted = true;
-			countdownTimer.cancel(); // is this a good idea?
+			service.cancel(countdown);
 		}
 
-		// i have no idea as of yet why it crashes here.
-		countdownTimer.expires_from_now(boost::posix_time::milliseconds(milliseconds));
-		countdownTimer.async_wait(this->callbackFunc);
-
+		if (!service.setRemaining(countdown, milliseconds)) {
+			countdown = service.schedule(milliseconds, boost::bind(&CountdownTimer::onTimeout, this));
+		}
 	}
 
 
-	void CountdownTimer::startIOService()
+	void CountdownTimer::onTimeout()
 	{
-		io.run();
+		// the handle is stale by now, so a callback that restarts the countdown gets a new timer
+		isStarted = false;
+		this->callbackFunc();
 	}
 
-	
+
 	void CountdownTimer::addTimeToCountdown(unsigned int millis)
 	{
 		if (!isStarted) { return; }
@@ -95,15 +88,32 @@ namespace ac {
 		if (timeRem > originalCountdownDuration) {
 			timeRem = originalCountdownDuration;
 		}
-		startCountdown(timeRem);
+		service.setRemaining(countdown, timeRem);
 	}
-	
-	
+
+
 	void CountdownTimer::deductTimeFromCountdown(unsigned int millis)
 	{
 		if (!isStarted) { return; }
 		long newTime = timeRemaining() - millis;
-		startCountdown(newTime >= 0 ? newTime : 0);
+		service.setRemaining(countdown, newTime >= 0 ? newTime : 0);
+	}
+
+
+	void CountdownTimer::pause()
+	{
+		service.pause(countdown);
+	}
+
+
+	void CountdownTimer::resume()
+	{
+		service.resume(countdown);
 	}
 
+
+	bool CountdownTimer::paused() const
+	{
+		return service.isPaused(countdown);
+	}
 }
@@ -5,24 +5,24 @@
 //  Created by Aldrich Co on 10/10/13.
 //  Copyright (c) 2013 Aldrich Co. All rights reserved.
 //
+//	A countdown on a TimerService, so the expiry callback is made on the main thread from the frame update (and
+//	never for a countdown that was reset or restarted before it ran out).
 
 #pragma once
 
-// #include <boost/timer/timer.hpp>
-#include <boost/asio/io_service.hpp>
-#include <boost/asio/deadline_timer.hpp>
-#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include "TimerService.h"
 
 namespace ac {
 
 
-	typedef boost::function<void(const boost::system::error_code& e)> TimerCallback_t;
+	typedef boost::function<void()> TimerCallback_t;
 
 	class CountdownTimer
 	{
 	public:
 
-		CountdownTimer();
+		explicit CountdownTimer(TimerService &service = TimerService::getInstance());
 		~CountdownTimer();
 
 		void reset();
@@ -30,28 +30,29 @@ namespace ac {
 		bool running() const;
 
 		void startCountdown(unsigned int milliseconds, bool justStarted = false);
-		
-		// assumes countdown is running.
+
+		// assumes countdown is running. These move the deadline of the same timer.
 		void deductTimeFromCountdown(unsigned int);
 		void addTimeToCountdown(unsigned int);
 
-		// useful only when timer isn't paused; expressed in milliseconds
-		long timeRemaining();
+		void pause();
+		void resume();
+		bool paused() const;
+
+		// expressed in milliseconds (0 if not running)
+		long timeRemaining() const;
 
 		// timer expiry callback
-		void on_timeout(const boost::system::error_code& e);
 		void setExpiryCallbackFunc(TimerCallback_t);
 
 	private:
-		
-		boost::asio::io_service io;
-		boost::asio::deadline_timer countdownTimer;
+		CountdownTimer(const CountdownTimer &) = delete;
+		CountdownTimer &operator=(const CountdownTimer &) = delete;
 
-		// prevents the io service from returning after run() when there's no work to be done
-		boost::asio::io_service::work work;
+		void onTimeout();
 
-		// has to be done in background thread
-		void startIOService();
+		TimerService &service;
+		TimerHandle countdown;
 
 		bool isStarted;
 		long originalCountdownDuration;
@@ -10,6 +10,7 @@
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
+#include "BoostPTreeHelper.h"
 #include "Utilities.h"
 
 
@@ -34,7 +35,7 @@ namespace ac {
 
 			// get ready to catch an exception if reading the file fails
 			try {
-				read_json(fullPath, pt);
+				utilities::readJSONWithComments(fullPath, pt);
 			} catch (const json_parser_error &obj) {
 				LogE << "Problem reading configuration file: " << obj.what();
 				hasError = true;
@@ -0,0 +1,62 @@
+//
+//  GameClock.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/21/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "GameClock.h"
+#include <algorithm>
+#include <chrono>
+
+namespace ac {
+
+	SteadyClock &SteadyClock::getInstance()
+	{
+		static SteadyClock instance;
+		return instance;
+	}
+
+
+	uint64_t SteadyClock::now() const
+	{
+		typedef std::chrono::steady_clock clock;
+		return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now().time_since_epoch()).count();
+	}
+
+
+#pragma mark - Frame Clock
+
+	FrameClock &FrameClock::getInstance()
+	{
+		static FrameClock instance(SteadyClock::getInstance());
+		return instance;
+	}
+
+
+	FrameClock::FrameClock(const GameClock &source)
+	: source(&source), offset(0), frameTime(source.now()), frameCount(0)
+	{
+	}
+
+
+	void FrameClock::tick()
+	{
+		frameTime = std::max(frameTime, source->now() + offset);
+		frameCount++;
+	}
+
+
+	void FrameClock::setSource(const GameClock &newSource)
+	{
+		source = &newSource;
+		offset = (int64_t) (frameTime - newSource.now());
+	}
+
+
+	void FrameClock::resetSource()
+	{
+		setSource(SteadyClock::getInstance());
+	}
+}
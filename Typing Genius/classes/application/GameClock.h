@@ -0,0 +1,90 @@
+//
+//  GameClock.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/21/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Where the game gets the time from. All of it is in milliseconds on a monotonic clock: it never goes backwards and
+//	doesn't care about midnight or the user changing the time of day, which also means the numbers only mean
+//	something relative to each other (use the wall clock for dates).
+//
+//	The game itself reads the FrameClock, which the app moves forward once at the start of each frame, so that the
+//	countdown, the timers and the HUD all see the same time for the whole frame. Tests swap its source for a
+//	ManualClock, and then fast-forward the game by advancing that.
+
+#pragma once
+
+#include <cstdint>
+
+namespace ac {
+
+	class GameClock
+	{
+	public:
+		virtual ~GameClock() {}
+
+		// milliseconds, never going backwards
+		virtual uint64_t now() const = 0;
+	};
+
+
+	// std::chrono::steady_clock
+	class SteadyClock : public GameClock
+	{
+	public:
+		static SteadyClock &getInstance();
+
+		uint64_t now() const;
+	};
+
+
+	// only moves when told to
+	class ManualClock : public GameClock
+	{
+	public:
+		explicit ManualClock(uint64_t start = 0) : time(start) {}
+
+		uint64_t now() const { return time; }
+
+		// going backwards is ignored
+		void set(uint64_t milliseconds) { if (milliseconds > time) time = milliseconds; }
+		void advance(uint64_t milliseconds) { time += milliseconds; }
+
+	private:
+		uint64_t time;
+	};
+
+
+	// Holds on to its source's time as of the last tick(), so it doesn't change in the middle of a frame.
+	class FrameClock : public GameClock
+	{
+	public:
+		// the one the game runs on, ticked by the app at the start of each frame and reading the steady clock
+		static FrameClock &getInstance();
+
+		explicit FrameClock(const GameClock &source);
+
+		uint64_t now() const { return frameTime; }
+
+		// reads the source: the time everyone gets until the next tick
+		void tick();
+
+		// frames ticked so far
+		inline uint64_t frame() const { return frameCount; }
+
+		// Picks up from now() on the new source (which must outlive its use here), so the time carries on from
+		// where it was rather than jumping to whatever the new clock reads: a manual clock can just start at 0.
+		void setSource(const GameClock &);
+		void resetSource(); // back to the steady clock
+
+	private:
+		FrameClock(const FrameClock &) = delete;
+		FrameClock &operator=(const FrameClock &) = delete;
+
+		const GameClock *source;
+		int64_t offset; // added to the source's time
+		uint64_t frameTime;
+		uint64_t frameCount;
+	};
+}
@@ -13,17 +13,20 @@
 
 namespace ac {
 	
-	using std::shared_ptr;
-	using std::static_pointer_cast;
-	
 	const int SecondsToAddForFrogs = 10;
 	
-	void GameModifierHelper::notifCallback(const string &code, shared_ptr<void> data)
+	GameModifierHelper::GameModifierHelper()
+	{
+		listenTo({ notif::CopyText_TriggerAltKey });
+	}
+
+
+	void GameModifierHelper::topicCallback(notif_topic_t topic, const NotifData &data)
 	{
 		
-		if ("CopyText_TriggerAltKey" == code) {
+		if (notif::CopyText_TriggerAltKey == topic) {
 			
-			shared_ptr<KeyEvent> kev = static_pointer_cast<KeyEvent>(data);
+			const KeyEvent *kev = data.get<KeyEvent>();
 		
 			// use GS to get what the key stands for...
 			GlyphMap &gm(GameState::getInstance().glyphMap());
@@ -18,7 +18,9 @@ namespace ac {
 	class GameModifierHelper : public NotifListener
 	{
 	public:
-		void notifCallback(const string &, std::shared_ptr<void> data);
+		GameModifierHelper();
+
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 	
 		inline GameState &gs() const { return GameState::getInstance(); }
 		inline Player &player() const { return gs().player(); }
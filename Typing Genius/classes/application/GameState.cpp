@@ -7,16 +7,16 @@
 //
 
 #include "GameState.h"
-#include "StatsHUDModel.h"
-#include "StatsHUD.h"
 #include "DebugSettingsHelper.h"
 #include "CountdownTimer.h"
+#include "GameClock.h"
 #include "CopyText.h"
 #include "KeypressTracker.h"
 #include "ScoreKeeper.h"
 #include "Player.h"
 #include "GameModifierHelper.h"
 #include "GlyphMap.h"
+#include "SessionHistory.h"
 
 namespace ac {
 	
@@ -37,7 +37,7 @@ namespace ac {
 		timer()
 		{
 			isGodMode = DebugSettingsHelper::sharedHelper().boolValueForProperty("god_mode", false);
-			timer.setExpiryCallbackFunc(boost::bind(&GameStateImpl::countdownExpiryCallback, this, _1));
+			timer.setExpiryCallbackFunc(boost::bind(&GameStateImpl::countdownExpiryCallback, this));
 		}
 		
 		ac::CountdownTimer timer;
@@ -50,6 +50,7 @@ namespace ac {
 		Player player;
 		GameModifierHelper gameModifierHelper;
 		GlyphMap glyphMap;
+		SessionRecorder sessionRecorder;
 
 		bool timerJustStarted; // will be set when starting, and unset after notifying
 		bool isInPostGameState;
@@ -58,7 +59,7 @@ namespace ac {
 
 		void processTypingMistake();
 
-		void countdownExpiryCallback(const boost::system::error_code& e);
+		void countdownExpiryCallback();
 	};
 	
 	
@@ -68,6 +69,8 @@ namespace ac {
 	{
 		LogD << "Inside GameState constructor";
 		pImpl.reset(new GameStateImpl);
+
+		listenTo({ notif::ScoreKeeper_Mistake });
 	}
 	
 	
@@ -89,6 +92,12 @@ namespace ac {
 	void GameState::stop(bool finishedStage = false)
 	{
 		pImpl->timer.reset();
+
+		// to the history, before the player moves on to the next level
+		SessionRecord session;
+		if (pImpl->sessionRecorder.end(finishedStage, scoreKeeper().getTotalScore(), session)) {
+			this->player().recordSession(std::move(session));
+		}
 		if (finishedStage) {
 			this->player().incrementPlayerLevel();
 			LogI << "Incrementing player level. Now at " << this->player().getLevel();
@@ -108,9 +117,9 @@ namespace ac {
 	
 #pragma mark - Notif Event Handling and Processing
 
-	void GameState::notifCallback(const string &code, std::shared_ptr<void> data)
+	void GameState::topicCallback(notif_topic_t topic, const NotifData &data)
 	{
-		if ("ScoreKeeper_Mistake" == code) {
+		if (notif::ScoreKeeper_Mistake == topic) {
 			pImpl->processTypingMistake();
 		}
 	}
@@ -168,6 +177,12 @@ namespace ac {
 		return pImpl->glyphMap;
 	}
 
+
+	SessionRecorder &GameState::sessionRecorder() const
+	{
+		return pImpl->sessionRecorder;
+	}
+
 	
 	void GameState::resetGameState()
 	{
@@ -176,6 +191,7 @@ namespace ac {
 
 		pImpl->copyText.reset();
 		pImpl->timer.reset();
+		pImpl->sessionRecorder.discard();
 		pImpl->keypressTracker.reset();
 		pImpl->scoreKeeper.reset();
 	}
@@ -230,10 +246,11 @@ namespace ac {
 		pImpl->timerJustStarted = true; // observers will query this
 		float timeRemaining = seconds == 0.0 ? this->getTimeRemainingValueForLevel() : seconds;
 		pImpl->timer.startCountdown(timeRemaining * 1000, true);
+		pImpl->sessionRecorder.begin(player().getLevel());
 
-		std::shared_ptr<GameStateTimerEventInfo> pInfo(new GameStateTimerEventInfo);
-		pInfo->delta = timeRemaining;
-		Notif::send("GameState_Timer_StartTimer", pInfo);
+		GameStateTimerEventInfo info = {};
+		info.delta = timeRemaining;
+		Notif::send(notif::GameState_Timer_StartTimer, info);
 
 		pImpl->timerJustStarted = false; // observers already notified
 		return timeRemaining;
@@ -245,26 +262,22 @@ namespace ac {
 		long timeRemaining = getTimeRemaining();
 		if (timeRemaining <= 0) {
 			// timer has indeed stopped, send a notification to the observers
-			Notif::send("GameState_Timer_StopTimer");
+			Notif::send(notif::GameState_Timer_StopTimer);
 			return true;
 		}
 		return false;
 	}
 
 
-	void GameStateImpl::countdownExpiryCallback(const boost::system::error_code& e)
+	// only called for a countdown that ran out; resetting or restarting it cancels the timer instead
+	void GameStateImpl::countdownExpiryCallback()
 	{
-		if (e == boost::asio::error::operation_aborted) {
-			LogD << ">>> Timer reset!";
-
-		} else {
-			LogI << ">>> Timer finished!";
-			// should now trigger a signal that SHM should listen for...
-			Notif::send("GameState_Timer_StopTimer");
-			gs().stop(false);
-			gs().setIsGameOver(true); // AC 2013.12.10: based on our rules
-			gs().copyText().clearCopyString();
-		}
+		LogI << ">>> Timer finished!";
+		// should now trigger a signal that SHM should listen for...
+		Notif::send(notif::GameState_Timer_StopTimer);
+		gs().stop(false);
+		gs().setIsGameOver(true); // AC 2013.12.10: based on our rules
+		gs().copyText().clearCopyString();
 	}
 	
 	
@@ -278,18 +291,18 @@ namespace ac {
 	{
 		pImpl->timer.deductTimeFromCountdown(seconds * 1000);
 
-		std::shared_ptr<GameStateTimerEventInfo> pInfo(new GameStateTimerEventInfo);
-		pInfo->delta = seconds;
-		Notif::send("GameState_Timer_DeductTime", pInfo);
+		GameStateTimerEventInfo info = {};
+		info.delta = seconds;
+		Notif::send(notif::GameState_Timer_DeductTime, info);
 	}
 	
 	
 	void GameState::addTimer(float seconds)
 	{
 		pImpl->timer.addTimeToCountdown(seconds * 1000);
-		std::shared_ptr<GameStateTimerEventInfo> pInfo(new GameStateTimerEventInfo);
-		pInfo->delta = seconds;
-		Notif::send("GameState_Timer_AddTime", pInfo);
+		GameStateTimerEventInfo info = {};
+		info.delta = seconds;
+		Notif::send(notif::GameState_Timer_AddTime, info);
 	}
 	
 	
@@ -305,6 +318,12 @@ namespace ac {
 
 #pragma mark - Misc
 
+	uint64_t GameState::getTimeNow()
+	{
+		return FrameClock::getInstance().now();
+	}
+
+
 	std::string GameState::formattedTimeVal(long millis, bool includeMinute)
 	{
 		static boost::format fmtNoMinute("%|1$|.%|2$1d| sec");
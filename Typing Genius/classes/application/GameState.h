@@ -8,8 +8,7 @@
 
 #pragma once
 
-#include <boost/date_time.hpp>
-#include <boost/system/error_code.hpp>
+#include <cstdint>
 #include "Notif.h"
 
 namespace ac {
@@ -20,12 +19,11 @@ namespace ac {
 	class ScoreKeeper;
 	class Player;
 	class GlyphMap;
+	class SessionRecorder;
 
 //	const int AddTimeCurrencyCost = 5;
 //	const int SecondsToAddForFrogs = 10;
 	
-	using namespace boost::posix_time;
-
 
 	struct GameStateTimerEventInfo
 	{
@@ -73,6 +71,7 @@ namespace ac {
 		ScoreKeeper &scoreKeeper() const;
 		Player &player() const;
 		GlyphMap &glyphMap() const;
+		SessionRecorder &sessionRecorder() const; // the session runs from tryStartTimer() until stop()
 
 		// observers will query this.
 		bool hasTimerStateUpdatedToStartIt() const;
@@ -82,15 +81,13 @@ namespace ac {
 		bool isGodMode() const;
 		void setGodMode(bool);
 
-		static inline long getTimeNow()
-		{
-			ptime now(microsec_clock::local_time());
-			return now.time_of_day().total_milliseconds();
-		}
+		// milliseconds on the FrameClock: the same for everyone within a frame, and only good for measuring
+		// durations (it's not a time of day)
+		static uint64_t getTimeNow();
 
 
 		// NotifListener callback
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 		
 	private:
 		GameState(); // use singleton instead
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <vector>
 #include "PlayerLevel.h"
+#include "SessionHistory.h"
 
 namespace ac
 {
@@ -40,9 +42,26 @@ namespace ac
 		void resetPlayer();
 
 		/** 
-		 *	@brief saves updated values to corresponding db entry. Can throw!
+		 *	@brief saves updated values to corresponding db entry. Can throw! The write itself happens in the
+		 *	background, so this returns right away.
 		 */
 		void syncStatsToDB(const ScoreKeeper &);
+
+		/**
+		 *	@brief blocks until everything synced so far has been written, e.g. before the app may be killed
+		 */
+		void flushStatsToDB();
+
+		/**
+		 *	@brief queues a finished session (and its keystrokes) for the history, in the background too
+		 */
+		void recordSession(SessionRecord &&);
+
+		// from the history: accuracy and speed per key, by label
+		std::vector<KeyAccuracy> keyAccuracy() const;
+
+		// from the history: the last `sessions` sessions' typing speed, oldest first
+		std::vector<SessionSpeed> speedTrend(size_t sessions) const;
 		
 		
 	private:
@@ -0,0 +1,670 @@
+//
+//  PlayerStore.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/22/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "PlayerStore.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "sqlite3.h"
+#include "Utilities.h"
+
+namespace ac {
+
+	namespace {
+
+		const char *CreateTableSql =
+		"CREATE TABLE IF NOT EXISTS Player ( "\
+			"PlayerName         VARCHAR(15) , "\
+			"CurrencyCollected  INT         NOT NULL, "\
+			"TopScore           INT         NOT NULL, "\
+			"TopLevel           INT         NOT NULL, "\
+			"TotalBlocksCleared INT         NOT NULL, "\
+			"TotalCorrectCount  INT         NOT NULL, "\
+			"TotalMistakeCount  INT         NOT NULL, "\
+			"LongestStreak      INT         NOT NULL, "\
+			"DateLastPlayed     DATETIME    "\
+		");";
+
+		// The history. Keys are numbered in the database by label, as the KeyRegistry's IDs don't last past a launch.
+		// KeyStats holds each player's running totals per key, added to as sessions are written.
+		const char *CreateHistoryTablesSql =
+		"CREATE TABLE IF NOT EXISTS Key ( "\
+			"KeyID              INTEGER     PRIMARY KEY, "\
+			"Label              TEXT        NOT NULL UNIQUE "\
+		"); "\
+		"CREATE TABLE IF NOT EXISTS Session ( "\
+			"SessionID          INTEGER     PRIMARY KEY, "\
+			"PlayerID           INT         NOT NULL, "\
+			"StartedAt          INT         NOT NULL, "\
+			"DurationMillis     INT         NOT NULL, "\
+			"Level              INT         NOT NULL, "\
+			"Score              INT         NOT NULL, "\
+			"CorrectCount       INT         NOT NULL, "\
+			"MistakeCount       INT         NOT NULL, "\
+			"Cleared            INT         NOT NULL "\
+		"); "\
+		"CREATE INDEX IF NOT EXISTS SessionByPlayer ON Session (PlayerID); "\
+		"CREATE TABLE IF NOT EXISTS Keystroke ( "\
+			"SessionID          INT         NOT NULL, "\
+			"KeyID              INT         NOT NULL, "\
+			"ExpectedGlyph      INT         NOT NULL, "\
+			"Outcome            INT         NOT NULL, "\
+			"IntervalMillis     INT         NOT NULL "\
+		"); "\
+		"CREATE INDEX IF NOT EXISTS KeystrokeBySession ON Keystroke (SessionID); "\
+		"CREATE TABLE IF NOT EXISTS KeyStats ( "\
+			"PlayerID           INT         NOT NULL, "\
+			"KeyID              INT         NOT NULL, "\
+			"CorrectCount       INT         NOT NULL, "\
+			"MistakeCount       INT         NOT NULL, "\
+			"TimedCount         INT         NOT NULL, "\
+			"TotalIntervalMillis INT        NOT NULL, "\
+			"PRIMARY KEY (PlayerID, KeyID) "\
+		");";
+
+		// NORMAL is as safe as it gets with WAL, short of syncing on every commit: a crash can lose the last few
+		// transactions, but never leaves the database corrupt
+		const char *PragmasSql = "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;";
+
+		// the record's columns, in the order bindRecord() binds them
+		const char *SelectLastPlayerSql =
+		"SELECT rowid, PlayerName, CurrencyCollected, TopScore, TopLevel, TotalBlocksCleared, TotalCorrectCount, "\
+		"TotalMistakeCount, LongestStreak, DateLastPlayed FROM Player ORDER BY rowid DESC LIMIT 1";
+
+		const char *InsertPlayerSql =
+		"INSERT INTO Player (PlayerName, CurrencyCollected, TopScore, TopLevel, TotalBlocksCleared, "\
+		"TotalCorrectCount, TotalMistakeCount, LongestStreak, DateLastPlayed) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9)";
+
+		const char *UpdatePlayerSql =
+		"UPDATE Player SET PlayerName = ?1, CurrencyCollected = ?2, TopScore = ?3, TopLevel = ?4, "\
+		"TotalBlocksCleared = ?5, TotalCorrectCount = ?6, TotalMistakeCount = ?7, LongestStreak = ?8, "\
+		"DateLastPlayed = ?9 WHERE rowid = ?10";
+
+		const int RowIDParameter = 10; // of the update
+
+		const char *InsertSessionSql =
+		"INSERT INTO Session (PlayerID, StartedAt, DurationMillis, Level, Score, CorrectCount, MistakeCount, Cleared) "\
+		"VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8)";
+
+		// Keystrokes go in this many rows per INSERT, which is about as many as fit under the bound parameter limit
+		// (999 by default). What's left over goes in one at a time.
+		const int KeystrokesPerInsert = 128;
+		const int KeystrokeColumns = 5;
+
+		std::string insertKeystrokesSql(int rows)
+		{
+			std::string sql("INSERT INTO Keystroke (SessionID, KeyID, ExpectedGlyph, Outcome, IntervalMillis) VALUES ");
+			for (int row = 0; row < rows; row++) {
+				sql += row ? ", (?, ?, ?, ?, ?)" : "(?, ?, ?, ?, ?)";
+			}
+			return sql;
+		}
+
+		const char *InsertKeySql = "INSERT OR IGNORE INTO Key (Label) VALUES (?1)";
+		const char *SelectKeySql = "SELECT KeyID FROM Key WHERE Label = ?1";
+
+		// no upsert in this SQLite, so the row is made sure of first
+		const char *InsertKeyStatsSql = "INSERT OR IGNORE INTO KeyStats VALUES (?1, ?2, 0, 0, 0, 0)";
+		const char *AddToKeyStatsSql =
+		"UPDATE KeyStats SET CorrectCount = CorrectCount + ?3, MistakeCount = MistakeCount + ?4, "\
+		"TimedCount = TimedCount + ?5, TotalIntervalMillis = TotalIntervalMillis + ?6 WHERE PlayerID = ?1 AND KeyID = ?2";
+
+		const char *SelectKeyAccuracySql =
+		"SELECT Label, CorrectCount, MistakeCount, TimedCount, TotalIntervalMillis FROM KeyStats "\
+		"JOIN Key ON Key.KeyID = KeyStats.KeyID WHERE PlayerID = ?1 ORDER BY Label";
+
+		const char *SelectSpeedTrendSql =
+		"SELECT StartedAt, DurationMillis, CorrectCount, MistakeCount FROM Session WHERE PlayerID = ?1 "\
+		"ORDER BY SessionID DESC LIMIT ?2";
+
+
+		// a statement prepared once, and reset after each use
+		class Statement
+		{
+		public:
+			Statement() : stmt(nullptr) {}
+			~Statement() { finalize(); }
+
+			bool prepare(sqlite3 *db, const std::string &sql)
+			{
+				return SQLITE_OK == sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+			}
+
+			void finalize()
+			{
+				sqlite3_finalize(stmt);
+				stmt = nullptr;
+			}
+
+			inline sqlite3_stmt *get() const { return stmt; }
+
+			// steps it to completion, for statements that don't return rows
+			bool run()
+			{
+				const int result = sqlite3_step(stmt);
+				sqlite3_reset(stmt);
+				return SQLITE_DONE == result;
+			}
+
+		private:
+			Statement(const Statement &) = delete;
+			Statement &operator=(const Statement &) = delete;
+
+			sqlite3_stmt *stmt;
+		};
+
+
+		// parameters 1 through 9, everything but the id
+		void bindRecord(sqlite3_stmt *stmt, const PlayerRecord &record)
+		{
+			sqlite3_bind_text(stmt, 1, record.playerName.c_str(), (int) record.playerName.size(), SQLITE_STATIC);
+			sqlite3_bind_int64(stmt, 2, record.currencyCollected);
+			sqlite3_bind_int64(stmt, 3, record.topScore);
+			sqlite3_bind_int64(stmt, 4, record.topLevel);
+			sqlite3_bind_int64(stmt, 5, record.totalBlocksCleared);
+			sqlite3_bind_int64(stmt, 6, record.totalCorrectCount);
+			sqlite3_bind_int64(stmt, 7, record.totalMistakeCount);
+			sqlite3_bind_int64(stmt, 8, record.longestStreak);
+			if (record.datePlayed) {
+				sqlite3_bind_int64(stmt, 9, record.datePlayed);
+			} else {
+				sqlite3_bind_null(stmt, 9);
+			}
+		}
+
+
+		// a row's worth, starting at parameter `first`; `key` is the Key table's
+		void bindKeystroke(sqlite3_stmt *stmt, int first, int64_t sessionId, int64_t key, const KeystrokeRecord &keystroke)
+		{
+			sqlite3_bind_int64(stmt, first, sessionId);
+			sqlite3_bind_int64(stmt, first + 1, key);
+			sqlite3_bind_int(stmt, first + 2, keystroke.expectedGlyph);
+			sqlite3_bind_int(stmt, first + 3, (int) keystroke.outcome);
+			sqlite3_bind_int64(stmt, first + 4, keystroke.intervalMillis);
+		}
+
+
+		// a session's keystrokes added up per key, for KeyStats
+		struct KeyTotals
+		{
+			int64_t correctCount;
+			int64_t mistakeCount;
+			int64_t timedCount;
+			int64_t totalIntervalMillis;
+		};
+	}
+
+
+#pragma mark - pImpl
+
+	struct PlayerStoreImpl
+	{
+		PlayerStoreImpl() :
+		db(), savedCount(0), writtenCount(0), stopping(false), stats()
+		{
+		}
+
+		sqlite3 *db;
+		std::mutex dbMutex; // the connection is shared between the writer and the calls made at launch
+
+		Statement selectLastPlayer, insertPlayer, updatePlayer;
+		Statement begin, commit, rollback;
+		Statement insertSession, insertKeystrokes, insertKeystroke;
+		Statement insertKey, selectKey, insertKeyStats, addToKeyStats;
+		Statement selectKeyAccuracy, selectSpeedTrend;
+
+		// between save() and the writer
+		std::mutex queueMutex;
+		std::condition_variable queueChanged; // the writer waits on this
+		std::condition_variable batchWritten; // and flush() on this
+		std::vector<PlayerRecord> pending;
+		std::vector<SessionRecord> pendingSessions;
+		uint64_t savedCount;
+		uint64_t writtenCount; // of those saved, how many the writer is done with
+		bool stopping;
+		PlayerStore::Stats stats;
+
+		std::thread writer;
+
+		// the writer's own
+		std::unordered_map<std::string, int64_t> keysByLabel; // as numbered in the Key table
+		std::vector<int64_t> sessionKeys; // the same, indexed by KeyID for the session being written
+		std::vector<KeyTotals> sessionKeyTotals;
+
+		bool open(const std::string &path);
+		void close();
+
+		void writerLoop();
+		bool writeBatch(const std::vector<PlayerRecord> &, const std::vector<SessionRecord> &);
+		bool writeSession(const SessionRecord &);
+		void rollBack();
+		int64_t keyForLabel(const std::string &label);
+	};
+
+
+	bool PlayerStoreImpl::open(const std::string &path)
+	{
+		// this one creates the db if not yet exist
+		if (SQLITE_OK != sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE, nullptr)) {
+			LogE << "Unable to open db: " << sqlite3_errmsg(db);
+			close();
+			return false;
+		}
+
+		char *errMsg = nullptr;
+		for (const char *sql : { PragmasSql, CreateTableSql, CreateHistoryTablesSql }) {
+			if (SQLITE_OK != sqlite3_exec(db, sql, nullptr, nullptr, &errMsg)) {
+				LogE << "SQL error setting up the db: " << (errMsg ? errMsg : "");
+				sqlite3_free(errMsg);
+				close();
+				return false;
+			}
+		}
+
+		const bool prepared =
+			selectLastPlayer.prepare(db, SelectLastPlayerSql) &&
+			insertPlayer.prepare(db, InsertPlayerSql) &&
+			updatePlayer.prepare(db, UpdatePlayerSql) &&
+			begin.prepare(db, "BEGIN") &&
+			commit.prepare(db, "COMMIT") &&
+			rollback.prepare(db, "ROLLBACK") &&
+			insertSession.prepare(db, InsertSessionSql) &&
+			insertKeystrokes.prepare(db, insertKeystrokesSql(KeystrokesPerInsert)) &&
+			insertKeystroke.prepare(db, insertKeystrokesSql(1)) &&
+			insertKey.prepare(db, InsertKeySql) &&
+			selectKey.prepare(db, SelectKeySql) &&
+			insertKeyStats.prepare(db, InsertKeyStatsSql) &&
+			addToKeyStats.prepare(db, AddToKeyStatsSql) &&
+			selectKeyAccuracy.prepare(db, SelectKeyAccuracySql) &&
+			selectSpeedTrend.prepare(db, SelectSpeedTrendSql);
+		if (!prepared) {
+			LogE << "Problem preparing the Player statements: " << sqlite3_errmsg(db);
+			close();
+			return false;
+		}
+
+		LogI << "Initialized DB.. Player table is ready";
+		return true;
+	}
+
+
+	void PlayerStoreImpl::close()
+	{
+		for (Statement *statement : { &selectLastPlayer, &insertPlayer, &updatePlayer, &begin, &commit, &rollback,
+				&insertSession, &insertKeystrokes, &insertKeystroke, &insertKey, &selectKey, &insertKeyStats,
+				&addToKeyStats, &selectKeyAccuracy, &selectSpeedTrend }) {
+			statement->finalize();
+		}
+		if (db) {
+			sqlite3_close_v2(db);
+			db = nullptr;
+		}
+	}
+
+
+#pragma mark - Lifetime
+
+	PlayerStore::PlayerStore(const std::string &path) : pImpl(new PlayerStoreImpl)
+	{
+		if (pImpl->open(path)) {
+			pImpl->writer = std::thread(&PlayerStoreImpl::writerLoop, pImpl.get());
+		}
+	}
+
+
+	PlayerStore::~PlayerStore()
+	{
+		if (pImpl->writer.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(pImpl->queueMutex);
+				pImpl->stopping = true;
+			}
+			pImpl->queueChanged.notify_one();
+			pImpl->writer.join(); // after it has written what was left
+		}
+		pImpl->close();
+	}
+
+
+	bool PlayerStore::isOpen() const
+	{
+		return pImpl->db != nullptr;
+	}
+
+
+#pragma mark - At Launch
+
+	bool PlayerStore::loadLastPlayer(PlayerRecord &record)
+	{
+		if (!isOpen()) return false;
+
+		std::lock_guard<std::mutex> lock(pImpl->dbMutex);
+		sqlite3_stmt *stmt = pImpl->selectLastPlayer.get();
+		const bool found = SQLITE_ROW == sqlite3_step(stmt);
+		if (found) {
+			const unsigned char *name = sqlite3_column_text(stmt, 1);
+			record.playerId = sqlite3_column_int64(stmt, 0);
+			record.playerName = name ? (const char *) name : "";
+			record.currencyCollected = sqlite3_column_int64(stmt, 2);
+			record.topScore = sqlite3_column_int64(stmt, 3);
+			record.topLevel = sqlite3_column_int64(stmt, 4);
+			record.totalBlocksCleared = sqlite3_column_int64(stmt, 5);
+			record.totalCorrectCount = sqlite3_column_int64(stmt, 6);
+			record.totalMistakeCount = sqlite3_column_int64(stmt, 7);
+			record.longestStreak = sqlite3_column_int64(stmt, 8);
+			record.datePlayed = sqlite3_column_int64(stmt, 9); // 0 for NULL
+		}
+		sqlite3_reset(stmt);
+		return found;
+	}
+
+
+	int64_t PlayerStore::insertPlayer(const PlayerRecord &record)
+	{
+		if (!isOpen()) return 0;
+
+		std::lock_guard<std::mutex> lock(pImpl->dbMutex);
+		bindRecord(pImpl->insertPlayer.get(), record);
+		if (!pImpl->insertPlayer.run()) {
+			LogW << "Inserting player failed: " << sqlite3_errmsg(pImpl->db);
+			return 0;
+		}
+		LogD1 << "Successfully created new Player entry in the DB";
+		return sqlite3_last_insert_rowid(pImpl->db);
+	}
+
+
+#pragma mark - Write Behind
+
+	void PlayerStore::save(const PlayerRecord &record)
+	{
+		if (!isOpen()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(pImpl->queueMutex);
+			std::vector<PlayerRecord> &pending(pImpl->pending);
+			auto queued = std::find_if(pending.begin(), pending.end(), [&record](const PlayerRecord &other) {
+				return other.playerId == record.playerId;
+			});
+			if (queued != pending.end()) {
+				*queued = record; // still waiting, so only the latest one needs writing
+			} else {
+				pending.push_back(record);
+			}
+			pImpl->savedCount++;
+			pImpl->stats.saves++;
+		}
+		pImpl->queueChanged.notify_one();
+	}
+
+
+	void PlayerStore::saveSession(SessionRecord &&session)
+	{
+		if (!isOpen()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(pImpl->queueMutex);
+			pImpl->pendingSessions.push_back(std::move(session));
+			pImpl->savedCount++;
+		}
+		pImpl->queueChanged.notify_one();
+	}
+
+
+	void PlayerStore::flush()
+	{
+		if (!isOpen()) return;
+
+		std::unique_lock<std::mutex> lock(pImpl->queueMutex);
+		const uint64_t target = pImpl->savedCount;
+		pImpl->batchWritten.wait(lock, [this, target]() { return pImpl->writtenCount >= target; });
+	}
+
+
+	PlayerStore::Stats PlayerStore::stats() const
+	{
+		std::lock_guard<std::mutex> lock(pImpl->queueMutex);
+		return pImpl->stats;
+	}
+
+
+	// Takes everything queued so far and writes it in one transaction, until stopped with nothing left to write.
+	void PlayerStoreImpl::writerLoop()
+	{
+		std::vector<PlayerRecord> batch;
+		std::vector<SessionRecord> sessions;
+		std::unique_lock<std::mutex> lock(queueMutex);
+		while (true) {
+			queueChanged.wait(lock, [this]() { return stopping || !pending.empty() || !pendingSessions.empty(); });
+			if (pending.empty() && pendingSessions.empty()) {
+				break; // stopping
+			}
+
+			batch.swap(pending); // both keep their capacity, so this settles into not allocating
+			sessions.swap(pendingSessions);
+			const uint64_t upTo = savedCount;
+			lock.unlock();
+
+			const bool committed = writeBatch(batch, sessions);
+
+			lock.lock();
+			if (committed) {
+				stats.rowsWritten += batch.size();
+				stats.sessionsWritten += sessions.size();
+				for (const SessionRecord &session : sessions) {
+					stats.keystrokesWritten += session.keystrokes.size();
+				}
+				stats.transactions++;
+			}
+			batch.clear();
+			sessions.clear();
+			writtenCount = upTo; // failed or not, flush() shouldn't wait on it forever
+			batchWritten.notify_all();
+		}
+	}
+
+
+	bool PlayerStoreImpl::writeBatch(const std::vector<PlayerRecord> &batch, const std::vector<SessionRecord> &sessions)
+	{
+		std::lock_guard<std::mutex> lock(dbMutex);
+		if (!begin.run()) {
+			LogW << "Couldn't begin saving the player: " << sqlite3_errmsg(db);
+			return false;
+		}
+
+		for (const PlayerRecord &record : batch) {
+			sqlite3_stmt *stmt = updatePlayer.get();
+			bindRecord(stmt, record);
+			sqlite3_bind_int64(stmt, RowIDParameter, record.playerId);
+			if (!updatePlayer.run()) {
+				LogW << "Updating player failed: " << sqlite3_errmsg(db);
+				rollBack();
+				return false;
+			}
+		}
+
+		for (const SessionRecord &session : sessions) {
+			if (!writeSession(session)) {
+				LogW << "Saving a session failed: " << sqlite3_errmsg(db);
+				rollBack();
+				return false;
+			}
+		}
+
+		if (!commit.run()) {
+			LogW << "Committing the player failed: " << sqlite3_errmsg(db);
+			rollBack();
+			return false;
+		}
+		LogD1 << "Successfully updated " << batch.size() << " Player entries and saved " << sessions.size()
+			  << " sessions in the DB";
+		return true;
+	}
+
+
+	void PlayerStoreImpl::rollBack()
+	{
+		rollback.run();
+		keysByLabel.clear(); // some may have been added in the transaction
+	}
+
+
+	// inside writeBatch()'s transaction
+	bool PlayerStoreImpl::writeSession(const SessionRecord &session)
+	{
+		sqlite3_stmt *stmt = insertSession.get();
+		sqlite3_bind_int64(stmt, 1, session.playerId);
+		sqlite3_bind_int64(stmt, 2, session.startedAt);
+		sqlite3_bind_int64(stmt, 3, session.durationMillis);
+		sqlite3_bind_int64(stmt, 4, session.level);
+		sqlite3_bind_int64(stmt, 5, session.score);
+		sqlite3_bind_int64(stmt, 6, session.correctCount);
+		sqlite3_bind_int64(stmt, 7, session.mistakeCount);
+		sqlite3_bind_int(stmt, 8, session.cleared ? 1 : 0);
+		if (!insertSession.run()) return false;
+		const int64_t sessionId = sqlite3_last_insert_rowid(db);
+
+		// the keys the session used, as numbered in the Key table, and what they add to KeyStats
+		sessionKeys.assign(session.keyLabels.size(), 0);
+		sessionKeyTotals.assign(session.keyLabels.size(), KeyTotals());
+		for (const KeystrokeRecord &keystroke : session.keystrokes) {
+			if (keystroke.key >= session.keyLabels.size()) continue;
+			if (!sessionKeys[keystroke.key]) {
+				sessionKeys[keystroke.key] = keyForLabel(session.keyLabels[keystroke.key]);
+				if (!sessionKeys[keystroke.key]) return false;
+			}
+			KeyTotals &totals(sessionKeyTotals[keystroke.key]);
+			if (keystroke.outcome == KeystrokeOutcome::Correct) {
+				totals.correctCount++;
+			} else if (keystroke.outcome == KeystrokeOutcome::Mistake) {
+				totals.mistakeCount++;
+			} else {
+				continue;
+			}
+			if (keystroke.intervalMillis) {
+				totals.timedCount++;
+				totals.totalIntervalMillis += keystroke.intervalMillis;
+			}
+		}
+
+		// keystrokes with a key out of range (there shouldn't be any) go in as key 0
+		const std::vector<KeystrokeRecord> &keystrokes(session.keystrokes);
+		auto keyFor = [this](const KeystrokeRecord &keystroke) {
+			return keystroke.key < sessionKeys.size() ? sessionKeys[keystroke.key] : 0;
+		};
+
+		size_t next = 0;
+		for (; next + KeystrokesPerInsert <= keystrokes.size(); next += KeystrokesPerInsert) {
+			sqlite3_stmt *stmt = insertKeystrokes.get();
+			for (int row = 0; row < KeystrokesPerInsert; row++) {
+				const KeystrokeRecord &keystroke(keystrokes[next + row]);
+				bindKeystroke(stmt, row * KeystrokeColumns + 1, sessionId, keyFor(keystroke), keystroke);
+			}
+			if (!insertKeystrokes.run()) return false;
+		}
+		for (; next < keystrokes.size(); next++) {
+			bindKeystroke(insertKeystroke.get(), 1, sessionId, keyFor(keystrokes[next]), keystrokes[next]);
+			if (!insertKeystroke.run()) return false;
+		}
+
+		for (size_t key = 0; key < sessionKeyTotals.size(); key++) {
+			const KeyTotals &totals(sessionKeyTotals[key]);
+			if (!totals.correctCount && !totals.mistakeCount) continue;
+
+			sqlite3_bind_int64(insertKeyStats.get(), 1, session.playerId);
+			sqlite3_bind_int64(insertKeyStats.get(), 2, sessionKeys[key]);
+			if (!insertKeyStats.run()) return false;
+
+			sqlite3_stmt *stmt = addToKeyStats.get();
+			sqlite3_bind_int64(stmt, 1, session.playerId);
+			sqlite3_bind_int64(stmt, 2, sessionKeys[key]);
+			sqlite3_bind_int64(stmt, 3, totals.correctCount);
+			sqlite3_bind_int64(stmt, 4, totals.mistakeCount);
+			sqlite3_bind_int64(stmt, 5, totals.timedCount);
+			sqlite3_bind_int64(stmt, 6, totals.totalIntervalMillis);
+			if (!addToKeyStats.run()) return false;
+		}
+		return true;
+	}
+
+
+	// the label's KeyID in the Key table, adding it if it's new (0 on failure)
+	int64_t PlayerStoreImpl::keyForLabel(const std::string &label)
+	{
+		auto found = keysByLabel.find(label);
+		if (found != keysByLabel.end()) {
+			return found->second;
+		}
+
+		sqlite3_bind_text(insertKey.get(), 1, label.c_str(), (int) label.size(), SQLITE_STATIC);
+		if (!insertKey.run()) return 0;
+
+		sqlite3_stmt *stmt = selectKey.get();
+		sqlite3_bind_text(stmt, 1, label.c_str(), (int) label.size(), SQLITE_STATIC);
+		const int64_t key = SQLITE_ROW == sqlite3_step(stmt) ? sqlite3_column_int64(stmt, 0) : 0;
+		sqlite3_reset(stmt);
+
+		if (key) {
+			keysByLabel[label] = key; // forgotten again if the transaction doesn't commit (see rollBack())
+		}
+		return key;
+	}
+
+
+#pragma mark - History
+
+	std::vector<KeyAccuracy> PlayerStore::keyAccuracy(int64_t playerId)
+	{
+		std::vector<KeyAccuracy> keys;
+		if (!isOpen()) return keys;
+
+		std::lock_guard<std::mutex> lock(pImpl->dbMutex);
+		sqlite3_stmt *stmt = pImpl->selectKeyAccuracy.get();
+		sqlite3_bind_int64(stmt, 1, playerId);
+		while (SQLITE_ROW == sqlite3_step(stmt)) {
+			const unsigned char *label = sqlite3_column_text(stmt, 0);
+			const int64_t timedCount = sqlite3_column_int64(stmt, 3);
+			KeyAccuracy key = {};
+			key.label = label ? (const char *) label : "";
+			key.correctCount = sqlite3_column_int64(stmt, 1);
+			key.mistakeCount = sqlite3_column_int64(stmt, 2);
+			key.meanIntervalMillis = timedCount ? (double) sqlite3_column_int64(stmt, 4) / timedCount : 0;
+			keys.push_back(key);
+		}
+		sqlite3_reset(stmt);
+		return keys;
+	}
+
+
+	std::vector<SessionSpeed> PlayerStore::speedTrend(int64_t playerId, size_t sessions)
+	{
+		std::vector<SessionSpeed> trend;
+		if (!isOpen()) return trend;
+
+		std::lock_guard<std::mutex> lock(pImpl->dbMutex);
+		sqlite3_stmt *stmt = pImpl->selectSpeedTrend.get();
+		sqlite3_bind_int64(stmt, 1, playerId);
+		sqlite3_bind_int64(stmt, 2, (int64_t) sessions);
+		while (SQLITE_ROW == sqlite3_step(stmt)) {
+			const double minutes = sqlite3_column_int64(stmt, 1) / 60000.0;
+			const int64_t correctCount = sqlite3_column_int64(stmt, 2);
+			const int64_t attempts = correctCount + sqlite3_column_int64(stmt, 3);
+			SessionSpeed speed = {};
+			speed.startedAt = sqlite3_column_int64(stmt, 0);
+			speed.wordsPerMinute = minutes > 0 ? correctCount / 5.0 / minutes : 0;
+			speed.accuracy = attempts ? (double) correctCount / attempts : 0;
+			trend.push_back(speed);
+		}
+		sqlite3_reset(stmt);
+		std::reverse(trend.begin(), trend.end()); // came newest first
+		return trend;
+	}
+}
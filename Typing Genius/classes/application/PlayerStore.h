@@ -0,0 +1,96 @@
+//
+//  PlayerStore.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/22/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	The Player table in the SQLite database. Loading and creating a player happen at launch, on the calling thread;
+//	saving stats after that is write-behind: save() only queues a copy of the record, and a writer thread of its own
+//	commits whatever has queued up in one transaction, so the game thread never waits on the disk. Saves of the same
+//	player that queue up before the writer gets to them are folded into the last one.
+//
+//	Finished sessions are saved the same way, each with all of its keystrokes, and also go towards running per-key
+//	totals, so the questions asked of the history (how accurate is each key, is the player getting faster) don't have
+//	to go through every keystroke ever recorded.
+//
+//	The database is kept in WAL mode, and the statements are prepared once and reused.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SessionHistory.h"
+
+namespace ac {
+
+	struct PlayerStoreImpl;
+
+	// a row of the Player table
+	struct PlayerRecord
+	{
+		int64_t playerId; // the rowid
+		std::string playerName;
+		int64_t currencyCollected;
+		int64_t topScore;
+		int64_t topLevel;
+		int64_t totalBlocksCleared;
+		int64_t totalCorrectCount;
+		int64_t totalMistakeCount;
+		int64_t longestStreak;
+		int64_t datePlayed; // seconds since the epoch, 0 if never
+	};
+
+
+	class PlayerStore
+	{
+	public:
+		// opens the database at `path`, creating it and the table if needed (check isOpen())
+		explicit PlayerStore(const std::string &path);
+
+		// commits whatever is still queued
+		~PlayerStore();
+
+		bool isOpen() const;
+
+		// the most recently created player; false if there are none
+		bool loadLastPlayer(PlayerRecord &);
+
+		// returns the new player's id (0 on failure)
+		int64_t insertPlayer(const PlayerRecord &);
+
+		// queues the record to be written, and returns right away
+		void save(const PlayerRecord &);
+
+		// queues a finished session, to be written along with its keystrokes in a single transaction
+		void saveSession(SessionRecord &&);
+
+		// blocks until everything saved before the call is committed (or has failed to be)
+		void flush();
+
+		// the player's totals for every key typed so far, by label
+		std::vector<KeyAccuracy> keyAccuracy(int64_t playerId);
+
+		// the player's last `sessions` sessions, oldest first
+		std::vector<SessionSpeed> speedTrend(int64_t playerId, size_t sessions);
+
+		struct Stats
+		{
+			uint64_t saves;
+			uint64_t rowsWritten; // fewer than saves, when some were folded together
+			uint64_t sessionsWritten;
+			uint64_t keystrokesWritten;
+			uint64_t transactions;
+		};
+
+		Stats stats() const;
+
+	private:
+		PlayerStore(const PlayerStore &) = delete;
+		PlayerStore &operator=(const PlayerStore &) = delete;
+
+		std::unique_ptr<PlayerStoreImpl> pImpl;
+	};
+}
@@ -9,6 +9,7 @@
 #include "ScoreKeeper.h"
 #include "CopyText.h"
 #include "GameState.h"
+#include "KeystrokeTrace.h"
 #include "PlayerLevel.h"
 #include "Player.h"
 
@@ -38,8 +39,11 @@ namespace ac {
 
 #pragma mark - RecordXXX functions
 	
-	void ScoreKeeper::recordBlockClear(size_t units = 1)
+	void ScoreKeeper::recordBlockClear(size_t units = 1, int glyphCode, uint32_t latencyMillis)
 	{
+		AC_TRACE_SPAN(ScoreKeeper);
+		this->glyphDifficulty.recordCorrect(glyphCode, latencyMillis);
+
 		int addedPoints = bonusForSuccessfulBlockClear(units) +
 			bonusForActiveStreak(this->curStreak);
 
@@ -58,17 +62,20 @@ namespace ac {
 		
 		this->addToLevelProgress(levelProgressPerBlock); //  for now
 
-		std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-		pInfo->scoreDelta = addedPoints;
-		pInfo->curStreakLevel = this->curStreak;
-		Notif::send("ScoreKeeper_Score", pInfo);
+		ScoreKeeperUpdateInfo info = {};
+		info.scoreDelta = addedPoints;
+		info.curStreakLevel = this->curStreak;
+		// right away: the block canvas floats the score over the block just cleared, before the chain moves on
+		Notif::send(notif::ScoreKeeper_Score, info);
 	}
 	
 	
-	void ScoreKeeper::recordMistakenAttempt(size_t units = 1)
+	void ScoreKeeper::recordMistakenAttempt(size_t units = 1, int glyphCode)
 	{
+		AC_TRACE_SPAN(ScoreKeeper);
+		this->glyphDifficulty.recordMistake(glyphCode);
 		this->mistakeCount += units;
-		Notif::send("ScoreKeeper_Mistake");
+		Notif::send(notif::ScoreKeeper_Mistake);
 	}
 	
 	
@@ -77,9 +84,9 @@ namespace ac {
 		int bonus = bonusForTimeRemaining(seconds);
 		this->sessionScore.bonusForTimeRemaining += bonus;
 
-		std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-		pInfo->scoreDelta = bonus;
-		Notif::send("ScoreKeeper_PostGameTimeRemainingBonus", pInfo);
+		ScoreKeeperUpdateInfo info = {};
+		info.scoreDelta = bonus;
+		Notif::send(notif::ScoreKeeper_PostGameTimeRemainingBonus, info);
 	}
 
 
@@ -88,18 +95,18 @@ namespace ac {
 		int bonus = bonusForAccuracy(getAccuracy(), this->correctCount);
 		this->sessionScore.bonusForAccuracy += bonus;
 
-		std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-		pInfo->scoreDelta = bonus;
-		Notif::send("ScoreKeeper_PostGameAccuracyBonus", pInfo);
+		ScoreKeeperUpdateInfo info = {};
+		info.scoreDelta = bonus;
+		Notif::send(notif::ScoreKeeper_PostGameAccuracyBonus, info);
 	}
 	
 	
 	void ScoreKeeper::resetCurrentStreak()
 	{
 		// last chance to inform followers. If leveling up, curStreak will reset to zero without notifying
-		std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-		pInfo->curStreakLevel = this->curStreak;
-		Notif::send("ScoreKeeper_StreakFinished", pInfo);
+		ScoreKeeperUpdateInfo info = {};
+		info.curStreakLevel = this->curStreak;
+		Notif::send(notif::ScoreKeeper_StreakFinished, info); // ahead of the Mistake that ended it
 
 		this->curStreak = 0;
 	}
@@ -118,18 +125,18 @@ namespace ac {
 			this->curStreak = 0;
 			GameState::getInstance().copyText().reComposeCopyText(GameState::getInstance().player().getLevel());
 
-			std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-			pInfo->levelProgressDelta = progress;
-			Notif::send("ScoreKeeper_NewLevelUpdate", pInfo);
+			ScoreKeeperUpdateInfo info = {};
+			info.levelProgressDelta = progress;
+			Notif::send(notif::ScoreKeeper_NewLevelUpdate, info);
 
 			GameState::getInstance().player().syncStatsToDB(*this);
 			LogI << "Level progress at 100%";
 		}
 
 		// LevelProgressUpdate
-		std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-		pInfo->levelProgressDelta = progress;
-		Notif::send("ScoreKeeper_LevelProgressUpdate", pInfo);
+		ScoreKeeperUpdateInfo info = {};
+		info.levelProgressDelta = progress;
+		Notif::post(notif::ScoreKeeper_LevelProgressUpdate, info);
 	}
 
 
@@ -141,9 +148,9 @@ namespace ac {
 			LogI << "Level progress at 100%";
 		}
 
-		std::shared_ptr<ScoreKeeperUpdateInfo> pInfo(new ScoreKeeperUpdateInfo);
-		pInfo->levelProgressDelta = progress;
-		Notif::send("ScoreKeeper_LevelProgressUpdate", pInfo);
+		ScoreKeeperUpdateInfo info = {};
+		info.levelProgressDelta = progress;
+		Notif::post(notif::ScoreKeeper_LevelProgressUpdate, info);
 	}
 
 
@@ -11,6 +11,8 @@
 
 #pragma once
 #include <cmath>
+#include <cstdint>
+#include "GlyphDifficulty.h"
 
 namespace ac {
 
@@ -67,8 +69,15 @@ namespace ac {
 		}
 
 		// Important: internal streak counter should be updated in a separate call
-		void recordBlockClear(size_t units);
-		void recordMistakenAttempt(size_t units);
+		// The glyph code (of the block at the cursor) and the time since the previous keystroke, when given, go to
+		// the glyph difficulty.
+		void recordBlockClear(size_t units, int glyphCode = -1, uint32_t latencyMillis = 0);
+		void recordMistakenAttempt(size_t units, int glyphCode = -1);
+
+		// which glyphs the player has been having trouble with; unlike everything else here, reset() keeps it, as
+		// that carries on from one level to the next
+		inline GlyphDifficulty &getGlyphDifficulty() { return this->glyphDifficulty; }
+		inline const GlyphDifficulty &getGlyphDifficulty() const { return this->glyphDifficulty; }
 		
 		// score
 		inline size_t getTotalScore() const {
@@ -128,5 +137,7 @@ namespace ac {
 
 		float levelProgress; // 0 - 1
 		SessionScore sessionScore;
+
+		GlyphDifficulty glyphDifficulty;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+//
+//  SessionHistory.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/23/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "SessionHistory.h"
+#include <ctime>
+#include "GameClock.h"
+#include "KeyRegistry.h"
+
+namespace ac {
+
+	// enough for most sessions, so recording a keystroke doesn't allocate
+	const size_t ExpectedKeystrokesPerSession = 512;
+
+
+	SessionRecorder::SessionRecorder()
+	: recording(false), startTime(0), lastKeystrokeTime(0), current()
+	{
+	}
+
+
+	void SessionRecorder::begin(size_t level)
+	{
+		current = SessionRecord();
+		current.startedAt = (int64_t) std::time(nullptr);
+		current.level = (uint32_t) level;
+		current.keystrokes.reserve(ExpectedKeystrokesPerSession);
+
+		startTime = FrameClock::getInstance().now();
+		lastKeystrokeTime = 0;
+		recording = true;
+	}
+
+
+	void SessionRecorder::discard()
+	{
+		recording = false;
+		current.keystrokes.clear();
+	}
+
+
+	void SessionRecorder::recordKeystroke(KeyID key, int32_t expectedGlyph, KeystrokeOutcome outcome,
+										  uint64_t timestamp)
+	{
+		if (!recording) return;
+
+		const uint64_t interval = lastKeystrokeTime && timestamp > lastKeystrokeTime ? timestamp - lastKeystrokeTime : 0;
+		lastKeystrokeTime = timestamp;
+
+		const KeystrokeRecord keystroke = { key, expectedGlyph, outcome, (uint32_t) (interval / 1000) };
+		current.keystrokes.push_back(keystroke);
+
+		if (outcome == KeystrokeOutcome::Correct) {
+			current.correctCount++;
+		} else if (outcome == KeystrokeOutcome::Mistake) {
+			current.mistakeCount++;
+		}
+	}
+
+
+	bool SessionRecorder::end(bool cleared, int64_t score, SessionRecord &session)
+	{
+		if (!recording) return false;
+		recording = false;
+
+		current.durationMillis = (uint32_t) (FrameClock::getInstance().now() - startTime);
+		current.score = score;
+		current.cleared = cleared;
+
+		// the labels go along, as the registry's numbering is only good until the app quits
+		const KeyRegistry &registry(KeyRegistry::getInstance());
+		current.keyLabels.resize(registry.size());
+		for (size_t key = 0; key < registry.size(); key++) {
+			current.keyLabels[key] = registry.label((KeyID) key);
+		}
+
+		session = std::move(current);
+		current = SessionRecord();
+		return true;
+	}
+}
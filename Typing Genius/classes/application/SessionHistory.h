@@ -0,0 +1,104 @@
+//
+//  SessionHistory.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/23/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	What gets kept of each session (one level's countdown, from its start until it's cleared, runs out or moves on to
+//	the next level) for looking back on: every keystroke checked against the copy text, and a summary. The
+//	SessionRecorder collects them in memory while the session runs, and hands the lot to the PlayerStore at the end,
+//	which writes it in one go.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ACTypes.h"
+
+namespace ac {
+
+	enum class KeystrokeOutcome : uint8_t
+	{
+		Correct,
+		Mistake,
+		Blocked, // the block was encased
+		Space, // neither right nor wrong
+	};
+
+
+	struct KeystrokeRecord
+	{
+		KeyID key;
+		int32_t expectedGlyph; // the code of the glyph the copy text had at the cursor
+		KeystrokeOutcome outcome;
+		uint32_t intervalMillis; // since the session's previous keystroke (0 for its first)
+	};
+
+
+	struct SessionRecord
+	{
+		int64_t playerId;
+		int64_t startedAt; // seconds since the epoch
+		uint32_t durationMillis;
+		uint32_t level;
+		int64_t score;
+		uint32_t correctCount;
+		uint32_t mistakeCount;
+		bool cleared; // the copy text was finished
+
+		std::vector<KeystrokeRecord> keystrokes;
+		std::vector<std::string> keyLabels; // indexed by the keystrokes' key
+	};
+
+
+	// from the store's per-key totals
+	struct KeyAccuracy
+	{
+		std::string label;
+		uint64_t correctCount;
+		uint64_t mistakeCount;
+		double meanIntervalMillis;
+
+		inline double accuracy() const
+		{
+			const uint64_t total = correctCount + mistakeCount;
+			return total ? (double) correctCount / total : 0;
+		}
+	};
+
+
+	// a session, for the typing speed trend
+	struct SessionSpeed
+	{
+		int64_t startedAt;
+		double wordsPerMinute; // five correct glyphs to a word
+		double accuracy;
+	};
+
+
+	class SessionRecorder
+	{
+	public:
+		SessionRecorder();
+
+		// starts a new session, dropping any that wasn't ended
+		void begin(size_t level);
+		void discard();
+
+		inline bool isRecording() const { return recording; }
+
+		// ignored unless recording; the timestamp is in microseconds on the steady clock, as stamped on KeyEvents
+		void recordKeystroke(KeyID key, int32_t expectedGlyph, KeystrokeOutcome outcome, uint64_t timestamp);
+
+		// Finishes the session, moving it into `session` (with no player set). False if there was none recording.
+		bool end(bool cleared, int64_t score, SessionRecord &session);
+
+	private:
+		bool recording;
+		uint64_t startTime; // on the game clock
+		uint64_t lastKeystrokeTime;
+		SessionRecord current;
+	};
+}
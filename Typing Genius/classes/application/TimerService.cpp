@@ -0,0 +1,308 @@
+//
+//  TimerService.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/19/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "TimerService.h"
+#include <algorithm>
+
+namespace ac {
+
+	const uint32_t TimerService::Slots;
+	const int32_t TimerService::None;
+
+	static inline uint64_t levelSpan(int level) { return 1ULL << (6 * level); } // ticks per slot
+
+	// the position of the first set bit at or after `from`, wrapping around (64 if there are none)
+	static inline unsigned nextSetBit(uint64_t bits, unsigned from)
+	{
+		if (!bits) return 64;
+		const uint64_t rotated = from ? (bits >> from) | (bits << (64 - from)) : bits;
+		return (unsigned) __builtin_ctzll(rotated);
+	}
+
+
+	TimerService &TimerService::getInstance()
+	{
+		static TimerService instance(FrameClock::getInstance());
+		return instance;
+	}
+
+
+	TimerService::TimerService(const GameClock &clock)
+	: clock(clock), lastUpdate(clock.now()), timers(), freeList(None), activeCount(0), due()
+	{
+		nextTick = lastUpdate + 1;
+		for (int level = 0; level < Levels; level++) {
+			std::fill(slotHeads[level], slotHeads[level] + Slots, None);
+			occupied[level] = 0;
+		}
+	}
+
+
+#pragma mark - Running
+
+	void TimerService::update()
+	{
+		advanceTo(clock.now());
+	}
+
+
+	void TimerService::advanceTo(uint64_t now)
+	{
+		now = std::max(now, lastUpdate);
+
+		for (uint64_t tick = nextTickWorthVisiting(now); tick <= now; tick = nextTickWorthVisiting(now)) {
+			nextTick = tick;
+
+			// bring down whatever is due within the coming slot of each level, coarsest first
+			for (int level = Levels - 1; level > 0; level--) {
+				if ((tick & (levelSpan(level) - 1)) == 0) {
+					cascade(level, (tick >> (SlotBits * level)) & (Slots - 1));
+				}
+			}
+			fireTick(tick);
+		}
+
+		lastUpdate = now;
+		nextTick = now + 1;
+	}
+
+
+	// the next tick (up to limit + 1) at which some slot has timers to fire or to move down a level
+	uint64_t TimerService::nextTickWorthVisiting(uint64_t limit) const
+	{
+		uint64_t next = limit + 1;
+
+		const unsigned offset = nextSetBit(occupied[0], nextTick & (Slots - 1));
+		if (offset < Slots) {
+			next = std::min(next, nextTick + offset);
+		}
+
+		for (int level = 1; level < Levels; level++) {
+			const uint64_t firstSlot = (nextTick + levelSpan(level) - 1) >> (SlotBits * level); // starting at or after
+			const unsigned slotOffset = nextSetBit(occupied[level], firstSlot & (Slots - 1));
+			if (slotOffset < Slots) {
+				next = std::min(next, (firstSlot + slotOffset) << (SlotBits * level));
+			}
+		}
+		return next;
+	}
+
+
+	void TimerService::cascade(int level, uint32_t slot)
+	{
+		int32_t index = slotHeads[level][slot];
+		slotHeads[level][slot] = None;
+		occupied[level] &= ~(1ULL << slot);
+
+		while (index != None) {
+			const int32_t next = timers[index].next;
+			link(index);
+			index = next;
+		}
+	}
+
+
+	void TimerService::fireTick(uint64_t tick)
+	{
+		const uint32_t slot = tick & (Slots - 1);
+
+		due.clear();
+		for (int32_t index = slotHeads[0][slot]; index != None; index = timers[index].next) {
+			timers[index].state = TimerState::Firing;
+			due.push_back(index);
+		}
+		slotHeads[0][slot] = None;
+		occupied[0] &= ~(1ULL << slot);
+
+		// as far as the callbacks can tell, it's now the time they were due
+		lastUpdate = tick;
+		nextTick = tick + 1;
+
+		for (size_t i = 0; i < due.size(); i++) {
+			const int32_t index = due[i];
+			if (timers[index].state != TimerState::Firing) {
+				continue; // cancelled by an earlier callback
+			}
+			Callback callback;
+			callback.swap(timers[index].callback);
+			release(index);
+			callback();
+		}
+	}
+
+
+#pragma mark - Scheduling
+
+	TimerHandle TimerService::schedule(uint64_t milliseconds, const Callback &callback)
+	{
+		int32_t index = freeList;
+		if (index != None) {
+			freeList = timers[index].next;
+		} else {
+			index = (int32_t) timers.size();
+			timers.push_back(Timer());
+			timers.back().generation = 1;
+		}
+
+		Timer &timer(timers[index]);
+		timer.deadline = std::max(lastUpdate + milliseconds, nextTick);
+		timer.callback = callback;
+		timer.state = TimerState::Scheduled;
+		link(index);
+		activeCount++;
+
+		const TimerHandle handle = { (uint32_t) index, timer.generation };
+		return handle;
+	}
+
+
+	bool TimerService::cancel(const TimerHandle &handle)
+	{
+		Timer *timer = timerFor(handle);
+		if (!timer) return false;
+
+		const int32_t index = (int32_t) handle.index;
+		if (timer->state == TimerState::Scheduled) {
+			unlink(index);
+		}
+		release(index);
+		return true;
+	}
+
+
+	bool TimerService::isActive(const TimerHandle &handle) const
+	{
+		return timerFor(handle) != nullptr;
+	}
+
+
+	bool TimerService::pause(const TimerHandle &handle)
+	{
+		Timer *timer = timerFor(handle);
+		if (!timer || timer->state != TimerState::Scheduled) return false;
+
+		unlink((int32_t) handle.index);
+		timer->deadline = timer->deadline > lastUpdate ? timer->deadline - lastUpdate : 0;
+		timer->state = TimerState::Paused;
+		return true;
+	}
+
+
+	bool TimerService::resume(const TimerHandle &handle)
+	{
+		Timer *timer = timerFor(handle);
+		if (!timer || timer->state != TimerState::Paused) return false;
+
+		timer->deadline = std::max(lastUpdate + timer->deadline, nextTick);
+		timer->state = TimerState::Scheduled;
+		link((int32_t) handle.index);
+		return true;
+	}
+
+
+	bool TimerService::isPaused(const TimerHandle &handle) const
+	{
+		const Timer *timer = timerFor(handle);
+		return timer && timer->state == TimerState::Paused;
+	}
+
+
+	uint64_t TimerService::remaining(const TimerHandle &handle) const
+	{
+		const Timer *timer = timerFor(handle);
+		if (!timer) return 0;
+		if (timer->state == TimerState::Paused) return timer->deadline;
+		return timer->deadline > lastUpdate ? timer->deadline - lastUpdate : 0;
+	}
+
+
+	bool TimerService::setRemaining(const TimerHandle &handle, uint64_t milliseconds)
+	{
+		Timer *timer = timerFor(handle);
+		if (!timer) return false;
+
+		switch (timer->state) {
+			case TimerState::Paused:
+				timer->deadline = milliseconds;
+				return true;
+			case TimerState::Scheduled:
+				unlink((int32_t) handle.index);
+				timer->deadline = std::max(lastUpdate + milliseconds, nextTick);
+				link((int32_t) handle.index);
+				return true;
+			default: // already firing
+				return false;
+		}
+	}
+
+
+#pragma mark - Timer Wheel
+
+	TimerService::Timer *TimerService::timerFor(const TimerHandle &handle)
+	{
+		if (handle.index >= timers.size()) return nullptr;
+		Timer &timer(timers[handle.index]);
+		return timer.generation == handle.generation && timer.state != TimerState::Free ? &timer : nullptr;
+	}
+
+
+	const TimerService::Timer *TimerService::timerFor(const TimerHandle &handle) const
+	{
+		return const_cast<TimerService *>(this)->timerFor(handle);
+	}
+
+
+	// into the slot of the finest level whose span still reaches the deadline from the next tick
+	void TimerService::link(int32_t index)
+	{
+		Timer &timer(timers[index]);
+		const uint64_t delta = timer.deadline - nextTick;
+
+		int level = 0;
+		while (level < Levels - 1 && delta >= levelSpan(level + 1)) {
+			level++;
+		}
+		// anything further off than the wheel reaches waits in the last slot it can, and is placed again from there
+		const uint64_t reach = nextTick + levelSpan(Levels) - 1;
+		const uint64_t placedAt = std::min(timer.deadline, reach);
+
+		timer.level = (uint8_t) level;
+		timer.slot = (uint8_t) ((placedAt >> (SlotBits * level)) & (Slots - 1));
+
+		int32_t &head(slotHeads[level][timer.slot]);
+		timer.prev = None;
+		timer.next = head;
+		if (head != None) timers[head].prev = index;
+		head = index;
+		occupied[level] |= 1ULL << timer.slot;
+	}
+
+
+	void TimerService::unlink(int32_t index)
+	{
+		Timer &timer(timers[index]);
+		int32_t &head(slotHeads[timer.level][timer.slot]);
+
+		if (timer.prev != None) timers[timer.prev].next = timer.next;
+		if (timer.next != None) timers[timer.next].prev = timer.prev;
+		if (head == index) head = timer.next;
+		if (head == None) occupied[timer.level] &= ~(1ULL << timer.slot);
+	}
+
+
+	void TimerService::release(int32_t index)
+	{
+		Timer &timer(timers[index]);
+		timer.state = TimerState::Free;
+		timer.callback = Callback();
+		if (++timer.generation == 0) timer.generation = 1;
+		timer.next = freeList;
+		freeList = index;
+		activeCount--;
+	}
+}
@@ -0,0 +1,121 @@
+//
+//  TimerService.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/19/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Runs any number of one-shot timers off the main loop: update() is called once per frame, reads the clock, and calls
+//	back the timers that have come due, on the calling thread. Nothing here is thread safe, and nothing needs to be as
+//	long as it's only used from the main thread.
+//
+//	The timers are kept in a hierarchical timer wheel with a millisecond tick: four levels of 64 slots, each level's
+//	slots 64 times as long as the one below, so scheduling, cancelling and moving a timer are constant time, and an
+//	update only looks at the slots that have timers in them. A timer sitting in a coarse slot is moved down a level
+//	whenever its slot comes up, until it lands in the one for its tick.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <boost/function.hpp>
+#include "GameClock.h"
+
+namespace ac {
+
+	// identifies a scheduled timer; goes stale (and is then ignored) once the timer fires or is cancelled
+	struct TimerHandle
+	{
+		uint32_t index;
+		uint32_t generation; // 0 is never handed out, so a zeroed handle is never valid
+	};
+
+
+	class TimerService
+	{
+	public:
+		typedef boost::function<void()> Callback;
+
+		// the one the game's timers run on, driven by the app each frame off the FrameClock
+		static TimerService &getInstance();
+
+		// the clock must outlive the service
+		explicit TimerService(const GameClock &clock);
+
+		// reads the clock and fires whatever has come due
+		void update();
+
+		// Fires, in order of their deadlines, every timer due at or before `now` (which must not go backwards).
+		// Callbacks may schedule, move and cancel timers, including each other.
+		void advanceTo(uint64_t now);
+
+		// the clock time as of the last update
+		inline uint64_t now() const { return lastUpdate; }
+
+		// the callback runs on the first update at least `milliseconds` from now
+		TimerHandle schedule(uint64_t milliseconds, const Callback &callback);
+
+		// false for a stale handle (the timer has already fired or been cancelled)
+		bool cancel(const TimerHandle &);
+		bool isActive(const TimerHandle &) const;
+
+		// a paused timer keeps its remaining time, and doesn't count down until it's resumed
+		bool pause(const TimerHandle &);
+		bool resume(const TimerHandle &);
+		bool isPaused(const TimerHandle &) const;
+
+		// milliseconds until it fires (0 for a stale handle, or one due on the next update)
+		uint64_t remaining(const TimerHandle &) const;
+
+		// moves the deadline to `milliseconds` from now, keeping the timer and its callback
+		bool setRemaining(const TimerHandle &, uint64_t milliseconds);
+
+		// timers scheduled and not yet fired or cancelled, paused ones included
+		inline size_t size() const { return activeCount; }
+
+	private:
+		TimerService(const TimerService &) = delete;
+		TimerService &operator=(const TimerService &) = delete;
+
+		static const int SlotBits = 6;
+		static const uint32_t Slots = 1 << SlotBits;
+		static const int Levels = 4;
+		static const int32_t None = -1;
+
+		enum class TimerState : uint8_t { Free, Scheduled, Paused, Firing };
+
+		struct Timer
+		{
+			uint64_t deadline; // or, while paused, the time remaining
+			Callback callback;
+			int32_t prev, next; // within a slot's list, or the free list (next only)
+			uint32_t generation;
+			uint8_t level, slot;
+			TimerState state;
+		};
+
+		const GameClock &clock;
+		uint64_t lastUpdate;
+		uint64_t nextTick; // every tick before this has been processed
+
+		std::vector<Timer> timers;
+		int32_t freeList;
+		size_t activeCount;
+
+		int32_t slotHeads[Levels][Slots];
+		uint64_t occupied[Levels]; // a bit per non-empty slot
+
+		std::vector<int32_t> due; // reused by advanceTo()
+
+		Timer *timerFor(const TimerHandle &);
+		const Timer *timerFor(const TimerHandle &) const;
+
+		void link(int32_t index);
+		void unlink(int32_t index);
+		void release(int32_t index);
+
+		void cascade(int level, uint32_t slot);
+		void fireTick(uint64_t tick);
+		uint64_t nextTickWorthVisiting(uint64_t limit) const;
+	};
+}
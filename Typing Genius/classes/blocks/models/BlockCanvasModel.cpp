@@ -47,6 +47,19 @@ namespace ac {
 	BlockCanvasModel::BlockCanvasModel()
 	{
 		pImpl.reset(new BlockCanvasModelImpl(this));
+
+		listenTo({
+			notif::StatsHUDModel_EndTimer,
+			notif::ScoreKeeper_Score,
+			notif::BlockCanvasView_FinishedPopAnimation,
+			notif::BlockCanvasView_EncasementDowngraded,
+			notif::BlockCanvasView_ObstructionRemoved,
+			notif::CopyText_LoadedString,
+			notif::CopyText_Advance,
+			notif::CopyText_AdvanceWithSpace,
+			notif::CopyText_Preadvance,
+			notif::CopyText_Mistake
+		});
 	}
 
 	
@@ -65,86 +78,83 @@ namespace ac {
 
 	bool BlockCanvasModelImpl::hasObstructionAtIndex(size_t index) const
 	{
-		// obtain the glyphstring from.. copytext's copystring
-		const CopyText &ct(GameState::getInstance().copyText());
-		const GlyphString &gs(ct.copyString());
-
-		const size_t copyStringOffset = index + ct.curOffset();
-
-		return (gs.hasObstructionAtIndex(copyStringOffset));
+		// the row shows the visible string of the copy text
+		return GameState::getInstance().copyText().getVisibleString().hasObstructionAtIndex(index);
 	}
 
 
 	size_t BlockCanvasModelImpl::encasementLevelAtIndex(size_t index) const
 	{
-		const CopyText &ct(GameState::getInstance().copyText());
-		const GlyphString &gs(ct.copyString());
-		const size_t copyStringOffset = index + ct.curOffset();
-		return (gs.encasementLevelAtIndex(copyStringOffset));
+		return GameState::getInstance().copyText().getVisibleString().encasementLevelAtIndex(index);
 	}
 
 
 	void BlockCanvasModelImpl::reduceEncasementLevelAtIndex(size_t index, size_t amount)
 	{
-		CopyText &ct(GameState::getInstance().copyText());
-		GlyphString &gs(ct.copyString());
-		const size_t copyStringOffset = index + ct.curOffset();
-		gs.reduceEncasementLevelAtIndex(copyStringOffset, amount);
+		GameState::getInstance().copyText().reduceEncasementLevelInVisibleRow(index, amount);
 	}
 
 	
 #pragma mark - Respond to Notifs Events
 
-	void BlockCanvasModel::notifCallback(const string &code, std::shared_ptr<void> data) {
-		if ("StatsHUDModel_EndTimer" == code) {
-			LogI << "ran out of time... dim the glyphs on the BCV";
-			Notif::send("BlockCanvasModel_EndTimer");
-		}
-
-		// ScoreKeeper
-		else if ("ScoreKeeper_Score" == code) {
-			// extract latest score delta from sk
-			std::shared_ptr<ScoreKeeperUpdateInfo> info = std::static_pointer_cast<ScoreKeeperUpdateInfo>(data);
-			std::shared_ptr<BlockCanvasModelUpdateInfo> pInfo(new BlockCanvasModelUpdateInfo);
-			pInfo->scoreUpdateDelta = info->scoreDelta; // ScoreKeeperUpdateInfo
-			pInfo->curStreakLevel = info->curStreakLevel;
-			Notif::send("BlockCanvasModel_PerBlockScoreDelta", pInfo);
-		}
-
-		// BlockCanvasView
-		else if ("BlockCanvasView_FinishedPopAnimation" == code) {
-			Notif::send("BlockCanvasModel_DoneAnimation");
-
-		} else if ("BlockCanvasView_EncasementDowngraded" == code) {
-			std::shared_ptr<BlockCanvasViewUpdateInfo> pInfo = std::static_pointer_cast<BlockCanvasViewUpdateInfo>(data);
-			pImpl->reduceEncasementLevelAtIndex(pInfo->blockIndex,
-												pImpl->encasementLevelAtIndex(pInfo->blockIndex));
-
-		} else if ("BlockCanvasView_ObstructionRemoved" == code) {
-			reportObstructionRemoved();
-
-		}
-
-		// CopyText
-		else if ("CopyText_LoadedString" == code) {
-			updateBlockChain(GameState::getInstance().copyText().getVisibleString());
-			Notif::send("BlockCanvasModel_Load");
-
-		} else if ("CopyText_Advance" == code) {
-			updateBlockChain(GameState::getInstance().copyText().getVisibleString());
-			Notif::send("BlockCanvasModel_Advance");
-
-		} else if ("CopyText_AdvanceWithSpace" == code) {
-			updateBlockChain(GameState::getInstance().copyText().getVisibleString());
-			Notif::send("BlockCanvasModel_AdvanceWithSpace");
-
-		} else if ("CopyText_Preadvance" == code) {
-			Notif::send("BlockCanvasModel_Highlight");
-
-		} else if ("CopyText_Mistake" == code) {
-			updateBlockChain(GameState::getInstance().copyText().getVisibleString());
-			Notif::send("BlockCanvasModel_Mistake");
-
+	void BlockCanvasModel::topicCallback(notif_topic_t topic, const NotifData &data) {
+		switch (topic) {
+			case notif::StatsHUDModel_EndTimer:
+				LogI << "ran out of time... dim the glyphs on the BCV";
+				Notif::send(notif::BlockCanvasModel_EndTimer);
+				break;
+
+			// ScoreKeeper
+			case notif::ScoreKeeper_Score: {
+				// extract latest score delta from sk
+				const ScoreKeeperUpdateInfo *skInfo = data.get<ScoreKeeperUpdateInfo>();
+				BlockCanvasModelUpdateInfo info = {};
+				info.scoreUpdateDelta = skInfo->scoreDelta; // ScoreKeeperUpdateInfo
+				info.curStreakLevel = skInfo->curStreakLevel;
+				Notif::send(notif::BlockCanvasModel_PerBlockScoreDelta, info);
+			} break;
+
+			// BlockCanvasView
+			case notif::BlockCanvasView_FinishedPopAnimation:
+				Notif::send(notif::BlockCanvasModel_DoneAnimation);
+				break;
+
+			case notif::BlockCanvasView_EncasementDowngraded: {
+				const BlockCanvasViewUpdateInfo *info = data.get<BlockCanvasViewUpdateInfo>();
+				pImpl->reduceEncasementLevelAtIndex(info->blockIndex,
+													pImpl->encasementLevelAtIndex(info->blockIndex));
+			} break;
+
+			case notif::BlockCanvasView_ObstructionRemoved:
+				reportObstructionRemoved();
+				break;
+
+			// CopyText
+			case notif::CopyText_LoadedString:
+				updateBlockChain(GameState::getInstance().copyText().getVisibleString());
+				Notif::send(notif::BlockCanvasModel_Load);
+				break;
+
+			case notif::CopyText_Advance:
+				updateBlockChain(GameState::getInstance().copyText().getVisibleString());
+				Notif::send(notif::BlockCanvasModel_Advance);
+				break;
+
+			case notif::CopyText_AdvanceWithSpace:
+				updateBlockChain(GameState::getInstance().copyText().getVisibleString());
+				Notif::send(notif::BlockCanvasModel_AdvanceWithSpace);
+				break;
+
+			case notif::CopyText_Preadvance:
+				Notif::send(notif::BlockCanvasModel_Highlight);
+				break;
+
+			case notif::CopyText_Mistake:
+				updateBlockChain(GameState::getInstance().copyText().getVisibleString());
+				Notif::send(notif::BlockCanvasModel_Mistake);
+				break;
+
+			default: break;
 		}
 	}
 
@@ -158,7 +168,7 @@ namespace ac {
 		// ... time to tell the GameState player that it has a new froggie
 		gs.player().addToCurrencyOwned(1);
 		gs.player().syncStatsToDB(gs.scoreKeeper());
-		Notif::send("BlockCanvasModel_CurrencyCollected");
+		Notif::send(notif::BlockCanvasModel_CurrencyCollected);
 	}
 
 
@@ -197,7 +207,7 @@ namespace ac {
 
 #pragma mark - Initialize the Row of Blocks
 
-	void BlockCanvasModel::updateBlockChain(const GlyphString &str)
+	void BlockCanvasModel::updateBlockChain(const GlyphStringView &str)
 	{
 		pImpl->row1Blox.setString(str);
 		// now set properties for the blockmodels in the row1blox here using info available
@@ -14,7 +14,7 @@
 namespace ac {
 
 	class CopyText;
-	class GlyphString;
+	class GlyphStringView;
 	class ScoreKeeper;
 	class BlockChain;
 	
@@ -42,7 +42,7 @@ namespace ac {
 
 		// this sets the block chain contents with what's
 		// in str.
-		void updateBlockChain(const GlyphString &str);
+		void updateBlockChain(const GlyphStringView &str);
 
 		// convenience methods in relation to CopyText and checking.
 		size_t unitsToAdvance() const; // after checking, how many blocks should go?
@@ -60,7 +60,7 @@ namespace ac {
 		void reportObstructionRemoved();
 
 		// NotifListener callback
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 
 	private:
 		std::unique_ptr<BlockCanvasModelImpl> pImpl;
@@ -31,7 +31,7 @@ namespace ac {
 	}
 
 
-	void BlockChain::setString(const GlyphString &str)
+	void BlockChain::setString(const GlyphStringView &str)
 	{
 		size_t size = str.size();
 
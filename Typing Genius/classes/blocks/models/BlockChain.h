@@ -13,7 +13,7 @@ namespace ac {
 
 	using std::string;
 	class BlockModel;
-	class GlyphString;
+	class GlyphStringView;
 
 	// the equivalent of a string.
 	class BlockChain
@@ -26,7 +26,7 @@ namespace ac {
 
 		size_t size() const;
 
-		void setString(const GlyphString &str);
+		void setString(const GlyphStringView &str);
 
 	private:
 		std::vector<BlockModel> elements;
@@ -13,7 +13,9 @@
 #include "BlockChain.h"
 #include "BlockModel.h"
 // #include "BlockTypesetter.h"
+#include "BlockTweener.h"
 #include "BlockView.h"
+#include "BlockViewPool.h"
 #include "CopyText.h"
 #include "DebugSettingsHelper.h"
 #include "GameState.h"
@@ -22,7 +24,7 @@
 #include "Keyboard.h"
 #include "KeyboardModel.h"
 #include "KeypressTracker.h"
-#include "MCBCallLambda.h"
+#include "KeystrokeTrace.h"
 #include "ScreenResolutionHelper.h"
 #include "SimpleAudioEngine.h"
 #include "StatsHUD.h"
@@ -35,6 +37,14 @@ namespace ac {
 	const char *SFXMistake = "sfx/bad-type.mp3";
 	const char *SFXWhoosh = "sfx/whoosh.mp3";
 
+	// what the block tweens tell the canvas when they finish
+	enum BlockTweenEvent
+	{
+		BlockFlewOff = 1, // a popped block is out of the way and can be recycled
+		BlockSettled, // some time after that, the next blocks can slide in
+		BlockSlidIn
+	};
+
 #pragma mark - pImpl
 
 	struct BlockCanvasViewImpl : public CCObject /* only to satisfy the requirement for callbacks */
@@ -44,16 +54,13 @@ namespace ac {
 		BlockCanvasView *canvasView; // pointer passed from the main class
 		CCSprite *bgSprite;
 
-		// holds just the pointers to the blocks. This is so that so you don't need to dig through
-		// canvasNode->getChildren with potentially expensive dynamic_cast<>s
-		// they don't have to be shown
-		std::set<BlockView *> allBlocks;
-
-		// blocks which are marked for reuse (and are hidden)
-		std::set<BlockView *> reusableBlocks;
+		// every block, by index on the row, and the ones which are marked for reuse (and are hidden). This is so
+		// that you don't need to dig through canvasNode->getChildren with potentially expensive dynamic_cast<>s
+		BlockViewPool<BlockView> blockPool;
 
-		// keeps track of the total number of simultaneous pop operations. When this goes to zero, the next phase begins
-		int numOfOngoingBlockPops;
+		// the blocks' (and their glyphs') animations while typing. When no popped block has yet to settle, the next
+		// phase begins
+		BlockTweener<CCSprite> tweener;
 
 		// --------- LOCATE BLOCKS ---------
 		BlockView *blockViewWithIndex(int index);
@@ -85,12 +92,16 @@ namespace ac {
 		// call this in preparation for running an action on a block
 		void stopBlockAnimations(BlockView *);
 
-		CCFiniteTimeAction *popAndRecycleBlock(BlockView *blockView, bool spaceWasUsed = false);
-		CCFiniteTimeAction *slideBlock(BlockView *blockView, bool relaxed);
-		CCFiniteTimeAction *blinkBlock(BlockView *blockView);
-		CCFiniteTimeAction *highlightBlock(); // run on getGlyphSprite
+		// these queue up tweens
+		void popAndRecycleBlock(BlockView *blockView, bool spaceWasUsed, float settleDelay);
+		void slideBlock(BlockView *blockView, bool relaxed, float delay);
+		void blinkBlock(BlockView *blockView);
+		void highlightBlock(BlockView *blockView); // on its glyph sprite
 		CCFiniteTimeAction *fadeInBlock();
 
+		// steps the tweens and handles the events of those that finished
+		void updateTweens(float deltaTime);
+
 		// callbacks
 		void donePoppingAllBlocksCallback(); // callbacks after finished eliminating blocks
 		void doneSlidingAllBlocksCallback();
@@ -105,8 +116,8 @@ namespace ac {
 		void setBlockViewProperties(BlockView *blockView, const BlockModel &blockModel);
 		
 
-		BlockCanvasViewImpl(BlockCanvasView *canvasView) : colorLayer(), bgSprite(), spriteBatchNode(), allBlocks(),
-		numOfOngoingBlockPops(0), reusableBlocks(), 	canvasView(canvasView) {
+		BlockCanvasViewImpl(BlockCanvasView *canvasView) : colorLayer(), bgSprite(), spriteBatchNode(), blockPool(),
+		tweener(), canvasView(canvasView) {
 			// ...
 		}
 	};
@@ -117,6 +128,16 @@ namespace ac {
 	BlockCanvasView::BlockCanvasView()
 	{
 		pImpl.reset(new BlockCanvasViewImpl(this));
+
+		listenTo({
+			notif::BlockCanvasModel_Load,
+			notif::BlockCanvasModel_Advance,
+			notif::BlockCanvasModel_AdvanceWithSpace,
+			notif::BlockCanvasModel_Mistake,
+			notif::BlockCanvasModel_Highlight,
+			notif::BlockCanvasModel_EndTimer,
+			notif::BlockCanvasModel_PerBlockScoreDelta
+		});
 	}
 
 
@@ -186,6 +207,13 @@ namespace ac {
 			pImpl->spriteBatchNode->ignoreAnchorPointForPosition(false);
 			pImpl->spriteBatchNode->setContentSize(sz);
 			this->addChild(pImpl->spriteBatchNode);
+
+			// a row's worth of blocks may still be popping while the next ones slide in
+			const size_t blocksPerRow = blockCountPerRow();
+			pImpl->blockPool.reserve(blocksPerRow, blocksPerRow);
+			// popping takes the most tweens per block
+			pImpl->tweener.reserve(2 * blocksPerRow * 8);
+			this->scheduleUpdate();
 			
 			ret = true;
 		} while (false);
@@ -209,32 +237,48 @@ namespace ac {
 	}
 
 
+	void BlockCanvasView::update(float deltaTime)
+	{
+		pImpl->updateTweens(deltaTime);
+	}
+
+
 #pragma mark - NotifListener Callback
 
-	void BlockCanvasView::notifCallback(const string &code, std::shared_ptr<void> data)
+	void BlockCanvasView::topicCallback(notif_topic_t topic, const NotifData &data)
 	{
 		const BlockCanvasModel &model(*BlockCanvas::getInstance().model());
-		
-		if ("BlockCanvasModel_Load" == code) {
-			pImpl->recycleAllBlocks();
-			pImpl->layoutBlockChain(BlockCanvas::getInstance().model());
-		} else if ("BlockCanvasModel_Advance" == code) {
-			pImpl->advanceBlockChain(model.unitsToAdvance(), false);
-		} else if ("BlockCanvasModel_AdvanceWithSpace" == code) {
-			pImpl->advanceBlockChain(model.unitsToAdvance(), true);
-		} else if ("BlockCanvasModel_Mistake" == code) {
-			pImpl->blinkBlockChain(model.unitsWithMistake());
-		} else if ("BlockCanvasModel_Highlight" == code) {
-			pImpl->highlightBlockChain(model.unitsToAdvance());
-		} else if ("BlockCanvasModel_EndTimer" == code) {
-			pImpl->dimBlockChain();
-			pImpl->marchOffBlockChain();
-		} else if ("BlockCanvasModel_PerBlockScoreDelta" == code) {
-			BlockView *blockView = pImpl->blockViewWithIndex(0);
-			if (blockView) {
-				std::shared_ptr<BlockCanvasModelUpdateInfo> pInfo = std::static_pointer_cast<BlockCanvasModelUpdateInfo>(data);
-				pImpl->floatStatsAboveBlock(*pInfo, blockView);
+
+		switch (topic) {
+			case notif::BlockCanvasModel_Load:
+				pImpl->recycleAllBlocks();
+				pImpl->layoutBlockChain(BlockCanvas::getInstance().model());
+				break;
+			case notif::BlockCanvasModel_Advance:
+				pImpl->advanceBlockChain(model.unitsToAdvance(), false);
+				break;
+			case notif::BlockCanvasModel_AdvanceWithSpace:
+				pImpl->advanceBlockChain(model.unitsToAdvance(), true);
+				break;
+			case notif::BlockCanvasModel_Mistake:
+				pImpl->blinkBlockChain(model.unitsWithMistake());
+				break;
+			case notif::BlockCanvasModel_Highlight:
+				pImpl->highlightBlockChain(model.unitsToAdvance());
+				break;
+			case notif::BlockCanvasModel_EndTimer:
+				pImpl->dimBlockChain();
+				pImpl->marchOffBlockChain();
+				break;
+			case notif::BlockCanvasModel_PerBlockScoreDelta: {
+				BlockView *blockView = pImpl->blockViewWithIndex(0);
+				const BlockCanvasModelUpdateInfo *info = data.get<BlockCanvasModelUpdateInfo>();
+				if (blockView && info) {
+					pImpl->floatStatsAboveBlock(*info, blockView);
+				}
+				break;
 			}
+			default: break;
 		} // i think there should be an event that responds to increase / decrease in block chain length.
 	}
 
@@ -246,7 +290,7 @@ namespace ac {
 		if (blockView->getParent() != spriteBatchNode) {
 			spriteBatchNode->addChild(blockView);
 			blockView->setCanvasView(canvasView);
-			this->allBlocks.insert(blockView);
+			this->blockPool.adopt(blockView);
 		}
 	}
 
@@ -259,22 +303,9 @@ namespace ac {
 
 #pragma mark - Create, Reuse, and Access Blocks
 
-	// not the fastest due to its use of dynamic_cast. Perhaps use static_cast?
 	BlockView *BlockCanvasViewImpl::blockViewWithIndex(int index)
 	{
-		CCNode *canvas = canvasView->getCanvasNode();
-
-		CCArray *canvasChildren = canvas->getChildren();
-		CCObject *obj;
-		CCARRAY_FOREACH(canvasChildren, obj) {
-			BlockView *blockV = dynamic_cast<BlockView *>(obj);
-			if (blockV) {
-				if (blockV->getIndex() == index) {
-					return blockV;
-				}
-			}
-		}
-		return NULL;
+		return blockPool.viewAt(index);
 	}
 
 
@@ -296,32 +327,20 @@ namespace ac {
 	// available blocks in the pool.
 	void BlockCanvasView::recycleBlock(BlockView *block)
 	{
-		block->setIndex(-1);
+		pImpl->blockPool.recycle(block); // also sets the index to -1
 		block->setVisible(false);
-		pImpl->reusableBlocks.insert(block);
-		LogI << "recycling block.";
+		LogD4 << "recycling block.";
 	}
 
 
 	// may return NULL, so check for the return value
 	BlockView *BlockCanvasViewImpl::getReusableBlock()
 	{
-		BlockView *ret = NULL;
-		auto it = reusableBlocks.begin();
-		if (it != reusableBlocks.end()) {
-			ret = *it;
-
-//			if (ret->getParent() != NULL) {
-//				// it's not yet ready
-//				return NULL;
-//			}
+		BlockView *ret = blockPool.reuse();
+		if (ret) {
 			ret->setVisible(true);
 			ret->setScaleX(1);
 			ret->setScaleY(1);
-
-			reusableBlocks.erase(it);
-			// ret->release();
-
 		}
 		return ret;
 	}
@@ -329,7 +348,7 @@ namespace ac {
 
 	void BlockCanvasViewImpl::recycleAllBlocks()
 	{
-		for (BlockView *block: this->allBlocks) {
+		for (BlockView *block: blockPool.allViews()) {
 			canvasView->recycleBlock(block);
 		}
 	}
@@ -339,9 +358,9 @@ namespace ac {
 
 	void BlockCanvasView::attemptedDowngradeOfBlockEnclosureLevel(BlockView *block)
 	{
-		std::shared_ptr<BlockCanvasViewUpdateInfo> pInfo(new BlockCanvasViewUpdateInfo);
-		pInfo->blockIndex = block->getIndex();
-		Notif::send("BlockCanvasView_EncasementDowngraded", pInfo);
+		BlockCanvasViewUpdateInfo info = {};
+		info.blockIndex = block->getIndex();
+		Notif::send(notif::BlockCanvasView_EncasementDowngraded, info);
 		block->setEnclosureLevel(0);
 	}
 
@@ -349,9 +368,9 @@ namespace ac {
 	void BlockCanvasView::obstructionRemovedFromBlockView(BlockView *block)
 	{
 		// tell the model. What should happen is that the frog count will eventually be updated for the player
-		std::shared_ptr<BlockCanvasViewUpdateInfo> pInfo(new BlockCanvasViewUpdateInfo);
-		pInfo->blockIndex = block->getIndex();
-		Notif::send("BlockCanvasView_ObstructionRemoved", pInfo);
+		BlockCanvasViewUpdateInfo info = {};
+		info.blockIndex = block->getIndex();
+		Notif::send(notif::BlockCanvasView_ObstructionRemoved, info);
 	}
 
 
@@ -373,18 +392,17 @@ namespace ac {
 			const Glyph &g(blockModel.getGlyph());
 			
 			aBlockView = createOrReuseBlockView(g);
-			aBlockView->setIndex(i);
 			
 			GlyphMap &gm(GameState::getInstance().glyphMap());
 
-			string keyLabel(gm.keyLabelForGlyph(g));
-			if (!keyLabel.empty()) {
+			const KeyID key = gm.keyForGlyph(g);
+			if (key != InvalidKeyID) {
 				// look up KeyboardModel
 				if (g.getCode() == 0) { // space
 					aBlockView->enableHint(false);
 				} else {
 					aBlockView->enableHint(true);
-					const utilities::RGBByte &rgb(kbModel->getColorForKey(keyLabel));
+					const utilities::RGBByte &rgb(kbModel->getColorForKey(key));
 					aBlockView->setHintColor(utilities::ccc3FromRGB(rgb));
 				}
 			}
@@ -394,6 +412,7 @@ namespace ac {
 			aBlockView->getGlyphSprite()->runAction(fadeInBlock());
 
 			addBlockViewToCanvas(aBlockView);
+			blockPool.place(aBlockView, i);
 
 			// prepare for sliding in
 			setBlockPosition(aBlockView);
@@ -483,20 +502,20 @@ namespace ac {
 	// Could be called rapid-fire depending on the user's typing speed!
 	void BlockCanvasViewImpl::advanceBlockChain(size_t advanceUnits, bool spaceWasUsed)
 	{
+		AC_TRACE_SPAN(BlockAnimation);
 		shared_ptr<BlockCanvasModel> model(BlockCanvas::getInstance().model());
 
-		if (numOfOngoingBlockPops >= model->totalBlocksDisplayable()) {
+		const size_t ongoingBlockPops = tweener.pending(BlockSettled);
+		if (ongoingBlockPops >= model->totalBlocksDisplayable()) {
 			LogI << "slow down! too many already. number of ongoing pop block operations pending: "
-				<< numOfOngoingBlockPops;
+				<< ongoingBlockPops;
 		}
 
 		// pop the blocks first. when that finishes, slide the blocks in through a callback
-		int rightMostPoppedBlockIndex = -1; // useful for the index adjustment op later
-
 		for (size_t i = 0; i < advanceUnits; i++) {
 
-			// this relies on the next step (for loop) which readjusts the remaining blocks' indices after
-			// these are taken off
+			// this relies on the next step (advancing the pool) which readjusts the remaining blocks' indices
+			// after these are taken off
 			BlockView *blockView = blockViewWithIndex(i);
 
 			if (blockView) {
@@ -504,47 +523,22 @@ namespace ac {
 				// halt any animations before the current one
 				stopBlockAnimations(blockView);
 
-				const float delay = model->slideBackTime();
-
-				auto donePoppingABlock = MCBPlatformSupport::MCBCallLambda::createWithDelay(delay, [=] () {
-					numOfOngoingBlockPops -= 1;
-					if (numOfOngoingBlockPops < 1) {
-						CopyText &ct(GameState::getInstance().copyText());
-						ct.registerStreakFinished();
-
-						if (!GameState::getInstance().isGameOver()) {
-							donePoppingAllBlocksCallback();
-						}
-					}
-				});
-
-				blockView->runAction(CCSequence::create(popAndRecycleBlock(blockView, spaceWasUsed), donePoppingABlock, NULL));
-				numOfOngoingBlockPops += 1;
-
-				if (blockView->getIndex() > rightMostPoppedBlockIndex) {
-					rightMostPoppedBlockIndex = blockView->getIndex();
-				}
-
-				blockView->setIndex(-1); // take this block out of consideration for the next step
+				popAndRecycleBlock(blockView, spaceWasUsed, model->slideBackTime());
 
 			} else {
 				LogW << "no block found...";
 			}
 		}
 
-		// drop the indices of the remaining blocks so they reflect proper index ordering.
-		for (BlockView *block : this->allBlocks) {
-			int blockIndex = block->getIndex();
-			if (blockIndex > rightMostPoppedBlockIndex) {
-				int newIndex = blockIndex - 1 - rightMostPoppedBlockIndex;
-				block->setIndex(newIndex);
-			}
-		}
+		// take the popped blocks off the row (their index becomes -1) and drop the indices of the remaining blocks
+		// so they reflect proper index ordering.
+		blockPool.advance(advanceUnits);
 	}
 
 
 	void BlockCanvasViewImpl::blinkBlockChain(size_t units) // used when there is a mistake
 	{
+		AC_TRACE_SPAN(BlockAnimation);
 #ifndef BOOST_TEST_TARGET
 		if (!DebugSettingsHelper::sharedHelper().boolValueForProperty("disable_sfx")) {
 			CocosDenshion::SimpleAudioEngine::sharedEngine()->playEffect(SFXMistake);
@@ -556,7 +550,7 @@ namespace ac {
 			if (blockView) {
 				// halt any animations before the current one
 				stopBlockAnimations(blockView);
-				blockView->runAction(blinkBlock(blockView));
+				blinkBlock(blockView);
 			} else {
 				LogI << "Note: less than " << units << " blocks found to work on!";
 			}
@@ -566,13 +560,14 @@ namespace ac {
 	
 	void BlockCanvasViewImpl::highlightBlockChain(size_t preadvanceUnits)
 	{
+		AC_TRACE_SPAN(BlockAnimation);
 		for (size_t i = 0; i < preadvanceUnits; i++) {
 			BlockView *blockView = blockViewWithIndex(i);
 			if (blockView) {
 				// halt any animations before the current one
 				// stopBlockAnimations(blockView);
 				blockView->setZOrder(1000 + i); // make it appear higher up than the others
-				blockView->getGlyphSprite()->runAction(highlightBlock());
+				highlightBlock(blockView);
 			} else {
 				LogI << "Note: less than " << preadvanceUnits << " blocks found to work on!";
 			}
@@ -582,7 +577,7 @@ namespace ac {
 
 	void BlockCanvasViewImpl::dimBlockChain()
 	{
-		for (BlockView *blockView : this->allBlocks) {
+		for (BlockView *blockView : blockPool.allViews()) {
 			blockView->getGlyphSprite()->runAction(CCFadeTo::create(0.3, 40));
 		}
 	}
@@ -590,7 +585,7 @@ namespace ac {
 
 	void BlockCanvasViewImpl::marchOffBlockChain()
 	{
-		for (BlockView *blockView : this->allBlocks) {
+		for (BlockView *blockView : blockPool.allViews()) {
 
 			if (blockView->getIndex() != -1) { // target only onscreen blocks
 
@@ -677,19 +672,18 @@ namespace ac {
 	void BlockCanvasViewImpl::stopBlockAnimations(BlockView *blockView)
 	{
 		blockView->stopAllActions();
+		tweener.stop(blockView);
+		tweener.stop(blockView->getGlyphSprite(), TweenProperty::Blink);
 		blockView->setIsAnimating(false);
 		blockView->showBlock(blockView, true);
 	}
 
 	
-	// will shrink the block and then when finished, return it to the 'pool.
-	CCFiniteTimeAction *BlockCanvasViewImpl::popAndRecycleBlock(BlockView *blockView, bool spaceWasUsed)
+	// will shrink the block and then when finished, return it to the 'pool. Once it has also settled (some time
+	// after) the blocks can slide in.
+	void BlockCanvasViewImpl::popAndRecycleBlock(BlockView *blockView, bool spaceWasUsed, float settleDelay)
 	{
-		// note: fade off only affects the parent not the children!
-		// http://stackoverflow.com/questions/12409697/ccsprite-fadeout-with-children
-		
-		CCActionInterval *pop = CCScaleTo::create(0.1, 1, 0.01f); // after which the block is hidden
-		pop = CCEaseIn::create(pop, 2);
+		const float FlyUpTime = 0.3, FlyLeftTime = 0.2;
 
 		StatsHUDView *shView(StatsHUD::getInstance().view());
 		
@@ -709,34 +703,26 @@ namespace ac {
 		globalPoint.y += progressBlockSize.height / 2;
 		
 		CCPoint pointInBC(canvasView->convertToNodeSpace(globalPoint));
-		
-		CCActionInterval *flyUp = CCMoveTo::create(0.3, pointInBC);
-		flyUp = CCEaseIn::create(flyUp, 2);
-
-		CCActionInterval *flyLeft = CCMoveTo::create(0.2, ccp(0 - 2 * bs.width, blockView->getPosition().y));
-		flyLeft = CCEaseIn::create(flyLeft, 2);
-		
-		CCActionInterval *scaleDown = CCScaleTo::create(0.3, newScale);
-		scaleDown = CCEaseOut::create(scaleDown, 2);
-		
-		CCSpawn *spawn;
 
+		float flightTime;
 		if (spaceWasUsed) {
 			if (!DebugSettingsHelper::sharedHelper().boolValueForProperty("disable_sfx")) {
 				CocosDenshion::SimpleAudioEngine::sharedEngine()->playEffect(SFXWhoosh);
 			}
-			spawn = CCSpawn::create(flyLeft, NULL);
+			// fly left
+			flightTime = FlyLeftTime;
+			tweener.tween(blockView, TweenProperty::PositionX, 0 - 2 * bs.width, flightTime, 0, TweenEase::In,
+						  BlockFlewOff);
 		} else {
-			spawn = CCSpawn::create(flyUp, scaleDown, NULL);
+			// fly up while scaling down
+			flightTime = FlyUpTime;
+			tweener.tween(blockView, TweenProperty::PositionX, pointInBC.x, flightTime, 0, TweenEase::In,
+						  BlockFlewOff);
+			tweener.tween(blockView, TweenProperty::PositionY, pointInBC.y, flightTime, 0, TweenEase::In);
+			tweener.tween(blockView, TweenProperty::ScaleX, newScale, flightTime, 0, TweenEase::Out);
+			tweener.tween(blockView, TweenProperty::ScaleY, newScale, flightTime, 0, TweenEase::Out);
 		}
 
-		// the call back reclaims the block
-		CCCallFunc *recycleAction = CCCallFuncO::create(blockView,
-														callfuncO_selector(BlockView::finishedPopAnimation),
-														canvasView);
-		
-		CCCallFunc *finishedAnimationAction = CCCallFunc::create(this, callfunc_selector(BlockCanvasViewImpl::finishedPopAnimation));
-		
 		// once the fly up animation is done you can tell StatsHud so it can update the view.
 		// but shview is currently mainly governed by CopyText.
 		// here's the plan:
@@ -745,41 +731,40 @@ namespace ac {
 		// of which blocks are in use.
 		// 3. bcv sends a signal to the shmodel to make the shview update, using ct.
 
-		CCSequence *sequence = CCSequence::create(spawn, finishedAnimationAction, recycleAction, NULL);
-		return sequence;
+		tweener.wait(blockView, flightTime + settleDelay, BlockSettled);
 	}
 	
 	
 	// will slide the existing blocks by x units to the left
-	CCFiniteTimeAction *BlockCanvasViewImpl::slideBlock(BlockView *blockView, bool relaxed)
+	void BlockCanvasViewImpl::slideBlock(BlockView *blockView, bool relaxed, float delay)
 	{
 		float rate = relaxed ? 0.4 : 0.2;
 		CCPoint position = canvasView->blockPositionForBlock(blockView->getIndex(), blockView->blockSize().width);
 		// LogI << boost::format("position for index %d: %.2f") % index % position.x;
-		CCActionInterval *action = CCMoveTo::create(rate, position);
-		action = CCEaseIn::create(action, 2);
-		return action;
+		tweener.tween(blockView, TweenProperty::PositionX, position.x, rate, delay, TweenEase::In, BlockSlidIn);
+		tweener.tween(blockView, TweenProperty::PositionY, position.y, rate, delay, TweenEase::In);
 	}
 
 
-	CCFiniteTimeAction *BlockCanvasViewImpl::blinkBlock(BlockView *blockView)
+	void BlockCanvasViewImpl::blinkBlock(BlockView *blockView)
 	{
-		CCMoveTo *resetPosition = CCMoveTo::create(0.1, canvasView->blockPositionForBlock(blockView->getIndex(), blockView->blockSize().width));
-
-		CCCallFunc *blinkOff = CCCallFunc::create(blockView, callfunc_selector(BlockView::hideBlock));
-		CCCallFunc *blinkOn = CCCallFunc::create(blockView, callfunc_selector(BlockView::showBlock));
-		CCDelayTime *delay = CCDelayTime::create(0.05);
-		CCSequence *theBlinking = CCSequence::create(blinkOff, delay, blinkOn, delay, blinkOff, delay, blinkOn, NULL);
+		CCPoint position = canvasView->blockPositionForBlock(blockView->getIndex(), blockView->blockSize().width);
+		tweener.tween(blockView, TweenProperty::PositionX, position.x, 0.1);
+		tweener.tween(blockView, TweenProperty::PositionY, position.y, 0.1);
 
-		return CCSpawn::create(resetPosition, theBlinking, NULL);
+		// off and on twice, 0.05s each time
+		tweener.tween(blockView->getGlyphSprite(), TweenProperty::Blink, 2, 0.15);
 	}
 	
 	
-	CCFiniteTimeAction *BlockCanvasViewImpl::highlightBlock()
+	void BlockCanvasViewImpl::highlightBlock(BlockView *blockView)
 	{
-		CCFiniteTimeAction *goUp = CCEaseIn::create(CCScaleTo::create(0.15, 1.3), 2);
-		CCFiniteTimeAction *goDown = CCEaseIn::create(CCScaleTo::create(0.10, 1), 2);
-		return CCSequence::create(goUp, goDown, NULL);
+		CCSprite *glyph = blockView->getGlyphSprite();
+		const float goUp = 0.15, goDown = 0.10;
+		tweener.tween(glyph, TweenProperty::ScaleX, 1.3f, goUp, 0, TweenEase::In);
+		tweener.tween(glyph, TweenProperty::ScaleY, 1.3f, goUp, 0, TweenEase::In);
+		tweener.tween(glyph, TweenProperty::ScaleX, 1.3f, 1, goDown, goUp, TweenEase::In);
+		tweener.tween(glyph, TweenProperty::ScaleY, 1.3f, 1, goDown, goUp, TweenEase::In);
 	}
 
 
@@ -791,6 +776,40 @@ namespace ac {
 
 #pragma mark - Post-Animation Callbacks
 
+	void BlockCanvasViewImpl::updateTweens(float deltaTime)
+	{
+		tweener.update(deltaTime);
+
+		bool blocksSettled = false;
+		for (const BlockTweener<CCSprite>::Event &e : tweener.events()) {
+			BlockView *blockView = static_cast<BlockView *>(e.target);
+			switch (e.event) {
+				case BlockFlewOff:
+					finishedPopAnimation();
+					blockView->finishedPopAnimation(canvasView); // the call back reclaims the block
+					break;
+				case BlockSettled:
+					blocksSettled = true;
+					break;
+				case BlockSlidIn:
+					doneSlidingABlock(blockView);
+					break;
+				default: break;
+			}
+		}
+
+		// several may settle in the same frame; the next phase begins once
+		if (blocksSettled && tweener.pending(BlockSettled) == 0) {
+			CopyText &ct(GameState::getInstance().copyText());
+			ct.registerStreakFinished();
+
+			if (!GameState::getInstance().isGameOver()) {
+				donePoppingAllBlocksCallback();
+			}
+		}
+	}
+
+
 	void BlockCanvasViewImpl::doneSlidingABlock(CCObject *obj)
 	{
 		BlockView *blockView = static_cast<BlockView *>(obj);
@@ -804,7 +823,7 @@ namespace ac {
 		}
 		
 		bool inProgress = false;
-		for (BlockView *blockView : allBlocks) {
+		for (BlockView *blockView : blockPool.allViews()) {
 			if (blockView->isAnimating()) {
 				inProgress = true;
 				break;
@@ -820,7 +839,7 @@ namespace ac {
 	void BlockCanvasViewImpl::finishedPopAnimation()
 	{
 		// this informs the model. Could be improved by specifying which block caused this.
-		Notif::send("BlockCanvasView_FinishedPopAnimation");
+		Notif::send(notif::BlockCanvasView_FinishedPopAnimation);
 	}
 
 
@@ -847,18 +866,12 @@ namespace ac {
 
 		// now slide the chain in; add as many blocks that were lost to the end (right)
 		//
-		// all popped blocks have -1 as their index. I can use that info to determine how many
+		// popped blocks leave their slots on the row empty. I can use that info to determine how many
 		// needs to be brought back to the right end.
 
-		int poppedCount = 0;
 		const int totalBlocksDisplayable = model->totalBlocksDisplayable();
 		const int visibleStringSize = model->visibleStringSize();
-		
-		for (BlockView *block : this->allBlocks) {
-			if (block->getIndex() == -1) {
-				poppedCount++;
-			}
-		}
+		const int poppedCount = MAX(0, totalBlocksDisplayable - (int) blockPool.countOnRow());
 		
 		int restorable = MAX(0, visibleStringSize - totalBlocksDisplayable + poppedCount);
 		// the number of new blocks to slide in = poppedCount (with some proviso)
@@ -875,23 +888,23 @@ namespace ac {
 
 			BlockView *blockView = createOrReuseBlockView(glyph);
 			if (blockView) {
-				blockView->setIndex(newIndex);
 				
 				GlyphMap &gm(GameState::getInstance().glyphMap());
 
-				string keyLabel(gm.keyLabelForGlyph(glyph));
-				if (!keyLabel.empty()) {
+				const KeyID key = gm.keyForGlyph(glyph);
+				if (key != InvalidKeyID) {
 					// look up KeyboardModel
 					if (glyph.getCode() == 0) { // space
 						blockView->enableHint(false);
 					} else {
 						blockView->enableHint(true);
-						const utilities::RGBByte &rgb(kbModel->getColorForKey(keyLabel));
+						const utilities::RGBByte &rgb(kbModel->getColorForKey(key));
 						blockView->setHintColor(utilities::ccc3FromRGB(rgb));
 					}
 				}
 
 				addBlockViewToCanvas(blockView);
+				blockPool.place(blockView, newIndex);
 
 				// prepare for sliding in
 				setBlockPosition(blockView);
@@ -920,7 +933,7 @@ namespace ac {
 		BlockChain &blockChain = model->getBlockChain();
 		const int totalBlocksDisplayable = model->totalBlocksDisplayable();
 
-		for (BlockView *blockV : this->allBlocks) {
+		for (BlockView *blockV : blockPool.allViews()) {
 			// prepare to slide
 			stopBlockAnimations(blockV);
 
@@ -935,17 +948,12 @@ namespace ac {
 				// do the slide: if its one of the newer blocks take a little longer to slide in.
 				bool relaxed = index >= totalBlocksDisplayable - offscreenBlockCount;
 
-				CCCallFuncO *func = CCCallFuncO::create(this,
-														callfuncO_selector(BlockCanvasViewImpl::doneSlidingABlock),
-														blockV);
-
 				if (relaxed) {
 					// staggered entry: the left blocks from outside the screen will make their entrance a bit sooner
 					const float relaxDelay = 0.075 * (1 + index - totalBlocksDisplayable + offscreenBlockCount);
-					blockV->runAction(CCSequence::create(CCDelayTime::create(relaxDelay), slideBlock(blockV, relaxed),
-														 func, NULL));
+					slideBlock(blockV, relaxed, relaxDelay);
 				} else {
-					blockV->runAction(CCSequence::create(slideBlock(blockV, relaxed), func, NULL));
+					slideBlock(blockV, relaxed, 0);
 				}
 
 				// actually should wait till all the sliding blocks are done.
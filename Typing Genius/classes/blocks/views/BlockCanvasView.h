@@ -41,6 +41,9 @@ namespace ac {
 		virtual void onEnter();
 		virtual void onExit();
 
+		// steps the block animations
+		virtual void update(float deltaTime);
+
 		// called by BlockView when it's done... needed?
 		void recycleBlock(BlockView *block);
 
@@ -62,7 +65,7 @@ namespace ac {
 		CCPoint blockPositionForBlock(int index, float blockWidth);
 
 		// NotifListener callback
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 		
 	private:
 		BlockCanvasView();
@@ -0,0 +1,231 @@
+//
+//  BlockTweener.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/26/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	The block canvas's animations (pops, slides, blinks and highlights), which happen for every block on every
+//	keystroke. Instead of a graph of CCActions per block, each tween is one property of one sprite going from one value
+//	to another, kept in a flat array that update() steps once a frame. What would have been a CCSequence is tweens with
+//	delays, and a CCSpawn is tweens side by side. Rather than calling back, a tween can finish with an event (any
+//	nonzero number), which the canvas picks up from events() after the update. Once reserve() has been called with
+//	enough room, queueing and updating tweens don't allocate.
+//
+//	It's a template so that it can be tested without cocos2d-x: a target needs the getters and setters of a
+//	CCSprite's position, scale and opacity.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace ac {
+
+	enum class TweenProperty : unsigned char
+	{
+		None, // nothing changes, for waiting and then sending an event
+		PositionX,
+		PositionY,
+		ScaleX,
+		ScaleY,
+		Opacity,
+		Blink // opacity off and on again, `to` times (ending on)
+	};
+
+	// CCEaseIn / CCEaseOut with a rate of 2, which is what the blocks always used
+	enum class TweenEase : unsigned char
+	{
+		Linear,
+		In,
+		Out
+	};
+
+
+	template <class Target>
+	class BlockTweener
+	{
+	public:
+		struct Event
+		{
+			int event;
+			Target *target;
+		};
+
+		BlockTweener() {}
+
+		void reserve(size_t tweenCount)
+		{
+			tweens.reserve(tweenCount);
+			finished.reserve(tweenCount);
+		}
+
+		// from whatever the property is when the tween starts (after the delay) to `to`
+		inline void tween(Target *target, TweenProperty property, float to, float duration, float delay = 0,
+						  TweenEase ease = TweenEase::Linear, int event = 0)
+		{
+			add(target, property, 0, false, to, duration, delay, ease, event);
+		}
+
+		// for tweens that follow one another on the same property, where the second shouldn't depend on the first
+		// having been applied before it starts
+		inline void tween(Target *target, TweenProperty property, float from, float to, float duration, float delay,
+						  TweenEase ease = TweenEase::Linear, int event = 0)
+		{
+			add(target, property, from, true, to, duration, delay, ease, event);
+		}
+
+		// sends the event after a while
+		inline void wait(Target *target, float delay, int event)
+		{
+			add(target, TweenProperty::None, 0, true, 0, 0, delay, TweenEase::Linear, event);
+		}
+
+		// drops the target's tweens where they are, without their events
+		void stop(Target *target)
+		{
+			for (size_t i = 0; i < tweens.size(); ) {
+				if (tweens[i].target == target) {
+					remove(i);
+				} else {
+					i++;
+				}
+			}
+		}
+
+		void stop(Target *target, TweenProperty property)
+		{
+			for (size_t i = 0; i < tweens.size(); ) {
+				if (tweens[i].target == target && tweens[i].property == property) {
+					remove(i);
+				} else {
+					i++;
+				}
+			}
+		}
+
+		// steps every tween, and replaces events() with those of the tweens that finished
+		void update(float deltaTime)
+		{
+			finished.clear();
+
+			for (size_t i = 0; i < tweens.size(); ) {
+				Tween &t(tweens[i]);
+				t.elapsed += deltaTime;
+				if (t.elapsed < t.delay) {
+					i++;
+					continue;
+				}
+
+				if (!t.started) {
+					t.started = true;
+					if (!t.fromGiven) t.from = get(t);
+				}
+
+				const float progress = t.duration > 0 ? std::min(1.0f, (t.elapsed - t.delay) / t.duration) : 1;
+				set(t, progress);
+
+				if (progress < 1) {
+					i++;
+				} else {
+					if (t.event) {
+						const Event e = { t.event, t.target };
+						finished.push_back(e);
+					}
+					remove(i);
+				}
+			}
+		}
+
+		// from the last update(); the tweens that sent them are gone, so it's safe to queue and stop tweens while
+		// going through these
+		inline const std::vector<Event> &events() const { return finished; }
+
+		// tweens yet to finish that will send that event
+		size_t pending(int event) const
+		{
+			size_t count = 0;
+			for (const Tween &t : tweens) {
+				if (t.event == event) count++;
+			}
+			return count;
+		}
+
+		inline size_t size() const { return tweens.size(); }
+
+	private:
+		struct Tween
+		{
+			Target *target;
+			float from;
+			float to;
+			float duration;
+			float delay;
+			float elapsed; // including the delay
+			int event;
+			TweenProperty property;
+			TweenEase ease;
+			bool fromGiven;
+			bool started;
+		};
+
+		std::vector<Tween> tweens; // in no particular order
+		std::vector<Event> finished;
+
+		void add(Target *target, TweenProperty property, float from, bool fromGiven, float to, float duration,
+				 float delay, TweenEase ease, int event)
+		{
+			const Tween t = { target, from, to, duration, delay, 0, event, property, ease, fromGiven, false };
+			tweens.push_back(t);
+		}
+
+		// the last one takes its place
+		inline void remove(size_t i)
+		{
+			if (i + 1 < tweens.size()) tweens[i] = tweens.back();
+			tweens.pop_back();
+		}
+
+		static inline float eased(TweenEase ease, float progress)
+		{
+			switch (ease) {
+				case TweenEase::In: return progress * progress;
+				case TweenEase::Out: return std::sqrt(progress);
+				default: return progress;
+			}
+		}
+
+		static float get(const Tween &t)
+		{
+			switch (t.property) {
+				case TweenProperty::PositionX: return t.target->getPositionX();
+				case TweenProperty::PositionY: return t.target->getPositionY();
+				case TweenProperty::ScaleX: return t.target->getScaleX();
+				case TweenProperty::ScaleY: return t.target->getScaleY();
+				case TweenProperty::Opacity: return t.target->getOpacity();
+				default: return 0;
+			}
+		}
+
+		static void set(const Tween &t, float progress)
+		{
+			const float value = t.from + (t.to - t.from) * eased(t.ease, progress);
+			switch (t.property) {
+				case TweenProperty::PositionX: t.target->setPositionX(value); break;
+				case TweenProperty::PositionY: t.target->setPositionY(value); break;
+				case TweenProperty::ScaleX: t.target->setScaleX(value); break;
+				case TweenProperty::ScaleY: t.target->setScaleY(value); break;
+				case TweenProperty::Opacity: t.target->setOpacity((unsigned char) (value + 0.5f)); break;
+				case TweenProperty::Blink: {
+					// off, on, off, on... in equal parts, so that it ends on
+					const int phases = 2 * (int) t.to - 1;
+					const int phase = progress < 1 ? (int) (progress * phases) : phases;
+					t.target->setOpacity(phase % 2 ? 255 : 0);
+					break;
+				}
+				default: break;
+			}
+		}
+	};
+}
@@ -81,7 +81,7 @@ namespace ac {
 
 #pragma mark - Lifetime
 
-	BlockView::BlockView() : animating(false)
+	BlockView::BlockView() : index(-1), animating(false), recycled(false)
 	{
 		// LogI << "Inside BlockView constructor";
 		pImpl.reset(new BlockViewImpl(this));
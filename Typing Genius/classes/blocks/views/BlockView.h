@@ -47,6 +47,10 @@ namespace ac {
 		
 		void setIndex(int index);
 		inline int getIndex() { return this->index; }
+
+		// set by the BlockCanvasView's pool while the block is hidden and waiting to be reused
+		inline bool isRecycled() const { return this->recycled; }
+		inline void setRecycled(bool recycled) { this->recycled = recycled; }
 		
 		void setHintColor(const ccColor3B &);
 		const ccColor3B &getHintColor() const;
@@ -116,6 +120,7 @@ namespace ac {
 		int index;
 		
 		bool animating;
+		bool recycled;
 
 
 		/**
@@ -0,0 +1,157 @@
+//
+//  BlockViewPool.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/26/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Keeps track of the BlockCanvasView's blocks: which one is at each index of the row, and which are spare (popped
+//	and hidden) for reuse. The row is a ring, so advancing it turns the slots of the blocks that were popped off the
+//	front into the empty ones at the back instead of moving the rest, and spare blocks are a stack. Finding the block
+//	at an index, recycling a block and reusing one are all O(1) and, once reserve() has been called with enough room,
+//	never allocate.
+//
+//	The pool keeps each block's index (-1 when it isn't on the row) in step with where it is. It doesn't own the
+//	blocks (the sprite batch node does), and it's a template only so that it can be tested without cocos2d-x; a
+//	block needs getIndex() / setIndex() and isRecycled() / setRecycled().
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace ac {
+
+	template <class View>
+	class BlockViewPool
+	{
+	public:
+		BlockViewPool() : head(0), onRow(0) {}
+
+		// room for a row of rowLength blocks, plus as many more still being popped while the next ones slide in
+		void reserve(size_t rowLength, size_t lookahead)
+		{
+			if (rowLength > row.size()) resizeRow(rowLength);
+			all.reserve(rowLength + lookahead);
+			spare.reserve(rowLength + lookahead);
+		}
+
+		// a block that hasn't been in the pool before; it starts off the row
+		void adopt(View *view)
+		{
+			all.push_back(view);
+			view->setIndex(-1);
+			view->setRecycled(false);
+		}
+
+		// NULL if there is no block at that index
+		inline View *viewAt(int index) const
+		{
+			return index >= 0 && (size_t) index < row.size() ? row[slot(index)] : NULL;
+		}
+
+		// puts a block (just adopted or reused) at an index of the row, replacing whatever was there
+		void place(View *view, int index)
+		{
+			if (index < 0) return;
+			if ((size_t) index >= row.size()) resizeRow(index + 1);
+
+			View *&at(row[slot(index)]);
+			if (at == view) return;
+			if (at) { at->setIndex(-1); onRow--; }
+			if (view->getIndex() >= 0) take(view->getIndex());
+
+			at = view;
+			view->setIndex(index);
+			onRow++;
+		}
+
+		// takes the block at an index off the row (to be popped), leaving its slot empty
+		View *take(int index)
+		{
+			View *view = viewAt(index);
+			if (view) {
+				row[slot(index)] = NULL;
+				view->setIndex(-1);
+				onRow--;
+			}
+			return view;
+		}
+
+		// the front `units` slots, which should have been taken already, go to the back, and every block on the row
+		// moves down that many places
+		void advance(size_t units)
+		{
+			if (row.empty() || units == 0) return;
+			units = std::min(units, row.size());
+			for (size_t i = 0; i < units; i++) {
+				take((int) i);
+			}
+			head = (head + units) % row.size();
+
+			for (size_t i = 0; i < row.size() - units; i++) {
+				if (View *view = row[slot(i)]) {
+					view->setIndex((int) i);
+				}
+			}
+		}
+
+		// the block can be reused; recycling it again before then does nothing
+		void recycle(View *view)
+		{
+			if (view->isRecycled()) return;
+			if (view->getIndex() >= 0) take(view->getIndex());
+			view->setRecycled(true);
+			spare.push_back(view);
+		}
+
+		void recycleAll()
+		{
+			for (View *view : all) {
+				recycle(view);
+			}
+		}
+
+		// NULL when there are none to spare
+		View *reuse()
+		{
+			if (spare.empty()) return NULL;
+			View *view = spare.back();
+			spare.pop_back();
+			view->setRecycled(false);
+			return view;
+		}
+
+		// every block adopted, whether on the row, being popped or spare
+		inline const std::vector<View *> &allViews() const { return all; }
+
+		inline size_t rowLength() const { return row.size(); }
+		inline size_t countOnRow() const { return onRow; }
+		inline size_t spareCount() const { return spare.size(); }
+
+	private:
+		std::vector<View *> row; // ring of slots; index 0 of the row is at head
+		size_t head;
+		size_t onRow;
+
+		std::vector<View *> all;
+		std::vector<View *> spare; // used as a stack
+
+		inline size_t slot(size_t index) const
+		{
+			const size_t s = head + index;
+			return s < row.size() ? s : s - row.size();
+		}
+
+		// only grows; lays the ring back out from index 0
+		void resizeRow(size_t length)
+		{
+			std::vector<View *> resized(length, NULL);
+			for (size_t i = 0; i < row.size(); i++) {
+				resized[i] = row[slot(i)];
+			}
+			row.swap(resized);
+			head = 0;
+		}
+	};
+}
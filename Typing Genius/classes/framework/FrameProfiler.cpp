@@ -0,0 +1,227 @@
+//
+//  FrameProfiler.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/27/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <boost/format.hpp>
+
+namespace ac {
+
+	const size_t FrameProfiler::FrameCapacity;
+
+	namespace {
+
+		// microseconds with the nanoseconds kept, as in the keystroke trace
+		void writeMicroseconds(std::ostream &out, uint64_t nanoseconds)
+		{
+			out << nanoseconds / 1000 << '.' << boost::format("%03d") % (nanoseconds % 1000);
+		}
+	}
+
+
+	const char *FrameProfiler::sectionName(Section section)
+	{
+		switch (section) {
+			case Section::SchedulerUpdate: return "SchedulerUpdate";
+			case Section::ActionManager: return "ActionManager";
+			case Section::ParticleUpdate: return "ParticleUpdate";
+			case Section::Visit: return "Visit";
+			case Section::SortChildren: return "SortChildren";
+			case Section::NotifDispatch: return "NotifDispatch";
+			default: return "Unknown";
+		}
+	}
+
+
+	FrameProfiler &FrameProfiler::getInstance()
+	{
+		static FrameProfiler instance;
+		return instance;
+	}
+
+
+	FrameProfiler::FrameProfiler() : enabled(false), inFrame(false), frames(FrameCapacity), head(0), count(0),
+	recorded(0), current(), sectionBegan(), depth()
+	{
+		scratch.reserve(FrameCapacity);
+	}
+
+
+	void FrameProfiler::setEnabled(bool enabled)
+	{
+		this->enabled = enabled;
+		inFrame = false;
+	}
+
+
+	void FrameProfiler::reset()
+	{
+		head = 0;
+		count = 0;
+		recorded = 0;
+		inFrame = false;
+	}
+
+
+#pragma mark - Recording
+
+	void FrameProfiler::beginFrame(uint64_t now)
+	{
+		if (!enabled) return;
+
+		current = Frame();
+		current.begin = now;
+		std::fill(depth, depth + (size_t) Section::Count, 0);
+		inFrame = true;
+	}
+
+
+	void FrameProfiler::endFrame(uint64_t now)
+	{
+		if (!enabled || !inFrame) return;
+
+		current.duration = now - current.begin;
+		frames[head] = current;
+		head = (head + 1) % FrameCapacity;
+		count = std::min(count + 1, FrameCapacity);
+		recorded++;
+		inFrame = false;
+	}
+
+
+	void FrameProfiler::beginSection(Section section, uint64_t now)
+	{
+		if (!enabled || !inFrame || section >= Section::Count) return;
+
+		const size_t s = (size_t) section;
+		if (depth[s]++ == 0) {
+			sectionBegan[s] = now;
+		}
+	}
+
+
+	void FrameProfiler::endSection(Section section, uint64_t now)
+	{
+		if (!enabled || !inFrame || section >= Section::Count) return;
+
+		const size_t s = (size_t) section;
+		if (depth[s] > 0 && --depth[s] == 0) {
+			current.sections[s] += now - sectionBegan[s];
+		}
+	}
+
+
+#pragma mark - Reading
+
+	const FrameProfiler::Frame &FrameProfiler::frameAt(size_t i) const
+	{
+		return frames[(head + FrameCapacity - count + i) % FrameCapacity];
+	}
+
+
+	template <class Duration>
+	FrameProfiler::Stats FrameProfiler::statsOf(Duration duration) const
+	{
+		Stats stats = { count, 0, 0, 0, 0 };
+		if (count == 0) return stats;
+
+		scratch.clear();
+		uint64_t total = 0;
+		for (size_t i = 0; i < count; i++) {
+			const uint64_t d = duration(frameAt(i));
+			scratch.push_back(d);
+			total += d;
+		}
+
+		// nearest rank
+		const size_t rank = std::min(std::max((size_t) (0.99 * count + 0.999999), (size_t) 1), count) - 1;
+		std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+		stats.p99 = scratch[rank];
+		stats.min = *std::min_element(scratch.begin(), scratch.end());
+		stats.max = *std::max_element(scratch.begin(), scratch.end());
+		stats.avg = total / count;
+		return stats;
+	}
+
+
+	FrameProfiler::Stats FrameProfiler::frameStats() const
+	{
+		return statsOf([](const Frame &frame) { return frame.duration; });
+	}
+
+
+	FrameProfiler::Stats FrameProfiler::sectionStats(Section section) const
+	{
+		const size_t s = std::min((size_t) section, (size_t) Section::Count - 1);
+		return statsOf([s](const Frame &frame) { return frame.sections[s]; });
+	}
+
+
+#pragma mark - Writing
+
+	void FrameProfiler::writeCSV(std::ostream &out) const
+	{
+		out << "frame,begin_us,frame_us";
+		for (size_t s = 0; s < (size_t) Section::Count; s++) {
+			out << ',' << sectionName((Section) s) << "_us";
+		}
+		out << '\n';
+
+		const uint64_t firstFrame = recorded - count;
+		const uint64_t origin = count ? frameAt(0).begin : 0;
+		for (size_t i = 0; i < count; i++) {
+			const Frame &frame(frameAt(i));
+			out << firstFrame + i << ',';
+			writeMicroseconds(out, frame.begin - origin);
+			out << ',';
+			writeMicroseconds(out, frame.duration);
+			for (size_t s = 0; s < (size_t) Section::Count; s++) {
+				out << ',';
+				writeMicroseconds(out, frame.sections[s]);
+			}
+			out << '\n';
+		}
+	}
+
+
+	void FrameProfiler::writeSummary(std::ostream &out) const
+	{
+		boost::format row("%-16s min %9.3f us   avg %9.3f us   p99 %9.3f us   max %9.3f us\n");
+
+		const Stats frame(frameStats());
+		out << row % "Frame" % (frame.min / 1000.0) % (frame.avg / 1000.0) % (frame.p99 / 1000.0) %
+			(frame.max / 1000.0);
+		for (size_t s = 0; s < (size_t) Section::Count; s++) {
+			const Stats stats(sectionStats((Section) s));
+			out << row % sectionName((Section) s) % (stats.min / 1000.0) % (stats.avg / 1000.0) %
+				(stats.p99 / 1000.0) % (stats.max / 1000.0);
+		}
+	}
+
+
+	bool FrameProfiler::dump(const std::string &path) const
+	{
+		std::ofstream file(path.c_str());
+		if (file) {
+			writeCSV(file);
+		}
+
+		std::ostringstream summary;
+		writeSummary(summary);
+		LogI << "Frame profile: the last " << count << " of " << recorded << " frames, written to " << path << "\n"
+			<< summary.str();
+
+		if (!file) {
+			LogE << "Couldn't write the frame profile to " << path;
+			return false;
+		}
+		return true;
+	}
+}
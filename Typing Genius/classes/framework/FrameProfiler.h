@@ -0,0 +1,137 @@
+//
+//  FrameProfiler.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/27/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Where each of the last few hundred frames went: how long the frame took, and how much of it was spent in each of
+//	cocos2d-x's scheduler, action manager, particles, scene visit and child sorting (timed through
+//	CCProfilingFrameListener, see AppDelegate) and in the game's deferred Notif dispatch. Frames are kept in a ring
+//	allocated up front, so profiling costs a few clock reads a frame and nothing while it's off.
+//
+//	Sections nest the way the engine runs them (the scheduler's time includes the actions, particles and Notifs; the
+//	visit's includes the sorting), and a section entered several times in a frame adds up. Main thread only.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "KeystrokeTrace.h"
+
+namespace ac {
+
+	class FrameProfiler
+	{
+	public:
+		// the first five are in the order of cocos2d-x's ccProfilingSection
+		enum class Section : uint8_t
+		{
+			SchedulerUpdate,
+			ActionManager,
+			ParticleUpdate,
+			Visit,
+			SortChildren,
+			NotifDispatch,
+			Count
+		};
+
+		static const char *sectionName(Section section);
+
+		// 10 seconds at 60 fps
+		static const size_t FrameCapacity = 600;
+
+		struct Frame
+		{
+			uint64_t begin; // nanoseconds on the steady clock
+			uint64_t duration;
+			uint64_t sections[(size_t) Section::Count];
+		};
+
+		// nanoseconds, over the frames in the ring
+		struct Stats
+		{
+			size_t frames;
+			uint64_t min;
+			uint64_t avg;
+			uint64_t p99;
+			uint64_t max;
+		};
+
+		static FrameProfiler &getInstance();
+
+		// starts off disabled; disabling doesn't clear the frames already kept
+		void setEnabled(bool enabled);
+		inline bool isEnabled() const { return enabled; }
+		void reset();
+
+		// The times default to now; tests pass their own. A section outside a frame is ignored.
+		void beginFrame(uint64_t now = trace::now());
+		void endFrame(uint64_t now = trace::now());
+		void beginSection(Section section, uint64_t now = trace::now());
+		void endSection(Section section, uint64_t now = trace::now());
+
+		// the ring, oldest first
+		inline size_t frameCount() const { return count; }
+		const Frame &frameAt(size_t i) const;
+		inline uint64_t framesRecorded() const { return recorded; } // since the last reset, including those dropped
+
+		Stats frameStats() const;
+		Stats sectionStats(Section section) const;
+
+		// one row per frame in the ring, times in microseconds
+		void writeCSV(std::ostream &out) const;
+		void writeSummary(std::ostream &out) const;
+
+		// writes the CSV to the file and logs the summary. False if the file couldn't be written.
+		bool dump(const std::string &path) const;
+
+
+		// times a section until the end of the scope
+		class Scope
+		{
+		public:
+			explicit Scope(Section section) : section(section), profiler(getInstance())
+			{
+				if (profiler.isEnabled()) profiler.beginSection(section);
+			}
+
+			~Scope()
+			{
+				if (profiler.isEnabled()) profiler.endSection(section);
+			}
+
+		private:
+			Scope(const Scope &) = delete;
+			Scope &operator=(const Scope &) = delete;
+
+			Section section;
+			FrameProfiler &profiler;
+		};
+
+	private:
+		FrameProfiler();
+		FrameProfiler(const FrameProfiler &) = delete;
+		FrameProfiler &operator=(const FrameProfiler &) = delete;
+
+		bool enabled;
+		bool inFrame;
+
+		std::vector<Frame> frames; // the ring, FrameCapacity long
+		size_t head; // where the next frame goes
+		size_t count;
+		uint64_t recorded;
+
+		Frame current;
+		uint64_t sectionBegan[(size_t) Section::Count];
+		unsigned depth[(size_t) Section::Count]; // only the outermost of a section re-entered within itself counts
+
+		mutable std::vector<uint64_t> scratch; // for the percentiles
+
+		template <class Duration>
+		Stats statsOf(Duration duration) const;
+	};
+}
@@ -0,0 +1,266 @@
+//
+//  KeystrokeTrace.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/18/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "KeystrokeTrace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <pthread.h>
+#include <boost/format.hpp>
+#include "SPSCRing.h"
+#include "Utilities.h"
+
+namespace ac {
+
+	namespace trace {
+
+		namespace {
+
+			const size_t SpansPerThread = 4096;
+
+			struct ThreadTrace
+			{
+				explicit ThreadTrace(uint32_t id) : id(id), dropped(0) {}
+
+				uint32_t id;
+				SPSCRing<SpanRecord, SpansPerThread> ring; // the thread produces, collect() consumes
+				std::atomic<size_t> dropped;
+			};
+
+			// every thread that ever recorded a span; they're kept after the thread exits so their spans can be collected
+			struct Registry
+			{
+				std::mutex mutex;
+				std::vector<std::unique_ptr<ThreadTrace>> threads;
+				pthread_key_t key;
+			};
+
+			std::atomic<uint32_t> latestKeystroke(0);
+
+			pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+
+			Registry &registry()
+			{
+				static Registry instance;
+				return instance;
+			}
+
+			void createThreadKey()
+			{
+				pthread_key_create(&registry().key, nullptr);
+			}
+
+			ThreadTrace &threadTrace()
+			{
+				pthread_once(&keyOnce, createThreadKey);
+				Registry &reg(registry());
+
+				ThreadTrace *trace = static_cast<ThreadTrace *>(pthread_getspecific(reg.key));
+				if (!trace) { // first span on this thread
+					std::lock_guard<std::mutex> lock(reg.mutex);
+					trace = new ThreadTrace((uint32_t) reg.threads.size());
+					reg.threads.push_back(std::unique_ptr<ThreadTrace>(trace));
+					pthread_setspecific(reg.key, trace);
+				}
+				return *trace;
+			}
+
+			// nearest rank, over sorted durations
+			uint64_t percentile(const std::vector<uint64_t> &sorted, double p)
+			{
+				if (sorted.empty()) return 0;
+				size_t rank = (size_t) (p * sorted.size() + 0.999999);
+				return sorted[std::min(std::max(rank, (size_t) 1), sorted.size()) - 1];
+			}
+
+			StageSummary summaryOf(const std::string &name, std::vector<uint64_t> &durations)
+			{
+				std::sort(durations.begin(), durations.end());
+				StageSummary summary = { name, durations.size(), percentile(durations, 0.5), percentile(durations, 0.99) };
+				return summary;
+			}
+
+			// microseconds, which is what the trace format wants, keeping the nanoseconds
+			void writeMicroseconds(std::ostream &out, uint64_t nanoseconds)
+			{
+				out << nanoseconds / 1000 << '.' << boost::format("%03d") % (nanoseconds % 1000);
+			}
+		}
+
+
+		const char *stageName(Stage stage)
+		{
+			switch (stage) {
+				case Stage::Touch: return "Touch";
+				case Stage::KeypressTracker: return "KeypressTracker";
+				case Stage::CopyTextCheck: return "CopyTextCheck";
+				case Stage::ScoreKeeper: return "ScoreKeeper";
+				case Stage::BlockAnimation: return "BlockAnimation";
+				default: return "Unknown";
+			}
+		}
+
+
+		uint64_t now()
+		{
+			typedef std::chrono::steady_clock clock;
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+		}
+
+
+		uint32_t beginKeystroke()
+		{
+			return latestKeystroke.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+
+
+		uint32_t currentKeystroke()
+		{
+			return latestKeystroke.load(std::memory_order_relaxed);
+		}
+
+
+		void record(Stage stage, uint32_t keystroke, uint64_t begin, uint64_t end)
+		{
+			ThreadTrace &trace(threadTrace());
+			const SpanRecord span = { begin, end, keystroke, trace.id, stage };
+			if (!trace.ring.push(span)) {
+				trace.dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+
+#pragma mark - Collecting
+
+		std::vector<SpanRecord> collect()
+		{
+			Registry &reg(registry());
+			std::lock_guard<std::mutex> lock(reg.mutex); // also keeps collect() the only consumer of each ring
+
+			std::vector<SpanRecord> spans;
+			for (const std::unique_ptr<ThreadTrace> &trace : reg.threads) {
+				SpanRecord span;
+				while (trace->ring.pop(span)) {
+					spans.push_back(span);
+				}
+			}
+			return spans;
+		}
+
+
+		size_t droppedSpans()
+		{
+			Registry &reg(registry());
+			std::lock_guard<std::mutex> lock(reg.mutex);
+
+			size_t dropped = 0;
+			for (const std::unique_ptr<ThreadTrace> &trace : reg.threads) {
+				dropped += trace->dropped.load(std::memory_order_relaxed);
+			}
+			return dropped;
+		}
+
+
+		void writeChromeTrace(const std::vector<SpanRecord> &spans, std::ostream &out)
+		{
+			// timestamps are made relative to the first span, so they stay readable
+			uint64_t origin = spans.empty() ? 0 : spans.front().begin;
+			for (const SpanRecord &span : spans) {
+				origin = std::min(origin, span.begin);
+			}
+
+			out << "{\"traceEvents\":[";
+			for (size_t i = 0; i < spans.size(); i++) {
+				const SpanRecord &span(spans[i]);
+				out << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << stageName(span.stage)
+					<< "\",\"cat\":\"keystroke\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread << ",\"ts\":";
+				writeMicroseconds(out, span.begin - origin);
+				out << ",\"dur\":";
+				writeMicroseconds(out, span.end - span.begin);
+				out << ",\"args\":{\"keystroke\":" << span.keystroke << "}}";
+			}
+			out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+		}
+
+
+#pragma mark - Summarizing
+
+		std::vector<StageSummary> summarize(const std::vector<SpanRecord> &spans)
+		{
+			std::vector<uint64_t> durations[(size_t) Stage::Count];
+			std::map<uint32_t, std::pair<uint64_t, uint64_t>> keystrokes; // first begin, last end
+
+			for (const SpanRecord &span : spans) {
+				if (span.stage < Stage::Count) {
+					durations[(size_t) span.stage].push_back(span.end - span.begin);
+				}
+				if (span.keystroke == 0) continue; // before the first keystroke
+
+				std::map<uint32_t, std::pair<uint64_t, uint64_t>>::iterator it = keystrokes.find(span.keystroke);
+				if (it == keystrokes.end()) {
+					keystrokes[span.keystroke] = std::make_pair(span.begin, span.end);
+				} else {
+					it->second.first = std::min(it->second.first, span.begin);
+					it->second.second = std::max(it->second.second, span.end);
+				}
+			}
+
+			std::vector<StageSummary> summary;
+			for (size_t s = 0; s < (size_t) Stage::Count; s++) {
+				if (!durations[s].empty()) {
+					summary.push_back(summaryOf(stageName((Stage) s), durations[s]));
+				}
+			}
+
+			std::vector<uint64_t> keystrokeDurations;
+			for (const auto &kv : keystrokes) {
+				keystrokeDurations.push_back(kv.second.second - kv.second.first);
+			}
+			if (!keystrokeDurations.empty()) {
+				summary.push_back(summaryOf("Keystroke", keystrokeDurations));
+			}
+			return summary;
+		}
+
+
+		void writeSummary(const std::vector<StageSummary> &summary, std::ostream &out)
+		{
+			for (const StageSummary &row : summary) {
+				out << boost::format("%-16s %7d spans   p50 %9.3f us   p99 %9.3f us\n") % row.name % row.count %
+					(row.p50 / 1000.0) % (row.p99 / 1000.0);
+			}
+		}
+
+
+		bool dump(const std::string &path)
+		{
+			const std::vector<SpanRecord> spans(collect());
+
+			std::ofstream file(path.c_str());
+			if (file) {
+				writeChromeTrace(spans, file);
+			}
+
+			std::ostringstream summary;
+			writeSummary(summarize(spans), summary);
+			LogI << "Keystroke trace: " << spans.size() << " spans (" << droppedSpans() << " dropped), written to "
+				<< path << "\n" << summary.str();
+
+			if (!file) {
+				LogE << "Couldn't write the keystroke trace to " << path;
+				return false;
+			}
+			return true;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+//
+//  KeystrokeTrace.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/18/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Times each stage a keystroke goes through, from the touch reaching the KeyboardView to the block animation being
+//	kicked off. A span costs two clock reads and a push into a ring owned by the calling thread (no lock, no
+//	allocation); the rings are only drained when a trace is collected. Spans are tagged with the keystroke that was
+//	current when they began, so stages reached through Notif::post on the next frame can be attributed to the wrong
+//	keystroke if the player is quick.
+//
+//	The AC_TRACE_* macros compile to nothing unless AC_TRACING is on, which it is by default in builds without NDEBUG.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef AC_TRACING
+#	ifdef NDEBUG
+#		define AC_TRACING 0
+#	else
+#		define AC_TRACING 1
+#	endif
+#endif
+
+namespace ac {
+
+	namespace trace {
+
+		enum class Stage : uint8_t
+		{
+			Touch,				// KeyboardView, finding the key touched and passing it on
+			KeypressTracker,	// tracking the touch and buffering the key event
+			CopyTextCheck,		// comparing what was typed against the copy text
+			ScoreKeeper,		// scoring the block cleared, or the mistake
+			BlockAnimation,		// BlockCanvasView starting the block animations
+			Count
+		};
+
+		const char *stageName(Stage stage);
+
+		struct SpanRecord
+		{
+			uint64_t begin; // nanoseconds on the steady clock
+			uint64_t end;
+			uint32_t keystroke;
+			uint32_t thread; // small number, in order of each thread's first span
+			Stage stage;
+		};
+
+		uint64_t now();
+
+		// starts a new keystroke; spans beginning after this are tagged with it
+		uint32_t beginKeystroke();
+		uint32_t currentKeystroke();
+
+		// called at the end of a span, with the keystroke current when it began. Only the calling thread's ring is
+		// touched.
+		void record(Stage stage, uint32_t keystroke, uint64_t begin, uint64_t end);
+
+		// Drains every thread's ring, oldest first per thread. Spans that didn't fit in a full ring were dropped and
+		// counted instead.
+		std::vector<SpanRecord> collect();
+		size_t droppedSpans();
+
+		// Chrome's trace event format (load it at chrome://tracing); one complete event per span
+		void writeChromeTrace(const std::vector<SpanRecord> &spans, std::ostream &out);
+
+		struct StageSummary
+		{
+			std::string name;
+			size_t count;
+			uint64_t p50; // nanoseconds
+			uint64_t p99;
+		};
+
+		// one row per stage that has spans, then a "Keystroke" row for the first begin to the last end of each keystroke
+		std::vector<StageSummary> summarize(const std::vector<SpanRecord> &spans);
+		void writeSummary(const std::vector<StageSummary> &summary, std::ostream &out);
+
+		// collects, writes the Chrome trace to the file and logs the summary. False if the file couldn't be written.
+		bool dump(const std::string &path);
+
+
+		class Span
+		{
+		public:
+			explicit Span(Stage stage) : stage(stage), keystroke(currentKeystroke()), begin(now()) {}
+			~Span() { record(stage, keystroke, begin, now()); }
+
+		private:
+			Span(const Span &) = delete;
+			Span &operator=(const Span &) = delete;
+
+			Stage stage;
+			uint32_t keystroke;
+			uint64_t begin;
+		};
+	}
+}
+
+
+#define AC_TRACE_CONCAT_(a, b) a##b
+#define AC_TRACE_CONCAT(a, b) AC_TRACE_CONCAT_(a, b)
+
+#if AC_TRACING
+#	define AC_TRACE_KEYSTROKE() ac::trace::beginKeystroke()
+#	define AC_TRACE_SPAN(stage) ac::trace::Span AC_TRACE_CONCAT(acTraceSpan, __LINE__)(ac::trace::Stage::stage)
+#else
+#	define AC_TRACE_KEYSTROKE() ((void) 0)
+#	define AC_TRACE_SPAN(stage) ((void) 0)
+#endif
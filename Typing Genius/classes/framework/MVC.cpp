@@ -31,16 +31,6 @@ namespace ac {
 		return _view;
 	}
 
-	// note: neither are const because subclasses might be asked to lazily recreate them when null
-	template<class M, class V, class C>
-	const shared_ptr<M>& Controller<M, V, C>::model()
-	{
-		if (!_model) {
-			_model.reset(new M);
-		}
-		return _model;
-	}
-
 
 #pragma mark - Template Instantiation
 
@@ -106,6 +106,27 @@ namespace ac {
 		// IMPORTANT: can be called several times without repercussions!
 //		virtual void loadConfig(shared_ptr<C> config) = 0;
 	};
+
+
+	// in here, so that a model can be had without the views (view() is defined in MVC.cpp, with the views)
+	template<class M, class V, class C>
+	const shared_ptr<M>& Controller<M, V, C>::model()
+	{
+		if (!_model) {
+			_model.reset(new M);
+		}
+		return _model;
+	}
+
+
+#if AC_HEADLESS
+	// the headless build has no views to create
+	template<class M, class V, class C>
+	V *Controller<M, V, C>::view()
+	{
+		return nullptr;
+	}
+#endif
 	
 	
 
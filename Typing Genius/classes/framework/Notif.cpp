@@ -7,54 +7,494 @@
 //
 
 #include "Notif.h"
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
 #include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace ac {
-	
+
+#pragma mark - Topic Registry
+
+	// Subscriber lists are copy-on-write: send() reads the current list without locking, and (un)subscribing builds
+	// a new list under the mutex. Old lists and disconnected slots are kept in 'retired' until no send() is running,
+	// since a callback may unsubscribe (itself or others) while its topic is still being dispatched.
+	struct TopicSlot
+	{
+		TopicSlot(unsigned id, const notif_slot_t &func) : id(id), func(func), connected(true) {}
+
+		unsigned id;
+		notif_slot_t func;
+		std::atomic<bool> connected;
+	};
+
+	typedef std::vector<TopicSlot *> slot_list_t;
+
+	const size_t MaxTopics = 1024;
+
+	class TopicRegistry
+	{
+	public:
+
+		TopicRegistry() : legacySubscriberCount(0), topicCount(0), nextSlotId(1), ongoingSends(0)
+		{
+			for (auto &subscribers : topicSubscribers) {
+				subscribers = nullptr;
+			}
+#define AC_NOTIF_TOPIC_INTERN(name) intern(#name);
+			AC_NOTIF_TOPICS(AC_NOTIF_TOPIC_INTERN)
+#undef AC_NOTIF_TOPIC_INTERN
+		}
+
+		~TopicRegistry()
+		{
+			for (const auto &topic : topicSubscribers) {
+				const slot_list_t *subscribers = topic.load();
+				if (subscribers) {
+					for (TopicSlot *slot : *subscribers) delete slot;
+					delete subscribers;
+				}
+			}
+			freeRetired();
+		}
+
+		notif_topic_t intern(const string &code)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			auto it = topicIds.find(code);
+			if (it != topicIds.end()) {
+				return it->second;
+			}
+
+			const unsigned topic = topicCount.load();
+			if (topic >= MaxTopics) {
+				throw std::length_error("Notif: too many topics");
+			}
+			topicNames[topic] = code;
+			topicIds[code] = (notif_topic_t) topic;
+			topicCount.store(topic + 1);
+			return (notif_topic_t) topic;
+		}
+
+		const string &name(notif_topic_t topic) const
+		{
+			static const string Unknown;
+			return topic < topicCount.load() ? topicNames[topic] : Unknown;
+		}
+
+		void dispatch(notif_topic_t topic, const NotifData &data)
+		{
+			if (topic >= topicCount.load()) return;
+
+			OngoingSend scope(ongoingSends);
+			const slot_list_t *subscribers = topicSubscribers[topic].load();
+			if (subscribers) {
+				for (TopicSlot *slot : *subscribers) {
+					if (slot->connected.load(std::memory_order_relaxed)) {
+						slot->func(topic, data);
+					}
+				}
+			}
+		}
+
+		NotifSubscription add(notif_topic_t topic, const notif_slot_t &func)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			if (topic >= topicCount.load()) {
+				throw std::out_of_range("Notif: subscribing to a topic that was never interned");
+			}
+
+			TopicSlot *slot = new TopicSlot(nextSlotId++, func);
+			const slot_list_t *current = topicSubscribers[topic].load();
+			slot_list_t *replacement = current ? new slot_list_t(*current) : new slot_list_t;
+			replacement->push_back(slot);
+			publish(topic, replacement);
+
+			return { topic, slot->id };
+		}
+
+		void remove(const NotifSubscription &subscription)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			if (subscription.topic >= topicCount.load()) return;
+
+			const slot_list_t *current = topicSubscribers[subscription.topic].load();
+			if (!current) return;
+
+			slot_list_t *replacement = new slot_list_t;
+			replacement->reserve(current->size());
+			for (TopicSlot *slot : *current) {
+				if (slot->id == subscription.id) {
+					slot->connected = false;
+					retiredSlots.push_back(slot);
+				} else {
+					replacement->push_back(slot);
+				}
+			}
+			publish(subscription.topic, replacement);
+		}
+
+		void removeAll()
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			for (notif_topic_t topic = 0; topic < topicCount.load(); topic++) {
+				const slot_list_t *current = topicSubscribers[topic].load();
+				if (!current) continue;
+				for (TopicSlot *slot : *current) {
+					slot->connected = false;
+					retiredSlots.push_back(slot);
+				}
+				publish(topic, nullptr);
+			}
+		}
+
+		// over-approximates; only used to skip the legacy signal when nobody could be listening on it
+		std::atomic<int> legacySubscriberCount;
+
+	private:
+
+		struct OngoingSend
+		{
+			OngoingSend(std::atomic<int> &counter) : counter(counter) { counter++; }
+			~OngoingSend() { counter--; }
+			std::atomic<int> &counter;
+		};
+
+		// expects the mutex to be held
+		void publish(notif_topic_t topic, slot_list_t *replacement)
+		{
+			const slot_list_t *old = topicSubscribers[topic].exchange(replacement);
+			if (old) retiredLists.push_back(old);
+			if (ongoingSends.load() == 0) {
+				freeRetired();
+			}
+		}
+
+		void freeRetired()
+		{
+			for (const slot_list_t *list : retiredLists) delete list;
+			for (TopicSlot *slot : retiredSlots) delete slot;
+			retiredLists.clear();
+			retiredSlots.clear();
+		}
+
+		boost::mutex mutex;
+
+		std::unordered_map<string, notif_topic_t> topicIds;
+		string topicNames[MaxTopics];
+		std::atomic<const slot_list_t *> topicSubscribers[MaxTopics];
+		std::atomic<unsigned> topicCount;
+
+		unsigned nextSlotId;
+		std::atomic<int> ongoingSends;
+
+		std::vector<const slot_list_t *> retiredLists;
+		std::vector<TopicSlot *> retiredSlots;
+	};
+
+
+	static TopicRegistry &registry()
+	{
+		static TopicRegistry instance;
+		return instance;
+	}
+
+
+#pragma mark - Deferred Queue
+
+	// Bounded multi-producer, single-consumer ring (after Dmitry Vyukov's bounded MPMC queue). Each cell carries a
+	// sequence number telling producers and the consumer whose turn it is, so neither side takes a lock.
+	struct DeferredNotif
+	{
+		notif_topic_t topic;
+		const void *type;
+		size_t payloadSize;
+		alignas(std::max_align_t) char payload[Notif::MaxDeferredPayloadSize];
+	};
+
+	class DeferredQueue
+	{
+	public:
+
+		static const size_t Capacity = 1024; // power of two
+
+		DeferredQueue() : enabled(false), overflowReported(false), frameEvents(Capacity), enqueuePos(0), dequeuePos(0)
+		{
+			for (size_t i = 0; i < Capacity; i++) {
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+			for (auto &flag : coalesced) flag = false;
+		}
+
+		// false if the ring is full
+		bool push(notif_topic_t topic, const void *payload, size_t payloadSize, const void *type)
+		{
+			size_t pos = enqueuePos.load(std::memory_order_relaxed);
+			Cell *cell;
+			for (;;) {
+				cell = &cells[pos & (Capacity - 1)];
+				const size_t seq = cell->sequence.load(std::memory_order_acquire);
+				const intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+				if (diff == 0) {
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				} else if (diff < 0) {
+					return false;
+				} else {
+					pos = enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->notif.topic = topic;
+			cell->notif.type = type;
+			cell->notif.payloadSize = payloadSize;
+			if (payloadSize) std::memcpy(cell->notif.payload, payload, payloadSize);
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer side only
+		bool pop(DeferredNotif &out)
+		{
+			const size_t pos = dequeuePos;
+			Cell &cell = cells[pos & (Capacity - 1)];
+			if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+				return false;
+			}
+			out = cell.notif;
+			cell.sequence.store(pos + Capacity, std::memory_order_release);
+			dequeuePos = pos + 1;
+			return true;
+		}
+
+		// Takes everything queued so far out of the ring and marks which entries survive coalescing. Consumer only.
+		size_t collectFrame()
+		{
+			size_t count = 0;
+			while (count < Capacity && pop(frameEvents[count])) {
+				const notif_topic_t topic = frameEvents[count].topic;
+				if (coalesced[topic]) {
+					lastSeenIndex[topic] = count;
+				}
+				count++;
+			}
+			return count;
+		}
+
+		inline bool survivesCoalescing(size_t index) const
+		{
+			const notif_topic_t topic = frameEvents[index].topic;
+			return !coalesced[topic] || lastSeenIndex[topic] == index;
+		}
+
+		std::atomic<bool> enabled;
+		std::atomic<bool> overflowReported; // warn once per drain, not once per overflowing post
+		bool coalesced[MaxTopics];
+		std::vector<DeferredNotif> frameEvents;
+
+	private:
+
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			DeferredNotif notif;
+		};
+
+		Cell cells[Capacity];
+		alignas(64) std::atomic<size_t> enqueuePos;
+		alignas(64) size_t dequeuePos;
+
+		size_t lastSeenIndex[MaxTopics];
+	};
+
+
+	static DeferredQueue &deferredQueue()
+	{
+		static DeferredQueue instance;
+		return instance;
+	}
+
+
 #pragma mark - Notif
-	
+
 	static signal_t NotificationSignal;
-	
+
+
+	notif_topic_t Notif::topic(const string &code)
+	{
+		return registry().intern(code);
+	}
+
+
+	const string &Notif::topicName(notif_topic_t topic)
+	{
+		return registry().name(topic);
+	}
+
+
+	void Notif::send(notif_topic_t topic, const NotifData &data)
+	{
+		TopicRegistry &r(registry());
+		r.dispatch(topic, data);
+
+		if (r.legacySubscriberCount.load(std::memory_order_relaxed) > 0) {
+			NotificationSignal(r.name(topic), data.toShared());
+		}
+	}
+
+
 	void Notif::send(const string &notifCode, std::shared_ptr<void> data)
 	{
-		NotificationSignal(notifCode, data);
+		TopicRegistry &r(registry());
+		r.dispatch(r.intern(notifCode), NotifData(data));
+
+		if (r.legacySubscriberCount.load(std::memory_order_relaxed) > 0) {
+			NotificationSignal(notifCode, data);
+		}
 	}
-	
-	
+
+
 	sign_conn_t Notif::subscribe(const signal_t::slot_type &func)
 	{
+		registry().legacySubscriberCount++;
 		return NotificationSignal.connect(func);
 	}
-	
-	
+
+
+	void Notif::unsubscribe(sign_conn_t &conn)
+	{
+		if (conn.connected()) {
+			conn.disconnect();
+			registry().legacySubscriberCount--;
+		}
+	}
+
+
+	NotifSubscription Notif::subscribe(notif_topic_t topic, const notif_slot_t &func)
+	{
+		return registry().add(topic, func);
+	}
+
+
+	void Notif::unsubscribe(const NotifSubscription &subscription)
+	{
+		registry().remove(subscription);
+	}
+
+
 	void Notif::unsubscribeAll()
 	{
 		NotificationSignal.disconnect_all_slots();
+		registry().legacySubscriberCount = 0;
+		registry().removeAll();
 	}
-	
-	
+
+
+	void Notif::post(notif_topic_t topic)
+	{
+		post(topic, NotifData(), 0);
+	}
+
+
+	void Notif::post(notif_topic_t topic, const NotifData &data, size_t payloadSize)
+	{
+		DeferredQueue &q(deferredQueue());
+		if (!q.enabled.load(std::memory_order_relaxed)) {
+			send(topic, data);
+			return;
+		}
+
+		if (!q.push(topic, data.ptr, payloadSize, data.type)) {
+			if (!q.overflowReported.exchange(true, std::memory_order_relaxed)) {
+				LogW << "Notif: deferred queue is full, sending " << topicName(topic) << " right away";
+			}
+			send(topic, data);
+		}
+	}
+
+
+	void Notif::setDeferredDispatch(bool enabled)
+	{
+		deferredQueue().enabled = enabled;
+		if (!enabled) {
+			dispatchDeferred(); // don't strand anything already queued
+		}
+	}
+
+
+	bool Notif::isDeferredDispatchEnabled()
+	{
+		return deferredQueue().enabled;
+	}
+
+
+	void Notif::setCoalesced(notif_topic_t topic, bool coalesced)
+	{
+		if (topic < MaxTopics) {
+			deferredQueue().coalesced[topic] = coalesced;
+		}
+	}
+
+
+	size_t Notif::dispatchDeferred()
+	{
+		DeferredQueue &q(deferredQueue());
+		const size_t count = q.collectFrame();
+		q.overflowReported.store(false, std::memory_order_relaxed);
+
+		size_t sent = 0;
+		for (size_t i = 0; i < count; i++) {
+			if (q.survivesCoalescing(i)) {
+				const DeferredNotif &notif(q.frameEvents[i]);
+				send(notif.topic, NotifData(notif.payloadSize ? notif.payload : nullptr, notif.type));
+				sent++;
+			}
+		}
+		return sent;
+	}
+
+
 #pragma mark - NotifListener
-	
+
 	NotifListener::NotifListener() : notifConn()
 	{
 		this->notifConn = Notif::subscribe(boost::bind(&NotifListener::handleNotif, this, _1, _2));
 	}
-	
-	
+
+
 	NotifListener::~NotifListener()
 	{
-		this->notifConn.disconnect();
+		Notif::unsubscribe(this->notifConn);
+		for (const auto &subscription : this->topicSubscriptions) {
+			Notif::unsubscribe(subscription);
+		}
+	}
+
+
+	void NotifListener::listenTo(std::initializer_list<notif_topic_t> topics)
+	{
+		Notif::unsubscribe(this->notifConn);
+		for (notif_topic_t topic : topics) {
+			this->topicSubscriptions.push_back(
+				Notif::subscribe(topic, boost::bind(&NotifListener::topicCallback, this, _1, _2)));
+		}
 	}
-	
-	
+
+
 	void NotifListener::handleNotif(const string &code, std::shared_ptr<void> data)
 	{
 		this->notifCallback(code, data);
 	}
-	
-	
+
+
 	void NotifListener::notifCallback(const string &, std::shared_ptr<void> data)
 	{
 		// std::cout << "[NL] notification handled!" << std::endl;
 	}
-}
\ No newline at end of file
+
+
+	void NotifListener::topicCallback(notif_topic_t topic, const NotifData &data)
+	{
+		this->notifCallback(Notif::topicName(topic), data.toShared());
+	}
+}
@@ -10,47 +10,174 @@
 #define __Typing_Genius__Notif__
 
 #include <iostream>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
 #include <boost/signals2.hpp>
 #include <boost/function.hpp>
+#include "NotifTopics.h"
 
 namespace ac {
 
 	using std::string;
 	using boost::signals2::connection;
 	using boost::signals2::signal;
-	
+
 	typedef connection sign_conn_t;
-	
+
 	typedef signal<void(const string &, std::shared_ptr<void> data)> signal_t;
-	
+
+
+	// Payload passed along with a topic. Typed sends point at the sender's own (usually stack) object, so nothing is
+	// allocated and the pointer is only valid for the duration of the callback: copy out what you need to keep.
+	class NotifData
+	{
+	public:
+
+		NotifData() : ptr(nullptr), type(nullptr) {}
+
+		template <typename T>
+		explicit NotifData(const T &value) : ptr(&value), type(typeTag<T>()) {}
+
+		// for the string-based Notif::send; the payload type is not known so get() doesn't check it
+		explicit NotifData(const std::shared_ptr<void> &data) : ptr(data.get()), type(nullptr), owner(data) {}
+
+		// returns nullptr if there is no payload, or if it was sent as a different type
+		template <typename T>
+		const T *get() const
+		{
+			if (type && type != typeTag<T>()) return nullptr;
+			return static_cast<const T *>(ptr);
+		}
+
+		// for legacy listeners. Does not allocate; for typed payloads the pointer doesn't own anything.
+		std::shared_ptr<void> toShared() const
+		{
+			if (owner || !ptr) return owner;
+			return std::shared_ptr<void>(std::shared_ptr<void>(), const_cast<void *>(ptr));
+		}
+
+	private:
+
+		friend class Notif;
+
+		NotifData(const void *ptr, const void *type) : ptr(ptr), type(type) {}
+
+		template <typename T>
+		static const void *typeTag()
+		{
+			static const char tag = 0;
+			return &tag;
+		}
+
+		const void *ptr;
+		const void *type;
+		std::shared_ptr<void> owner;
+	};
+
+
+	typedef boost::function<void(notif_topic_t, const NotifData &)> notif_slot_t;
+
+	struct NotifSubscription
+	{
+		notif_topic_t topic;
+		unsigned id; // 0 is never handed out
+	};
+
+
 	class Notif
 	{
 	public:
 
+		// Interns the code, returning its compact id. Predefined codes (NotifTopics.h) can be used directly instead.
+		static notif_topic_t topic(const string &code);
+
+		static const string &topicName(notif_topic_t topic);
+
+		// Only subscribers of the topic are called (plus legacy catch-all subscribers, if any).
+		static void send(notif_topic_t topic, const NotifData &data = NotifData());
+
+		template <typename T>
+		static void send(notif_topic_t topic, const T &payload)
+		{
+			send(topic, NotifData(payload));
+		}
+
+		// legacy entry point; interns the code on every call, so prefer the topic-based overloads in hot paths.
 		static void send(const string &code, std::shared_ptr<void> data = nullptr);
-		
+
 		// subscribers keep the return values and use it to unsubscribe (calling conn.disconnect() on it)
-		// Children of NotifListener, which include Model and View classes, already call this.
+		// This receives every notification sent, regardless of topic.
 		static sign_conn_t subscribe(const signal_t::slot_type &func);
-		
+
+		static void unsubscribe(sign_conn_t &conn);
+
+		static NotifSubscription subscribe(notif_topic_t topic, const notif_slot_t &func);
+
+		static void unsubscribe(const NotifSubscription &subscription);
+
 		static void unsubscribeAll();
+
+
+		// Deferred sends. While deferred dispatch is on, these are queued (from any thread) and delivered in order by
+		// dispatchDeferred(), which the app calls once per frame; while it's off they're sent right away. Payloads are
+		// copied into the queue, so they have to be small and trivially copyable.
+		static const size_t MaxDeferredPayloadSize = 32;
+
+		static void post(notif_topic_t topic);
+
+		template <typename T>
+		static void post(notif_topic_t topic, const T &payload)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "deferred payloads are copied byte for byte");
+			static_assert(sizeof(T) <= MaxDeferredPayloadSize, "deferred payload too large");
+			post(topic, NotifData(payload), sizeof(T));
+		}
+
+		static void setDeferredDispatch(bool enabled);
+
+		static bool isDeferredDispatchEnabled();
+
+		// Of the posts of a coalesced topic queued in one frame, only the last is delivered (at its position in the
+		// queue). Meant for "state changed, go look" events whose receivers read the current state anyway.
+		static void setCoalesced(notif_topic_t topic, bool coalesced = true);
+
+		// Delivers what was queued before the call, returning the number of notifications actually sent. Posts made
+		// by the callbacks wait for the next call. Must always be called from the same thread, and not from a callback.
+		static size_t dispatchDeferred();
+
+	private:
+
+		static void post(notif_topic_t topic, const NotifData &data, size_t payloadSize);
 	};
-	
-	
+
+
 	class NotifListener
 	{
 	public:
-		
+
 		NotifListener();
 		virtual ~NotifListener() = 0; // pure virtual
-		
+
 		void handleNotif(const string &, std::shared_ptr<void> data);
-		
+
 		virtual void notifCallback(const string &, std::shared_ptr<void> data);
-	
+
+		// Called for the topics passed to listenTo(). By default it forwards to the string-based notifCallback, which
+		// is what listeners that never call listenTo() receive (every notification, by code).
+		virtual void topicCallback(notif_topic_t topic, const NotifData &data);
+
+	protected:
+
+		// Restricts this listener to the given topics, so it no longer sees every notification. Call it from the
+		// constructor of the subclass.
+		void listenTo(std::initializer_list<notif_topic_t> topics);
+
 	private:
 		sign_conn_t notifConn;
-		
+
+		std::vector<NotifSubscription> topicSubscriptions;
+
 	};
 
 }
@@ -0,0 +1,107 @@
+//
+//  NotifTopics.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/5/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Every notification code known at compile time. The registry interns these in this exact order on first use, so
+//	the enum value of each entry is also its topic id and can be used directly in a switch statement. Codes not listed
+//	here (e.g. ones made up by tests) are still accepted by Notif::topic() and get ids from NumberOfPredefinedTopics up.
+
+#ifndef __Typing_Genius__NotifTopics__
+#define __Typing_Genius__NotifTopics__
+
+#define AC_NOTIF_TOPICS(X) \
+	X(AppDelegate_FinishLaunch) \
+	X(AppDelegate_EnteredBackground) \
+	X(AppDelegate_EnteringForeground) \
+	\
+	X(BlockCanvasModel_Advance) \
+	X(BlockCanvasModel_AdvanceWithSpace) \
+	X(BlockCanvasModel_CurrencyCollected) \
+	X(BlockCanvasModel_DoneAnimation) \
+	X(BlockCanvasModel_EndTimer) \
+	X(BlockCanvasModel_Highlight) \
+	X(BlockCanvasModel_Load) \
+	X(BlockCanvasModel_Mistake) \
+	X(BlockCanvasModel_PerBlockScoreDelta) \
+	\
+	X(BlockCanvasView_EncasementDowngraded) \
+	X(BlockCanvasView_FinishedPopAnimation) \
+	X(BlockCanvasView_ObstructionRemoved) \
+	\
+	X(CopyText_Advance) \
+	X(CopyText_AdvanceWithSpace) \
+	X(CopyText_AllCleared) \
+	X(CopyText_Blocked) \
+	X(CopyText_ClearedString) \
+	X(CopyText_FirstPress) \
+	X(CopyText_LoadedString) \
+	X(CopyText_Mistake) \
+	X(CopyText_Preadvance) \
+	X(CopyText_TriggerAltKey) \
+	\
+	X(GameState_Timer_AddTime) \
+	X(GameState_Timer_DeductTime) \
+	X(GameState_Timer_StartTimer) \
+	X(GameState_Timer_StopTimer) \
+	\
+	X(KeyboardModel_AltModeToggled) \
+	X(KeyboardModel_NewLevel) \
+	X(KeyboardView_KeyPress) \
+	\
+	X(KeypressTracker_ModKeyPressed) \
+	X(KeypressTracker_ModKeyReleased) \
+	X(KeypressTracker_RequiresUIRefresh) \
+	\
+	X(MainLayer_AddTime) \
+	\
+	X(ScoreKeeper_LevelProgressUpdate) \
+	X(ScoreKeeper_Mistake) \
+	X(ScoreKeeper_NewLevelUpdate) \
+	X(ScoreKeeper_PostGameAccuracyBonus) \
+	X(ScoreKeeper_PostGameTimeRemainingBonus) \
+	X(ScoreKeeper_Score) \
+	X(ScoreKeeper_StreakFinished) \
+	\
+	X(StatsHUDModel_AddTime) \
+	X(StatsHUDModel_AllCleared) \
+	X(StatsHUDModel_Blocked) \
+	X(StatsHUDModel_CurrencyCollected) \
+	X(StatsHUDModel_CurrencyConsumed) \
+	X(StatsHUDModel_EndTimer) \
+	X(StatsHUDModel_LevelProgressUpdate) \
+	X(StatsHUDModel_Mistake) \
+	X(StatsHUDModel_NewLevel) \
+	X(StatsHUDModel_ScoreOrAccuracyUpdate) \
+	X(StatsHUDModel_SetNumberOfCharsTyped) \
+	X(StatsHUDModel_SetNumberOfMistakes) \
+	X(StatsHUDModel_StartTimer) \
+	X(StatsHUDModel_StreakFinished) \
+	X(StatsHUDModel_UpdateProgress) \
+	\
+	X(StatsHUDView_PostGameSubheadlineShown) \
+	X(StatsHUDView_TimerExpired)
+
+
+namespace ac {
+
+	typedef unsigned short notif_topic_t;
+
+	namespace notif {
+
+#define AC_NOTIF_TOPIC_ENUM(name) name,
+
+		enum Topic : notif_topic_t
+		{
+			AC_NOTIF_TOPICS(AC_NOTIF_TOPIC_ENUM)
+			NumberOfPredefinedTopics
+		};
+
+#undef AC_NOTIF_TOPIC_ENUM
+
+	}
+}
+
+#endif /* defined(__Typing_Genius__NotifTopics__) */
@@ -67,10 +67,16 @@ namespace ac
 		TouchCancelled
 	};
 	
+	// a key label's number in the KeyRegistry
+	typedef uint16_t KeyID;
+	const KeyID InvalidKeyID = UINT16_MAX; // no key (the touch was between keys, or off the keyboard)
+
+	// plain data, so it can go through the keypress ring
 	struct KeyEvent
 	{
-		std::string key;
+		KeyID key;
 		TouchType type;
+		uint64_t timestamp; // microseconds on the steady clock, when the touch was tracked
 	};
 	
 
@@ -0,0 +1,90 @@
+//
+//  AliasTable.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/14/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Walker's alias method: after an O(n) build, draws from a discrete distribution over 0..n-1 in constant time,
+//	with two numbers from the engine and no allocation.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ac {
+
+	class AliasTable
+	{
+	public:
+		AliasTable() {}
+
+		// weights don't have to sum to anything; negative ones count as zero. If every weight is zero the
+		// distribution is uniform.
+		explicit AliasTable(const std::vector<double> &weights) { build(weights.data(), weights.size()); }
+
+		void build(const double *weights, size_t n)
+		{
+			chances.assign(n, 1.0);
+			aliases.resize(n);
+			for (size_t i = 0; i < n; i++) aliases[i] = (uint32_t) i;
+			if (n == 0) return;
+
+			double total = 0;
+			for (size_t i = 0; i < n; i++) {
+				if (weights[i] > 0) total += weights[i];
+			}
+			if (total <= 0) return;
+
+			// scaled so the average column holds exactly 1
+			std::vector<double> scaled(n);
+			std::vector<uint32_t> small, large;
+			for (size_t i = 0; i < n; i++) {
+				scaled[i] = (weights[i] > 0 ? weights[i] : 0) * n / total;
+				(scaled[i] < 1.0 ? small : large).push_back((uint32_t) i);
+			}
+
+			while (!small.empty() && !large.empty()) {
+				const uint32_t s = small.back(), l = large.back();
+				small.pop_back();
+				chances[s] = scaled[s];
+				aliases[s] = l;
+				scaled[l] -= 1.0 - scaled[s];
+				if (scaled[l] < 1.0) {
+					large.pop_back();
+					small.push_back(l);
+				}
+			}
+			// whatever is left over is 1 give or take rounding: those columns never use their alias
+			for (uint32_t i : small) chances[i] = 1.0;
+			for (uint32_t i : large) chances[i] = 1.0;
+		}
+
+		inline size_t size() const { return chances.size(); }
+
+		// Engine has to return 32 random bits per call (Random and boost::random::mt19937 do). Must not be empty.
+		template <typename Engine>
+		inline size_t sample(Engine &engine) const
+		{
+			const uint32_t column = (uint32_t) (((uint64_t) (uint32_t) engine() * chances.size()) >> 32);
+			const double r = (uint32_t) engine() * (1.0 / 4294967296.0); // [0..1)
+			return r < chances[column] ? column : aliases[column];
+		}
+
+		// for tests: the probability of drawing i
+		double probability(size_t i) const
+		{
+			double p = 0;
+			for (size_t c = 0; c < chances.size(); c++) {
+				if (c == i) p += chances[c];
+				if (aliases[c] == i && c != i) p += 1.0 - chances[c];
+			}
+			return chances.empty() ? 0 : p / chances.size();
+		}
+
+	private:
+		std::vector<double> chances; // of a column drawing itself rather than its alias
+		std::vector<uint32_t> aliases;
+	};
+}
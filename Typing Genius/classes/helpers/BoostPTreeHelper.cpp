@@ -9,6 +9,8 @@
 
 #include "BoostPTreeHelper.h"
 #include "Utilities.h"
+#include <fstream>
+#include <sstream>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
@@ -23,15 +25,51 @@ namespace ac {
 			
 			bool hasError = false;
 			try {
-				read_json(fullPath, pt);
+				readJSONWithComments(fullPath, pt);
 			} catch (const json_parser_error &obj) {
 				LogE << "Problem reading configuration file: " << obj.what();
 				hasError = true;
 			}
 			return pt;
 		}
-		
-		
 
+
+		void readJSONWithComments(const string &path, PropTree &pt)
+		{
+			std::ifstream file(path.c_str());
+			if (!file) {
+				throw json_parser_error("cannot open file", path, 0);
+			}
+			const string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+			// comments become spaces (newlines are kept, so errors still point at the right line)
+			string stripped(json);
+			bool inString = false;
+			for (size_t i = 0; i < json.size(); i++) {
+				const char c = json[i];
+				const char next = i + 1 < json.size() ? json[i + 1] : '\0';
+				if (inString) {
+					if (c == '\\') {
+						i++;
+					} else if (c == '"') {
+						inString = false;
+					}
+				} else if (c == '"') {
+					inString = true;
+				} else if (c == '/' && next == '/') {
+					for (; i < json.size() && json[i] != '\n'; i++) stripped[i] = ' ';
+				} else if (c == '/' && next == '*') {
+					const size_t end = json.find("*/", i + 2);
+					const size_t stop = end == string::npos ? json.size() : end + 2;
+					for (; i < stop; i++) {
+						if (json[i] != '\n') stripped[i] = ' ';
+					}
+					i--;
+				}
+			}
+
+			std::istringstream is(stripped);
+			read_json(is, pt);
+		}
 	}
 }
\ No newline at end of file
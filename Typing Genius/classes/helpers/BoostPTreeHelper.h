@@ -23,5 +23,9 @@ namespace ac {
 		
 		// if PropTree has error, pt.empty() is true
 		PropTree getPropertyTreeFromJSONFileBundle(const string &filename);
+
+		// Like read_json, but takes the // and /* */ comments in our configuration files, which Boost's JSON parser
+		// stopped accepting in 1.59. Throws json_parser_error.
+		void readJSONWithComments(const string &path, PropTree &pt);
 	}
 }
\ No newline at end of file
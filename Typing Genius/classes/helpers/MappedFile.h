@@ -0,0 +1,62 @@
+//
+//  MappedFile.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/12/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Read-only memory mapping of a whole file, unmapped on destruction or on the next map().
+
+#pragma once
+
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ac {
+
+	class MappedFile
+	{
+	public:
+		MappedFile() : data(nullptr), length(0) {}
+		~MappedFile() { unmap(); }
+
+		// false if the file can't be opened, or is empty
+		bool map(const std::string &path)
+		{
+			unmap();
+			const int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) return false;
+
+			struct stat info;
+			if (fstat(fd, &info) == 0 && info.st_size > 0) {
+				void *p = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED) {
+					data = static_cast<const char *>(p);
+					length = (size_t) info.st_size;
+				}
+			}
+			close(fd); // the mapping stays valid without the descriptor
+			return data != nullptr;
+		}
+
+		void unmap()
+		{
+			if (data) munmap(const_cast<char *>(data), length);
+			data = nullptr;
+			length = 0;
+		}
+
+		inline bool isMapped() const { return data != nullptr; }
+
+		const char *data;
+		size_t length;
+
+	private:
+		// noncopyable
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+	};
+}
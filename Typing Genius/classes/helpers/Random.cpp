@@ -0,0 +1,38 @@
+//
+//  Random.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/15/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "Random.h"
+#include <chrono>
+
+namespace ac {
+
+	RandomService &RandomService::getInstance()
+	{
+		static RandomService instance;
+		return instance;
+	}
+
+
+	RandomService::RandomService()
+	{
+		// not meant to be unpredictable, only different from one launch to the next
+		seed((uint64_t) std::chrono::system_clock::now().time_since_epoch().count());
+	}
+
+
+	void RandomService::seed(uint64_t seed)
+	{
+		masterSeed = seed;
+
+		// each stream gets its own seed drawn from the master seed, so streams stay unrelated to each other
+		Random seeder(seed);
+		for (Random &stream : streams) {
+			stream.seed(seeder.next64());
+		}
+	}
+}
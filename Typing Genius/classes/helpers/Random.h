@@ -0,0 +1,131 @@
+//
+//  Random.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/15/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Random number engine (xoshiro128**) and the app-wide service that hands out one independently seeded engine per
+//	subsystem, so that what one part of the game draws doesn't change what another gets: with the same seed the same
+//	copy string, obstructions and encasements come out no matter how often colors were picked in between.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ac {
+
+	// Small and fast, with 128 bits of state. Also satisfies the requirements of a boost/std random engine (32 bits
+	// per call), so the boost distributions can draw from it.
+	class Random
+	{
+	public:
+		typedef uint32_t result_type;
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return UINT32_MAX; }
+
+		explicit Random(uint64_t seed = 0) { this->seed(seed); }
+
+		// any value is fine, including 0
+		void seed(uint64_t seed)
+		{
+			for (int i = 0; i < 4; i += 2) {
+				const uint64_t mixed = splitMix(seed);
+				state[i] = (uint32_t) mixed;
+				state[i + 1] = (uint32_t) (mixed >> 32);
+			}
+		}
+
+		inline result_type operator()()
+		{
+			const uint32_t result = rotl(state[1] * 5, 7) * 9;
+			const uint32_t t = state[1] << 9;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotl(state[3], 11);
+			return result;
+		}
+
+		inline uint64_t next64() { return (uint64_t) (*this)() << 32 | (*this)(); }
+
+		// [0..1)
+		inline double nextDouble() { return (*this)() * (1.0 / 4294967296.0); }
+
+		inline bool chance(double probability) { return nextDouble() < probability; }
+
+		// 0 to max, inclusive (like utilities::random)
+		inline uint32_t upTo(uint32_t max)
+		{
+			if (max == UINT32_MAX) return (*this)();
+			// Lemire's multiply and shift, rejecting the few values that would make low results more likely
+			const uint64_t range = (uint64_t) max + 1;
+			uint64_t m = (uint64_t) (*this)() * range;
+			if ((uint32_t) m < range) {
+				const uint32_t threshold = (uint32_t) ((0x100000000ull - range) % range);
+				while ((uint32_t) m < threshold) {
+					m = (uint64_t) (*this)() * range;
+				}
+			}
+			return (uint32_t) (m >> 32);
+		}
+
+		inline float between(float min, float max) { return min + (float) nextDouble() * (max - min); }
+
+	private:
+		static inline uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+		static inline uint64_t splitMix(uint64_t &x)
+		{
+			uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		uint32_t state[4];
+	};
+
+
+	enum class RandomStream : uint8_t
+	{
+		General,		// utilities::random, randomChance, randomFloat
+		CopyText,		// GlyphString::generateRandom
+		Obstructions,
+		Encasements,
+		Colors			// utilities::randomRGBByte
+	};
+
+	const size_t NumberOfRandomStreams = 5;
+
+
+	// Not thread safe: draw from the main thread only (or keep a Random of your own).
+	class RandomService
+	{
+	public:
+		static RandomService &getInstance(); // singleton getter
+
+		static inline Random &get(RandomStream stream) { return getInstance().stream(stream); }
+
+		// Restarts every stream from the one seed. Until this is called the seed comes from the clock.
+		void seed(uint64_t seed);
+
+		inline uint64_t getSeed() const { return masterSeed; }
+
+		inline Random &stream(RandomStream stream) { return streams[(size_t) stream]; }
+
+	private:
+		RandomService();
+
+		// noncopyable
+		RandomService(const RandomService &);
+		RandomService &operator=(const RandomService &);
+
+		uint64_t masterSeed;
+		Random streams[NumberOfRandomStreams];
+	};
+}
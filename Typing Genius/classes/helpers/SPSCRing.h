@@ -0,0 +1,75 @@
+//
+//  SPSCRing.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Fixed-capacity queue for exactly one producer thread and one consumer thread (which may be the same). Neither side
+//	takes a lock or allocates: the elements live in the ring itself, and each side only writes its own index.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace ac {
+
+	template <typename T, size_t Capacity>
+	class SPSCRing
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity has to be a power of two");
+		static_assert(std::is_trivially_copyable<T>::value, "elements are copied in and out byte for byte");
+
+	public:
+		SPSCRing() : head(0), tail(0) {}
+
+		// producer only. False (and nothing is written) if the ring is full.
+		bool push(const T &element)
+		{
+			const size_t t = tail.load(std::memory_order_relaxed);
+			if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+			elements[t & (Capacity - 1)] = element;
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only. False if the ring is empty.
+		bool pop(T &element)
+		{
+			const size_t h = head.load(std::memory_order_relaxed);
+			if (h == tail.load(std::memory_order_acquire)) return false;
+			element = elements[h & (Capacity - 1)];
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only: drops everything pushed so far
+		void clear()
+		{
+			head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+		}
+
+		// exact on the consumer side; from anywhere else it may already be out of date
+		inline bool empty() const
+		{
+			return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+		}
+
+		inline size_t size() const
+		{
+			const size_t h = head.load(std::memory_order_acquire); // first, so it can't pass the tail read after it
+			return tail.load(std::memory_order_acquire) - h;
+		}
+
+		static inline size_t capacity() { return Capacity; }
+
+	private:
+		T elements[Capacity];
+
+		// kept on separate cache lines so the two sides don't keep stealing each other's line
+		alignas(64) std::atomic<size_t> head; // next to pop
+		alignas(64) std::atomic<size_t> tail; // next to push
+	};
+}
@@ -12,16 +12,16 @@ namespace ac
 {
 	namespace utilities
 	{
-		// note: using time(0) as seed is not cryptographically secure, so don't use this for
+		// note: the random streams are not cryptographically secure, so don't use them for
 		// similar purposes
 
 		const RGBByte randomRGBByte()
 		{
-			boost::random::uniform_int_distribution<> rUbyte(0,255); // give it something darker
+			Random &rng(RandomService::get(RandomStream::Colors));
 
-			unsigned char r = rUbyte(rng);
-			unsigned char g = rUbyte(rng);
-			unsigned char b = rUbyte(rng);
+			unsigned char r = rng.upTo(255);
+			unsigned char g = rng.upTo(255);
+			unsigned char b = rng.upTo(255);
 			
 			// LogD << "rgb(" << (int)r << "," << (int)g << "," << (int)b << ")";
 			return (RGBByte) { r, g, b };
@@ -149,15 +149,13 @@ namespace ac
 
 		const size_t random(size_t max)
 		{
-			boost::random::uniform_int_distribution<> rSizeT(0, max);
-			return rSizeT(rng);
+			Random &rng(RandomService::get(RandomStream::General));
+			return max > UINT32_MAX ? (size_t) (rng.next64() % (max + 1)) : rng.upTo((uint32_t) max);
 		}
 
 		const float randomFloat(float min, float max)
 		{
-			static boost::random::uniform_real_distribution<> randomFloat(0, 1);
-			float zeroToOne = randomFloat(utilities::rng); // random float bet. 0 & 1
-			return min + zeroToOne * (max - min);
+			return RandomService::get(RandomStream::General).between(min, max);
 		}
 
 
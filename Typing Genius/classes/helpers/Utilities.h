@@ -10,6 +10,7 @@
 
 #include "cocos2d.h"
 #include <boost/random.hpp>
+#include "Random.h"
 
 namespace ac {
 
@@ -17,8 +18,6 @@ namespace ac {
 		
 		using std::string;
 
-		static boost::random::mt19937 rng((const unsigned int)std::time(0));
-
 		struct RGBByte { unsigned char r; unsigned char g; unsigned char b; };
 
 
@@ -61,11 +60,10 @@ namespace ac {
 			return out;
 		}
 
+		// these draw from RandomStream::General
 		inline bool randomChance(float probability)
 		{
-			static boost::random::uniform_real_distribution<> rRepeatChance(0, 1); // results in a number between [0..1)
-			if (rRepeatChance(utilities::rng) < probability) return true;
-			return false;
+			return RandomService::get(RandomStream::General).chance(probability);
 		}
 
 
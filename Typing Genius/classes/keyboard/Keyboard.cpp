@@ -7,7 +7,9 @@
 //
 
 #include "Keyboard.h"
+#if !AC_HEADLESS
 #include "KeyboardView.h"
+#endif
 #include "KeyboardModel.h"
 #include "DefaultKeyboardConfiguration.h"
 #include "GameState.h"
@@ -87,8 +89,10 @@ namespace ac
 		deregisterSignals();
 		
 		this->setModel(nullptr);
-		
+
+#if !AC_HEADLESS
 		this->view()->release();
+#endif
 		this->setView(nullptr);
 		
 		pImpl->pConfig = nullptr;
@@ -0,0 +1,52 @@
+//
+//  KeyRegistry.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/17/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "KeyRegistry.h"
+#include "Utilities.h"
+
+namespace ac {
+
+	KeyRegistry &KeyRegistry::getInstance()
+	{
+		static KeyRegistry instance;
+		return instance;
+	}
+
+
+	KeyID KeyRegistry::intern(const string &label)
+	{
+		std::unordered_map<string, KeyID>::const_iterator it = ids.find(label);
+		if (it != ids.end()) {
+			return it->second;
+		}
+		if (labels.size() == InvalidKeyID) {
+			LogE << "Out of key IDs, can't register " << label;
+			return InvalidKeyID;
+		}
+
+		const KeyID key = (KeyID) labels.size();
+		labels.push_back(label);
+		modifiers.push_back(utilities::keyIsAModifier(label));
+		ids.insert(std::make_pair(label, key));
+		return key;
+	}
+
+
+	KeyID KeyRegistry::find(const string &label) const
+	{
+		std::unordered_map<string, KeyID>::const_iterator it = ids.find(label);
+		return it == ids.end() ? InvalidKeyID : it->second;
+	}
+
+
+	const string &KeyRegistry::label(KeyID key) const
+	{
+		static const string Empty;
+		return key < labels.size() ? labels[key] : Empty;
+	}
+}
@@ -0,0 +1,53 @@
+//
+//  KeyRegistry.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/17/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Hands out a small integer (KeyID) for every key label seen while loading the keyboard and glyph map configurations,
+//	numbered from 0 in the order they were first seen. IDs never change or get reused once given out, so lookup tables
+//	elsewhere can be plain arrays indexed by them, and a key press can be passed around without its label.
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ACTypes.h"
+
+namespace ac {
+
+	using std::string;
+
+	class KeyRegistry
+	{
+	public:
+		static KeyRegistry &getInstance();
+
+		// the label's ID, giving it the next one if it doesn't have one yet
+		KeyID intern(const string &label);
+
+		// InvalidKeyID for a label that was never interned
+		KeyID find(const string &label) const;
+
+		// "" for InvalidKeyID (or any other ID not given out)
+		const string &label(KeyID key) const;
+
+		// modifier keys are the ones labeled "mod:..." (see utilities::keyIsAModifier)
+		inline bool isModifier(KeyID key) const { return key < modifiers.size() && modifiers[key]; }
+
+		// every ID below this has been given out
+		inline size_t size() const { return labels.size(); }
+
+	private:
+		KeyRegistry() = default;
+		KeyRegistry(const KeyRegistry &) = delete;
+		KeyRegistry &operator=(const KeyRegistry &) = delete;
+
+		std::deque<string> labels; // deque, so label() references survive later interning
+		std::vector<bool> modifiers;
+		std::unordered_map<string, KeyID> ids;
+	};
+}
@@ -16,8 +16,8 @@
 #include "GameState.h"
 #include "Utilities.h"
 #include "ScoreKeeper.h"
-#include "KeyboardView.h"
 #include "Player.h"
+#include "KeyRegistry.h"
 
 namespace ac {
 	
@@ -30,8 +30,7 @@ namespace ac {
 	{
 		KeyboardModelImpl(KeyboardModel &kbModel) :
 		label(), description(), keysize(), keyboardSize(), printablesMap(), keyPositionsMap(),
-		keyAltGlyphCodes(), 	customKeySizes(), touchEventsConnection(), keyGlyphCodes(), kbModel(kbModel),
-		keyColores(), altMode(false)
+		customKeySizes(), touchEventsConnection(), kbModel(kbModel), keys(), altMode(false)
 		{
 			// LogD << "Inside KeyboardImpl constructor";
 		}
@@ -69,10 +68,27 @@ namespace ac {
 		
 		vector<string> keyLabels;
 
-		map<string, Glyph> keyGlyphCodes;
-		map<string, Glyph> keyAltGlyphCodes;
+		// what a key press needs to know about the key, indexed by KeyID
+		struct KeyEntry
+		{
+			bool hasGlyph, hasAltGlyph, hasColor;
+			Glyph glyph, altGlyph;
+			utilities::RGBByte color;
+		};
+		vector<KeyEntry> keys;
+
+		// the key's entry, growing the table if the label was only just registered
+		KeyEntry &entryForKey(KeyID key) {
+			if (key >= keys.size()) {
+				const KeyEntry blank = { false, false, false, Glyph(), Glyph(), { 0, 0, 0 } };
+				keys.resize(KeyRegistry::getInstance().size(), blank);
+			}
+			return keys[key];
+		}
 
-		map<string, utilities::RGBByte> keyColores;
+		inline const KeyEntry *findEntry(KeyID key) const {
+			return key < keys.size() ? &keys[key] : nullptr;
+		}
 		
 		sign_conn_t touchEventsConnection; // from KeyboardView
 
@@ -106,6 +122,14 @@ namespace ac {
 	{
 		pImpl.reset(new KeyboardModelImpl(*this));
 		LogD << "KeyboardModel constructor";
+
+		listenTo({
+			notif::KeyboardView_KeyPress,
+			notif::ScoreKeeper_NewLevelUpdate,
+			notif::KeypressTracker_ModKeyPressed,
+			notif::KeypressTracker_ModKeyReleased,
+			notif::CopyText_TriggerAltKey
+		});
 	}
 	
 	
@@ -151,7 +175,7 @@ namespace ac {
 	{
 		pImpl->altMode = inAltMode;
 		// primarily intended for the KBView
-		Notif::send("KeyboardModel_AltModeToggled", std::make_shared<bool>(pImpl->altMode));
+		Notif::send(notif::KeyboardModel_AltModeToggled, pImpl->altMode);
 	}
 
 
@@ -247,6 +271,27 @@ namespace ac {
 	void KeyboardModel::setKeyLabels(const vector<string> &labels)
 	{
 		pImpl->keyLabels = labels;
+		for (const string &label : labels) {
+			KeyRegistry::getInstance().intern(label);
+		}
+	}
+
+
+	KeyID KeyboardModel::keyIDForLabel(const string &label) const
+	{
+		return KeyRegistry::getInstance().find(label);
+	}
+
+
+	const string &KeyboardModel::getKeyLabel(KeyID key) const
+	{
+		return KeyRegistry::getInstance().label(key);
+	}
+
+
+	bool KeyboardModel::isModifierKey(KeyID key) const
+	{
+		return KeyRegistry::getInstance().isModifier(key);
 	}
 	
 	
@@ -301,86 +346,145 @@ namespace ac {
 
 	bool KeyboardModel::hasGlyphForKeyLabel(const string &label) const
 	{
-		return pImpl->keyGlyphCodes.find(label) != pImpl->keyGlyphCodes.end();
+		return hasGlyphForKey(keyIDForLabel(label));
 	}
 
 
 	const Glyph &KeyboardModel::getGlyphForKeyLabel(const string &label) const
 	{
-		return pImpl->keyGlyphCodes.at(label);
+		return getGlyphForKey(keyIDForLabel(label));
 	}
 
 
 	void KeyboardModel::setGlyphForKeyLabel(const Glyph &glyph, const string &label)
 	{
-		pImpl->keyGlyphCodes[label] = glyph;
+		KeyboardModelImpl::KeyEntry &entry(pImpl->entryForKey(KeyRegistry::getInstance().intern(label)));
+		entry.hasGlyph = true;
+		entry.glyph = glyph;
 	}
 
 
 	bool KeyboardModel::hasAltGlyphForKeyLabel(const string& label) const
 	{
-		return pImpl->keyAltGlyphCodes.find(label) != pImpl->keyAltGlyphCodes.end();
+		return hasAltGlyphForKey(keyIDForLabel(label));
 	}
 
 
 	const Glyph &KeyboardModel::getAltGlyphForKeyLabel(const string &label) const
 	{
-		return pImpl->keyAltGlyphCodes.at(label);
+		return getAltGlyphForKey(keyIDForLabel(label));
 	}
 
 
 	void KeyboardModel::setAltGlyphForKeyLabel(const Glyph &glyph, const string &label)
 	{
-		pImpl->keyAltGlyphCodes[label] = glyph;
+		KeyboardModelImpl::KeyEntry &entry(pImpl->entryForKey(KeyRegistry::getInstance().intern(label)));
+		entry.hasAltGlyph = true;
+		entry.altGlyph = glyph;
 	}
 
 
 	const RGBByte &KeyboardModel::getColorForKey(const string &label)
 	{
-		// use a try catch here
-		RGBByte &ret(pImpl->keyColores.at(label));
-		return ret;
+		return getColorForKey(keyIDForLabel(label));
 	}
 
 
 	void KeyboardModel::setColorForKey(const RGBByte &color, const string &keyLabel)
 	{
-		pImpl->keyColores[keyLabel] = color;
+		KeyboardModelImpl::KeyEntry &entry(pImpl->entryForKey(KeyRegistry::getInstance().intern(keyLabel)));
+		entry.hasColor = true;
+		entry.color = color;
+	}
+
+
+	bool KeyboardModel::hasGlyphForKey(KeyID key) const
+	{
+		const KeyboardModelImpl::KeyEntry *entry = pImpl->findEntry(key);
+		return entry && entry->hasGlyph;
+	}
+
+
+	const Glyph &KeyboardModel::getGlyphForKey(KeyID key) const
+	{
+		if (!hasGlyphForKey(key)) {
+			throw std::out_of_range("no glyph for key " + getKeyLabel(key));
+		}
+		return pImpl->keys[key].glyph;
+	}
+
+
+	bool KeyboardModel::hasAltGlyphForKey(KeyID key) const
+	{
+		const KeyboardModelImpl::KeyEntry *entry = pImpl->findEntry(key);
+		return entry && entry->hasAltGlyph;
+	}
+
+
+	const Glyph &KeyboardModel::getAltGlyphForKey(KeyID key) const
+	{
+		if (!hasAltGlyphForKey(key)) {
+			throw std::out_of_range("no alt glyph for key " + getKeyLabel(key));
+		}
+		return pImpl->keys[key].altGlyph;
+	}
+
+
+	const RGBByte &KeyboardModel::getColorForKey(KeyID key) const
+	{
+		const KeyboardModelImpl::KeyEntry *entry = pImpl->findEntry(key);
+		if (!entry || !entry->hasColor) {
+			throw std::out_of_range("no color for key " + getKeyLabel(key));
+		}
+		return entry->color;
 	}
 	
 	
 #pragma mark - Event Handling
 	
-	void KeyboardModel::keyTouchEvent(string keyLabel, CCTouch *touch, TouchType type)
+	void KeyboardModel::keyTouchEvent(KeyID key, CCTouch *touch, TouchType type)
 	{
-		int requiredGlyphLevel = pImpl->keyGlyphCodes[keyLabel].getLevel();
+		const KeyboardModelImpl::KeyEntry *entry = pImpl->findEntry(key);
+		int requiredGlyphLevel = entry && entry->hasGlyph ? entry->glyph.getLevel() : Glyph().getLevel();
 		bool hasMapping = GameState::getInstance().player().getLevel() >= requiredGlyphLevel;
-		GameState::getInstance().keypressTracker().trackTouchEvent(touch, keyLabel, type, hasMapping);
+		GameState::getInstance().keypressTracker().trackTouchEvent(touch, key, type, hasMapping);
 	}
 
 
-	void KeyboardModel::notifCallback(const string &code, std::shared_ptr<void> data)
+	void KeyboardModel::keyTouchEvent(const string &label, CCTouch *touch, TouchType type)
 	{
-		if ("KeyboardView_KeyPress" == code) {
-			std::shared_ptr<KeyboardViewTouchInfo> pInfo = std::static_pointer_cast<KeyboardViewTouchInfo>(data);
-			keyTouchEvent(pInfo->label, pInfo->touch, pInfo->type);
-		}
+		keyTouchEvent(keyIDForLabel(label), touch, type);
+	}
 
-		else if ("ScoreKeeper_NewLevelUpdate" == code) {
-			pImpl->setUpKeysFromGlyphMap();
 
-			// trigger an event for the KBV
-			Notif::send("KeyboardModel_NewLevel");
-		}
+	void KeyboardModel::topicCallback(notif_topic_t topic, const NotifData &data)
+	{
+		switch (topic) {
+			case notif::KeyboardView_KeyPress: {
+				const KeyboardViewTouchInfo *info = data.get<KeyboardViewTouchInfo>();
+				keyTouchEvent(info->key, info->touch, info->type);
+			} break;
+
+			case notif::ScoreKeeper_NewLevelUpdate:
+				pImpl->setUpKeysFromGlyphMap();
+
+				// trigger an event for the KBV
+				Notif::send(notif::KeyboardModel_NewLevel);
+				break;
+
+			case notif::KeypressTracker_ModKeyPressed:
+				this->enableAltMode(true);
+				break;
 
-		else if ("KeypressTracker_ModKeyPressed" == code) {
-			this->enableAltMode(true);
+			case notif::KeypressTracker_ModKeyReleased:
+				// this->enableAltMode(false);
+				break;
 
-		} else if ("KeypressTracker_ModKeyReleased" == code) {
-			// this->enableAltMode(false);
+			case notif::CopyText_TriggerAltKey:
+				this->enableAltMode(false);
+				break;
 
-		} else if ("CopyText_TriggerAltKey" == code) {
-			this->enableAltMode(false);
+			default: break;
 		}
 	}
 	
@@ -34,6 +34,15 @@ namespace ac {
 
 	class ScoreKeeper;
 
+	// sent by the KeyboardView with KeyboardView_KeyPress
+	struct KeyboardViewTouchInfo
+	{
+		KeyID key; // InvalidKeyID if the touch isn't on a key
+		CCTouch *touch;
+		TouchType type;
+	};
+
+
 	class KeyboardModel : public Model
 	{
 	public:
@@ -50,13 +59,19 @@ namespace ac {
 		void setupKeyMappings();
 		
 		// initiate a keypress event
-		void keyTouchEvent(string, CCTouch *, TouchType);
+		void keyTouchEvent(KeyID, CCTouch *, TouchType);
+		void keyTouchEvent(const string &label, CCTouch *, TouchType);
 
 		/** Keys Information: labels */
 		size_t numberOfKeys() const;
 		const vector<string> &getKeyLabels() const;
 		void setKeyLabels(const vector<string> &labels);
 		bool hasLabel(const string &label);
+
+		// Key IDs come from the KeyRegistry, which setKeyLabels() registers the labels with.
+		KeyID keyIDForLabel(const string &label) const; // InvalidKeyID if there is no such key
+		const string &getKeyLabel(KeyID key) const; // "" for InvalidKeyID
+		bool isModifierKey(KeyID key) const;
 		
 		/** Keyboard metadata */
 		const string& getLabel() const;
@@ -102,7 +117,14 @@ namespace ac {
 		void setColorForKey(const RGBByte &, const string &);
 		const RGBByte &getColorForKey(const string &label);
 
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		// the same by key ID. The getters throw std::out_of_range for a key without one, as the label ones do.
+		bool hasGlyphForKey(KeyID key) const;
+		const Glyph &getGlyphForKey(KeyID key) const;
+		bool hasAltGlyphForKey(KeyID key) const;
+		const Glyph &getAltGlyphForKey(KeyID key) const;
+		const RGBByte &getColorForKey(KeyID key) const;
+
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 
 	private:
 		unique_ptr<KeyboardModelImpl> pImpl;
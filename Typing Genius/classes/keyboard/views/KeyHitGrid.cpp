@@ -0,0 +1,120 @@
+//
+//  KeyHitGrid.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "KeyHitGrid.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace ac {
+
+	// keeps a degenerate layout (one tiny key far away from the rest) from asking for a huge grid
+	static const int MaxCellsPerSide = 256;
+
+	const int KeyHitGrid::NoKey;
+
+
+	KeyHitGrid::KeyHitGrid() : area(), cellsPerX(0), cellsPerY(0), columns(0), rows(0)
+	{
+		// constructor
+	}
+
+
+	inline int KeyHitGrid::column(float x) const
+	{
+		return std::min(columns - 1, (int) ((x - area.minX) * cellsPerX));
+	}
+
+
+	inline int KeyHitGrid::row(float y) const
+	{
+		return std::min(rows - 1, (int) ((y - area.minY) * cellsPerY));
+	}
+
+
+	void KeyHitGrid::addKey(const KeyboardPoint &origin, const KeySize &size)
+	{
+		const Bounds b = { origin.x, origin.y, origin.x + size.width, origin.y + size.height };
+		keys.push_back(b);
+	}
+
+
+	void KeyHitGrid::clear()
+	{
+		keys.clear();
+		cellStarts.clear();
+		cellKeys.clear();
+		columns = rows = 0;
+	}
+
+
+	void KeyHitGrid::build()
+	{
+		cellStarts.clear();
+		cellKeys.clear();
+		columns = rows = 0;
+		if (keys.empty()) return;
+
+		area.minX = area.minY = FLT_MAX;
+		area.maxX = area.maxY = -FLT_MAX;
+		float cellWidth = FLT_MAX, cellHeight = FLT_MAX;
+		for (const Bounds &b : keys) {
+			area.minX = std::min(area.minX, b.minX);
+			area.minY = std::min(area.minY, b.minY);
+			area.maxX = std::max(area.maxX, b.maxX);
+			area.maxY = std::max(area.maxY, b.maxY);
+			if (b.maxX > b.minX) cellWidth = std::min(cellWidth, b.maxX - b.minX);
+			if (b.maxY > b.minY) cellHeight = std::min(cellHeight, b.maxY - b.minY);
+		}
+
+		const float width = area.maxX - area.minX, height = area.maxY - area.minY;
+		columns = cellWidth == FLT_MAX ? 1 : std::max(1, std::min(MaxCellsPerSide, (int) (width / cellWidth) + 1));
+		rows = cellHeight == FLT_MAX ? 1 : std::max(1, std::min(MaxCellsPerSide, (int) (height / cellHeight) + 1));
+		cellsPerX = width > 0 ? columns / width : 0;
+		cellsPerY = height > 0 ? rows / height : 0;
+
+		// Counting pass, then filling pass, so every cell's keys end up next to each other. A key goes into every cell
+		// between the cells of its corners; since column() and row() never decrease, any point inside it lands there.
+		cellStarts.assign(numberOfCells() + 1, 0);
+		for (const Bounds &b : keys) {
+			for (int r = row(b.minY); r <= row(b.maxY); r++) {
+				for (int c = column(b.minX); c <= column(b.maxX); c++) {
+					cellStarts[r * columns + c + 1]++;
+				}
+			}
+		}
+		for (size_t i = 1; i < cellStarts.size(); i++) {
+			cellStarts[i] += cellStarts[i - 1];
+		}
+
+		cellKeys.resize(cellStarts.back());
+		std::vector<uint32_t> filled(cellStarts.begin(), cellStarts.end() - 1);
+		for (size_t k = 0; k < keys.size(); k++) {
+			const Bounds &b = keys[k];
+			for (int r = row(b.minY); r <= row(b.maxY); r++) {
+				for (int c = column(b.minX); c <= column(b.maxX); c++) {
+					cellKeys[filled[r * columns + c]++] = (uint16_t) k;
+				}
+			}
+		}
+	}
+
+
+	int KeyHitGrid::keyAt(float x, float y) const
+	{
+		// also rejects NaN
+		if (cellStarts.empty() || !(x >= area.minX && x <= area.maxX && y >= area.minY && y <= area.maxY)) {
+			return NoKey;
+		}
+
+		const size_t cell = (size_t) (row(y) * columns + column(x));
+		for (uint32_t i = cellStarts[cell]; i < cellStarts[cell + 1]; i++) {
+			if (contains(keys[cellKeys[i]], x, y)) return cellKeys[i];
+		}
+		return NoKey;
+	}
+}
@@ -0,0 +1,59 @@
+//
+//  KeyHitGrid.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/16/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	A helper class of KeyboardView: finds the key under a touch. The key bounds are bucketed into a uniform grid once
+//	the layout is known, so a lookup only tests the one or two keys sharing the touched cell instead of every key.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ACTypes.h"
+
+namespace ac {
+
+	class KeyHitGrid
+	{
+	public:
+		static const int NoKey = -1;
+
+		KeyHitGrid();
+
+		// Keys are numbered in the order they are added. Edges are inclusive (like CCRect::containsPoint), and where
+		// bounds touch or overlap the key added first wins. Call build() after the last one.
+		void addKey(const KeyboardPoint &origin, const KeySize &size);
+		void build();
+		void clear();
+
+		// the number of the key containing the point, or NoKey
+		int keyAt(float x, float y) const;
+
+		inline size_t numberOfKeys() const { return keys.size(); }
+		inline size_t numberOfCells() const { return (size_t) columns * rows; }
+
+	private:
+		struct Bounds { float minX, minY, maxX, maxY; };
+
+		inline bool contains(const Bounds &b, float x, float y) const {
+			return x >= b.minX && x <= b.maxX && y >= b.minY && y <= b.maxY;
+		}
+
+		inline int column(float x) const;
+		inline int row(float y) const;
+
+		std::vector<Bounds> keys;
+
+		// the area covered by all keys, cut into columns x rows cells about the size of the smallest key
+		Bounds area;
+		float cellsPerX, cellsPerY;
+		int columns, rows;
+
+		// the keys overlapping cell c are cellKeys[cellStarts[c]..cellStarts[c + 1]), lowest number first
+		std::vector<uint32_t> cellStarts;
+		std::vector<uint16_t> cellKeys;
+	};
+}
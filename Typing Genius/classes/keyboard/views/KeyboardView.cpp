@@ -13,8 +13,11 @@
 #include "GameState.h"
 // #include "GlyphMap.h"
 #include "Keyboard.h"
+#include "KeyHitGrid.h"
+#include "KeystrokeTrace.h"
 #include "KeyboardModel.h"
 #include "KeypressTracker.h"
+#include "KeyRegistry.h"
 #include "KeyView.h"
 #include "ScreenResolutionHelper.h"
 #include "SimpleAudioEngine.h"
@@ -32,13 +35,12 @@ namespace ac
 	const char *SFXKeyDown = "sfx/soft-key-down.mp3";
 	const char *SFXKeyUp = "sfx/soft-key-up.mp3";
 
-	using std::set;
 
 	struct KeyboardViewImpl
 	{
 		KeyboardViewImpl(KeyboardView *kbView) : keyViewMap(), layerColor(), spriteBatchNode(), kbBGSprite(),
-		keyBounds(), keyLabelsSpriteBatchNode(), keyLabelSpriteMap(), kbView(kbView), touchLocations(),
-		shouldPlaySFX(false)
+		keyBounds(), keyViewsByID(), keyHitGrid(), keysInHitGrid(), keyLabelsSpriteBatchNode(), keyLabelSpriteMap(),
+		kbView(kbView), touchLocations(), shouldPlaySFX(false)
 		{
 #ifndef BOOST_TEST_TARGET
 			shouldPlaySFX = !DebugSettingsHelper::sharedHelper().boolValueForProperty("disable_sfx");
@@ -68,15 +70,18 @@ namespace ac
 		// useful for identifying which keys are hit
 		map<KeyView *, CCRect> keyBounds;
 
+		// indexed by KeyID (nullptr if the key view couldn't be created)
+		std::vector<KeyView *> keyViewsByID;
+
+		// the same bounds, for looking up touches. Numbered in key label order
+		KeyHitGrid keyHitGrid;
+		std::vector<KeyID> keysInHitGrid;
+
 		// map for keylabels to their sprites
 		map<string, CCSprite *> keyLabelSpriteMap;
 		
-		void changePressStateOfKeysToDown(set<string> keyLabels);
+		void changePressStateOfKeysToDown(const KeysDown &keysDown);
 
-		inline bool isPointInKeyBounds(KeyView *keyView, const CCPoint &point) {
-			return this->keyBounds[keyView].containsPoint(point);
-		}
-		
 		inline KeypressTracker &keypressTracker() const { return GameState::getInstance().keypressTracker(); }
 
 		// sends input signal to KPT, bypassing KBM
@@ -98,6 +103,13 @@ namespace ac
 	{
 		LogD << "Entered KeyboardView constructor...";
 		pImpl.reset(new KeyboardViewImpl(this));
+
+		listenTo({
+			notif::KeyboardModel_NewLevel,
+			notif::KeypressTracker_RequiresUIRefresh,
+			notif::CopyText_Mistake,
+			notif::KeyboardModel_AltModeToggled
+		});
 	}
 
 
@@ -106,6 +118,9 @@ namespace ac
 		LogD << "Entered KeyboardView destructor...";
 		pImpl->keyViewMap.clear();
 		pImpl->keyBounds.clear();
+		pImpl->keyViewsByID.clear();
+		pImpl->keyHitGrid.clear();
+		pImpl->keysInHitGrid.clear();
 		pImpl->keyLabelSpriteMap.clear();
 		this->removeAllChildrenWithCleanup(true);
 	}
@@ -192,12 +207,17 @@ namespace ac
 		}
 
 		
+		keyViewsByID.assign(KeyRegistry::getInstance().size(), nullptr);
+		keyHitGrid.clear();
+		keysInHitGrid.clear();
+
 		LogD << "KeyLabels size: " << keyLabels.size();
 		// set them randomly within the area...
 		for (int i = 0; i < keyLabels.size(); i++) {
 			
 			const string &keyLabel(keyLabels[i]);
-			if (true /*model->hasGlyphForKeyLabel(keyLabel) */) {
+			const KeyID key = model->keyIDForLabel(keyLabel);
+			if (key != InvalidKeyID /* && model->hasGlyphForKeyLabel(keyLabel) */) {
 
 				// const Glyph &glyph = model->getGlyphForKeyLabel(keyLabel);
 
@@ -225,8 +245,12 @@ namespace ac
 					keyView->setKeySize(bounds.size);
 					keyBounds[keyView] = bounds;
 
+					keyViewsByID[key] = keyView;
+					keyHitGrid.addKey(keyPoint, keySize);
+					keysInHitGrid.push_back(key);
+
 					try {
-						RGBByte color(model->getColorForKey(keyLabel));
+						RGBByte color(model->getColorForKey(key));
 						keyView->setHintColor(ccc3(color.r, color.g, color.b));
 					} catch (std::out_of_range e) {
 						LogD << "only keys with hint color defined will get them, which does not include: " << keyLabel;
@@ -236,6 +260,8 @@ namespace ac
 			}
 		}
 
+		keyHitGrid.build();
+
 		addGlyphsToKeys();
 		return true;
 	}
@@ -397,36 +423,40 @@ namespace ac
 
 	const string &KeyboardView::keyLabelIntersectingPoint(const CCPoint &point)
 	{
-		static string Empty = "";
-		for (auto &kv : pImpl->keyBounds) {
-			if (pImpl->isPointInKeyBounds(kv.first, point)) {
-				return kv.first->getLabel();
-			}
-		}
-		return Empty;
+		return KeyRegistry::getInstance().label(keyIntersectingPoint(point));
+	}
+
+
+	KeyID KeyboardView::keyIntersectingPoint(const CCPoint &point) const
+	{
+		const int key = pImpl->keyHitGrid.keyAt(point.x, point.y);
+		return key == KeyHitGrid::NoKey ? InvalidKeyID : pImpl->keysInHitGrid[key];
 	}
 
 
-	void KeyboardViewImpl::changePressStateOfKeysToDown(set<string> keyLabels)
+	void KeyboardViewImpl::changePressStateOfKeysToDown(const KeysDown &keysDown)
 	{
-		if (keyLabels.size() > 0) {
+		if (keysDown.count > 0) {
 			LogD2 << "changing key press state to down";
-			for (const string &label : keyLabels) {
-				LogD4 << boost::format("label to set to down (everything else is going up): %s") % label;
+			for (size_t i = 0; i < keysDown.count; i++) {
+				LogD4 << boost::format("key to set to down (everything else is going up): %d") % keysDown.keys[i];
 			}
 		}
 		
-		for (auto &kv : keyViewMap) {
-			if (keyLabels.find(kv.first) != keyLabels.end()) {
-				if (shouldPlaySFX && !kv.second->isDown()) {
+		for (size_t key = 0; key < keyViewsByID.size(); key++) {
+			KeyView *keyView = keyViewsByID[key];
+			if (!keyView) continue;
+
+			if (keysDown.contains((KeyID) key)) {
+				if (shouldPlaySFX && !keyView->isDown()) {
 					CocosDenshion::SimpleAudioEngine::sharedEngine()->playEffect(SFXKeyDown);
 				}
-				kv.second->keyDown();
+				keyView->keyDown();
 			} else {
-				if (shouldPlaySFX && kv.second->isDown()) {
+				if (shouldPlaySFX && keyView->isDown()) {
 					CocosDenshion::SimpleAudioEngine::sharedEngine()->playEffect(SFXKeyUp);
 				}
-				kv.second->keyUp();
+				keyView->keyUp();
 			}
 		}
 	}
@@ -486,13 +516,15 @@ namespace ac
 
 
 			if (shouldRegisterKeypress) {
+				AC_TRACE_KEYSTROKE();
+				AC_TRACE_SPAN(Touch);
 
-				std::shared_ptr<KeyboardViewTouchInfo> pInfo(new KeyboardViewTouchInfo);
-				pInfo->label = kbView->keyLabelIntersectingPoint(location);
-				pInfo->touch = touch;
-				pInfo->type = type;
+				KeyboardViewTouchInfo info = {};
+				info.key = kbView->keyIntersectingPoint(location);
+				info.touch = touch;
+				info.type = type;
 
-				Notif::send("KeyboardView_KeyPress", pInfo);
+				Notif::send(notif::KeyboardView_KeyPress, info);
 			}
 		}
 
@@ -532,25 +564,27 @@ namespace ac
 	
 #pragma mark - Events
 
-	void KeyboardView::notifCallback(const string &code, std::shared_ptr<void> data)
+	void KeyboardView::topicCallback(notif_topic_t topic, const NotifData &data)
 	{
-		if ("KeyboardModel_NewLevel" == code) {
-			showNewKeySymbols();
-		}
+		switch (topic) {
+			case notif::KeyboardModel_NewLevel:
+				showNewKeySymbols();
+				break;
 
-		else if ("KeypressTracker_RequiresUIRefresh" == code) {
-			pImpl->changePressStateOfKeysToDown(keypressTracker().keysInDownState());
-		}
+			case notif::KeypressTracker_RequiresUIRefresh:
+				pImpl->changePressStateOfKeysToDown(keypressTracker().keysInDownState());
+				break;
 
-		else if ("CopyText_Mistake" == code) {
-			// forget everything pressed after a mistake is registered
-			keypressTracker().reset();
-		}
+			case notif::CopyText_Mistake:
+				// forget everything pressed after a mistake is registered
+				keypressTracker().reset();
+				break;
 
+			case notif::KeyboardModel_AltModeToggled:
+				pImpl->enableAltMode(*data.get<bool>());
+				break;
 
-		else if ("KeyboardModel_AltModeToggled" == code) {
-			std::shared_ptr<bool> isAltModeOn = std::static_pointer_cast<bool>(data);
-			pImpl->enableAltMode(*isAltModeOn);
+			default: break;
 		}
 	}
 
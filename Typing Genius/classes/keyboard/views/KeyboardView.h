@@ -26,14 +26,6 @@ namespace ac
 	class KeypressTracker;
 	struct KeyboardViewImpl;
 
-	struct KeyboardViewTouchInfo
-	{
-		string label;
-		CCTouch *touch;
-		TouchType type;
-	};
-
-
 	class KeyboardView : public View, public CCLayer
 	{
 	public:
@@ -55,12 +47,13 @@ namespace ac
 		KeyView *getKeyFromLabel(const std::string &label) const;
 
 		const string &keyLabelIntersectingPoint(const CCPoint &point);
+		KeyID keyIntersectingPoint(const CCPoint &point) const;
 
 		KeypressTracker &keypressTracker();
 
 		void showNewKeySymbols();
 
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 
 	private:
 		unique_ptr<KeyboardViewImpl> pImpl;
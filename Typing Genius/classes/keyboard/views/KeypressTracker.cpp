@@ -7,161 +7,141 @@
 //
 
 #include "KeypressTracker.h"
-#include "KeyView.h"
+#include <chrono>
 #include "GameState.h"
 #include "CopyText.h"
+#include "Keyboard.h"
+#include "KeyboardModel.h"
+#include "KeystrokeTrace.h"
 #include "Utilities.h"
 
 namespace ac {
-	
-	using std::pair;
-	using std::shared_ptr;
-	using std::static_pointer_cast;
 
-	// if at least one modifier key is held this returns true.
-	static bool hasModifierKeys(const set<string> &keys);
-
-	typedef deque<KeyEvent>::const_iterator deqIt;
-	
-	inline bool operator== (const KeyEvent &kev1, const KeyEvent &kev2)
+	static inline const char *touchTypeName(TouchType type)
 	{
-		return (kev1.key == kev2.key && kev1.type == kev2.type);
+		// assumes there are only two types that are stored in the keypress buffer
+		return type == TouchType::TouchBegan ? "Began" : "End";
 	}
 
-	
-	// will start from the end, going backward, and return keyBuffer.begin if not found.
-	bool locateKeyEvent(const KeyEvent &kev, const deque<KeyEvent> &keyBuffer);
-
-	// first member of pair are for those entering touch, second are for those leaving touch
-	// pair<set<string>, set<string>> keysAboutToEnterAndLeaveTouch(set<string> keysHeldDown, const deque<KeyEvent> &keyBuffer);
-	set<string> keysEnteringTouch(set<string> keysHeldDown, const deque<KeyEvent> &keyBuffer);
-	
-	set<string> keysDown(const map<CCTouch *, string>& tracker);
-	
-	
-	KeypressTracker::KeypressTracker()
+
+	KeypressTracker::KeypressTracker() : trackedCount(0), lastKeyDown(InvalidKeyID)
 	{
 		reset();
 	}
 
 
-	/** 
+	/**
 	 @param touch one touch object
-	 @param label keyLabel
+	 @param key the key under the touch (InvalidKeyID if none)
 	 @param type one of four possible values
 	 */
-	void KeypressTracker::trackTouchEvent(CCTouch *touch, const string &label, TouchType type, bool isMapped = true)
+	void KeypressTracker::trackTouchEvent(CCTouch *touch, KeyID key, TouchType type, bool isMapped = true)
+	{
+		KeypressTrackerUpdateInfo info = {};
+		{
+			AC_TRACE_SPAN(KeypressTracker);
+			info = recordTouchEvent(touch, key, type, isMapped, timestampNow());
+
+			if ((info.newKeysSize + info.oldKeysSize) > 0) {
+				// set the key states here!
+				if (info.newKeysSize > 0 && Keyboard::getInstance().model()->isModifierKey(key)) {
+					LogD2 << "modifier keys held!";
+					Notif::send(notif::KeypressTracker_ModKeyPressed);
+				}
+
+				Notif::send(notif::KeypressTracker_RequiresUIRefresh, info);
+			}
+		}
+
+		if ((info.newKeysSize + info.oldKeysSize) > 0) {
+			// this may modify tracker, which kbView relies upon to properly set the key states (up or down)
+			GameState::getInstance().copyText().tryProcessingNextBufferedInput();
+		}
+	}
+
+
+	KeypressTrackerUpdateInfo KeypressTracker::recordTouchEvent(CCTouch *touch, KeyID key, TouchType type,
+																bool isMapped, uint64_t timestamp)
 	{
-		// you have to decide how to handle non assigned values
-		// return value should take its cue from addKeypressToBuffer.
-		static string Empty = "";
-		set<string> oldKeys;
-		set<string> newKeys;
+		// a touch can lift at most one key and press at most one (the one under it now)
+		KeyID oldKey = InvalidKeyID;
+		bool keyLifted = false, keyPressed = false;
 
 		switch (type) {
-			case TouchType::TouchBegan:
-				tracker[touch] = label;
+			case TouchType::TouchBegan: {
+				TrackedTouch *tracked = slotForTouch(touch);
+				if (tracked) tracked->key = key;
 
 				if (isMapped) {
-					newKeys.insert(label);
-					lastKeyDown = label;
+					keyPressed = true;
+					lastKeyDown = key;
 				}
-				break;
+			} break;
 
 			case TouchType::TouchEnded: 	case TouchType::TouchCancelled:
 			{
-				string keyLifted(tracker[touch]);
-				// AC 2014.1.14: sometimes the tracker[touch] returns empty string, a mystery I've yet to solve.
-				oldKeys.insert(keyLifted.empty() ? label : keyLifted);
-				tracker.erase(touch);
+				oldKey = key;
+				for (size_t i = 0; i < trackedCount; i++) {
+					// AC 2014.1.14: sometimes the tracked key is missing, a mystery I've yet to solve.
+					if (tracker[i].touch == touch && tracker[i].key != InvalidKeyID) oldKey = tracker[i].key;
+				}
+				keyLifted = true;
+				untrack(touch);
 			} break;
-			case TouchType::TouchMoved:
+
+			case TouchType::TouchMoved: {
 				// because the copytext can pop off the last key entered, while the key is down and dragged
 				// the same key can be kept added as new
-				if (label == lastKeyDown) { // more like last key down
+				if (key == lastKeyDown) { // more like last key down
 					break;
 				}
-				if (tracker[touch] != Empty) { // not previously empty (touch was at some other key prior)
-					if (tracker[touch] != label) { // pointed at a key different from the one now
-
-						if (isMapped) {
-							oldKeys.insert(tracker[touch]);
-						}
-
-						if (label != Empty) {
-
-							if (isMapped) {
-								newKeys.insert(label);
-							}
-						}
-					}
-				} else { // dragged into key (label) from nothing
-					if (label != Empty) {
-						if (isMapped) {
-							newKeys.insert(label);
-						}
+				TrackedTouch *tracked = slotForTouch(touch);
+				const KeyID previousKey = tracked ? tracked->key : InvalidKeyID;
+
+				if (previousKey != InvalidKeyID) { // not previously empty (touch was at some other key prior)
+					if (previousKey != key && isMapped) { // pointed at a key different from the one now
+						oldKey = previousKey;
+						keyLifted = true;
+						keyPressed = key != InvalidKeyID;
 					}
+				} else { // dragged into key from nothing
+					keyPressed = key != InvalidKeyID && isMapped;
 				}
-				tracker[touch] = label;
-				break;
+				if (tracked) tracked->key = key;
+			} break;
+
 			default: break;
 		}
-		
-		if ((newKeys.size() + oldKeys.size()) > 0) {
-			std::stringstream report;
-			for (auto i : oldKeys) {
-				keyPressBuffer.push_back({i, TouchType::TouchEnded});
-				report << " -" << i << "]";
-			}
-			for (auto i : newKeys) {
-				keyPressBuffer.push_back({i, TouchType::TouchBegan});
-				report << " +" << i << "]";
-			}
-
-			LogD2 << "report: [" << report.str();
-
-			// set the key states here!
-
-			// areKeysInvolved
-			shared_ptr<KeypressTrackerUpdateInfo> pInfo(new KeypressTrackerUpdateInfo);
-			pInfo->newKeysSize = newKeys.size();
-			pInfo->oldKeysSize = oldKeys.size();
 
-			pInfo->touchType = type;
-			pInfo->label = label;
-
-			if (hasModifierKeys(newKeys)) {
-				LogD2 << "modifier keys held!";
-				Notif::send("KeypressTracker_ModKeyPressed");
-			}
-
-			if (hasModifierKeys(oldKeys)) {
-				LogD2 << "modifier keys released!";
-				// Notif::send("KeypressTracker_ModKeyReleased");
-			}
-
-			Notif::send("KeypressTracker_RequiresUIRefresh", pInfo);
-
-			// this may modify tracker, which kbView relies upon to properly set the key states (up or down)
-			GameState::getInstance().copyText().tryProcessingNextBufferedInput();
+		KeypressTrackerUpdateInfo info = {};
+		info.oldKeysSize = keyLifted ? 1 : 0;
+		info.newKeysSize = keyPressed ? 1 : 0;
+		info.key = key;
+		info.touchType = type;
+
+		// CopyText has nothing to do with presses and releases of no key, so only the update info counts those
+		if (keyLifted && oldKey != InvalidKeyID) {
+			const KeyEvent released = { oldKey, TouchType::TouchEnded, timestamp };
+			if (!keyPressBuffer.push(released)) LogW << "Key press buffer is full, dropping the release of " << oldKey;
+			LogD2 << "report: -" << oldKey;
 		}
+		if (keyPressed && key != InvalidKeyID) {
+			const KeyEvent pressed = { key, TouchType::TouchBegan, timestamp };
+			if (!keyPressBuffer.push(pressed)) LogW << "Key press buffer is full, dropping the press of " << key;
+			LogD2 << "report: +" << key;
+		}
+		return info;
 	}
 
 
-	set<string> KeypressTracker::keysInDownState() const
-	{
-		return keysDown(this->tracker);
-	}
-
-
-	set<string> keysDown(const map<CCTouch *, string>& tracker)
+	KeysDown KeypressTracker::keysInDownState() const
 	{
-		static string Empty = "";
-		set<string> ret;
-		for (auto &kv : tracker) {
-			if (kv.second != Empty) {
-				LogD1 << "inserting " << kv.second << " into list of keys down";
-				ret.insert(kv.second);
+		KeysDown ret;
+		ret.count = 0;
+		for (size_t i = 0; i < trackedCount; i++) {
+			if (tracker[i].key != InvalidKeyID && !ret.contains(tracker[i].key)) {
+				LogD1 << "inserting " << tracker[i].key << " into list of keys down";
+				ret.keys[ret.count++] = tracker[i].key;
 			}
 		}
 		return ret;
@@ -170,71 +150,51 @@ namespace ac {
 
 	void KeypressTracker::reset()
 	{
-		this->tracker.clear();
-		this->keyPressBuffer.clear();
+		trackedCount = 0;
+		keyPressBuffer.clear();
 	}
 
 
-	const KeyEvent KeypressTracker::removeNextKeyEventFromBuffer()
+	bool KeypressTracker::removeNextKeyEventFromBuffer(KeyEvent &keyEvent)
 	{
-		KeyEvent ret = keyPressBuffer.front();
-		keyPressBuffer.pop_front();
-		
-		// assumes there are only two types that are stored in the keypress buffer
-		string type;
-		switch (ret.type) {
-			case TouchType::TouchBegan: type = "Began"; break;
-			default: type = "End"; break;
+		if (!keyPressBuffer.pop(keyEvent)) {
+			return false;
 		}
-		LogD << "removing from buffer key event '" << ret.key << "' with type: " << type;
+		LogD << "removing from buffer key event '" << keyEvent.key << "' with type: " << touchTypeName(keyEvent.type);
+		return true;
+	}
 
-		if (ret.key == "") {
-			LogW << "hmm";
-		}
 
-		return ret;
-	}
-	
-	
-	bool locateKeyEvent(const KeyEvent &kev, const deque<KeyEvent> &keyBuffer)
+	uint64_t KeypressTracker::timestampNow()
 	{
-		for (deqIt it = keyBuffer.end(); it!= keyBuffer.begin(); it--) {
-			if (*it == kev) {
-				return true;
-			}
-		}
-		return false;
+		typedef std::chrono::steady_clock clock;
+		return std::chrono::duration_cast<std::chrono::microseconds>(clock::now().time_since_epoch()).count();
 	}
-	
-	
-	set<string> keysEnteringTouch(set<string> keysHeldDown, const deque<KeyEvent> &keyBuffer)
+
+
+#pragma mark - Tracked Touches
+
+	KeypressTracker::TrackedTouch *KeypressTracker::slotForTouch(CCTouch *touch)
 	{
-		// handle entering
-		set<string> entering; // in keysHeldDown but not in keyBuffer
-		for (set<string>::const_iterator it = keysHeldDown.begin(); it != keysHeldDown.end(); ++it) {
-			bool found(false);
-			for (deqIt bufit = keyBuffer.begin(); bufit!= keyBuffer.end(); bufit++) {
-				if (bufit->key == *it) {
-					found = true;
-					break;
-				}
-			}
-			
-			if (!found) {
-				entering.insert(*it);
-			}
+		for (size_t i = 0; i < trackedCount; i++) {
+			if (tracker[i].touch == touch) return &tracker[i];
+		}
+		if (trackedCount == MaxTrackedTouches) {
+			return nullptr;
 		}
-		return entering;
+		tracker[trackedCount].touch = touch;
+		tracker[trackedCount].key = InvalidKeyID;
+		return &tracker[trackedCount++];
 	}
 
 
-	bool hasModifierKeys(const set<string> &keys)
+	void KeypressTracker::untrack(CCTouch *touch)
 	{
-		for (const auto &key : keys) {
-			if (utilities::keyIsAModifier(key)) {
-				return true;
+		for (size_t i = 0; i < trackedCount; i++) {
+			if (tracker[i].touch == touch) {
+				tracker[i] = tracker[--trackedCount];
+				return;
 			}
 		}
-		return false;
 	}
 }
@@ -5,13 +5,17 @@
 //  Created by Aldrich Co on 10/25/13.
 //  Copyright (c) 2013 Aldrich Co. All rights reserved.
 //
-//	A helper class of KeyboardView
+//	A helper class of KeyboardView. Turns touches into key presses and releases, which wait in a fixed-size ring until
+//	CopyText takes them (CopyText::tryProcessingNextBufferedInput). Nothing on that path allocates.
 
 #pragma once
 
 #include "cocos2d.h"
 #include "ACTypes.h"
-#include <deque>
+#include "SPSCRing.h"
+#include <algorithm>
+#include <map>
+#include <set>
 
 namespace ac {
 
@@ -21,7 +25,6 @@ namespace ac {
 	using std::map;
 	using std::vector;
 	using std::set;
-	using std::deque;
 
 	enum class TouchType;
 	class KeyboardView;
@@ -31,43 +34,75 @@ namespace ac {
 	{
 		size_t oldKeysSize;
 		size_t newKeysSize;
-		string label; // of last update (could be "")
+		KeyID key; // of last update (could be InvalidKeyID)
 		TouchType touchType;
 	};
 
 
+	// the keys currently held down, each once
+	struct KeysDown
+	{
+		static const size_t MaxKeys = 16;
+
+		KeyID keys[MaxKeys];
+		size_t count;
+
+		inline bool contains(KeyID key) const { return std::find(keys, keys + count, key) != keys + count; }
+	};
+
+
 	class KeypressTracker
 	{
 	public:
+		// more simultaneous touches than this are ignored (iOS reports up to 11)
+		static const size_t MaxTrackedTouches = KeysDown::MaxKeys;
+
+		// key events not yet taken by CopyText; more than this and new ones are dropped
+		static const size_t BufferCapacity = 256;
+
 		// key labels with modifier "mod" have special status
 		// e.g. "key:mod_shift"
 		KeypressTracker();
 
 		void reset();
 
-		// the return value is to indicate whether any substantial addition has been made to the buffer
-		void trackTouchEvent(CCTouch *touch, const string &label, TouchType type, bool isMapped);
+		// Records the event, then lets the keyboard view and CopyText know if it pressed or released a key.
+		void trackTouchEvent(CCTouch *touch, KeyID key, TouchType type, bool isMapped);
+
+		// Only the bookkeeping part of trackTouchEvent: updates which key each touch is on and buffers the resulting
+		// key events, without telling anyone. Never allocates.
+		KeypressTrackerUpdateInfo recordTouchEvent(CCTouch *touch, KeyID key, TouchType type, bool isMapped,
+												   uint64_t timestamp);
 
 		// use to get what is currently being pressed at any time.
-		set<string> keysInDownState() const;
+		KeysDown keysInDownState() const;
 
-		const KeyEvent removeNextKeyEventFromBuffer();
+		// false if there was nothing buffered
+		bool removeNextKeyEventFromBuffer(KeyEvent &keyEvent);
 
 		inline bool hasElementsInBuffer() const { return !keyPressBuffer.empty(); }
 
+		// microseconds on the steady clock, as stamped on KeyEvents
+		static uint64_t timestampNow();
+
 	private:
-		map<CCTouch *, string> tracker;
-		
-		string lastKeyDown; // ie pressed and registered as new
+		struct TrackedTouch
+		{
+			CCTouch *touch;
+			KeyID key; // InvalidKeyID while between keys
+		};
+
+		// the slot of the touch; a new one (on no key) if it wasn't tracked. nullptr if every slot is taken.
+		TrackedTouch *slotForTouch(CCTouch *touch);
+		void untrack(CCTouch *touch);
+
+		TrackedTouch tracker[MaxTrackedTouches];
+		size_t trackedCount;
+
+		KeyID lastKeyDown; // ie pressed and registered as new
 
 		// this will keep track of key presses in the order they are encountered
 		// only TouchTypes "Began" and "Ended" will be added to the buffer... the other types are compressed to these
-		deque<KeyEvent> keyPressBuffer;
+		SPSCRing<KeyEvent, BufferCapacity> keyPressBuffer;
 	};
-
-
-	
-	
-	
-	
-}
\ No newline at end of file
+}
@@ -79,6 +79,8 @@ namespace ac {
 	{
 		LogD << "Entered IntroLayer constructor";
 		pImpl.reset(new IntroLayerImpl(this));
+
+		listenTo({}); // nothing to respond to yet
 	}
 
 
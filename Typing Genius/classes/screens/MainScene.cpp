@@ -114,6 +114,13 @@ namespace ac {
 	{
 		LogD << "Entered MainLayer constructor";
 		pImpl.reset(new MainLayerImpl(this));
+
+		listenTo({
+			notif::AppDelegate_EnteringForeground,
+			notif::AppDelegate_EnteredBackground,
+			notif::AppDelegate_FinishLaunch,
+			notif::KeypressTracker_RequiresUIRefresh
+		});
 	}
 	
 	
@@ -363,24 +370,31 @@ namespace ac {
 #pragma mark - NotifListener
 
 
-	void MainLayer::notifCallback(const string &code, std::shared_ptr<void> data)
+	void MainLayer::topicCallback(notif_topic_t topic, const NotifData &data)
 	{
-		if ("AppDelegate_EnteringForeground" == code) {
-			GameState::getInstance().stop(false);
-			this->resetState(); // it should also show a "resuming" dialog while the app brings itself back
-
-		} else if ("AppDelegate_EnteredBackground" == code) {
-			LogI << "App entered background!";
-
-		} else if ("AppDelegate_FinishLaunch" == code) {
-			LogI << "App finished launching!";
-
-		} else if ("KeypressTracker_RequiresUIRefresh" == code) {
-			// flip game state from post game=true to false. This allows "Press any key to continue"
-			shared_ptr<KeypressTrackerUpdateInfo> pInfo = static_pointer_cast<KeypressTrackerUpdateInfo>(data);
-			if (pInfo->touchType == TouchType::TouchBegan && pInfo->label != "") {
-				pImpl->removePostGameClickShield();
-			}
+		switch (topic) {
+			case notif::AppDelegate_EnteringForeground:
+				GameState::getInstance().stop(false);
+				this->resetState(); // it should also show a "resuming" dialog while the app brings itself back
+				break;
+
+			case notif::AppDelegate_EnteredBackground:
+				LogI << "App entered background!";
+				break;
+
+			case notif::AppDelegate_FinishLaunch:
+				LogI << "App finished launching!";
+				break;
+
+			case notif::KeypressTracker_RequiresUIRefresh: {
+				// flip game state from post game=true to false. This allows "Press any key to continue"
+				const KeypressTrackerUpdateInfo *info = data.get<KeypressTrackerUpdateInfo>();
+				if (info->touchType == TouchType::TouchBegan && info->key != InvalidKeyID) {
+					pImpl->removePostGameClickShield();
+				}
+			} break;
+
+			default: break;
 		}
 	}
 
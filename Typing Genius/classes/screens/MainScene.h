@@ -53,7 +53,7 @@ namespace ac {
 		void resetState();
 
 		// NotifListener callback
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 
 	private:
 		// shouldn't these be inside MainSceneElements?
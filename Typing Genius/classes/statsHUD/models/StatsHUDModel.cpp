@@ -37,6 +37,25 @@ namespace ac {
 	{
 		LogI << "Inside StatsHUDModel constructor";
 		pImpl.reset(new StatsHUDModelImpl);
+
+		listenTo({
+			notif::StatsHUDView_TimerExpired,
+			notif::StatsHUDView_PostGameSubheadlineShown,
+			notif::CopyText_FirstPress,
+			notif::CopyText_AllCleared,
+			notif::CopyText_Blocked,
+			notif::BlockCanvasModel_DoneAnimation,
+			notif::BlockCanvasModel_CurrencyCollected,
+			notif::MainLayer_AddTime,
+			notif::ScoreKeeper_LevelProgressUpdate,
+			notif::ScoreKeeper_NewLevelUpdate,
+			notif::ScoreKeeper_Mistake,
+			notif::ScoreKeeper_Score,
+			notif::ScoreKeeper_StreakFinished,
+			notif::GameState_Timer_StartTimer,
+			notif::GameState_Timer_StopTimer,
+			notif::GameState_Timer_AddTime
+		});
 	}
 	
 	
@@ -56,7 +75,7 @@ namespace ac {
 	void StatsHUDModel::setNumberOfMistakes(size_t num)
 	{
 		pImpl->numberOfMistakes = num;
-		Notif::send("StatsHUDModel_SetNumberOfMistakes"); // unused
+		Notif::send(notif::StatsHUDModel_SetNumberOfMistakes); // unused
 	}
 	
 	
@@ -69,7 +88,7 @@ namespace ac {
 	void StatsHUDModel::setNumberOfCharsTyped(size_t num)
 	{
 		pImpl->numberOfCharsTyped = num;
-		Notif::send("StatsHUDModel_SetNumberOfCharsTyped"); // unused
+		Notif::send(notif::StatsHUDModel_SetNumberOfCharsTyped); // unused
 	}
 
 
@@ -111,13 +130,13 @@ namespace ac {
 	void StatsHUDModel::updateProgressMeter()
 	{
 		// meant for the SHView.
-		Notif::send("StatsHUDModel_UpdateProgress");
+		Notif::send(notif::StatsHUDModel_UpdateProgress);
 	}
 	
 	
 	size_t StatsHUDModel::totalBlocksDisplayable() const
 	{
-		return GameState::getInstance().copyText().copyString().size();
+		return GameState::getInstance().copyText().length();
 	}
 	
 	
@@ -129,92 +148,102 @@ namespace ac {
 
 #pragma mark - NotifListener callback
 	
-	void StatsHUDModel::notifCallback(const string &code, std::shared_ptr<void> data)
-	{
-		if ("StatsHUDView_TimerExpired" == code) {
-			LogI << "SHM: timer expired! (SHV)";
-			// most of the work is done already by GS.
-		} else if ("StatsHUDView_PostGameSubheadlineShown" == code) {
-			GameState::getInstance().setPostGameState(true);
-		}
-
-		// CopyText
-		else if ("CopyText_FirstPress" == code) { // still need this? maybe, later.
-			// start the timer.
-			GameState::getInstance().tryStartTimer(getTimerLength());
-			Notif::send("StatsHUDModel_StartTimer");
-
-		} else if ("CopyText_AllCleared" == code) {
-			Notif::send("StatsHUDModel_AllCleared");
-
-		} else if ("CopyText_Blocked" == code) {
-			Notif::send("StatsHUDModel_Blocked");
-		}
-
-		// BlockCanvasModel
-		else if ("BlockCanvasModel_DoneAnimation" == code) {
-			updateProgressMeter();
-		} else if ("BlockCanvasModel_CurrencyCollected" == code) {
-			Notif::send("StatsHUDModel_CurrencyCollected"); // pass this on to the view.
-		}
-
-
-		else if ("MainLayer_AddTime" == code) {
-			Notif::send("StatsHUDModel_CurrencyConsumed");
-		}
-
-		// ScoreKeeper
-		else if ("ScoreKeeper_LevelProgressUpdate" == code) {
-			std::shared_ptr<ScoreKeeperUpdateInfo> updateInfo = std::static_pointer_cast<ScoreKeeperUpdateInfo>(data);
-			std::shared_ptr<StatsHUDModelUpdateInfo> pInfo(new StatsHUDModelUpdateInfo);
-			pInfo->levelProgressDelta = updateInfo->levelProgressDelta;
-			Notif::send("StatsHUDModel_LevelProgressUpdate", pInfo);
-
-		} else if ("ScoreKeeper_NewLevelUpdate" == code) {
-			GameState::getInstance().stop(false);
-			GameState::getInstance().tryStartTimer(getTimerLength());
-			Notif::send("StatsHUDModel_NewLevel");
-
-		} else if ("ScoreKeeper_Mistake" == code) {
-			Notif::send("StatsHUDModel_Mistake");
-
-		} else if ("ScoreKeeper_Score" == code) {
-			std::shared_ptr<ScoreKeeperUpdateInfo> updateInfo = std::static_pointer_cast<ScoreKeeperUpdateInfo>(data);
-			std::shared_ptr<StatsHUDModelUpdateInfo> pInfo(new StatsHUDModelUpdateInfo);
-			pInfo->scoreDelta = updateInfo->scoreDelta;
-			pInfo->curStreakLevel = updateInfo->curStreakLevel;
-			Notif::send("StatsHUDModel_ScoreOrAccuracyUpdate", pInfo);
-
-		} else if ("ScoreKeeper_StreakFinished" == code) {
-			std::shared_ptr<ScoreKeeperUpdateInfo> updateInfo = std::static_pointer_cast<ScoreKeeperUpdateInfo>(data);
-			std::shared_ptr<StatsHUDModelUpdateInfo> pInfo(new StatsHUDModelUpdateInfo);
-			pInfo->curStreakLevel = updateInfo->curStreakLevel;
-			Notif::send("StatsHUDModel_StreakFinished", pInfo);
-
+	void StatsHUDModel::topicCallback(notif_topic_t topic, const NotifData &data)
+	{
+		switch (topic) {
+			case notif::StatsHUDView_TimerExpired:
+				LogI << "SHM: timer expired! (SHV)";
+				// most of the work is done already by GS.
+				break;
+			case notif::StatsHUDView_PostGameSubheadlineShown:
+				GameState::getInstance().setPostGameState(true);
+				break;
+
+			// CopyText
+			case notif::CopyText_FirstPress: // still need this? maybe, later.
+				// start the timer.
+				GameState::getInstance().tryStartTimer(getTimerLength());
+				Notif::send(notif::StatsHUDModel_StartTimer);
+				break;
+
+			case notif::CopyText_AllCleared:
+				Notif::send(notif::StatsHUDModel_AllCleared);
+				break;
+
+			case notif::CopyText_Blocked:
+				Notif::send(notif::StatsHUDModel_Blocked);
+				break;
+
+			// BlockCanvasModel
+			case notif::BlockCanvasModel_DoneAnimation:
+				updateProgressMeter();
+				break;
+			case notif::BlockCanvasModel_CurrencyCollected:
+				Notif::send(notif::StatsHUDModel_CurrencyCollected); // pass this on to the view.
+				break;
+
+			case notif::MainLayer_AddTime:
+				Notif::send(notif::StatsHUDModel_CurrencyConsumed);
+				break;
+
+			// ScoreKeeper
+			case notif::ScoreKeeper_LevelProgressUpdate: {
+				const ScoreKeeperUpdateInfo *updateInfo = data.get<ScoreKeeperUpdateInfo>();
+				StatsHUDModelUpdateInfo info = {};
+				info.levelProgressDelta = updateInfo->levelProgressDelta;
+				Notif::send(notif::StatsHUDModel_LevelProgressUpdate, info);
+			} break;
+
+			case notif::ScoreKeeper_NewLevelUpdate:
+				GameState::getInstance().stop(false);
+				GameState::getInstance().tryStartTimer(getTimerLength());
+				Notif::send(notif::StatsHUDModel_NewLevel);
+				break;
+
+			case notif::ScoreKeeper_Mistake:
+				Notif::send(notif::StatsHUDModel_Mistake);
+				break;
+
+			case notif::ScoreKeeper_Score: {
+				const ScoreKeeperUpdateInfo *updateInfo = data.get<ScoreKeeperUpdateInfo>();
+				StatsHUDModelUpdateInfo info = {};
+				info.scoreDelta = updateInfo->scoreDelta;
+				info.curStreakLevel = updateInfo->curStreakLevel;
+				Notif::send(notif::StatsHUDModel_ScoreOrAccuracyUpdate, info);
+			} break;
+
+			case notif::ScoreKeeper_StreakFinished: {
+				const ScoreKeeperUpdateInfo *updateInfo = data.get<ScoreKeeperUpdateInfo>();
+				StatsHUDModelUpdateInfo info = {};
+				info.curStreakLevel = updateInfo->curStreakLevel;
+				Notif::send(notif::StatsHUDModel_StreakFinished, info);
+			} break;
+
+			// GameState (Timer)
+			case notif::GameState_Timer_StartTimer:
+				// AC 2014.1.3: not sure what this condition means any more.
+				if (GameState::getInstance().hasTimerStateUpdatedToStartIt()) {
+					// should trigger its own signal that the stats view should be
+					// a slot to the view will query the GameState directly for the values.
+					Notif::send(notif::StatsHUDModel_StartTimer);
+				}
+				break;
+
+			case notif::GameState_Timer_StopTimer:
+				LogI << "SHM: timer expired!!! (GS)";
+				Notif::send(notif::StatsHUDModel_EndTimer);
+				break;
+
+			case notif::GameState_Timer_AddTime: {
+				LogI << "now: add the time.";
+				const GameStateTimerEventInfo *timerInfo = data.get<GameStateTimerEventInfo>();
+				StatsHUDModelUpdateInfo info = {};
+				info.timerDelta = timerInfo->delta;
+				Notif::send(notif::StatsHUDModel_AddTime, info);
+			} break;
+
+			default: break;
 		}
-
-		// GameState (Timer)
-		else if ("GameState_Timer_StartTimer" == code) {
-			// AC 2014.1.3: not sure what this condition means any more.
-			if (GameState::getInstance().hasTimerStateUpdatedToStartIt()) {
-				// should trigger its own signal that the stats view should be
-				// a slot to the view will query the GameState directly for the values.
-				Notif::send("StatsHUDModel_StartTimer");
-			}
-
-		} else if ("GameState_Timer_StopTimer" == code) {
-			LogI << "SHM: timer expired!!! (GS)";
-			Notif::send("StatsHUDModel_EndTimer");
-
-		} else if ("GameState_Timer_AddTime" == code) {
-			LogI << "now: add the time.";
-			std::shared_ptr<GameStateTimerEventInfo> info = std::static_pointer_cast<GameStateTimerEventInfo>(data);
-			std::shared_ptr<StatsHUDModelUpdateInfo> pInfo(new StatsHUDModelUpdateInfo);
-			pInfo->timerDelta = info->delta;
-			Notif::send("StatsHUDModel_AddTime", pInfo);
-
-		}
-
 	}
 }
 
@@ -57,7 +57,7 @@ namespace ac {
 		size_t totalBlocksDisplayable() const;
 		size_t blocksConsumedSoFar() const;
 
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 		
 	private:
 		unique_ptr<StatsHUDModelImpl> pImpl;
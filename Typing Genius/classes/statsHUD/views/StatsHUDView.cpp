@@ -61,7 +61,7 @@ namespace ac {
 		progressBorder(), progressTimer(), timerAnimationBar(),
 		headlineLabel(), subHeadlineLabel(), timerLabel(), scoreAtStartOfLevel(),
 		activeAccuracyLabel(), activeScoreLabel(), playerLevelLabel(), currencyCountLabel(),
-		visualEffectsHelper(), levelGauge(), levelGaugeBG(), maxTimeThisLevel(0)
+		visualEffectsHelper(), levelGauge(), levelGaugeBG(), maxTimeThisLevel(0), shownTimeTenths(-1)
 		{
 		}
 
@@ -94,6 +94,7 @@ namespace ac {
 		CCTimer *timer;
 		
 		float maxTimeThisLevel;
+		long shownTimeTenths; // what the timer label says, so it's only set again when that changes
 
 		// signal for model
 		sign_conn_t modelStatsUpdateSignalConnection;
@@ -136,6 +137,23 @@ namespace ac {
 	{
 		LogI << "Inside StatsHUDView Constructor";
 		pImpl.reset(new StatsHUDViewImpl(this));
+
+		listenTo({
+			notif::StatsHUDModel_AddTime,
+			notif::StatsHUDModel_AllCleared,
+			notif::StatsHUDModel_Blocked,
+			notif::StatsHUDModel_CurrencyCollected,
+			notif::StatsHUDModel_CurrencyConsumed,
+			notif::StatsHUDModel_EndTimer,
+			notif::StatsHUDModel_LevelProgressUpdate,
+			notif::StatsHUDModel_Mistake,
+			notif::StatsHUDModel_NewLevel,
+			notif::StatsHUDModel_ScoreOrAccuracyUpdate,
+			notif::StatsHUDModel_StartTimer,
+			notif::StatsHUDModel_StreakFinished,
+			notif::StatsHUDModel_UpdateProgress,
+			notif::GameState_Timer_DeductTime
+		});
 	}
 	
 	
@@ -340,13 +358,20 @@ namespace ac {
 		
 	void StatsHUDView::startTimerWithCountdown()
 	{
-		this->schedule(schedule_selector(StatsHUDView::timerUpdate), 0.1);
+		pImpl->shownTimeTenths = -1;
+		this->schedule(schedule_selector(StatsHUDView::timerUpdate)); // every frame
 	}
 	
 	
+	// The time remaining is as of the start of the frame (the same the countdown itself goes by), so reading it each
+	// frame is cheap; the label is only rebuilt when the tenths of a second it shows have changed.
 	void StatsHUDView::timerUpdate(float delta)
 	{
 		long timeRemainVal(GameState::getInstance().getTimeRemaining()); // millis
+		if (timeRemainVal / 100 == pImpl->shownTimeTenths) {
+			return;
+		}
+		pImpl->shownTimeTenths = timeRemainVal / 100;
 		string timeRemaining(GameState::formattedTimeVal(timeRemainVal));
 		pImpl->timerLabel->setString(timeRemaining.c_str());
 	}
@@ -466,7 +491,7 @@ namespace ac {
 	{
 		LogI << boost::format("SHV: timer expired! (animation)");
 		// inform the model.
-		Notif::send("StatsHUDView_TimerExpired");
+		Notif::send(notif::StatsHUDView_TimerExpired);
 		this->unschedule(schedule_selector(StatsHUDView::timerUpdate));
 	}
 	
@@ -474,91 +499,107 @@ namespace ac {
 #pragma mark - Event processing
 
 
-	void StatsHUDView::notifCallback(const string &code, shared_ptr<void> data)
+	void StatsHUDView::topicCallback(notif_topic_t topic, const NotifData &data)
 	{
 		const StatsHUDModel &model(*(StatsHUD::getInstance().model()));
 
 		// respond to SHModel events
-		if ("StatsHUDModel_AddTime" == code) {
+		switch (topic) {
+			case notif::StatsHUDModel_AddTime:
 
-			resetTimeInCountdown(GameState::getInstance().getTimeRemaining() / 1000.0, TimerResetAnimationType::Increase);
+				resetTimeInCountdown(GameState::getInstance().getTimeRemaining() / 1000.0, TimerResetAnimationType::Increase);
+				break;
 
-		} else if ("StatsHUDModel_AllCleared" == code) {
+			case notif::StatsHUDModel_AllCleared:
 
-			stopTimerCountdown();
-			pImpl->showGameCompleteStats(model);
+				stopTimerCountdown();
+				pImpl->showGameCompleteStats(model);
+				break;
 
-		} else if ("StatsHUDModel_Blocked" == code) {
+			case notif::StatsHUDModel_Blocked:
 
-			pImpl->reportBlockedBlock(model);
+				pImpl->reportBlockedBlock(model);
+				break;
 
-		} else if ("StatsHUDModel_CurrencyCollected" == code) {
+			case notif::StatsHUDModel_CurrencyCollected:
 
-			pImpl->updateCurrencyCount(model);
+				pImpl->updateCurrencyCount(model);
+				break;
 
-		} else if ("StatsHUDModel_CurrencyConsumed" == code) {
+			case notif::StatsHUDModel_CurrencyConsumed:
 
-			pImpl->updateCurrencyCount(model);
+				pImpl->updateCurrencyCount(model);
+				break;
 
-		} else if ("StatsHUDModel_EndTimer" == code) {
+			case notif::StatsHUDModel_EndTimer:
 
-			// force it to go to zero regardless of what GS::TimeRemaining says
-			pImpl->timerLabel->setString(GameState::formattedTimeVal(0).c_str());
-			pImpl->showGameCompleteStats(model);
+				// force it to go to zero regardless of what GS::TimeRemaining says
+				pImpl->timerLabel->setString(GameState::formattedTimeVal(0).c_str());
+				pImpl->showGameCompleteStats(model);
+				break;
 
-		} else if ("StatsHUDModel_LevelProgressUpdate" == code) {
+			case notif::StatsHUDModel_LevelProgressUpdate: {
 
-			shared_ptr<StatsHUDModelUpdateInfo> pInfo = static_pointer_cast<StatsHUDModelUpdateInfo>(data);
-			pImpl->updateLevelProgress(model, pInfo->levelProgressDelta);
-			pImpl->updatePlayerLevel(model);
+				const StatsHUDModelUpdateInfo *info = data.get<StatsHUDModelUpdateInfo>();
+				pImpl->updateLevelProgress(model, info->levelProgressDelta);
+				pImpl->updatePlayerLevel(model);
+			} break;
 
-		} else if ("StatsHUDModel_Mistake" == code) {
+			case notif::StatsHUDModel_Mistake:
 
-			resetTimeInCountdown(GameState::getInstance().getTimeRemaining() / 1000.0, TimerResetAnimationType::Decrease);
-			pImpl->updateScoreAndAccuracy(model);
+				resetTimeInCountdown(GameState::getInstance().getTimeRemaining() / 1000.0, TimerResetAnimationType::Decrease);
+				pImpl->updateScoreAndAccuracy(model);
+				break;
 
-		} else if ("StatsHUDModel_NewLevel" == code) {
+			case notif::StatsHUDModel_NewLevel:
 
-			startTimerCountdown(model.getTimerLength()); // restarts the timer.
-			pImpl->showNewLevelAnnouncement(model);
+				startTimerCountdown(model.getTimerLength()); // restarts the timer.
+				pImpl->showNewLevelAnnouncement(model);
+				break;
 
-		} else if ("StatsHUDModel_ScoreOrAccuracyUpdate" == code) {
+			case notif::StatsHUDModel_ScoreOrAccuracyUpdate: {
 
-			shared_ptr<StatsHUDModelUpdateInfo> pInfo = static_pointer_cast<StatsHUDModelUpdateInfo>(data);
-			pImpl->updateScoreAndAccuracy(model, pInfo->scoreDelta);
+				const StatsHUDModelUpdateInfo *info = data.get<StatsHUDModelUpdateInfo>();
+				pImpl->updateScoreAndAccuracy(model, info->scoreDelta);
+			} break;
 
-		} else if ("StatsHUDModel_StartTimer" == code) {
+			case notif::StatsHUDModel_StartTimer:
 
-			startTimerCountdown(GameState::getInstance().getTimeRemaining() / 1000.0f);
-			pImpl->scoreAtStartOfLevel = GameState::getInstance().player().getTotalScore();
-			pImpl->updatePlayerLevel(model);
-			pImpl->updateCurrencyCount(model);
-			pImpl->fadeOffHeadline();
+				startTimerCountdown(GameState::getInstance().getTimeRemaining() / 1000.0f);
+				pImpl->scoreAtStartOfLevel = GameState::getInstance().player().getTotalScore();
+				pImpl->updatePlayerLevel(model);
+				pImpl->updateCurrencyCount(model);
+				pImpl->fadeOffHeadline();
+				break;
 
-		} else if ("StatsHUDModel_StreakFinished" == code) {
+			case notif::StatsHUDModel_StreakFinished:
 
-			if (!GameState::getInstance().isGameOver()) {
-				shared_ptr<StatsHUDModelUpdateInfo> pInfo = static_pointer_cast<StatsHUDModelUpdateInfo>(data);
-				pImpl->reportStreakFinished(model, *pInfo);
-			}
+				if (!GameState::getInstance().isGameOver()) {
+					const StatsHUDModelUpdateInfo *info = data.get<StatsHUDModelUpdateInfo>();
+					pImpl->reportStreakFinished(model, *info);
+				}
+				break;
 
-		} else if ("StatsHUDModel_UpdateProgress" == code) {
-			// do nothing...
+			case notif::StatsHUDModel_UpdateProgress:
+				// do nothing...
+				break;
 
-		} else if ("GameState_Timer_DeductTime" == code) {
+			case notif::GameState_Timer_DeductTime: {
 
-			// play a sound when the time deduction directly causes timer to goes below the threshold
-			shared_ptr<GameStateTimerEventInfo> pInfo = static_pointer_cast<GameStateTimerEventInfo>(data);
-			const float newTimeRemaining = GameState::getInstance().getTimeRemaining() / 1000.0f;
-			const float oldTimeRemaining = newTimeRemaining + pInfo->delta; // time amount prior to the deduction
-			const float timeRemainingWarnThreshold = WarningPctUpperBound * pImpl->maxTimeThisLevel / 100.0f;
+				// play a sound when the time deduction directly causes timer to goes below the threshold
+				const GameStateTimerEventInfo *info = data.get<GameStateTimerEventInfo>();
+				const float newTimeRemaining = GameState::getInstance().getTimeRemaining() / 1000.0f;
+				const float oldTimeRemaining = newTimeRemaining + info->delta; // time amount prior to the deduction
+				const float timeRemainingWarnThreshold = WarningPctUpperBound * pImpl->maxTimeThisLevel / 100.0f;
 
-			if (newTimeRemaining <= timeRemainingWarnThreshold && oldTimeRemaining > timeRemainingWarnThreshold) {
-				if (!DebugSettingsHelper::sharedHelper().boolValueForProperty("disable_sfx")) {
-					CocosDenshion::SimpleAudioEngine::sharedEngine()->playEffect(SFXTimerWarn);
+				if (newTimeRemaining <= timeRemainingWarnThreshold && oldTimeRemaining > timeRemainingWarnThreshold) {
+					if (!DebugSettingsHelper::sharedHelper().boolValueForProperty("disable_sfx")) {
+						CocosDenshion::SimpleAudioEngine::sharedEngine()->playEffect(SFXTimerWarn);
+					}
 				}
-			}
+			} break;
 
+			default: break;
 		}
 	}
 
@@ -686,7 +727,7 @@ namespace ac {
 				subHeadlineLabel->setOpacity(0);
 				subHeadlineLabel->setString("PRESS A KEY TO CONTINUE");
 				subHeadlineLabel->runAction(CCFadeIn::create(1));
-				Notif::send("StatsHUDView_PostGameSubheadlineShown");
+				Notif::send(notif::StatsHUDView_PostGameSubheadlineShown);
 			}));
 
 		} else { // success! 2014-01-07 not really used currently
@@ -776,7 +817,7 @@ namespace ac {
 				subHeadlineLabel->setString("PRESS A KEY TO CONTINUE");
 				subHeadlineLabel->setOpacity(0);
 				subHeadlineLabel->runAction(CCFadeIn::create(0.7));
-				Notif::send("StatsHUDView_PostGameSubheadlineShown");
+				Notif::send(notif::StatsHUDView_PostGameSubheadlineShown);
 			}));
 		}
 		headlineLabel->runAction(CCSpawn::create(CCFadeIn::create(0.5), CCSequence::create(actionsInSequence), NULL));
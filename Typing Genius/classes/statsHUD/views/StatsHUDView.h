@@ -60,7 +60,7 @@ namespace ac {
 		void stopTimerCountdown();
 		
 		// NotifListener callback
-		void notifCallback(const string &code, std::shared_ptr<void> data);
+		void topicCallback(notif_topic_t topic, const NotifData &data);
 
 	private:
 		unique_ptr<StatsHUDViewImpl> pImpl;
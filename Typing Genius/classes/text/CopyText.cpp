@@ -9,15 +9,20 @@
 #include "CopyText.h"
 #include "DebugSettingsHelper.h"
 #include "KeypressTracker.h"
+#if !AC_HEADLESS
 #include "BlockCanvasView.h" // to learn how many blocks can fit within a row.
-#include "ScreenResolutionHelper.h"
+#endif
 #include "KeyboardModel.h"
 #include "Keyboard.h"
+#include "KeyRegistry.h"
+#include "KeystrokeTrace.h"
 #include "ScoreKeeper.h"
 #include "PlayerLevel.h"
 #include "Player.h"
 #include "GlyphMap.h"
 #include "GameState.h"
+#include "GlyphGenerator.h"
+#include "SessionHistory.h"
 // #include "BlockTypesetter.h"
 
 namespace ac {
@@ -34,9 +39,14 @@ namespace ac {
 		unitsToAdvance(0),
 		unitsToAdvanceSaved(0),
 		unitsToMistakeHL(0),
-		spaceKeyIsUsed(false)
+		spaceKeyIsUsed(false),
+		pressedKey(InvalidKeyID),
+		pressedAt(0),
+		lastCheckedAt(0),
+		copyTextLength(0),
+		generatesCopyString(false)
 		{
-#if BOOST_TEST_TARGET
+#if BOOST_TEST_TARGET || AC_HEADLESS
 			visibleBlocksPerRow = 12;
 #else
 			visibleBlocksPerRow = BlockCanvasView::blockCountPerRow();
@@ -52,10 +62,31 @@ namespace ac {
 		bool spaceKeyIsUsed;
 		bool isBlockedByEncasement;
 
+		// the key being checked, for the session history
+		KeyID pressedKey;
+		uint64_t pressedAt;
+		uint64_t lastCheckedAt; // the keystroke before, for how long this one took
+
 		size_t copyStringOffset; // offset into the copy string representing the first letter of the visible block
 		size_t visibleBlocksPerRow; // and theres one row
+
+		// A generated copy string is made a chunk at a time as the player gets to it, and chunks that have been typed
+		// are dropped, so copyString only holds the part of the copy text around the cursor. Offsets like
+		// copyStringOffset are positions in the whole text; indexOf() turns them into copyString indices.
+		static const size_t ChunkSize = 256;
+		static const size_t LookaheadChunks = 2; // past the visible row
+
+		size_t copyTextLength; // including what hasn't been generated yet
+		bool generatesCopyString; // strings given to setCopyString are used as they are
+		GlyphGenerator generator; // configured for the player level
+
+		inline size_t indexOf(size_t position) const { return position - copyString.droppedFromFront(); }
+		inline size_t generatedEnd() const { return copyString.droppedFromFront() + copyString.size(); }
+
+		void configureGenerator(size_t playerLevel);
+		void fillLookahead();
 		
-		void inputKeyWithValue(const GlyphString &gs); // present printable for checking.
+		void inputKeyWithValue(const Glyph &glyph); // present printable for checking.
 		void loadCopyString(size_t);
 		void performCheck(); // this makes the check and decides whether to advance the cursor or not
 		// (by the appropriate amount). That's all it does
@@ -84,7 +115,7 @@ namespace ac {
 	{
 		pImpl.reset(new CopyTextImpl(*this));
 		pImpl->loadCopyString(GameState::getInstance().player().getLevel());
-		Notif::send("CopyText_LoadedString");
+		Notif::send(notif::CopyText_LoadedString);
 	}
 
 
@@ -102,30 +133,32 @@ namespace ac {
 
 #pragma mark - Listener to KeyboardModel
 
-	void CopyText::keyEventTriggered(string &label, KeyPressState &state, const Glyph &glyph)
+	void CopyText::keyEventTriggered(KeyID key, const KeyPressState &state, const Glyph &glyph, uint64_t timestamp)
 	{
 		if (state == KeyPressState::Down) {
 			LogD1 << "Key pressed down, with code: " << glyph.getCode();
 			
 			// this may modify unitsToAdvance and other internal values
 			if (glyph.getCode() < 0) {
-				LogI << "nothing assigned to key with label " << label;
+				LogI << "nothing assigned to key with label " << KeyRegistry::getInstance().label(key);
 				return;
 			}
 
+			pImpl->pressedKey = key;
+			pImpl->pressedAt = timestamp;
 			pImpl->inputKeyWithValue(glyph);
 
 			if (pImpl->unitsToAdvance > 0) {
-				Notif::send("CopyText_Preadvance");
+				Notif::send(notif::CopyText_Preadvance);
 				return;
 			}
 
 			if (pImpl->unitsToMistakeHL > 0) {
 
 				if (pImpl->isBlockedByEncasement) {
-					Notif::send("CopyText_Blocked");
+					Notif::send(notif::CopyText_Blocked);
 				} else {
-					Notif::send("CopyText_Mistake");
+					Notif::send(notif::CopyText_Mistake);
 				}
 				pImpl->clearEnteredString();
 				return;
@@ -136,20 +169,21 @@ namespace ac {
 			// don't assume that everything went well.
 			pImpl->copyStringOffset += pImpl->unitsToAdvance;
 			LogD3 << "copy string offset now at " << pImpl->copyStringOffset;
+			pImpl->fillLookahead();
 
 			if (pImpl->unitsToAdvance > 0) {
 				if (pImpl->spaceKeyIsUsed) {
-					Notif::send("CopyText_AdvanceWithSpace");
+					Notif::send(notif::CopyText_AdvanceWithSpace);
 				} else {
-					Notif::send("CopyText_Advance");
+					Notif::send(notif::CopyText_Advance);
 				}
 			}
 
 			// this only covers the case where the player ran out of blocks to clear, but not when the user ran out
 			// of time. StatsHUD which controls the ingame timer can also notify GameState.
-			if (GameState::getInstance().isGameStarted() && pImpl->copyStringOffset >= pImpl->copyString.size()) {
+			if (GameState::getInstance().isGameStarted() && pImpl->copyStringOffset >= pImpl->generatedEnd()) {
 				pImpl->notifyGameStateOfGameEndState();
-				Notif::send("CopyText_AllCleared");
+				Notif::send(notif::CopyText_AllCleared);
 			}
 
 			// wait for the animation signal
@@ -178,9 +212,10 @@ namespace ac {
 
 #pragma mark - Checking
 	
-	void CopyTextImpl::inputKeyWithValue(const GlyphString &gs)
+	// appended as it is, without a GlyphString of its own, so that a keystroke doesn't allocate
+	void CopyTextImpl::inputKeyWithValue(const Glyph &glyph)
 	{
-		LogI << "appending " << gs;
+		LogI << "appending " << glyph.getCode();
 
 		bool inTestMode(false);
 #ifdef BOOST_TEST_TARGET
@@ -193,7 +228,7 @@ namespace ac {
 				if (copyString.size() > 0 && copyStringOffset == 0) {
 					LogI << boost::format("game has started!");
 					// notify listeners: game has started.
-					Notif::send("CopyText_FirstPress");
+					Notif::send(notif::CopyText_FirstPress);
 				} else {
 					// game is finished, need to reset
 					return; // <----------- exit
@@ -203,22 +238,23 @@ namespace ac {
 			}
 		}
 		
-		enteredString.append(gs);
+		enteredString.append(glyph);
 		performCheck();
 	}
 	
 
 	void CopyTextImpl::performCheck()
 	{
+		AC_TRACE_SPAN(CopyTextCheck);
 		size_t enteredLength = enteredString.size();
 		// hope this doesn't overflow.
 		
-		if (copyStringOffset >= copyString.size()) {
+		if (copyStringOffset >= generatedEnd()) {
 			LogW << "CopyString offset now past the size";
 			return;
 		}
 
-		GlyphString toBeCompared(copyString.substr(copyStringOffset, enteredLength));
+		const GlyphStringView toBeCompared(copyString.substr(indexOf(copyStringOffset), enteredLength));
 		
 		if (toBeCompared.size() < 1) {
 			LogW << "You've reached the end of the string. Escaping";
@@ -231,7 +267,22 @@ namespace ac {
 		this->spaceKeyIsUsed = false;
 
 		// can't be cleared without gradually 'peeling away' the encasement
-		this->isBlockedByEncasement = copyString.encasementLevelAtIndex(copyStringOffset) > 0;
+		this->isBlockedByEncasement = copyString.encasementLevelAtIndex(indexOf(copyStringOffset)) > 0;
+
+		KeystrokeOutcome outcome = KeystrokeOutcome::Mistake;
+		if (this->isBlockedByEncasement) {
+			outcome = KeystrokeOutcome::Blocked;
+		} else if (isSpace && !isGodMode) {
+			outcome = KeystrokeOutcome::Space;
+		} else if (isCorrect) {
+			outcome = KeystrokeOutcome::Correct;
+		}
+		const int expectedGlyph = toBeCompared[0].getCode();
+		GameState::getInstance().sessionRecorder().recordKeystroke(pressedKey, expectedGlyph, outcome, pressedAt);
+
+		const uint32_t latencyMillis = lastCheckedAt && pressedAt > lastCheckedAt ?
+									   (uint32_t) ((pressedAt - lastCheckedAt) / 1000) : 0;
+		lastCheckedAt = pressedAt;
 
 		if (this->isBlockedByEncasement) {
 
@@ -253,13 +304,13 @@ namespace ac {
 			LogI << boost::format("copy string offset now at %d") % copyStringOffset;
 			
 			this->scoreKeeper().recordStreakIncrement(enteredLength);
-			this->scoreKeeper().recordBlockClear(enteredLength);
+			this->scoreKeeper().recordBlockClear(enteredLength, expectedGlyph, latencyMillis);
 
 		} else {
 			// incorrect: do not advance, blink the block glyph, report mistake to scorekeeper
 			unitsToMistakeHL = enteredLength;
 			LogD2 << "The key you should be entering is " << toBeCompared;
-			this->scoreKeeper().recordMistakenAttempt(enteredLength);
+			this->scoreKeeper().recordMistakenAttempt(enteredLength, expectedGlyph);
 		}
 	}
 
@@ -300,26 +351,25 @@ namespace ac {
 		
 		KeypressTracker &kpt(GameState::getInstance().keypressTracker());
 		
-		if (kpt.hasElementsInBuffer()) {
-			std::shared_ptr<KeyboardModel> kbm(Keyboard::getInstance().model());
-
-			KeyEvent kev(kpt.removeNextKeyEventFromBuffer());
+		KeyEvent kev;
+		if (kpt.removeNextKeyEventFromBuffer(kev)) {
+			const std::shared_ptr<KeyboardModel> &kbm(Keyboard::getInstance().model());
 
 			KeyPressState pressState = kev.type == TouchType::TouchBegan ? KeyPressState::Down : KeyPressState::Up;
 
 			if (!kbm->isInAltMode()) { // normal behavior
 
-				if (kbm->hasGlyphForKeyLabel(kev.key)) {
-					const Glyph &glyph = kbm->getGlyphForKeyLabel(kev.key);
+				if (kbm->hasGlyphForKey(kev.key)) {
+					const Glyph &glyph = kbm->getGlyphForKey(kev.key);
 					// perform the keyEventTriggered to kick off checking
-					keyEventTriggered(kev.key, pressState, glyph);
+					keyEventTriggered(kev.key, pressState, glyph, kev.timestamp);
 				}
 			} else {
 				// trigger special powers
-				if (!kev.key.empty() && !utilities::keyIsAModifier(kev.key) && kev.type == TouchType::TouchEnded) {
-					LogI << "sending alt command for key " << kev.key;
-					// now send a Notif along with the key label. (KBM or somebody should take notice)
-					Notif::send("CopyText_TriggerAltKey", std::make_shared<KeyEvent>(kev));
+				if (kev.key != InvalidKeyID && !kbm->isModifierKey(kev.key) && kev.type == TouchType::TouchEnded) {
+					LogI << "sending alt command for key " << kbm->getKeyLabel(kev.key);
+					// now send a Notif along with the key event. (KBM or somebody should take notice)
+					Notif::send(notif::CopyText_TriggerAltKey, kev);
 				}
 			}
 		}
@@ -328,15 +378,15 @@ namespace ac {
 
 #pragma mark - Getting (parts of) the Copy String
 
-	GlyphString CopyText::getVisibleString() const
+	GlyphStringView CopyText::getVisibleString() const
 	{
 		// avoid exception
-		if (pImpl->copyStringOffset >= pImpl->copyString.size()) {
-			GlyphString empty;
-			return empty;
+		if (pImpl->copyStringOffset >= pImpl->generatedEnd()) {
+			return GlyphStringView();
 		}
 		
-		GlyphString visibleString(pImpl->copyString.substr(pImpl->copyStringOffset, pImpl->visibleBlocksPerRow));
+		const GlyphStringView visibleString(pImpl->copyString.substr(pImpl->indexOf(pImpl->copyStringOffset),
+																	 pImpl->visibleBlocksPerRow));
 		LogD4 << boost::format("The visible string: %s") % visibleString;
 		return visibleString;
 	}
@@ -351,14 +401,27 @@ namespace ac {
 			rightEdge -= pImpl->unitsToAdvanceSaved; // pImpl->unitsToAdvance by this point has been cleared to 0
 		}
 
-		if (rightEdge >= pImpl->copyString.size()) {
+		if (rightEdge >= pImpl->copyTextLength) {
 			return 0;
 		} else {
-			return pImpl->copyString.size() - rightEdge;
+			return pImpl->copyTextLength - rightEdge;
 		}
 	}
 
 
+	size_t CopyText::length() const
+	{
+		return pImpl->copyTextLength;
+	}
+
+
+	void CopyText::reduceEncasementLevelInVisibleRow(size_t index, int amount)
+	{
+		if (pImpl->copyStringOffset + index >= pImpl->generatedEnd()) return;
+		pImpl->copyString.reduceEncasementLevelAtIndex(pImpl->indexOf(pImpl->copyStringOffset + index), amount);
+	}
+
+
 #pragma mark - Initializing Copy String
 
 
@@ -366,17 +429,47 @@ namespace ac {
 	{
 		DebugSettingsHelper &debug(DebugSettingsHelper::sharedHelper());
 
-		std::vector<Glyph> usedGlyphs(GameState::getInstance().glyphMap().glyphsUsed(playerLevel));
+		copyString.clear();
+		copyTextLength = MAX(0, debug.intValueForProperty("glyphs_to_generate"));
+		generatesCopyString = true;
 
-		int noOfGlyphsToGenerate = debug.intValueForProperty("glyphs_to_generate");
+		configureGenerator(playerLevel);
+		fillLookahead();
+		// LogD << "(Random) Copy string Loaded: " << this->copyString;
+	}
+
+
+	void CopyTextImpl::configureGenerator(size_t playerLevel)
+	{
+		std::vector<Glyph> usedGlyphs(GameState::getInstance().glyphMap().glyphsUsed(playerLevel));
 
 		// should be read from a function in PlayerLevel
 		vector<float> repeatChances = PlayerLevel::glyphRepeatChances(playerLevel);
-		this->copyString.generateRandom(noOfGlyphsToGenerate, usedGlyphs, repeatChances);
+		generator.configure(usedGlyphs, repeatChances);
+		generator.setDifficulty(&scoreKeeper().getGlyphDifficulty());
+		generator.seed(RandomService::get(RandomStream::CopyText).next64());
+	}
 
-		this->copyString.generateObstructions();
-		this->copyString.generateEncasements(noOfGlyphsToGenerate, 0);
-		// LogD << "(Random) Copy string Loaded: " << this->copyString;
+
+	void CopyTextImpl::fillLookahead()
+	{
+		if (!generatesCopyString) return;
+
+		// whole chunks behind the cursor won't be looked at again
+		const size_t consumed = indexOf(copyStringOffset);
+		if (consumed >= ChunkSize) {
+			copyString.dropFront(consumed - consumed % ChunkSize);
+		}
+
+		const size_t wanted = MIN(copyTextLength, copyStringOffset + visibleBlocksPerRow + LookaheadChunks * ChunkSize);
+		while (generatedEnd() < wanted) {
+			const size_t from = copyString.size();
+			copyString.appendRandom(MIN(ChunkSize, copyTextLength - generatedEnd()), generator);
+			if (copyString.size() == from) break; // no glyphs to generate from
+
+			copyString.generateObstructions(from, copyString.size());
+			copyString.generateEncasements(from, copyString.size());
+		}
 	}
 
 
@@ -386,24 +479,17 @@ namespace ac {
 		GlyphMap &gm(GameState::getInstance().glyphMap());
 		
 		gm.loadGlyphToKeyMappings(playerLevel);
-		std::vector<Glyph> usedGlyphs(gm.glyphsUsed(playerLevel));
+		pImpl->configureGenerator(playerLevel);
 
 		// one past the visibility
 		size_t indexOfRightEdge = pImpl->copyStringOffset + getVisibleString().size();
-		size_t noOfGlyphsToGenerate = debug.intValueForProperty("glyphs_to_generate") - indexOfRightEdge;
-
-		// (Optional) subtract this amount by what's visible.
-
-		vector<float> repeatChances = PlayerLevel::glyphRepeatChances(playerLevel);
-
-		GlyphString appendee;
-		appendee.generateRandom(noOfGlyphsToGenerate, usedGlyphs, repeatChances);
-
-		pImpl->copyString.resize(indexOfRightEdge);
-		pImpl->copyString.append(appendee);
 
-		pImpl->copyString.generateObstructions();
-		pImpl->copyString.generateEncasements(noOfGlyphsToGenerate, indexOfRightEdge);
+		// what's already been typed or is on screen stays as it is; the rest is generated again for the new level
+		// as the player gets to it
+		pImpl->copyString.resize(pImpl->indexOf(indexOfRightEdge));
+		pImpl->copyTextLength = MAX(indexOfRightEdge, (size_t) MAX(0, debug.intValueForProperty("glyphs_to_generate")));
+		pImpl->generatesCopyString = true;
+		pImpl->fillLookahead();
 
 		LogI << "Appended new string";
 	}
@@ -414,14 +500,18 @@ namespace ac {
 	void CopyText::setCopyString(const GlyphString &newCopyStr)
 	{
 		pImpl->copyString = newCopyStr;
-		Notif::send("CopyText_LoadedString");
+		pImpl->copyTextLength = newCopyStr.droppedFromFront() + newCopyStr.size();
+		pImpl->generatesCopyString = false;
+		Notif::send(notif::CopyText_LoadedString);
 	}
 
 
 	void CopyText::clearCopyString()
 	{
 		pImpl->copyString.clear();
-		Notif::send("CopyText_ClearedString");
+		pImpl->copyTextLength = 0;
+		pImpl->generatesCopyString = false;
+		Notif::send(notif::CopyText_ClearedString);
 	}
 
 
@@ -442,7 +532,7 @@ namespace ac {
 	float CopyText::getProgress() const
 	{
 		// curOffset / glyf string size
-		float progress = (float) curOffset() / pImpl->copyString.size();
+		float progress = (float) curOffset() / pImpl->copyTextLength;
 		return progress;
 	}
 }
@@ -25,18 +25,26 @@ namespace ac {
 		// resets the copy text state to the start position. Issued upon the use of the restart button in the main screen
 		void reset();
 
-		// called as a result of processing buffered input.
-		void keyEventTriggered(string &label, KeyPressState &, const Glyph &);
+		// called as a result of processing buffered input. The timestamp is the key event's (microseconds on the steady
+		// clock), for the session history.
+		void keyEventTriggered(KeyID key, const KeyPressState &, const Glyph &, uint64_t timestamp = 0);
 
 		size_t curOffset() const; // position in the copy string that is affected by next keypress (starting from zero)
 		float getProgress() const;
 		
-		GlyphString getVisibleString() const; // the string to be shown
+		// the string to be shown; a view into the copy string, so only good until the copy string changes
+		GlyphStringView getVisibleString() const;
 
 		// number of glyphs to the right of the visible string; indicate whether figure represents
 		// before or after the advance
 		size_t remainingCharCount(bool preAdvance) const;
 
+		// glyphs in the whole copy text, including the ones that haven't been generated yet
+		size_t length() const;
+
+		// index is relative to the start of the visible string
+		void reduceEncasementLevelInVisibleRow(size_t index, int amount);
+
 		// BlockCanvasModel uses this to determine how many blocks to slide in (and out);
 		// done after checking what was entered.
 		size_t unitsToAdvance() const;
@@ -52,6 +60,8 @@ namespace ac {
 		void setCopyString(const GlyphString &glyphString);
 		void clearCopyString();
 
+		// Only the part of the copy text around the cursor: a generated copy string is made as the player gets to
+		// it, and the typed part is dropped. Position p (as in curOffset) is at index p - droppedFromFront().
 		GlyphString &copyString();
 		const GlyphString &copyString() const;
 
@@ -0,0 +1,504 @@
+//
+//  CopyTextCorpus.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/12/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "CopyTextCorpus.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include "MappedFile.h"
+#include "log.h"
+
+namespace ac {
+
+	using std::vector;
+	using boost::string_ref;
+
+	static const char CorpusMagic[8] = { 'T', 'G', 'C', 'O', 'R', 'P', 'U', 'S' };
+	static const uint32_t CorpusVersion = 1;
+
+
+#pragma mark - Parsing JSON Copy Files
+
+	namespace copytext {
+
+		static inline const char *skipWhitespace(const char *p, const char *end)
+		{
+			while (p < end && std::isspace((unsigned char) *p)) p++;
+			return p;
+		}
+
+
+		// end of the JSON string starting after the opening quote at p (pointing at the closing quote), or end
+		static inline const char *endOfString(const char *p, const char *end, bool &hasEscapes)
+		{
+			while (p < end && *p != '"') {
+				if (*p == '\\') {
+					hasEscapes = true;
+					p++;
+				}
+				p++;
+			}
+			return p < end ? p : end;
+		}
+
+
+		bool findJSONContent(const char *data, size_t length, string_ref &content, bool &hasEscapes)
+		{
+			const char *p = data, *end = data + length;
+			content = string_ref();
+			p = skipWhitespace(p, end);
+			if (p == end || *p != '{') return false;
+
+			static const string_ref key("content");
+			int depth = 0;
+			for (; p < end; p++) {
+				switch (*p) {
+					case '{': case '[': depth++; break;
+					case '}': case ']': depth--; break;
+					case '"': {
+						bool keyHasEscapes = false;
+						const char *first = p + 1, *last = endOfString(first, end, keyHasEscapes);
+						if (last == end) return false; // unterminated
+						p = last;
+
+						const char *colon = skipWhitespace(last + 1, end);
+						if (depth != 1 || colon == end || *colon != ':' || string_ref(first, last - first) != key) break;
+
+						const char *value = skipWhitespace(colon + 1, end);
+						if (value == end || *value != '"') return false; // content that's not a string
+						const char *valueEnd = endOfString(value + 1, end, hasEscapes);
+						if (valueEnd == end) return false;
+						content = string_ref(value + 1, valueEnd - value - 1);
+						return true;
+					}
+					default: break;
+				}
+			}
+			return true;
+		}
+
+
+		static void appendUtf8(string &out, unsigned codePoint)
+		{
+			if (codePoint < 0x80) {
+				out += (char) codePoint;
+			} else if (codePoint < 0x800) {
+				out += (char) (0xC0 | (codePoint >> 6));
+				out += (char) (0x80 | (codePoint & 0x3F));
+			} else if (codePoint < 0x10000) {
+				out += (char) (0xE0 | (codePoint >> 12));
+				out += (char) (0x80 | ((codePoint >> 6) & 0x3F));
+				out += (char) (0x80 | (codePoint & 0x3F));
+			} else {
+				out += (char) (0xF0 | (codePoint >> 18));
+				out += (char) (0x80 | ((codePoint >> 12) & 0x3F));
+				out += (char) (0x80 | ((codePoint >> 6) & 0x3F));
+				out += (char) (0x80 | (codePoint & 0x3F));
+			}
+		}
+
+
+		// the four hex digits of a \u escape starting at content[i]
+		static bool parseHex4(string_ref content, size_t i, unsigned &value)
+		{
+			if (i + 4 > content.size()) return false;
+			value = 0;
+			for (size_t k = i; k < i + 4; k++) {
+				const char c = content[k];
+				unsigned digit;
+				if (c >= '0' && c <= '9') digit = c - '0';
+				else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+				else return false;
+				value = value << 4 | digit;
+			}
+			return true;
+		}
+
+
+		bool decodeJSONEscapes(string_ref content, string &decoded)
+		{
+			decoded.clear();
+			decoded.reserve(content.size());
+			for (size_t i = 0; i < content.size(); i++) {
+				const char c = content[i];
+				if (c != '\\') {
+					decoded += c;
+					continue;
+				}
+				if (i + 1 == content.size()) return false;
+
+				const char escaped = content[++i];
+				switch (escaped) {
+					case 'n': decoded += '\n'; break;
+					case 't': decoded += '\t'; break;
+					case 'r': decoded += '\r'; break;
+					case 'b': decoded += '\b'; break;
+					case 'f': decoded += '\f'; break;
+					case '"': case '\\': case '/': decoded += escaped; break;
+					case 'u': {
+						unsigned codePoint;
+						if (!parseHex4(content, i + 1, codePoint)) return false;
+						i += 4;
+
+						// outside the basic plane it takes a surrogate pair, which is one character
+						if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) return false;
+						if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+							unsigned low;
+							if (i + 2 >= content.size() || content[i + 1] != '\\' || content[i + 2] != 'u' ||
+								!parseHex4(content, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+								return false;
+							}
+							codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+							i += 6;
+						}
+						appendUtf8(decoded, codePoint);
+						break;
+					}
+					default: return false;
+				}
+			}
+			return true;
+		}
+
+
+		// Words longer than the limit get a line of their own. Runs of spaces within a line are kept as they are,
+		// but wrapping counts each gap as a single space.
+		void wrapLines(string_ref content, size_t maxCharsPerLine, vector<CopyTextLine> &lines)
+		{
+			const char *base = content.data(), *end = base + content.size();
+
+			auto pushLine = [&](const char *first, const char *last) {
+				while (first < last && std::isspace((unsigned char) *first)) first++;
+				while (last > first && std::isspace((unsigned char) last[-1])) last--;
+				if (first < last) {
+					CopyTextLine line = {};
+					line.offset = (uint32_t) (first - base);
+					line.length = (uint32_t) (last - first);
+					lines.push_back(line);
+				}
+			};
+
+			const char *p = base;
+			while (p < end) {
+				const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+				if (!eol) eol = end;
+
+				const char *lineStart = nullptr, *lineEnd = nullptr;
+				size_t wrappedLength = 0; // words plus one space each
+				while (p < eol) {
+					while (p < eol && *p == ' ') p++;
+					if (p == eol) break;
+					const char *word = p;
+					while (p < eol && *p != ' ') p++;
+					const size_t wordLength = p - word;
+
+					if (maxCharsPerLine != 0 && lineStart && wordLength + wrappedLength > maxCharsPerLine) {
+						pushLine(lineStart, lineEnd);
+						lineStart = nullptr;
+						wrappedLength = 0;
+					}
+					if (!lineStart) lineStart = word;
+					lineEnd = p;
+					wrappedLength += wordLength + 1;
+				}
+				if (lineStart) pushLine(lineStart, lineEnd);
+
+				p = eol + 1;
+			}
+		}
+
+
+		size_t glyphClass(char c)
+		{
+			const unsigned char lower = (unsigned char) std::tolower((unsigned char) c);
+			return (lower >= 'a' && lower <= 'z') ? lower - 'a' : NumberOfGlyphClasses - 1;
+		}
+	}
+
+
+#pragma mark - pImpl
+
+	// The accessors below read through the pointers, which point either into the mapped file or at the vectors
+	// filled in by build().
+	struct CopyTextCorpusImpl
+	{
+		CopyTextCorpusImpl() : header(nullptr), lines(nullptr), linesByDifficulty(nullptr), text(nullptr) {}
+
+		void reset()
+		{
+			file.unmap();
+			builtLines.clear();
+			builtLinesByDifficulty.clear();
+			header = nullptr;
+			lines = nullptr;
+			linesByDifficulty = nullptr;
+			text = nullptr;
+		}
+
+		const CopyTextCorpusHeader *header;
+		const CopyTextLine *lines;
+		const uint32_t *linesByDifficulty;
+		const char *text;
+
+		MappedFile file;
+
+		CopyTextCorpusHeader builtHeader;
+		vector<CopyTextLine> builtLines;
+		vector<uint32_t> builtLinesByDifficulty;
+	};
+
+
+#pragma mark - Lifetime
+
+	CopyTextCorpus::CopyTextCorpus()
+	{
+		pImpl.reset(new CopyTextCorpusImpl);
+	}
+
+
+	CopyTextCorpus::~CopyTextCorpus() {}
+
+
+	void CopyTextCorpus::clear()
+	{
+		pImpl->reset();
+	}
+
+
+#pragma mark - Building
+
+	// A letter is rare if it makes up less than half of an even share of the corpus's letters. The difficulty of a
+	// line is the tercile its score (rare letters count double, plus the number of distinct glyphs) falls in.
+	void CopyTextCorpus::build(string_ref text, vector<CopyTextLine> lines, size_t maxCharsPerLine)
+	{
+		pImpl->reset();
+		if (text.size() > UINT32_MAX) {
+			LogE << "CopyTextCorpus: text too large to index";
+			return;
+		}
+
+		CopyTextCorpusHeader &header(pImpl->builtHeader);
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, CorpusMagic, sizeof(header.magic));
+		header.version = CorpusVersion;
+		header.maxCharsPerLine = (uint32_t) maxCharsPerLine;
+		header.lineCount = (uint32_t) lines.size();
+		header.textSize = (uint32_t) text.size();
+
+		// glyph class by byte, NoGlyph for whitespace
+		const uint8_t NoGlyph = 0xFF;
+		uint8_t classOf[256];
+		for (int b = 0; b < 256; b++) {
+			classOf[b] = std::isspace(b) ? NoGlyph : (uint8_t) copytext::glyphClass((char) b);
+		}
+
+		vector<uint32_t> scores(lines.size());
+		for (size_t n = 0; n < lines.size(); n++) {
+			CopyTextLine &line(lines[n]);
+			line.glyphMask = 0;
+			const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data()) + line.offset;
+			for (const unsigned char *end = p + line.length; p < end; p++) {
+				const uint8_t c = classOf[*p];
+				if (c == NoGlyph) continue;
+				header.glyphCounts[c]++;
+				line.glyphMask |= 1u << c;
+			}
+		}
+
+		uint32_t letters = 0;
+		for (size_t c = 0; c + 1 < NumberOfGlyphClasses; c++) letters += header.glyphCounts[c];
+		bool rare[NumberOfGlyphClasses] = {};
+		for (size_t c = 0; c + 1 < NumberOfGlyphClasses; c++) {
+			rare[c] = header.glyphCounts[c] * (NumberOfGlyphClasses - 1) * 2 < letters;
+		}
+
+		for (size_t n = 0; n < lines.size(); n++) {
+			CopyTextLine &line(lines[n]);
+			line.rareGlyphs = 0;
+			const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data()) + line.offset;
+			for (const unsigned char *end = p + line.length; p < end; p++) {
+				const uint8_t c = classOf[*p];
+				if (c != NoGlyph && rare[c] && line.rareGlyphs < UINT16_MAX) line.rareGlyphs++;
+			}
+			line.distinctGlyphs = (uint8_t) __builtin_popcount(line.glyphMask);
+			scores[n] = 2 * line.rareGlyphs + line.distinctGlyphs;
+		}
+
+		uint32_t thresholds[NumberOfCopyTextDifficulties - 1] = {};
+		if (!scores.empty()) {
+			vector<uint32_t> sorted(scores);
+			for (size_t d = 0; d + 1 < NumberOfCopyTextDifficulties; d++) {
+				auto nth = sorted.begin() + sorted.size() * (d + 1) / NumberOfCopyTextDifficulties;
+				std::nth_element(sorted.begin(), nth, sorted.end());
+				thresholds[d] = *nth;
+			}
+		}
+
+		// counting sort of the line numbers by difficulty
+		uint32_t counts[NumberOfCopyTextDifficulties] = {};
+		for (size_t n = 0; n < lines.size(); n++) {
+			size_t difficulty = 0;
+			while (difficulty + 1 < NumberOfCopyTextDifficulties && scores[n] >= thresholds[difficulty]) difficulty++;
+			lines[n].difficulty = (uint8_t) difficulty;
+			counts[difficulty]++;
+		}
+		for (size_t d = 0; d < NumberOfCopyTextDifficulties; d++) {
+			header.difficultyStarts[d + 1] = header.difficultyStarts[d] + counts[d];
+		}
+		pImpl->builtLinesByDifficulty.resize(lines.size());
+		uint32_t next[NumberOfCopyTextDifficulties];
+		std::copy(header.difficultyStarts, header.difficultyStarts + NumberOfCopyTextDifficulties, next);
+		for (size_t n = 0; n < lines.size(); n++) {
+			pImpl->builtLinesByDifficulty[next[lines[n].difficulty]++] = (uint32_t) n;
+		}
+
+		pImpl->builtLines = std::move(lines);
+		pImpl->header = &header;
+		pImpl->lines = pImpl->builtLines.data();
+		pImpl->linesByDifficulty = pImpl->builtLinesByDifficulty.data();
+		pImpl->text = text.data();
+	}
+
+
+#pragma mark - Compiled Corpus Files
+
+	bool CopyTextCorpus::isCompiledCorpus(const char *data, size_t length)
+	{
+		return length >= sizeof(CorpusMagic) && memcmp(data, CorpusMagic, sizeof(CorpusMagic)) == 0;
+	}
+
+
+	// The ranges of linesByDifficulty have to go up from 0 to lineCount, and each has to list lines of its own
+	// difficulty, so that nothing read from the mapping later indexes past it.
+	static bool isValidIndex(const CopyTextCorpusHeader &header, const CopyTextLine *lines,
+							 const uint32_t *linesByDifficulty)
+	{
+		if (header.difficultyStarts[0] != 0) return false;
+		for (size_t d = 0; d < NumberOfCopyTextDifficulties; d++) {
+			const uint32_t first = header.difficultyStarts[d], last = header.difficultyStarts[d + 1];
+			if (first > last || last > header.lineCount) return false;
+			for (uint32_t k = first; k < last; k++) {
+				const uint32_t lineNumber = linesByDifficulty[k];
+				if (lineNumber >= header.lineCount || lines[lineNumber].difficulty != d) return false;
+			}
+		}
+		return true;
+	}
+
+
+	bool CopyTextCorpus::open(const string &path)
+	{
+		pImpl->reset();
+		MappedFile &file(pImpl->file);
+		if (!file.map(path)) {
+			LogE << "CopyTextCorpus: could not map " << path;
+			return false;
+		}
+
+		const CopyTextCorpusHeader *header = reinterpret_cast<const CopyTextCorpusHeader *>(file.data);
+		if (file.length < sizeof(CopyTextCorpusHeader) || !isCompiledCorpus(file.data, file.length) ||
+			header->version != CorpusVersion) {
+			LogE << "CopyTextCorpus: " << path << " is not a compiled corpus (version " << CorpusVersion << ")";
+			pImpl->reset();
+			return false;
+		}
+
+		const size_t linesSize = (size_t) header->lineCount * sizeof(CopyTextLine);
+		const size_t indexSize = (size_t) header->lineCount * sizeof(uint32_t);
+		if (sizeof(CopyTextCorpusHeader) + linesSize + indexSize + header->textSize != file.length ||
+			header->difficultyStarts[NumberOfCopyTextDifficulties] != header->lineCount) {
+			LogE << "CopyTextCorpus: " << path << " is truncated or corrupt";
+			pImpl->reset();
+			return false;
+		}
+
+		const char *p = file.data + sizeof(CopyTextCorpusHeader);
+		const CopyTextLine *lines = reinterpret_cast<const CopyTextLine *>(p);
+		const uint32_t *linesByDifficulty = reinterpret_cast<const uint32_t *>(p + linesSize);
+		if (!isValidIndex(*header, lines, linesByDifficulty)) {
+			LogE << "CopyTextCorpus: " << path << " has a corrupt difficulty index";
+			pImpl->reset();
+			return false;
+		}
+
+		pImpl->header = header;
+		pImpl->lines = lines;
+		pImpl->linesByDifficulty = linesByDifficulty;
+		pImpl->text = p + linesSize + indexSize;
+		return true;
+	}
+
+
+	bool CopyTextCorpus::write(const string &path) const
+	{
+		if (!pImpl->header) return false;
+
+		std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+		const CopyTextCorpusHeader &header(*pImpl->header);
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char *>(pImpl->lines), header.lineCount * sizeof(CopyTextLine));
+		out.write(reinterpret_cast<const char *>(pImpl->linesByDifficulty), header.lineCount * sizeof(uint32_t));
+		out.write(pImpl->text, header.textSize);
+		return out.good();
+	}
+
+
+#pragma mark - Getters
+
+	size_t CopyTextCorpus::getNumberOfLines() const
+	{
+		return pImpl->header ? pImpl->header->lineCount : 0;
+	}
+
+
+	size_t CopyTextCorpus::getMaxCharsPerLine() const
+	{
+		return pImpl->header ? pImpl->header->maxCharsPerLine : 0;
+	}
+
+
+	string_ref CopyTextCorpus::getLine(size_t lineNumber) const
+	{
+		if (lineNumber >= getNumberOfLines()) return string_ref();
+
+		const CopyTextLine &line(pImpl->lines[lineNumber]);
+		if ((size_t) line.offset + line.length > pImpl->header->textSize) return string_ref();
+		return string_ref(pImpl->text + line.offset, line.length);
+	}
+
+
+	const CopyTextLine &CopyTextCorpus::getLineSummary(size_t lineNumber) const
+	{
+		static const CopyTextLine None = {};
+		return lineNumber < getNumberOfLines() ? pImpl->lines[lineNumber] : None;
+	}
+
+
+	size_t CopyTextCorpus::getNumberOfLines(CopyTextDifficulty difficulty) const
+	{
+		const size_t d = (size_t) difficulty;
+		if (!pImpl->header || d >= NumberOfCopyTextDifficulties) return 0;
+		return pImpl->header->difficultyStarts[d + 1] - pImpl->header->difficultyStarts[d];
+	}
+
+
+	size_t CopyTextCorpus::getLineNumber(CopyTextDifficulty difficulty, size_t nth) const
+	{
+		// no header or no such line: one past the last, which getLine() turns into an empty one
+		if (nth >= getNumberOfLines(difficulty)) return getNumberOfLines();
+		return pImpl->linesByDifficulty[pImpl->header->difficultyStarts[(size_t) difficulty] + nth];
+	}
+
+
+	uint32_t CopyTextCorpus::getGlyphCount(size_t glyphClass) const
+	{
+		return pImpl->header && glyphClass < NumberOfGlyphClasses ? pImpl->header->glyphCounts[glyphClass] : 0;
+	}
+}
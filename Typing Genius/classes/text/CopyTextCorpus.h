@@ -0,0 +1,121 @@
+//
+//  CopyTextCorpus.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/12/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Wrapped lines of copy text, each with a summary of the glyphs it uses, plus an index of the lines by difficulty.
+//	A corpus is either built in memory from a JSON copy file (see CopyTextLoader) or compiled ahead of time into a
+//	binary file (see Tools/CopyTextCompiler) that is used straight from a memory mapping:
+//
+//		CopyTextCorpusHeader
+//		CopyTextLine			lines[lineCount]
+//		uint32_t				linesByDifficulty[lineCount]	(line numbers, grouped by difficulty)
+//		char					text[textSize]					(UTF-8; lines are offsets into this)
+//
+//	Everything is stored in the byte order of the machine that compiled it (little-endian on every current target).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/utility/string_ref.hpp>
+
+namespace ac {
+
+	using std::string;
+
+	enum class CopyTextDifficulty : uint8_t
+	{
+		Easy, Moderate, Hard
+	};
+
+	const size_t NumberOfCopyTextDifficulties = 3;
+
+	// letters 'a' to 'z' (either case) are classes 0 to 25; anything else that isn't whitespace is 26
+	const size_t NumberOfGlyphClasses = 27;
+
+
+	struct CopyTextLine
+	{
+		uint32_t offset;
+		uint32_t length;
+		uint32_t glyphMask;		// bit n set if glyph class n appears in the line
+		uint16_t rareGlyphs;	// occurrences of letters that are uncommon across the whole corpus
+		uint8_t distinctGlyphs;
+		uint8_t difficulty;		// a CopyTextDifficulty
+	};
+
+
+	struct CopyTextCorpusHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t maxCharsPerLine;
+		uint32_t lineCount;
+		uint32_t textSize;
+		uint32_t glyphCounts[NumberOfGlyphClasses];
+		uint32_t difficultyStarts[NumberOfCopyTextDifficulties + 1]; // ranges within linesByDifficulty
+	};
+
+
+	namespace copytext {
+
+		// Locates the top-level "content" string of a JSON copy file. A file without one has no content (and isn't
+		// an error); false means the buffer isn't a JSON object.
+		bool findJSONContent(const char *data, size_t length, boost::string_ref &content, bool &hasEscapes);
+
+		// false on an escape that isn't valid JSON (a bad \u, or half a surrogate pair)
+		bool decodeJSONEscapes(boost::string_ref content, string &decoded);
+
+		// Splits on newlines, then wraps each line at word boundaries so that no line goes past maxCharsPerLine
+		// (0 means no limit). Only offset and length of the lines are filled in.
+		void wrapLines(boost::string_ref content, size_t maxCharsPerLine, std::vector<CopyTextLine> &lines);
+
+		size_t glyphClass(char c);
+	}
+
+
+	struct CopyTextCorpusImpl;
+
+	class CopyTextCorpus
+	{
+	public:
+		CopyTextCorpus();
+		~CopyTextCorpus();
+
+		// Summarizes and indexes lines of text that's kept elsewhere: text has to outlive the corpus (or the next
+		// build/open call).
+		void build(boost::string_ref text, std::vector<CopyTextLine> lines, size_t maxCharsPerLine);
+
+		// compiled corpus files
+		static bool isCompiledCorpus(const char *data, size_t length);
+		bool open(const string &path);
+		bool write(const string &path) const;
+
+		void clear();
+
+		size_t getNumberOfLines() const;
+		size_t getMaxCharsPerLine() const;
+
+		// empty (all zeroes) if out of range
+		boost::string_ref getLine(size_t lineNumber) const;
+		const CopyTextLine &getLineSummary(size_t lineNumber) const;
+
+		size_t getNumberOfLines(CopyTextDifficulty difficulty) const;
+		// the nth line (by line number) of the given difficulty; getNumberOfLines() if there's no such line
+		size_t getLineNumber(CopyTextDifficulty difficulty, size_t nth) const;
+
+		uint32_t getGlyphCount(size_t glyphClass) const; // over the whole corpus
+
+	private:
+		// noncopyable
+		CopyTextCorpus(const CopyTextCorpus &);
+		CopyTextCorpus &operator=(const CopyTextCorpus &);
+
+		std::unique_ptr<CopyTextCorpusImpl> pImpl;
+	};
+}
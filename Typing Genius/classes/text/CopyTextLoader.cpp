@@ -7,28 +7,31 @@
 //
 
 #include "CopyTextLoader.h"
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/tokenizer.hpp>
-#include <boost/foreach.hpp>
-#include <boost/algorithm/string.hpp> // for boost::trim
+#include "CopyTextCorpus.h"
+#include "MappedFile.h"
 #include "Utilities.h"
 #include "DebugSettingsHelper.h"
 
 namespace ac {
 	
 	using std::vector;
-	using boost::property_tree::ptree;
-	using boost::property_tree::json_parser_error;
-	
+	using boost::string_ref;
+
 #pragma mark - pImpl
 	
 	struct CopyTextLoaderImpl
 	{
-		CopyTextLoaderImpl() : lines(), pt(), loadingHasError(false), filename(), maxCharsPerLine(0) {}
-		
-		vector<string> lines;
-		ptree pt;
+		CopyTextLoaderImpl() : corpus(), file(), decodedContent(), loadingHasError(false), filename(),
+			maxCharsPerLine(0) {}
+
+		bool loadJSON(const string &fullPath);
+		bool loadCompiledCorpus(const string &fullPath);
+
+		CopyTextCorpus corpus;
+
+		MappedFile file; // a JSON copy file, which the corpus lines point into
+		string decodedContent; // only used when the content has escape sequences that need decoding
+
 		bool loadingHasError;
 		
 		string filename;
@@ -49,102 +52,114 @@ namespace ac {
 	{
 		pImpl.reset(new CopyTextLoaderImpl);
 	}
+
+
+	CopyTextLoader::~CopyTextLoader() {}
 	
 	
 #pragma mark - Initialize
+
+	// Either a JSON copy file, which is memory-mapped and wrapped in place (no property tree, no string per line), or
+	// a corpus compiled ahead of time by Tools/CopyTextCompiler, which is used straight from the mapping.
 	void CopyTextLoader::loadTextFile(const string &filename)
 	{
 		LogI << "Loading text file copy from " << filename;
-		pImpl->lines.clear();
+		pImpl->corpus.clear();
+		pImpl->file.unmap();
+		pImpl->decodedContent.clear();
 		pImpl->loadingHasError = false;
 		
 		string fullPath = utilities::getFullPathForFilename(filename);
-		try {
-			read_json(fullPath, pImpl->pt);
-		} catch (const json_parser_error &obj) {
-			LogE << "Problem loading copy file: " << obj.what();
+		if (!pImpl->file.map(fullPath)) {
+			LogE << "Problem loading copy file: could not map " << fullPath;
 			pImpl->loadingHasError = true;
 			return;
 		}
-		
+
+		const bool loaded = CopyTextCorpus::isCompiledCorpus(pImpl->file.data, pImpl->file.length) ?
+			pImpl->loadCompiledCorpus(fullPath) : pImpl->loadJSON(fullPath);
+		if (!loaded) {
+			pImpl->file.unmap();
+			pImpl->loadingHasError = true;
+			return;
+		}
+
 		pImpl->filename = filename;
-		
-		// read lines into lines one by one.
-		string content(pImpl->pt.get<string>("content", ""));
-		
-		if (!content.empty()) {
-			std::stringstream ss(content);
-			string to;
-			
-			while (std::getline(ss, to, '\n')) {
-				// to : a single line
-				
-				// if the whole line fits within the param, push it all in
-				// otherwise, only push the first n chars (not splitting within lexical words) and then repeat
-				
-				boost::char_separator<char> sep(" ");
-				
-				boost::tokenizer<boost::char_separator<char>> tokens(to, sep);
-				
-				std::ostringstream os;
-				
-				for (const auto& t : tokens) {
-					if (pImpl->maxCharsPerLine != 0 &&
-						t.size() + os.str().size() > pImpl->maxCharsPerLine) {
-
-						// wrap
-						if (!os.str().empty()) {
-							LogD << "Pushed: " << os.str();
-							pImpl->lines.push_back(boost::trim_copy(os.str()));
-						}
-						os.str("");
-					}
-					os << t << " ";
-				}
-				
-				// remaining string
-				if (!os.str().empty()) {
-					LogD << "Pushed: " << os.str();
-					pImpl->lines.push_back(boost::trim_copy(os.str()));
-				}
+		LogD << "Loaded " << pImpl->corpus.getNumberOfLines() << " lines";
+	}
+
+
+	bool CopyTextLoaderImpl::loadJSON(const string &fullPath)
+	{
+		string_ref content;
+		bool hasEscapes = false;
+		if (!copytext::findJSONContent(file.data, file.length, content, hasEscapes)) {
+			LogE << "Problem loading copy file: " << fullPath << " is not a JSON object";
+			return false;
+		}
+
+		if (hasEscapes) {
+			if (!copytext::decodeJSONEscapes(content, decodedContent)) {
+				LogE << "Problem loading copy file: " << fullPath << " has a malformed escape in its content";
+				return false;
 			}
-			
-//			BOOST_FOREACH(const auto &string, pImpl->lines) {
-//				LogI << string;
-//			}
-			
+			content = decodedContent;
 		}
+
+		vector<CopyTextLine> lines;
+		copytext::wrapLines(content, maxCharsPerLine, lines);
+		corpus.build(content, std::move(lines), maxCharsPerLine);
+		return true;
+	}
+
+
+	bool CopyTextLoaderImpl::loadCompiledCorpus(const string &fullPath)
+	{
+		file.unmap(); // the corpus maps it itself
+		if (!corpus.open(fullPath)) return false;
+
+		if (corpus.getMaxCharsPerLine() != maxCharsPerLine) {
+			LogW << "Copy corpus " << fullPath << " was wrapped at " << corpus.getMaxCharsPerLine() <<
+				" chars per line, not " << maxCharsPerLine << "; recompile it to change that";
+		}
+		return true;
 	}
 	
 	
 #pragma mark - Getters & Setters
 	
-	const string &CopyTextLoader::getLine(const size_t lineNumber) const
+	string_ref CopyTextLoader::getLine(const size_t lineNumber) const
 	{
-		static string emptyString = "";
-		
-		size_t numLines = pImpl->lines.size();
-		if (lineNumber < numLines) {
-			LogD << boost::format("the line: [%s]") % pImpl->lines[lineNumber];
-			return pImpl->lines[lineNumber];
-		}
-		
-		return emptyString;
+		return pImpl->corpus.getLine(lineNumber);
 	}
 
 
-	const string &CopyTextLoader::getRandomLine() const
+	string_ref CopyTextLoader::getRandomLine() const
 	{
-//		size_t numberOfLines(getNumberOfLines());
-//		return getLine(utilities::random(numberOfLines - 1));
-		
-		return getLine(0);
+		const size_t numberOfLines(getNumberOfLines());
+		if (numberOfLines == 0) return string_ref();
+		return getLine(utilities::random(numberOfLines - 1));
+	}
+
+
+	string_ref CopyTextLoader::getRandomLine(CopyTextDifficulty difficulty) const
+	{
+		const CopyTextCorpus &corpus(pImpl->corpus);
+		const size_t numberOfLines(corpus.getNumberOfLines(difficulty));
+		if (numberOfLines == 0) return string_ref();
+		return getLine(corpus.getLineNumber(difficulty, utilities::random(numberOfLines - 1)));
 	}
 	
 	
 	const size_t CopyTextLoader::getNumberOfLines() const
 	{
-		return pImpl->lines.size();
+		return pImpl->corpus.getNumberOfLines();
+	}
+
+
+	const CopyTextCorpus &CopyTextLoader::corpus() const
+	{
+		return pImpl->corpus;
 	}
 	
 	
@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <boost/utility/string_ref.hpp>
+#include "CopyTextCorpus.h"
+
 namespace ac {
 	
 	using std::string;
@@ -20,17 +23,26 @@ namespace ac {
 	public:
 		static CopyTextLoader& getInstance(); // singleton getter
 		
-		/** after calling this the loaded strings could be accessed through getLine and getNumberOfLines */
+		/** 
+		 *	after calling this the loaded strings could be accessed through getLine and getNumberOfLines. Takes either
+		 *	a JSON copy file or a corpus compiled by Tools/CopyTextCompiler (which keeps the width it was compiled with)
+		 */
 		void loadTextFile(const string &filename);
 		
-		// valid for the next loadTextFile call
+		// valid for the next loadTextFile call (of a JSON file)
 		void setMaxCharsPerLine(const size_t maxChars);
 		
 		bool hasError(); // for tests
 		
-		const string &getLine(const size_t lineNumber) const;
-		const string &getRandomLine() const;
+		// Lines point into the loaded file (which stays memory-mapped), so they are only good until the next
+		// loadTextFile call. Copy them into a string to keep them longer.
+		boost::string_ref getLine(const size_t lineNumber) const;
+		boost::string_ref getRandomLine() const;
+		boost::string_ref getRandomLine(CopyTextDifficulty difficulty) const;
 		const size_t getNumberOfLines() const;
+
+		// line summaries and the difficulty index
+		const CopyTextCorpus &corpus() const;
 		
 		// loader can be passed the strings from another class which returns
 		// filenames (from the bundle) that
@@ -38,6 +50,7 @@ namespace ac {
 		
 	private:
 		CopyTextLoader(); // use the public singleton getter instead
+		~CopyTextLoader();
 		
 		// noncopyable
 		CopyTextLoader(const CopyTextLoader &);
@@ -9,8 +9,11 @@
 
 #pragma once
 
-#include <set>
-#include <map>
+#include <algorithm>
+#include <ostream>
+#include <vector>
+#include <boost/dynamic_bitset.hpp>
+#include "Random.h"
 
 
 namespace ac {
@@ -21,7 +24,6 @@ namespace ac {
 		explicit Glyph() : Glyph(-1) {}
 		explicit Glyph(int code) : Glyph(code, 1) {}
 		explicit Glyph(int code, int level) : code(code), level(level) {	}
-		explicit Glyph(const Glyph &other) : code(other.getCode()), level(other.getLevel()) {}
 		inline int getCode() const { return code; }
 		inline void setCode(int code) { this->code = code; }
 
@@ -45,43 +47,57 @@ namespace ac {
 	}
 
 	
-	// maybe I should just inline all of these
+	class GlyphStringView;
+	class GlyphGenerator;
+
+
+	// Stored as parallel arrays (codes, levels, obstruction bits, encasement levels) rather than one array of Glyphs
+	// plus a set and a map on the side, so that checks on a keypress are plain array reads.
 	class GlyphString
 	{
 	public:
 		GlyphString();
 		
-		GlyphString(const GlyphString &gsToCopy);
+		GlyphString(const GlyphString &gsToCopy) = default;
+		GlyphString(GlyphString &&gsToMove) = default;
 		GlyphString(const Glyph &glyph);
+		GlyphString(const GlyphStringView &view); // copies the glyphs and their obstructions/encasements
 		
-		const Glyph &operator[](size_t idx) const;
-		GlyphString &operator=(const GlyphString& rhs);
+		Glyph operator[](size_t idx) const;
+		GlyphString &operator=(const GlyphString& rhs) = default;
+		GlyphString &operator=(GlyphString&& rhs) = default;
 		
 		void clear();
 		
-		size_t size() const;
+		inline size_t size() const { return codes.size(); }
 
 		void resize(size_t);
 
-		GlyphString substr(size_t idx, size_t len) const;
+		// does not copy anything: the view is only good while this string is alive and unmodified
+		GlyphStringView substr(size_t idx, size_t len) const;
+
+		inline int codeAtIndex(size_t index) const { return codes[index]; }
+
+		inline const int *codeData() const { return codes.data(); }
 
 		inline bool hasObstructionAtIndex(size_t index) const {
-			return indicesWithObstructions.find(index) != indicesWithObstructions.end();
+			return index < obstructions.size() && obstructions.test(index);
 		}
 
 
 		/** 
 		 *	@brief answers the question as to whether a glyph has something "covering it up"... and to what extent.
-		 *	@return 0 is nonexistent any other number represents the number of times the block has to be 'tapped'
+		 *	@return 0 is nonexistent (including past the end) any other number represents the number of times the
+		 *	block has to be 'tapped'
 		 */
-		inline size_t encasementLevelAtIndex(size_t index) const { return indicesWithEncasements.at(index); }
+		inline size_t encasementLevelAtIndex(size_t index) const {
+			return index < encasementLevels.size() ? encasementLevels[index] : 0;
+		}
 
 		inline void reduceEncasementLevelAtIndex(size_t index, int amount) {
-			size_t newEncasementLevel = 0;
-			if ((int) indicesWithEncasements[index] > amount) {
-				newEncasementLevel = indicesWithEncasements[index] - amount;
-			}
-			indicesWithEncasements[index] = newEncasementLevel;
+			if (index >= encasementLevels.size()) return;
+			const int level = encasementLevels[index];
+			encasementLevels[index] = level > amount ? level - amount : 0;
 		}
 		
 		void append(const Glyph &glyph);
@@ -91,41 +107,108 @@ namespace ac {
 		// assistanceLevel at zero means "truly random" (not necessarily the hardest).
 		// The larger the amount (positive), the more likely it is that a recognizable pattern can be generated.
 		// The smaller the amount (negative), the less likely that randomly-generated patterns are generated
+		// The generators draw from the given engine, by default their own stream of the RandomService: seed that
+		// (or pass engines seeded the same way) to get the same string again.
 		void generateRandom(size_t requiredSize, std::vector<Glyph>& glyphsUsed,
-							const std::vector<float> &repeatChances);
+							const std::vector<float> &repeatChances,
+							Random &random = RandomService::get(RandomStream::CopyText));
 
-		// has to be regenerated on a level up
-		void generateObstructions(); // should be called after generateRandom
+		// same, with a generator that's already configured (and seeded, for a reproducible string)
+		void generateRandom(size_t requiredSize, GlyphGenerator &generator);
 
-		void generateEncasements(size_t requiredSize, size_t startOffset);
+		// adds count generated glyphs (without obstructions or encasements), continuing from the ones already there
+		void appendRandom(size_t count, GlyphGenerator &generator);
+
+		// Removes the first count glyphs, for strings that are generated as they're consumed. The glyph that was at
+		// index i is at i - count afterwards; positions (see droppedFromFront) still count from the original start.
+		void dropFront(size_t count);
+
+		// glyphs removed by dropFront altogether. Obstruction and encasement chances go by position in the original
+		// string, which is this plus the index.
+		inline size_t droppedFromFront() const { return droppedCount; }
+
+		// Both only touch [from, to) (clamped to the string), leaving the rest as it is: on a level up only the tail
+		// that was replaced needs them. Call them after generateRandom, obstructions first (encasements skip
+		// obstructed glyphs).
+		void generateObstructions(size_t from, size_t to,
+								  Random &random = RandomService::get(RandomStream::Obstructions));
+
+		void generateEncasements(size_t from, size_t to,
+								 Random &random = RandomService::get(RandomStream::Encasements));
 
 	private:
-		std::vector<Glyph> vec;
-		std::set<size_t> indicesWithObstructions;
-		std::map<size_t, size_t> indicesWithEncasements; // index => encasement level
+		friend class GlyphStringView;
+
+		void appendRange(const GlyphString &gs, size_t idx, size_t len);
 
+		std::vector<int> codes;
+		std::vector<int> levels;
+		boost::dynamic_bitset<> obstructions;
+		std::vector<unsigned char> encasementLevels;
+
+		size_t droppedCount = 0;
 	};
 
 
-	inline std::ostream& operator<<(std::ostream& out, const GlyphString& gs)
+	// Non-owning window into a GlyphString (offset and length), returned by GlyphString::substr. Cheap to copy.
+	class GlyphStringView
+	{
+	public:
+		GlyphStringView() : source(nullptr), offset(0), length(0) {}
+		GlyphStringView(const GlyphString &gs) : source(&gs), offset(0), length(gs.size()) {}
+		GlyphStringView(const GlyphString &gs, size_t offset, size_t length) :
+			source(&gs), offset(offset), length(length) {}
+
+		inline size_t size() const { return length; }
+
+		inline size_t offsetInSource() const { return offset; }
+
+		// throws std::out_of_range like GlyphString does
+		Glyph operator[](size_t idx) const;
+
+		GlyphStringView substr(size_t idx, size_t len) const;
+
+		inline int codeAtIndex(size_t index) const { return source->codes[offset + index]; }
+
+		inline const int *codeData() const { return length ? source->codes.data() + offset : nullptr; }
+
+		inline bool hasObstructionAtIndex(size_t index) const {
+			return index < length && source->hasObstructionAtIndex(offset + index);
+		}
+
+		inline size_t encasementLevelAtIndex(size_t index) const {
+			return index < length ? source->encasementLevelAtIndex(offset + index) : 0;
+		}
+
+	private:
+		friend class GlyphString;
+
+		const GlyphString *source;
+		size_t offset;
+		size_t length;
+	};
+
+
+	inline std::ostream& operator<<(std::ostream& out, const GlyphStringView& gs)
 	{
 		out << "[ ";
-		for (int i = 0; i < gs.size(); ++i) {
-			out << gs[i].getCode() << " ";
+		for (size_t i = 0; i < gs.size(); ++i) {
+			out << gs.codeAtIndex(i) << " ";
 		}
 		out << "] (length " << gs.size() << ")";
 		return out;
 	}
 
-	inline bool operator==(const GlyphString &gs1, const GlyphString &gs2)
+	inline std::ostream& operator<<(std::ostream& out, const GlyphString& gs)
 	{
-		if (gs1.size() != gs2.size()) return false;
-
-		for (int i = 0; i < gs1.size(); i++) {
-			if (gs1[i].getCode() != gs2[i].getCode()) return false;
-		}
+		return out << GlyphStringView(gs);
+	}
 
-		return true;
+	// only the codes are compared. GlyphStrings convert to views, so this covers every combination of the two.
+	inline bool operator==(const GlyphStringView &gs1, const GlyphStringView &gs2)
+	{
+		if (gs1.size() != gs2.size()) return false;
+		return std::equal(gs1.codeData(), gs1.codeData() + gs1.size(), gs2.codeData());
 	}
 	
 	
@@ -135,7 +218,7 @@ namespace ac {
 	}
 
 
-	inline bool operator!=(const GlyphString &gs1, const GlyphString &gs2)
+	inline bool operator!=(const GlyphStringView &gs1, const GlyphStringView &gs2)
 	{
 		return !(gs1 == gs2);
 	}
@@ -0,0 +1,111 @@
+//
+//  GlyphDifficulty.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/24/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "GlyphDifficulty.h"
+#include <algorithm>
+
+namespace ac {
+
+	constexpr float GlyphDifficulty::MaxWeight;
+
+	// glyph codes past this aren't tracked (the glyph maps stay well under it)
+	static const int MaxTrackedCode = 4096;
+
+	// how far each keystroke moves a glyph's averages; about the last dozen times it was typed count
+	static const float GlyphDecay = 0.125f;
+	// the same for the mean over all glyphs, which sees every keystroke so can afford to be slower
+	static const float MeanDecay = 1.0f / 64;
+
+	// longer than this is the player pausing, not struggling
+	static const uint32_t MaxCountedLatencyMillis = 3000;
+
+	// weight added by a mistake rate of 1, and by taking twice as long as usual
+	static const float MistakeBoost = 6;
+	static const float LatencyBoost = 1.5f;
+
+
+	GlyphDifficulty::GlyphDifficulty() : meanLatency(0), ceiling(1)
+	{
+	}
+
+
+	void GlyphDifficulty::reset()
+	{
+		stats.clear();
+		meanLatency = 0;
+		ceiling = 1;
+	}
+
+
+	GlyphDifficulty::GlyphStats *GlyphDifficulty::statsFor(int code)
+	{
+		if (code < 0 || code >= MaxTrackedCode) return nullptr;
+		if ((size_t) code >= stats.size()) {
+			const GlyphStats untyped = { 0, 0, 1 };
+			stats.resize(code + 1, untyped);
+		}
+		return &stats[code];
+	}
+
+
+#pragma mark - Recording
+
+	void GlyphDifficulty::recordCorrect(int code, uint32_t latencyMillis)
+	{
+		GlyphStats *s = statsFor(code);
+		if (!s) return;
+
+		s->mistakeRate -= GlyphDecay * s->mistakeRate;
+
+		if (latencyMillis > 0 && latencyMillis <= MaxCountedLatencyMillis) {
+			const float latency = (float) latencyMillis;
+			// the first time starts the average rather than being decayed in from zero
+			s->latencyMillis = s->latencyMillis > 0 ? s->latencyMillis + GlyphDecay * (latency - s->latencyMillis) :
+													  latency;
+			meanLatency = meanLatency > 0 ? meanLatency + MeanDecay * (latency - meanLatency) : latency;
+		}
+		reweigh(*s);
+	}
+
+
+	void GlyphDifficulty::recordMistake(int code)
+	{
+		GlyphStats *s = statsFor(code);
+		if (!s) return;
+
+		s->mistakeRate += GlyphDecay * (1 - s->mistakeRate);
+		reweigh(*s);
+	}
+
+
+	// Only the glyph just typed is reweighed, against the mean as it is now; the others catch up the next time they
+	// come up. Redoing them all would make every keystroke cost as much as there are glyphs.
+	void GlyphDifficulty::reweigh(GlyphStats &s)
+	{
+		float weight = 1 + MistakeBoost * s.mistakeRate;
+		if (s.latencyMillis > 0 && meanLatency > 0) {
+			weight += LatencyBoost * std::max(0.0f, s.latencyMillis / meanLatency - 1);
+		}
+		s.weight = std::min(weight, MaxWeight);
+		ceiling = std::max(ceiling, s.weight);
+	}
+
+
+#pragma mark - Getters
+
+	float GlyphDifficulty::mistakeRate(int code) const
+	{
+		return code >= 0 && (size_t) code < stats.size() ? stats[code].mistakeRate : 0;
+	}
+
+
+	float GlyphDifficulty::latencyMillis(int code) const
+	{
+		return code >= 0 && (size_t) code < stats.size() ? stats[code].latencyMillis : 0;
+	}
+}
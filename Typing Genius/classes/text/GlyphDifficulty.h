@@ -0,0 +1,66 @@
+//
+//  GlyphDifficulty.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/24/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	How hard the player is finding each glyph lately: an exponentially decaying mistake rate and time to type it,
+//	kept per glyph code in one flat array and updated by the ScoreKeeper on every keystroke. Each glyph's weight
+//	(1 for one the player has no trouble with, up to MaxWeight) is worked out when its stats change, so that the
+//	GlyphGenerator can read it while drawing glyphs without any work on either side.
+//
+//	Nothing in here looks at a clock or a random number: the same keystrokes always give the same weights.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ac {
+
+	class GlyphDifficulty
+	{
+	public:
+		// how much more often than usual the hardest glyph is drawn
+		static constexpr float MaxWeight = 4;
+
+		GlyphDifficulty();
+
+		// latencyMillis is the time since the previous keystroke, 0 if there wasn't one to go by
+		void recordCorrect(int code, uint32_t latencyMillis);
+		void recordMistake(int code);
+
+		// forgets everything, as for a new player
+		void reset();
+
+		// 1 to MaxWeight; 1 for glyphs not typed yet
+		inline float weight(int code) const
+		{
+			return code >= 0 && (size_t) code < stats.size() ? stats[code].weight : 1;
+		}
+
+		// No glyph's weight has gone above this since the last reset(). The generator draws against it, so while
+		// it's still 1 weights can be ignored altogether.
+		inline float weightCeiling() const { return ceiling; }
+
+		float mistakeRate(int code) const; // 0 - 1
+		float latencyMillis(int code) const; // 0 if never timed
+		inline float meanLatencyMillis() const { return meanLatency; }
+
+	private:
+		struct GlyphStats
+		{
+			float mistakeRate;
+			float latencyMillis;
+			float weight;
+		};
+
+		std::vector<GlyphStats> stats; // by glyph code
+		float meanLatency; // over all glyphs, to tell what's slow for this player
+		float ceiling;
+
+		GlyphStats *statsFor(int code);
+		void reweigh(GlyphStats &);
+	};
+}
@@ -0,0 +1,152 @@
+//
+//  GlyphGenerator.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/14/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "GlyphGenerator.h"
+#include <algorithm>
+#include "GlyphDifficulty.h"
+#include "Utilities.h"
+
+namespace ac {
+
+	const size_t GlyphGenerator::MaxRepeatChances;
+
+	// a space can never repeat, and has its own probability
+	static const double ChanceOfSpace = 0.2;
+
+
+	GlyphGenerator::GlyphGenerator() : difficulty(nullptr), spaceWillBeUsed(false), canAvoidRepeats(false),
+	repeatCount(0)
+	{
+		// constructor
+	}
+
+
+	void GlyphGenerator::configure(const std::vector<Glyph> &glyphsUsed, const std::vector<float> &repeatChances)
+	{
+		glyphCodes.clear();
+		std::vector<double> weights;
+		spaceWillBeUsed = false;
+
+		for (const Glyph &g : glyphsUsed) {
+			if (g.getCode() == 0) {
+				spaceWillBeUsed = true;
+				continue;
+			}
+			std::vector<int>::iterator it = std::find(glyphCodes.begin(), glyphCodes.end(), g.getCode());
+			if (it == glyphCodes.end()) {
+				glyphCodes.push_back(g.getCode());
+				weights.push_back(1);
+			} else {
+				weights[it - glyphCodes.begin()] += 1;
+			}
+		}
+		glyphTable.build(weights.data(), weights.size());
+		canAvoidRepeats = spaceWillBeUsed || glyphCodes.size() > 1;
+
+		// Each step the old generator tried, in order: a space (if the last one wasn't), repeating the last glyph,
+		// then for every farther repeat chance that passed, replacing the fresh glyph with the one that far back.
+		// The last one to pass wins, so the farthest is checked first here.
+		repeatCount = std::min(repeatChances.size(), MaxRepeatChances);
+		const size_t outcomes = LookBack + (repeatCount > 1 ? repeatCount - 1 : 0);
+		stepTables.resize((size_t) 1 << (repeatCount + 1));
+
+		std::vector<double> p(outcomes);
+		for (size_t mask = 0; mask < stepTables.size(); mask++) {
+			std::fill(p.begin(), p.end(), 0.0);
+			double rest = 1;
+
+			if (mask & ((size_t) 1 << repeatCount)) {
+				p[Space] = ChanceOfSpace;
+				rest -= ChanceOfSpace;
+			}
+			if (repeatCount > 0 && (mask & 1)) {
+				const double chance = std::max(0.0, std::min(1.0, (double) repeatChances[0]));
+				p[RepeatLast] = rest * chance;
+				rest *= 1 - chance;
+			}
+			for (size_t i = repeatCount; i-- > 1;) {
+				if (!(mask & ((size_t) 1 << i))) continue;
+				const double chance = std::max(0.0, std::min(1.0, (double) repeatChances[i]));
+				p[LookBack + i - 1] = rest * chance;
+				rest *= 1 - chance;
+			}
+			p[Fresh] = rest;
+
+			stepTables[mask].build(p.data(), p.size());
+		}
+	}
+
+
+	void GlyphGenerator::seed(uint64_t seed)
+	{
+		engine.seed(seed);
+	}
+
+
+	int GlyphGenerator::drawFresh()
+	{
+		// no weight is past 1 yet, so the draw would always be kept
+		if (!difficulty || difficulty->weightCeiling() <= 1) {
+			return glyphCodes[glyphTable.sample(engine)];
+		}
+
+		const double ceiling = difficulty->weightCeiling();
+		for (;;) {
+			const int code = glyphCodes[glyphTable.sample(engine)];
+			if (engine.nextDouble() * ceiling < difficulty->weight(code)) return code;
+		}
+	}
+
+
+	size_t GlyphGenerator::generate(int *codes, size_t count, size_t preceding)
+	{
+		if (glyphCodes.empty()) {
+			LogW << "No glyphs assigned to keys yet. Try to load mappings first";
+			return 0;
+		}
+
+		const size_t spaceBit = (size_t) 1 << repeatCount;
+
+		// from here on codes[0..preceding) is the lookback and the new glyphs start at preceding
+		codes -= preceding;
+		count += preceding;
+
+		// you can't repeat if the last one is a repeat (and doubled glyphs are always repeats)
+		bool lastWasRepeat = preceding >= 2 && codes[preceding - 1] == codes[preceding - 2];
+
+		size_t n = preceding;
+		while (n < count) {
+			const int last = n > 0 ? codes[n - 1] : -1;
+
+			size_t mask = 0;
+			if (spaceWillBeUsed && last != 0) mask |= spaceBit;
+			if (n > 0 && last != 0 && !lastWasRepeat) mask |= 1;
+			for (size_t i = 1; i < repeatCount && i < n; i++) {
+				if (codes[n - 1 - i] != 0) mask |= (size_t) 1 << i;
+			}
+
+			const size_t outcome = stepTables[mask].sample(engine);
+			if (outcome == Space) {
+				codes[n++] = 0;
+				lastWasRepeat = false;
+			} else if (outcome == RepeatLast) {
+				codes[n++] = last;
+				lastWasRepeat = true;
+			} else {
+				const int code = outcome == Fresh ? drawFresh() :
+													codes[n - 1 - (outcome - LookBack + 1)];
+				// every doubled glyph is deliberate (RepeatLast), so draw again rather than double by accident
+				if (code != last || !canAvoidRepeats) {
+					codes[n++] = code;
+					lastWasRepeat = false;
+				}
+			}
+		}
+		return n - preceding;
+	}
+}
@@ -0,0 +1,74 @@
+//
+//  GlyphGenerator.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/14/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Generates the random copy string glyph codes. Everything that depends on the level (the glyph weights and the
+//	chances in PlayerLevel::glyphRepeatChances) is turned into alias tables by configure(), so generate() draws each
+//	glyph in constant time and writes straight into the caller's buffer.
+//
+//	Given a GlyphDifficulty, fresh glyphs are also weighted by how much trouble the player has with them. Those
+//	weights change as the player types, so rather than going into the alias table they are applied by rejection:
+//	a glyph drawn from the table is kept with a chance of its weight over the difficulty's weight ceiling.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "AliasTable.h"
+#include "Glyph.h"
+#include "Random.h"
+
+namespace ac {
+
+	class GlyphDifficulty;
+
+	class GlyphGenerator
+	{
+	public:
+		// repeat chances past this many are ignored (PlayerLevel uses five)
+		static const size_t MaxRepeatChances = 8;
+
+		GlyphGenerator();
+
+		// Glyphs are weighted by how many times their code appears in glyphsUsed. The space (code 0) isn't weighted:
+		// if it is in there it has its own chance, and is never placed twice in a row.
+		void configure(const std::vector<Glyph> &glyphsUsed, const std::vector<float> &repeatChances);
+
+		// the same seed and configuration always produce the same codes
+		void seed(uint64_t seed);
+
+		// not owned; the difficulty's weights are read as each glyph is drawn (nullptr to draw without them)
+		inline void setDifficulty(const GlyphDifficulty *difficulty) { this->difficulty = difficulty; }
+
+		// Fills codes[0..count) and returns the number written, which is 0 if no glyphs other than the space were
+		// configured. codes[-preceding..-1] are the glyphs before (if any), which repeats may look back on, so that a
+		// string generated in pieces reads like one generated at once. Doesn't allocate.
+		size_t generate(int *codes, size_t count, size_t preceding = 0);
+
+		inline bool isConfigured() const { return !glyphCodes.empty(); }
+
+	private:
+		// one step of the generator, see stepTables
+		enum Outcome { Space, Fresh, RepeatLast, LookBack };
+
+		Random engine;
+
+		std::vector<int> glyphCodes;
+		AliasTable glyphTable;
+		const GlyphDifficulty *difficulty;
+
+		int drawFresh();
+
+		bool spaceWillBeUsed;
+		bool canAvoidRepeats; // false when a glyph can only be followed by itself
+		size_t repeatCount;
+
+		// Indexed by which outcomes are possible at the current position (bit i < repeatCount: looking back i + 1
+		// glyphs is allowed; bit repeatCount: a space is allowed). Columns are the Outcome values, with LookBack + k
+		// for taking the glyph k + 1 back.
+		std::vector<AliasTable> stepTables;
+	};
+}
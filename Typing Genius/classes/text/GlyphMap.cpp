@@ -13,6 +13,7 @@
 #include "Player.h"
 #include "PlayerLevel.h"
 #include "Glyph.h"
+#include "KeyRegistry.h"
 
 namespace ac {
 
@@ -46,10 +47,19 @@ namespace ac {
 	{
 		labelToGlyphMap.clear();
 		specialAbilitiesMap.clear();
+		rebuildLookupTables();
 	}
 
 
 	void GlyphMap::setGlyphToKeyLabel(const Glyph &glyph, const string &label)
+	{
+		mapGlyphToKeyLabel(glyph, label);
+		rebuildLookupTables();
+	}
+
+
+	// for filling in many mappings at once, with one rebuildLookupTables() after
+	void GlyphMap::mapGlyphToKeyLabel(const Glyph &glyph, const string &label)
 	{
 		labelToGlyphMap[label] = glyph;
 	}
@@ -61,24 +71,73 @@ namespace ac {
 	}
 
 
+	const Glyph &GlyphMap::glyphForKey(KeyID key) const
+	{
+		if (!hasMapping(key)) {
+			throw std::out_of_range("no glyph for key " + KeyRegistry::getInstance().label(key));
+		}
+		return keyMappings[key].glyph;
+	}
+
+
 	const SpecialAbility &GlyphMap::specialAbilityForKey(const string &keyLabel) const
 	{
 		return specialAbilitiesMap.at(keyLabel);
 	}
 
 
+	const SpecialAbility &GlyphMap::specialAbilityForKey(KeyID key) const
+	{
+		if (!hasAltMapping(key)) {
+			throw std::out_of_range("no special ability for key " + KeyRegistry::getInstance().label(key));
+		}
+		return *keyMappings[key].ability;
+	}
+
+
 	// reverse lookup
 	const string &GlyphMap::keyLabelForGlyph(const Glyph &glyph) const
 	{
-		static string Empty("");
-		// traverse the map
-		for (const auto &pair : labelToGlyphMap) {
-			if (glyph.getCode() == pair.second.getCode()) {
-				return pair.first;
+		return KeyRegistry::getInstance().label(keyForGlyph(glyph));
+	}
+
+
+	KeyID GlyphMap::keyForGlyph(const Glyph &glyph) const
+	{
+		const int code = glyph.getCode();
+		return code >= 0 && (size_t) code < keyByGlyphCode.size() ? keyByGlyphCode[code] : InvalidKeyID;
+	}
+
+
+	void GlyphMap::rebuildLookupTables()
+	{
+		KeyRegistry &registry(KeyRegistry::getInstance());
+		for (const auto &kv : labelToGlyphMap) registry.intern(kv.first);
+		for (const auto &kv : specialAbilitiesMap) registry.intern(kv.first);
+
+		const KeyMapping unmapped = { false, Glyph(), nullptr };
+		keyMappings.assign(registry.size(), unmapped);
+		keyByGlyphCode.clear();
+
+		for (const auto &kv : labelToGlyphMap) {
+			KeyMapping &mapping(keyMappings[registry.find(kv.first)]);
+			mapping.hasGlyph = true;
+			mapping.glyph = kv.second;
+
+			const int code = kv.second.getCode();
+			if (code < 0) continue;
+			if ((size_t) code >= keyByGlyphCode.size()) {
+				keyByGlyphCode.resize(code + 1, InvalidKeyID);
+			}
+			// labels come in order, and it's the first one with the glyph that a reverse lookup has always found
+			if (keyByGlyphCode[code] == InvalidKeyID) {
+				keyByGlyphCode[code] = registry.find(kv.first);
 			}
 		}
 
-		return Empty;
+		for (const auto &kv : specialAbilitiesMap) {
+			keyMappings[registry.find(kv.first)].ability = &kv.second;
+		}
 	}
 
 
@@ -97,7 +156,8 @@ namespace ac {
 	
 	void GlyphMap::regenerateHintColors()
 	{
-		glyphHintColorMap.clear();
+		const utilities::RGBByte white { 255, 255, 255 }; // for glyphs without a color of their own
+		hintColorByGlyphCode.clear();
 		utilities::RGBByte randomRGB { 0,0,0 };
 
 		// per Glyph found, assign it a random color
@@ -111,7 +171,11 @@ namespace ac {
 			}
 			
 			int code = kv.second.getCode();
-			glyphHintColorMap[code] = randomRGB;
+			if (code < 0) continue;
+			if ((size_t) code >= hintColorByGlyphCode.size()) {
+				hintColorByGlyphCode.resize(code + 1, white);
+			}
+			hintColorByGlyphCode[code] = randomRGB;
 			LogI << boost::format("code: %d gets assigned rgb(%d, %d, %d)") % kv.second.getCode() %
 				(int)randomRGB.r % (int)randomRGB.g % (int)randomRGB.b;
 		}
@@ -121,12 +185,11 @@ namespace ac {
 	const utilities::RGBByte &GlyphMap::hintColorForGlyph(const Glyph &glyph) const
 	{
 		static utilities::RGBByte dummyRGB { 255, 255, 255 };
-		try {
-			const utilities::RGBByte &ret(glyphHintColorMap.at(glyph.getCode()));
-			return ret;
-		} catch (std::out_of_range) {
+		const int code = glyph.getCode();
+		if (code < 0 || (size_t) code >= hintColorByGlyphCode.size()) {
 			return dummyRGB;
 		}
+		return hintColorByGlyphCode[code];
 	}
 
 
@@ -136,10 +199,11 @@ namespace ac {
 		for (size_t i = 1; i <= 30; i++) {
 			fmt % i;
 			string keyLabel = fmt.str();
-			setGlyphToKeyLabel(Glyph(i), keyLabel);
+			mapGlyphToKeyLabel(Glyph(i), keyLabel);
 		}
 		// space bar
-		setGlyphToKeyLabel(Glyph(31), "key:000");
+		mapGlyphToKeyLabel(Glyph(31), "key:000");
+		rebuildLookupTables();
 	}
 
 
@@ -162,8 +226,8 @@ namespace ac {
 		// in the case of a unit test
 		if (pt.empty()) {
 			LogE << "PropTree is empty. Adding sample glyphs";
-			setGlyphToKeyLabel(Glyph(86), "key:012");
-			setGlyphToKeyLabel(Glyph(98), "key:013");
+			mapGlyphToKeyLabel(Glyph(86), "key:012");
+			mapGlyphToKeyLabel(Glyph(98), "key:013");
 		}
 
 		// mappings->row_X->key:XXX->{glyphCode/startLevel}
@@ -179,7 +243,7 @@ namespace ac {
 				if (glyphCode >= 0 /*&& playerLevel >= startLevel*/) {
 					LogD2 << boost::format("Key: %s gets Glyph Code %d at level %d") % v2.first % glyphCode % startLevel;
 					Glyph g(glyphCode, startLevel);
-					setGlyphToKeyLabel(g, v2.first);
+					mapGlyphToKeyLabel(g, v2.first);
 				}
 			}
 		}
@@ -203,5 +267,7 @@ namespace ac {
 			// set to a map (key => SA)
 			specialAbilitiesMap[kv.first] = ability;
 		}
+
+		rebuildLookupTables();
 	}
 }
@@ -11,6 +11,7 @@
 #include <vector>
 #include <set>
 #include "Utilities.h"
+#include "ACTypes.h"
 #include "Glyph.h"
 
 namespace ac {
@@ -57,6 +58,12 @@ namespace ac {
 		bool hasMapping(const string &) const;
 		bool hasAltMapping(const string &keyLabel) const;
 
+		// the same lookups by KeyRegistry ID, which are plain array reads
+		inline bool hasMapping(KeyID key) const { return key < keyMappings.size() && keyMappings[key].hasGlyph; }
+		inline bool hasAltMapping(KeyID key) const { return key < keyMappings.size() && keyMappings[key].ability; }
+		const Glyph &glyphForKey(KeyID) const; // can throw std::out_of_range, like glyphForKeyLabel
+		KeyID keyForGlyph(const Glyph &) const; // InvalidKeyID if no key has it
+
 		void loadGlyphToKeyMappings(size_t playerLevel = 1);
 		void regenerateHintColors();
 		
@@ -64,11 +71,25 @@ namespace ac {
 
 		// can throw, uses std::map.at()
 		const SpecialAbility &specialAbilityForKey(const string &keyLabel) const;
+		const SpecialAbility &specialAbilityForKey(KeyID key) const; // throws std::out_of_range too
 
 	private:
 		map<string, Glyph> labelToGlyphMap; // the main map
-		
-		map<int, utilities::RGBByte> glyphHintColorMap;
+
+		// what the maps say, flattened into arrays by KeyID (and glyph code) whenever they change
+		struct KeyMapping
+		{
+			bool hasGlyph;
+			Glyph glyph;
+			const SpecialAbility *ability; // points into specialAbilitiesMap
+		};
+		vector<KeyMapping> keyMappings;
+		vector<KeyID> keyByGlyphCode;
+
+		vector<utilities::RGBByte> hintColorByGlyphCode;
+
+		void mapGlyphToKeyLabel(const Glyph &, const string &);
+		void rebuildLookupTables();
 
 		void setUpBoostTestKeyMappings();
 
@@ -0,0 +1,25 @@
+//
+//  TestMain.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/25/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	What "Boost Unit Tests/main.mm" is to the simulator, for the headless build: there is no cocos2d context to set
+//	up, only the logging.
+
+#define BOOST_TEST_MODULE "Boost Unit Tests"
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+	struct LogLevelSetup
+	{
+		LogLevelSetup()
+		{
+			FILELog::ReportingLevel() = FILELog::FromString("WARNING");
+		}
+	};
+}
+
+BOOST_GLOBAL_FIXTURE(LogLevelSetup);
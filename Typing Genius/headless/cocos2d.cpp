@@ -0,0 +1,124 @@
+//
+//  cocos2d.cpp
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/25/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+
+#include "cocos2d.h"
+#include <cstdlib>
+#include <fstream>
+
+// set by the build (with trailing slashes)
+#ifndef AC_HEADLESS_RESOURCE_PATH
+#define AC_HEADLESS_RESOURCE_PATH "./"
+#endif
+
+#ifndef AC_HEADLESS_WRITABLE_PATH
+#define AC_HEADLESS_WRITABLE_PATH "./"
+#endif
+
+NS_CC_BEGIN
+
+	void CCObject::release()
+	{
+		if (--referenceCount == 0) {
+			delete this;
+		}
+	}
+
+
+#pragma mark - CCDirector
+
+	CCDirector::CCDirector() : winSize(480, 320) // the phone's design resolution
+	{
+	}
+
+
+	CCDirector *CCDirector::sharedDirector()
+	{
+		static CCDirector director;
+		return &director;
+	}
+
+
+#pragma mark - CCFileUtils
+
+	// the same as ScreenResolutionHelper sets up for a phone
+	CCFileUtils::CCFileUtils() :
+	resourceRoot(AC_HEADLESS_RESOURCE_PATH),
+	searchPaths({ "assets/", "configs/", "audio/", "" }),
+	resolutionsOrder({ "phone/", "" })
+	{
+	}
+
+
+	CCFileUtils *CCFileUtils::sharedFileUtils()
+	{
+		static CCFileUtils fileUtils;
+		return &fileUtils;
+	}
+
+
+	std::string CCFileUtils::fullPathForFilename(const char *fileName)
+	{
+		const std::string name(fileName);
+		if (name.empty() || name[0] == '/') return name;
+
+		const size_t slash = name.find_last_of('/');
+		const std::string directory = slash == std::string::npos ? "" : name.substr(0, slash + 1);
+		const std::string file = slash == std::string::npos ? name : name.substr(slash + 1);
+
+		for (const std::string &searchPath : searchPaths) {
+			for (const std::string &resolution : resolutionsOrder) {
+				const std::string path = resourceRoot + searchPath + directory + resolution + file;
+				if (isFileExist(path)) return path;
+			}
+		}
+		// like cocos2d-x, the name as given when it's nowhere to be found
+		return name;
+	}
+
+
+	bool CCFileUtils::isFileExist(const std::string &path)
+	{
+		return std::ifstream(path.c_str()).good();
+	}
+
+
+	static void addTrailingSlashes(std::vector<std::string> &paths)
+	{
+		bool hasDefault = false;
+		for (std::string &path : paths) {
+			if (!path.empty() && path[path.size() - 1] != '/') path += '/';
+			hasDefault = hasDefault || path.empty();
+		}
+		// cocos2d-x always falls back on the unqualified path
+		if (!hasDefault) paths.push_back("");
+	}
+
+
+	void CCFileUtils::setSearchPaths(const std::vector<std::string> &searchPaths)
+	{
+		this->searchPaths = searchPaths;
+		addTrailingSlashes(this->searchPaths);
+	}
+
+
+	void CCFileUtils::setSearchResolutionsOrder(const std::vector<std::string> &resolutionsOrder)
+	{
+		this->resolutionsOrder = resolutionsOrder;
+		addTrailingSlashes(this->resolutionsOrder);
+	}
+
+
+	std::string CCFileUtils::getWritablePath()
+	{
+		const char *path = std::getenv("AC_HEADLESS_WRITABLE_PATH");
+		std::string writable(path && *path ? path : AC_HEADLESS_WRITABLE_PATH);
+		if (writable[writable.size() - 1] != '/') writable += '/';
+		return writable;
+	}
+
+NS_CC_END
@@ -0,0 +1,209 @@
+//
+//  cocos2d.h
+//  Typing Genius
+//
+//  Created by Aldrich Co on 1/25/14.
+//  Copyright (c) 2014 Aldrich Co. All rights reserved.
+//
+//	Stands in for cocos2d-x in the headless build (see CMakeLists.txt), which is the game core without any of its
+//	views, for running the unit tests and benchmarks on Linux. Only what the core uses is here, declared the way
+//	cocos2d-x 2.x declares it so that the same sources build against either: the geometry types, touches by
+//	pointer, a director with a fixed window size, and file utilities that look in the resources folder of the
+//	source tree and write to the build folder.
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#define NS_CC_BEGIN namespace cocos2d {
+#define NS_CC_END }
+#define USING_NS_CC using namespace cocos2d
+
+#ifndef MIN
+#define MIN(x, y) (((x) > (y)) ? (y) : (x))
+#endif
+
+#ifndef MAX
+#define MAX(x, y) (((x) < (y)) ? (y) : (x))
+#endif
+
+#define ccp(__X__, __Y__) cocos2d::CCPointMake((float) (__X__), (float) (__Y__))
+
+NS_CC_BEGIN
+
+	typedef unsigned char GLubyte;
+
+
+	class CCObject
+	{
+	public:
+		CCObject() : referenceCount(1) {}
+		virtual ~CCObject() {}
+
+		inline void retain() { ++referenceCount; }
+		void release();
+		inline unsigned int retainCount() const { return referenceCount; }
+
+	private:
+		unsigned int referenceCount;
+	};
+
+
+#pragma mark - Geometry
+
+	class CCPoint
+	{
+	public:
+		float x;
+		float y;
+
+		CCPoint() : x(0), y(0) {}
+		CCPoint(float x, float y) : x(x), y(y) {}
+
+		inline void setPoint(float x, float y) { this->x = x; this->y = y; }
+		inline bool equals(const CCPoint &target) const { return x == target.x && y == target.y; }
+
+		inline CCPoint operator+(const CCPoint &right) const { return CCPoint(x + right.x, y + right.y); }
+		inline CCPoint operator-(const CCPoint &right) const { return CCPoint(x - right.x, y - right.y); }
+		inline CCPoint operator*(float a) const { return CCPoint(x * a, y * a); }
+	};
+
+
+	class CCSize
+	{
+	public:
+		float width;
+		float height;
+
+		CCSize() : width(0), height(0) {}
+		CCSize(float width, float height) : width(width), height(height) {}
+
+		inline void setSize(float width, float height) { this->width = width; this->height = height; }
+		inline bool equals(const CCSize &target) const { return width == target.width && height == target.height; }
+	};
+
+
+	class CCRect
+	{
+	public:
+		CCPoint origin;
+		CCSize size;
+
+		CCRect() {}
+		CCRect(float x, float y, float width, float height) : origin(x, y), size(width, height) {}
+
+		inline float getMinX() const { return origin.x; }
+		inline float getMidX() const { return origin.x + size.width / 2; }
+		inline float getMaxX() const { return origin.x + size.width; }
+		inline float getMinY() const { return origin.y; }
+		inline float getMidY() const { return origin.y + size.height / 2; }
+		inline float getMaxY() const { return origin.y + size.height; }
+
+		inline bool containsPoint(const CCPoint &point) const
+		{
+			return point.x >= getMinX() && point.x <= getMaxX() && point.y >= getMinY() && point.y <= getMaxY();
+		}
+
+		inline bool intersectsRect(const CCRect &rect) const
+		{
+			return !(getMaxX() < rect.getMinX() || rect.getMaxX() < getMinX() ||
+					 getMaxY() < rect.getMinY() || rect.getMaxY() < getMinY());
+		}
+	};
+
+
+	inline CCPoint CCPointMake(float x, float y) { return CCPoint(x, y); }
+	inline CCSize CCSizeMake(float width, float height) { return CCSize(width, height); }
+	inline CCRect CCRectMake(float x, float y, float width, float height) { return CCRect(x, y, width, height); }
+
+	inline CCPoint ccpAdd(const CCPoint &v1, const CCPoint &v2) { return v1 + v2; }
+	inline CCPoint ccpSub(const CCPoint &v1, const CCPoint &v2) { return v1 - v2; }
+	inline float ccpDistance(const CCPoint &v1, const CCPoint &v2) { return hypotf(v1.x - v2.x, v1.y - v2.y); }
+
+
+	struct ccColor3B
+	{
+		GLubyte r;
+		GLubyte g;
+		GLubyte b;
+	};
+
+	inline ccColor3B ccc3(const GLubyte r, const GLubyte g, const GLubyte b)
+	{
+		ccColor3B c = { r, g, b };
+		return c;
+	}
+
+
+#pragma mark - Nodes and Touches
+
+	class CCNode : public CCObject
+	{
+	public:
+		inline const CCSize &getContentSize() const { return contentSize; }
+		inline void setContentSize(const CCSize &size) { contentSize = size; }
+
+	private:
+		CCSize contentSize;
+	};
+
+
+	class CCTouch : public CCObject
+	{
+	public:
+		CCTouch() : id(0) {}
+
+		inline void setTouchInfo(int id, float x, float y) { this->id = id; point.setPoint(x, y); }
+		inline int getID() const { return id; }
+		inline CCPoint getLocation() const { return point; }
+
+	private:
+		int id;
+		CCPoint point;
+	};
+
+
+	// there is no window: the size is the game's design resolution
+	class CCDirector
+	{
+	public:
+		static CCDirector *sharedDirector();
+
+		inline CCSize getWinSize() const { return winSize; }
+		inline void setWinSize(const CCSize &size) { winSize = size; }
+
+	private:
+		CCDirector();
+		CCSize winSize;
+	};
+
+
+#pragma mark - Files
+
+	// Relative file names are looked up like cocos2d-x does (each search path, then each resolution directory
+	// between the name's own directory and its file name), with search paths relative to the resources folder.
+	class CCFileUtils
+	{
+	public:
+		static CCFileUtils *sharedFileUtils();
+
+		std::string fullPathForFilename(const char *fileName);
+		bool isFileExist(const std::string &path);
+
+		void setSearchPaths(const std::vector<std::string> &searchPaths);
+		void setSearchResolutionsOrder(const std::vector<std::string> &resolutionsOrder);
+
+		// ends in a slash
+		std::string getWritablePath();
+
+	private:
+		CCFileUtils();
+
+		std::string resourceRoot;
+		std::vector<std::string> searchPaths;
+		std::vector<std::string> resolutionsOrder;
+	};
+
+NS_CC_END
@@ -247,12 +247,19 @@ void CCDirector::setGLDefaultValues(void)
 // Draw the Scene
 void CCDirector::drawScene(void)
 {
+    CCProfilingFrameListener *pProfilingListener = g_pProfilingFrameListener;
+    if (pProfilingListener)
+    {
+        pProfilingListener->frameBegan();
+    }
+
     // calculate "global" dt
     calculateDeltaTime();
 
     //tick before glClear: issue #533
     if (! m_bPaused)
     {
+        CC_PROFILER_SECTION(kCCProfilingSectionSchedulerUpdate);
         m_pScheduler->update(m_fDeltaTime);
     }
 
@@ -270,6 +277,7 @@ void CCDirector::drawScene(void)
     // draw the scene
     if (m_pRunningScene)
     {
+        CC_PROFILER_SECTION(kCCProfilingSectionVisit);
         m_pRunningScene->visit();
     }
 
@@ -298,6 +306,11 @@ void CCDirector::drawScene(void)
     {
         calculateMPF();
     }
+
+    if (pProfilingListener)
+    {
+        pProfilingListener->frameEnded();
+    }
 }
 
 void CCDirector::calculateDeltaTime(void)
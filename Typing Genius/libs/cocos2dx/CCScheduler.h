@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "support/data_support/uthash.h"
+#include "support/CCDenseScheduler.h"
 
 NS_CC_BEGIN
 
@@ -102,10 +103,6 @@ protected:
 //
 // CCScheduler
 //
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
-
 class CCArray;
 
 /** @brief Scheduler is responsible for triggering the scheduled callbacks.
@@ -237,32 +234,11 @@ public:
       */
     void resumeTargets(CCSet* targetsToResume);
 
-private:
-    void removeHashElement(struct _hashSelectorEntry *pElement);
-    void removeUpdateFromHash(struct _listEntry *entry);
-
-    // update specific
-
-    void priorityIn(struct _listEntry **ppList, CCObject *pTarget, int nPriority, bool bPaused);
-    void appendIn(struct _listEntry **ppList, CCObject *pTarget, bool bPaused);
-
 protected:
     float m_fTimeScale;
 
-    //
-    // "updates with priority" stuff
-    //
-    struct _listEntry *m_pUpdatesNegList;        // list of priority < 0
-    struct _listEntry *m_pUpdates0List;            // list priority == 0
-    struct _listEntry *m_pUpdatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *m_pHashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
-
-    // Used for "selectors with interval"
-    struct _hashSelectorEntry *m_pHashForTimers;
-    struct _hashSelectorEntry *m_pCurrentTarget;
-    bool m_bCurrentTargetSalvaged;
-    // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
-    bool m_bUpdateHashLocked;
+    // the update selectors by priority and the custom selectors, each in an array (see CCDenseScheduler)
+    CCDenseScheduler<CCObject> m_oSelectors;
     CCArray* m_pScriptHandlerEntries;
 };
 
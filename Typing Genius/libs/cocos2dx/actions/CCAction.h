@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCGeometry.h"
+#include "support/CCPooledAllocation.h"
 #include "platform/CCPlatformMacros.h"
 
 NS_CC_BEGIN
@@ -102,6 +102,8 @@ protected:
  */
 class CC_DLL CCEaseIn : public CCEaseRateAction
 {
+    CC_POOLED_ALLOCATION(CCEaseIn)
+
 public:
     virtual void update(float time);
     virtual CCActionInterval* reverse(void);
@@ -118,6 +120,8 @@ public:
  */
 class CC_DLL CCEaseOut : public CCEaseRateAction
 {
+    CC_POOLED_ALLOCATION(CCEaseOut)
+
 public:
     virtual void update(float time);
     virtual CCActionInterval* reverse();
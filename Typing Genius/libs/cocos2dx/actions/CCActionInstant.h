@@ -205,6 +205,8 @@ protected:
 */
 class CC_DLL CCCallFunc : public CCActionInstant //<NSCopying>
 {
+    CC_POOLED_ALLOCATION(CCCallFunc)
+
 public:
     CCCallFunc()
         : m_pSelectorTarget(NULL)
@@ -271,6 +273,8 @@ N means Node
 */
 class CC_DLL CCCallFuncN : public CCCallFunc, public TypeInfo
 {
+    CC_POOLED_ALLOCATION(CCCallFuncN)
+
 public:
     CCCallFuncN(){}
     virtual ~CCCallFuncN(){}
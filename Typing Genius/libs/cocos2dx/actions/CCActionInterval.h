@@ -95,6 +95,8 @@ protected:
  */
 class CC_DLL CCSequence : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCSequence)
+
 public:
     ~CCSequence(void);
 
@@ -218,6 +220,8 @@ protected:
  */
 class CC_DLL CCSpawn : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCSpawn)
+
 public:
     ~CCSpawn(void);
 
@@ -312,6 +316,8 @@ protected:
  */
 class CC_DLL CCMoveBy : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCMoveBy)
+
 public:
     /** initializes the action */
     bool initWithDuration(float duration, const CCPoint& deltaPosition);
@@ -337,6 +343,8 @@ protected:
  */
 class CC_DLL CCMoveTo : public CCMoveBy
 {
+    CC_POOLED_ALLOCATION(CCMoveTo)
+
 public:
     /** initializes the action */
     bool initWithDuration(float duration, const CCPoint& position);
@@ -488,6 +496,8 @@ protected:
  */
 class CC_DLL CCScaleTo : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCScaleTo)
+
 public:
     /** initializes the action with the same scale factor for X and Y */
     bool initWithDuration(float duration, float s);
@@ -565,6 +575,8 @@ protected:
  */
 class CC_DLL CCFadeIn : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCFadeIn)
+
 public:
     virtual void update(float time);
     virtual CCActionInterval* reverse(void);
@@ -580,6 +592,8 @@ public:
 */
 class CC_DLL CCFadeOut : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCFadeOut)
+
 public:
     virtual void update(float time);
     virtual CCActionInterval* reverse(void);
@@ -596,6 +610,8 @@ public:
  */
 class CC_DLL CCFadeTo : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCFadeTo)
+
 public:
     /** initializes the action with duration and opacity */
     bool initWithDuration(float duration, GLubyte opacity);
@@ -618,6 +634,8 @@ protected:
 */
 class CC_DLL CCTintTo : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCTintTo)
+
 public:
     /** initializes the action with duration and color */
     bool initWithDuration(float duration, GLubyte red, GLubyte green, GLubyte blue);
@@ -665,6 +683,8 @@ protected:
 */
 class CC_DLL CCDelayTime : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCDelayTime)
+
 public:
     virtual void update(float time);
     virtual CCActionInterval* reverse(void);
@@ -29,31 +29,14 @@ THE SOFTWARE.
 #include "base_nodes/CCNode.h"
 #include "CCScheduler.h"
 #include "ccMacros.h"
-#include "support/data_support/ccCArray.h"
-#include "support/data_support/uthash.h"
 #include "cocoa/CCSet.h"
+#include "support/CCProfiling.h"
 
 NS_CC_BEGIN
-//
-// singleton stuff
-//
-typedef struct _hashElement
-{
-    struct _ccArray             *actions;
-    CCObject                    *target;
-    unsigned int                actionIndex;
-    CCAction                    *currentAction;
-    bool                        currentActionSalvaged;
-    bool                        paused;
-    UT_hash_handle                hh;
-} tHashElement;
 
 CCActionManager::CCActionManager(void)
-: m_pTargets(NULL), 
-  m_pCurrentTarget(NULL),
-  m_bCurrentTargetSalvaged(false)
 {
-
+    m_oActions.reserve(256);
 }
 
 CCActionManager::~CCActionManager(void)
@@ -63,97 +46,28 @@ CCActionManager::~CCActionManager(void)
     removeAllActions();
 }
 
-// private
-
-void CCActionManager::deleteHashElement(tHashElement *pElement)
-{
-    ccArrayFree(pElement->actions);
-    HASH_DEL(m_pTargets, pElement);
-    pElement->target->release();
-    free(pElement);
-}
-
-void CCActionManager::actionAllocWithHashElement(tHashElement *pElement)
-{
-    // 4 actions per Node by default
-    if (pElement->actions == NULL)
-    {
-        pElement->actions = ccArrayNew(4);
-    }else 
-    if (pElement->actions->num == pElement->actions->max)
-    {
-        ccArrayDoubleCapacity(pElement->actions);
-    }
-
-}
-
-void CCActionManager::removeActionAtIndex(unsigned int uIndex, tHashElement *pElement)
-{
-    CCAction *pAction = (CCAction*)pElement->actions->arr[uIndex];
-
-    if (pAction == pElement->currentAction && (! pElement->currentActionSalvaged))
-    {
-        pElement->currentAction->retain();
-        pElement->currentActionSalvaged = true;
-    }
-
-    ccArrayRemoveObjectAtIndex(pElement->actions, uIndex, true);
-
-    // update actionIndex in case we are in tick. looping over the actions
-    if (pElement->actionIndex >= uIndex)
-    {
-        pElement->actionIndex--;
-    }
-
-    if (pElement->actions->num == 0)
-    {
-        if (m_pCurrentTarget == pElement)
-        {
-            m_bCurrentTargetSalvaged = true;
-        }
-        else
-        {
-            deleteHashElement(pElement);
-        }
-    }
-}
-
 // pause / resume
 
 void CCActionManager::pauseTarget(CCObject *pTarget)
 {
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-    if (pElement)
-    {
-        pElement->paused = true;
-    }
+    m_oActions.setPaused(pTarget, true);
 }
 
 void CCActionManager::resumeTarget(CCObject *pTarget)
 {
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-    if (pElement)
-    {
-        pElement->paused = false;
-    }
+    m_oActions.setPaused(pTarget, false);
 }
 
 CCSet* CCActionManager::pauseAllRunningActions()
 {
     CCSet *idsWithActions = new CCSet();
     idsWithActions->autorelease();
-    
-    for (tHashElement *element=m_pTargets; element != NULL; element = (tHashElement *)element->hh.next) 
+
+    m_oActions.pauseAll([idsWithActions](CCObject *pTarget)
     {
-        if (! element->paused) 
-        {
-            element->paused = true;
-            idsWithActions->addObject(element->target);
-        }
-    }    
-    
+        idsWithActions->addObject(pTarget);
+    });
+
     return idsWithActions;
 }
 
@@ -173,37 +87,16 @@ void CCActionManager::addAction(CCAction *pAction, CCNode *pTarget, bool paused)
     CCAssert(pAction != NULL, "");
     CCAssert(pTarget != NULL, "");
 
-    tHashElement *pElement = NULL;
-    // we should convert it to CCObject*, because we save it as CCObject*
-    CCObject *tmp = pTarget;
-    HASH_FIND_INT(m_pTargets, &tmp, pElement);
-    if (! pElement)
-    {
-        pElement = (tHashElement*)calloc(sizeof(*pElement), 1);
-        pElement->paused = paused;
-        pTarget->retain();
-        pElement->target = pTarget;
-        HASH_ADD_INT(m_pTargets, target, pElement);
-    }
+    m_oActions.add(pAction, pTarget, paused);
 
-     actionAllocWithHashElement(pElement);
- 
-     CCAssert(! ccArrayContainsObject(pElement->actions, pAction), "");
-     ccArrayAppendObject(pElement->actions, pAction);
- 
-     pAction->startWithTarget(pTarget);
+    pAction->startWithTarget(pTarget);
 }
 
 // remove
 
 void CCActionManager::removeAllActions(void)
 {
-    for (tHashElement *pElement = m_pTargets; pElement != NULL; )
-    {
-        CCObject *pTarget = pElement->target;
-        pElement = (tHashElement*)pElement->hh.next;
-        removeAllActionsFromTarget(pTarget);
-    }
+    m_oActions.removeAll();
 }
 
 void CCActionManager::removeAllActionsFromTarget(CCObject *pTarget)
@@ -214,30 +107,7 @@ void CCActionManager::removeAllActionsFromTarget(CCObject *pTarget)
         return;
     }
 
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-    if (pElement)
-    {
-        if (ccArrayContainsObject(pElement->actions, pElement->currentAction) && (! pElement->currentActionSalvaged))
-        {
-            pElement->currentAction->retain();
-            pElement->currentActionSalvaged = true;
-        }
-
-        ccArrayRemoveAllObjects(pElement->actions);
-        if (m_pCurrentTarget == pElement)
-        {
-            m_bCurrentTargetSalvaged = true;
-        }
-        else
-        {
-            deleteHashElement(pElement);
-        }
-    }
-    else
-    {
-//        CCLOG("cocos2d: removeAllActionsFromTarget: Target not found");
-    }
+    m_oActions.removeAllFromTarget(pTarget);
 }
 
 void CCActionManager::removeAction(CCAction *pAction)
@@ -248,21 +118,7 @@ void CCActionManager::removeAction(CCAction *pAction)
         return;
     }
 
-    tHashElement *pElement = NULL;
-    CCObject *pTarget = pAction->getOriginalTarget();
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-    if (pElement)
-    {
-        unsigned int i = ccArrayGetIndexOfObject(pElement->actions, pAction);
-        if (UINT_MAX != i)
-        {
-            removeActionAtIndex(i, pElement);
-        }
-    }
-    else
-    {
-        CCLOG("cocos2d: removeAction: Target not found");
-    }
+    m_oActions.remove(pAction, pAction->getOriginalTarget());
 }
 
 void CCActionManager::removeActionByTag(unsigned int tag, CCObject *pTarget)
@@ -270,23 +126,7 @@ void CCActionManager::removeActionByTag(unsigned int tag, CCObject *pTarget)
     CCAssert((int)tag != kCCActionTagInvalid, "");
     CCAssert(pTarget != NULL, "");
 
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-
-    if (pElement)
-    {
-        unsigned int limit = pElement->actions->num;
-        for (unsigned int i = 0; i < limit; ++i)
-        {
-            CCAction *pAction = (CCAction*)pElement->actions->arr[i];
-
-            if (pAction->getTag() == (int)tag && pAction->getOriginalTarget() == pTarget)
-            {
-                removeActionAtIndex(i, pElement);
-                break;
-            }
-        }
-    }
+    m_oActions.removeByTag((int)tag, pTarget);
 }
 
 // get
@@ -295,104 +135,20 @@ CCAction* CCActionManager::getActionByTag(unsigned int tag, CCObject *pTarget)
 {
     CCAssert((int)tag != kCCActionTagInvalid, "");
 
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-
-    if (pElement)
-    {
-        if (pElement->actions != NULL)
-        {
-            unsigned int limit = pElement->actions->num;
-            for (unsigned int i = 0; i < limit; ++i)
-            {
-                CCAction *pAction = (CCAction*)pElement->actions->arr[i];
-
-                if (pAction->getTag() == (int)tag)
-                {
-                    return pAction;
-                }
-            }
-        }
-        CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
-    }
-    else
-    {
-        // CCLOG("cocos2d : getActionByTag: Target not found");
-    }
-
-    return NULL;
+    return m_oActions.getByTag((int)tag, pTarget);
 }
 
 unsigned int CCActionManager::numberOfRunningActionsInTarget(CCObject *pTarget)
 {
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(m_pTargets, &pTarget, pElement);
-    if (pElement)
-    {
-        return pElement->actions ? pElement->actions->num : 0;
-    }
-
-    return 0;
+    return m_oActions.count(pTarget);
 }
 
 // main loop
 void CCActionManager::update(float dt)
 {
-    for (tHashElement *elt = m_pTargets; elt != NULL; )
-    {
-        m_pCurrentTarget = elt;
-        m_bCurrentTargetSalvaged = false;
-
-        if (! m_pCurrentTarget->paused)
-        {
-            // The 'actions' CCMutableArray may change while inside this loop.
-            for (m_pCurrentTarget->actionIndex = 0; m_pCurrentTarget->actionIndex < m_pCurrentTarget->actions->num;
-                m_pCurrentTarget->actionIndex++)
-            {
-                m_pCurrentTarget->currentAction = (CCAction*)m_pCurrentTarget->actions->arr[m_pCurrentTarget->actionIndex];
-                if (m_pCurrentTarget->currentAction == NULL)
-                {
-                    continue;
-                }
-
-                m_pCurrentTarget->currentActionSalvaged = false;
-
-                m_pCurrentTarget->currentAction->step(dt);
-
-                if (m_pCurrentTarget->currentActionSalvaged)
-                {
-                    // The currentAction told the node to remove it. To prevent the action from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    m_pCurrentTarget->currentAction->release();
-                } else
-                if (m_pCurrentTarget->currentAction->isDone())
-                {
-                    m_pCurrentTarget->currentAction->stop();
-
-                    CCAction *pAction = m_pCurrentTarget->currentAction;
-                    // Make currentAction nil to prevent removeAction from salvaging it.
-                    m_pCurrentTarget->currentAction = NULL;
-                    removeAction(pAction);
-                }
-
-                m_pCurrentTarget->currentAction = NULL;
-            }
-        }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (m_bCurrentTargetSalvaged && m_pCurrentTarget->actions->num == 0)
-        {
-            deleteHashElement(m_pCurrentTarget);
-        }
-    }
+    CC_PROFILER_SECTION(kCCProfilingSectionActionManager);
 
-    // issue #635
-    m_pCurrentTarget = NULL;
+    m_oActions.update(dt);
 }
 
 NS_CC_END
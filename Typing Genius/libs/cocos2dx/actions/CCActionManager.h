@@ -31,13 +31,12 @@ THE SOFTWARE.
 #include "CCAction.h"
 #include "cocoa/CCArray.h"
 #include "cocoa/CCObject.h"
+#include "support/CCDenseActions.h"
 
 NS_CC_BEGIN
 
 class CCSet;
 
-struct _hashElement;
-
 /**
  * @addtogroup actions
  * @{
@@ -114,17 +113,11 @@ public:
     void resumeTargets(CCSet *targetsToResume);
 
 protected:
-    // declared in CCActionManager.m
-
-    void removeActionAtIndex(unsigned int uIndex, struct _hashElement *pElement);
-    void deleteHashElement(struct _hashElement *pElement);
-    void actionAllocWithHashElement(struct _hashElement *pElement);
     void update(float dt);
 
 protected:
-    struct _hashElement    *m_pTargets;
-    struct _hashElement    *m_pCurrentTarget;
-    bool            m_bCurrentTargetSalvaged;
+    // the running actions, sorted by target (see CCDenseActions)
+    CCDenseActions<CCObject, CCAction> m_oActions;
 };
 
 // end of actions group
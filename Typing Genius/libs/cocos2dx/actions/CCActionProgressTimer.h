@@ -62,6 +62,8 @@ protected:
 */
 class CC_DLL CCProgressFromTo : public CCActionInterval
 {
+    CC_POOLED_ALLOCATION(CCProgressFromTo)
+
 public:
     /** Initializes the action with a duration, a "from" percentage and a "to" percentage */
     bool initWithDuration(float duration, float fFromPercentage, float fToPercentage);
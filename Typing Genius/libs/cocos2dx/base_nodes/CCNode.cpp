@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "kazmath/GL/matrix.h"
 #include "support/component/CCComponent.h"
 #include "support/component/CCComponentContainer.h"
+#include "support/CCProfiling.h"
 
 #if CC_NODE_RENDER_SUBPIXEL
 #define RENDER_IN_SUBPIXEL
@@ -761,6 +762,8 @@ void CCNode::sortAllChildren()
 {
     if (m_bReorderChildDirty)
     {
+        CC_PROFILER_SECTION(kCCProfilingSectionSortChildren);
+
         int i,j,length = m_pChildren->data->num;
         CCNode ** x = (CCNode**)m_pChildren->data->arr;
         CCNode *tempItem;
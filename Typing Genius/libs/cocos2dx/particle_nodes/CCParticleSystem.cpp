@@ -602,6 +602,7 @@ bool CCParticleSystem::isFull()
 // ParticleSystem - MainLoop
 void CCParticleSystem::update(float dt)
 {
+    CC_PROFILER_SECTION(kCCProfilingSectionParticleUpdate);
     CC_PROFILER_START_CATEGORY(kCCProfilerCategoryParticles , "CCParticleSystem - update");
 
     if (m_bIsActive && m_fEmissionRate)
@@ -247,6 +247,8 @@ void CCSpriteBatchNode::sortAllChildren()
 {
     if (m_bReorderChildDirty)
     {
+        CC_PROFILER_SECTION(kCCProfilingSectionSortChildren);
+
         int i = 0,j = 0,length = m_pChildren->data->num;
         CCNode ** x = (CCNode**)m_pChildren->data->arr;
         CCNode *tempItem = NULL;
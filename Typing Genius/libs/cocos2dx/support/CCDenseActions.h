@@ -0,0 +1,328 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_CCDENSEACTIONS_H__
+#define __SUPPORT_CCDENSEACTIONS_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace cocos2d {
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief The running actions behind CCActionManager, in one array sorted by target.
+
+ Each running action is an entry of its target, the action and whether it's paused, and the entries are kept sorted
+ by target (in the order they were added within one), so a target's actions are found with a binary search and
+ update() steps them all in a single pass over contiguous memory. Actions added since the last update() wait at the
+ end of the array, and removed ones are left as holes; the next update() sorts the first in and drops the second, in
+ one merge into a spare array. Once reserve() has made room, none of it allocates.
+
+ An entry holds a reference to its action and to its target. Releasing them waits for the end of the call that removed
+ them, or for the end of update() if it was running, so an action can stop itself from its own step.
+
+ It's a template so it can be tested without the rest of cocos2d-x: an action needs step(float), isDone(), stop(),
+ getTag(), retain() and release(), and a target retain() and release(). It isn't reentrant: update() mustn't be called
+ from an action.
+ */
+template <class Target, class Action>
+class CCDenseActions
+{
+public:
+    CCDenseActions() : m_uSorted(0), m_uHoles(0), m_uAdded(0), m_bLocked(false)
+    {
+    }
+
+    void reserve(size_t actions)
+    {
+        m_entries.reserve(actions);
+        m_merged.reserve(actions);
+        m_releasing.reserve(actions);
+    }
+
+    /** An action added to a target that already has some is paused or not like them; otherwise as it says. Actions
+     added during update() are first stepped in the next. */
+    void add(Action *action, Target *target, bool paused)
+    {
+        const Entry *existing = first(target);
+        const Entry entry = { target, action, m_uAdded++, existing ? existing->paused : paused };
+        m_entries.push_back(entry);
+        action->retain();
+        target->retain();
+    }
+
+    void remove(Action *action, const Target *target)
+    {
+        const size_t i = find(target, IsAction(action));
+        if (i != None) removeAt(i);
+        settle();
+    }
+
+    /** the first one added with that tag */
+    void removeByTag(int tag, const Target *target)
+    {
+        const size_t i = find(target, HasTag(tag));
+        if (i != None) removeAt(i);
+        settle();
+    }
+
+    void removeAllFromTarget(const Target *target)
+    {
+        Range range = sortedRange(target);
+        for (size_t i = range.first; i < range.second; i++) {
+            if (m_entries[i].action) removeAt(i);
+        }
+        for (size_t i = m_uSorted; i < m_entries.size(); i++) {
+            if (m_entries[i].target == target && m_entries[i].action) removeAt(i);
+        }
+        settle();
+    }
+
+    void removeAll()
+    {
+        for (size_t i = 0; i < m_entries.size(); i++) {
+            if (m_entries[i].action) removeAt(i);
+        }
+        settle();
+    }
+
+    Action *getByTag(int tag, const Target *target) const
+    {
+        const size_t i = find(target, HasTag(tag));
+        return i == None ? NULL : m_entries[i].action;
+    }
+
+    unsigned int count(const Target *target) const
+    {
+        unsigned int count = 0;
+        Range range = sortedRange(target);
+        for (size_t i = range.first; i < range.second; i++) {
+            if (m_entries[i].action) count++;
+        }
+        for (size_t i = m_uSorted; i < m_entries.size(); i++) {
+            if (m_entries[i].target == target && m_entries[i].action) count++;
+        }
+        return count;
+    }
+
+    void setPaused(const Target *target, bool paused)
+    {
+        Range range = sortedRange(target);
+        for (size_t i = range.first; i < range.second; i++) {
+            m_entries[i].paused = paused;
+        }
+        for (size_t i = m_uSorted; i < m_entries.size(); i++) {
+            if (m_entries[i].target == target) m_entries[i].paused = paused;
+        }
+    }
+
+    /** pauses the targets that weren't, calling back with each of them */
+    template <class Callback>
+    void pauseAll(Callback paused)
+    {
+        for (size_t i = 0; i < m_entries.size(); i++) {
+            const Entry &entry = m_entries[i];
+            if (!entry.action || entry.paused) continue;
+            Target *target = entry.target;
+            setPaused(target, true);
+            paused(target);
+        }
+    }
+
+    /** Steps every action that isn't paused, and stops and removes those that are done. */
+    void update(float dt)
+    {
+        assert(!m_bLocked);
+        m_bLocked = true;
+
+        const size_t count = m_entries.size();
+        for (size_t i = 0; i < count; i++) {
+            Action *action = m_entries[i].action;
+            if (!action || m_entries[i].paused) continue;
+
+            action->step(dt);
+
+            // unless it was removed while stepping
+            if (m_entries[i].action == action && action->isDone()) {
+                action->stop();
+                if (m_entries[i].action == action) removeAt(i);
+            }
+        }
+
+        tidy();
+        m_bLocked = false;
+        settle();
+    }
+
+    /** running, not counting those removed during update() */
+    inline size_t size() const { return m_entries.size() - m_uHoles; }
+
+private:
+    static const size_t None = (size_t) -1;
+
+    struct Entry
+    {
+        Target *target;
+        Action *action; // NULL once removed
+        uint32_t added; // to keep the order within a target
+        bool paused;
+    };
+
+    struct Before
+    {
+        inline bool operator()(const Entry &a, const Entry &b) const
+        {
+            return a.target != b.target ? std::less<const Target *>()(a.target, b.target) : a.added < b.added;
+        }
+        inline bool operator()(const Entry &a, const Target *target) const
+        {
+            return std::less<const Target *>()(a.target, target);
+        }
+        inline bool operator()(const Target *target, const Entry &b) const
+        {
+            return std::less<const Target *>()(target, b.target);
+        }
+    };
+
+    struct IsAction
+    {
+        const Action *action;
+        IsAction(const Action *action) : action(action) {}
+        inline bool operator()(const Entry &entry) const { return entry.action == action; }
+    };
+
+    struct HasTag
+    {
+        int tag;
+        HasTag(int tag) : tag(tag) {}
+        inline bool operator()(const Entry &entry) const { return entry.action && entry.action->getTag() == tag; }
+    };
+
+    typedef std::pair<size_t, size_t> Range;
+
+    std::vector<Entry> m_entries; // sorted up to m_uSorted, then as added
+    std::vector<Entry> m_merged; // spare, for tidy()
+    std::vector<Entry> m_releasing;
+    size_t m_uSorted;
+    size_t m_uHoles;
+    uint32_t m_uAdded;
+    bool m_bLocked;
+
+    Range sortedRange(const Target *target) const
+    {
+        typename std::vector<Entry>::const_iterator begin = m_entries.begin(), end = begin + m_uSorted;
+        std::pair<typename std::vector<Entry>::const_iterator, typename std::vector<Entry>::const_iterator> range =
+            std::equal_range(begin, end, target, Before());
+        return Range(range.first - begin, range.second - begin);
+    }
+
+    // the first of the target's entries that matches, in the order they were added
+    template <class Match>
+    size_t find(const Target *target, Match match) const
+    {
+        Range range = sortedRange(target);
+        for (size_t i = range.first; i < range.second; i++) {
+            if (m_entries[i].action && match(m_entries[i])) return i;
+        }
+        for (size_t i = m_uSorted; i < m_entries.size(); i++) {
+            if (m_entries[i].target == target && m_entries[i].action && match(m_entries[i])) return i;
+        }
+        return None;
+    }
+
+    const Entry *first(const Target *target) const
+    {
+        const size_t i = find(target, IsAnything());
+        return i == None ? NULL : &m_entries[i];
+    }
+
+    struct IsAnything
+    {
+        inline bool operator()(const Entry &) const { return true; }
+    };
+
+    void removeAt(size_t i)
+    {
+        m_releasing.push_back(m_entries[i]);
+        m_entries[i].action = NULL;
+        m_uHoles++;
+    }
+
+    // sorts in what was added and drops the holes, in one pass when both
+    void tidy()
+    {
+        if (m_uSorted == m_entries.size() && m_uHoles == 0) return;
+
+        std::sort(m_entries.begin() + m_uSorted, m_entries.end(), Before());
+
+        m_merged.clear();
+        size_t a = 0, b = m_uSorted;
+        const size_t end = m_entries.size();
+        while (a < m_uSorted || b < end) {
+            const bool takeSorted = b == end || (a < m_uSorted && !Before()(m_entries[b], m_entries[a]));
+            const Entry &entry = m_entries[takeSorted ? a++ : b++];
+            if (entry.action) m_merged.push_back(entry);
+        }
+
+        m_entries.swap(m_merged);
+        m_uSorted = m_entries.size();
+        m_uHoles = 0;
+
+        // start over before the order numbers wrap around
+        if (m_uAdded > 0x7fffffff) {
+            for (size_t i = 0; i < m_entries.size(); i++) m_entries[i].added = (uint32_t) i;
+            m_uAdded = (uint32_t) m_entries.size();
+        }
+    }
+
+    // Outside update(), tidies up once most are holes, then releases what was removed. Releasing comes last as it may
+    // delete an action or a target, whose destructor may remove more.
+    void settle()
+    {
+        if (m_bLocked) return;
+
+        if (m_uHoles > m_entries.size() / 2) tidy();
+
+        while (!m_releasing.empty()) {
+            const Entry entry = m_releasing.back();
+            m_releasing.pop_back();
+            entry.action->release();
+            entry.target->release();
+        }
+    }
+};
+
+// end of global group
+/// @}
+
+}
+
+#endif // __SUPPORT_CCDENSEACTIONS_H__
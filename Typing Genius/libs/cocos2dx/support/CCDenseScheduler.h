@@ -0,0 +1,653 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_CCDENSESCHEDULER_H__
+#define __SUPPORT_CCDENSESCHEDULER_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace cocos2d {
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief The bookkeeping behind CCScheduler's update and custom selectors.
+
+ Update selectors are kept in one array sorted by priority (equal priorities in the order they were scheduled), and
+ custom selectors in another, each entry being a plain struct with its timer inlined, so update() walks two contiguous
+ arrays. Targets are found through an open-addressed hash of their pointers, and every entry gets a handle (a slot
+ plus a generation) that stays valid however the arrays move, and goes stale once it's unscheduled.
+
+ Scheduling an update at the end of its priority, scheduling a selector and unscheduling either are O(1) amortized and,
+ once reserve() has made room, don't allocate. Unscheduled updates are left behind as tombstones, swept out at the end
+ of the next update() or once there are more of them than live ones; unscheduled selectors are swapped out with the
+ last, or left for update() to sweep when it's running. Each target is retained while it has anything scheduled, and
+ released no earlier than the end of the update() it was unscheduled in.
+
+ It's a template so it can be tested without the rest of cocos2d-x: a target needs update(float), retain() and
+ release(). It isn't reentrant: update() mustn't be called from a callback.
+ */
+template <class Target>
+class CCDenseScheduler
+{
+public:
+    typedef void (Target::*Selector)(float);
+
+    struct Handle
+    {
+        uint32_t slot;
+        uint32_t generation; // 0 for no handle
+
+        Handle() : slot(0), generation(0) {}
+        Handle(uint32_t slot, uint32_t generation) : slot(slot), generation(generation) {}
+    };
+
+    CCDenseScheduler() : m_uHashBits(0), m_uHashCount(0), m_uDeadUpdates(0), m_uDeadTimers(0),
+        m_uUpdateIndex(0), m_bLocked(false)
+    {
+    }
+
+    /** makes room for that many targets and scheduled selectors (updates and custom ones together) */
+    void reserve(size_t targets, size_t selectors)
+    {
+        m_records.reserve(targets);
+        m_freeRecords.reserve(targets);
+        m_orphans.reserve(targets);
+        m_releasing.reserve(targets);
+        m_updates.reserve(selectors);
+        m_timers.reserve(selectors);
+        m_slots.reserve(selectors);
+        m_freeSlots.reserve(selectors);
+
+        unsigned int bits = 4;
+        while (((size_t) 1 << bits) < targets * 2) bits++;
+        if (bits > m_uHashBits) rehash(bits);
+    }
+
+    /** Schedules target->update() every frame. The lower the priority, the earlier it's called; if the target is
+     already scheduled, it keeps its priority and the existing handle is returned. */
+    Handle scheduleUpdate(Target *target, int priority, bool paused)
+    {
+        const uint32_t r = recordFor(target);
+        if (m_records[r].update != None) return handleOf(m_records[r].update);
+
+        // most are appended, at the end of priority 0 or at kCCPriorityNonSystemMin before anything else
+        size_t i = m_updates.size();
+        if (i > 0 && m_updates.back().priority > priority) {
+            i = std::upper_bound(m_updates.begin(), m_updates.end(), priority, HasLowerPriority()) - m_updates.begin();
+        }
+
+        const uint32_t slot = newSlot(false, (uint32_t) i);
+        const Update update = { target, priority, r, slot, paused };
+        m_updates.insert(m_updates.begin() + i, update);
+        for (size_t j = i + 1; j < m_updates.size(); j++) {
+            if (m_updates[j].slot != None) m_slots[m_updates[j].slot].index = (uint32_t) j;
+        }
+
+        // if this went before the one being called, update() carries on after it
+        if (m_bLocked && i <= m_uUpdateIndex) m_uUpdateIndex++;
+
+        m_records[r].update = slot;
+        return handleOf(slot);
+    }
+
+    /** Schedules target->*selector every interval seconds (every frame if 0), repeat + 1 times after the delay, or
+     forever with a repeat of kCCRepeatForever. If it's already scheduled only the interval changes. */
+    Handle scheduleSelector(Target *target, Selector selector, float interval, unsigned int repeat, float delay,
+        bool paused)
+    {
+        const uint32_t r = recordFor(target);
+        const uint32_t existing = findTimer(r, selector);
+        if (existing != None) {
+            m_timers[m_slots[existing].index].interval = interval;
+            return handleOf(existing);
+        }
+
+        const uint32_t slot = newSlot(true, (uint32_t) m_timers.size());
+        Timer timer;
+        timer.target = target;
+        timer.selector = selector;
+        timer.elapsed = -1;
+        timer.interval = interval;
+        timer.delay = delay;
+        timer.repeat = repeat;
+        timer.timesExecuted = 0;
+        timer.record = r;
+        timer.slot = slot;
+        timer.next = m_records[r].timers;
+        timer.runForever = repeat == RepeatForever;
+        timer.useDelay = delay > 0;
+        timer.paused = paused;
+        m_timers.push_back(timer);
+
+        m_records[r].timers = slot;
+        return handleOf(slot);
+    }
+
+    /** whether the handle's update or selector is still scheduled */
+    inline bool isScheduled(Handle handle) const
+    {
+        return handle.generation != 0 && handle.slot < m_slots.size() &&
+            m_slots[handle.slot].generation == handle.generation;
+    }
+
+    Handle updateHandle(const Target *target) const
+    {
+        const uint32_t r = find(target);
+        return r == None || m_records[r].update == None ? Handle() : handleOf(m_records[r].update);
+    }
+
+    Handle selectorHandle(const Target *target, Selector selector) const
+    {
+        const uint32_t r = find(target);
+        const uint32_t slot = r == None ? None : findTimer(r, selector);
+        return slot == None ? Handle() : handleOf(slot);
+    }
+
+    void unschedule(Handle handle)
+    {
+        if (!isScheduled(handle)) return;
+
+        const Slot &slot = m_slots[handle.slot];
+        if (slot.timer) {
+            removeTimer(slot.index);
+        } else {
+            removeUpdate(slot.index);
+        }
+        settle();
+    }
+
+    void unscheduleUpdate(const Target *target)
+    {
+        unschedule(updateHandle(target));
+    }
+
+    void unscheduleSelector(const Target *target, Selector selector)
+    {
+        unschedule(selectorHandle(target, selector));
+    }
+
+    /** both the update and the custom selectors */
+    void unscheduleAllForTarget(const Target *target)
+    {
+        const uint32_t r = find(target);
+        if (r == None) return;
+
+        while (m_records[r].timers != None) {
+            removeTimer(m_slots[m_records[r].timers].index);
+        }
+        if (m_records[r].update != None) {
+            removeUpdate(m_slots[m_records[r].update].index);
+        }
+        settle();
+    }
+
+    /** every custom selector, and the updates with at least that priority */
+    void unscheduleAllWithMinPriority(int minPriority)
+    {
+        for (size_t i = m_timers.size(); i-- > 0; ) {
+            if (m_timers[i].slot != None) removeTimer(i);
+        }
+        for (size_t i = 0; i < m_updates.size(); i++) {
+            if (m_updates[i].slot != None && m_updates[i].priority >= minPriority) removeUpdate(i);
+        }
+        settle();
+    }
+
+    void setPaused(const Target *target, bool paused)
+    {
+        const uint32_t r = find(target);
+        if (r == None) return;
+
+        for (uint32_t slot = m_records[r].timers; slot != None; ) {
+            Timer &timer = m_timers[m_slots[slot].index];
+            timer.paused = paused;
+            slot = timer.next;
+        }
+        if (m_records[r].update != None) {
+            m_updates[m_slots[m_records[r].update].index].paused = paused;
+        }
+    }
+
+    /** the custom selectors' pause if it has any, otherwise the update's */
+    bool isPaused(const Target *target) const
+    {
+        const uint32_t r = find(target);
+        if (r == None) return false;
+        if (m_records[r].timers != None) return m_timers[m_slots[m_records[r].timers].index].paused;
+        if (m_records[r].update != None) return m_updates[m_slots[m_records[r].update].index].paused;
+        return false;
+    }
+
+    /** Pauses every custom selector and the updates with at least that priority, calling back with each of their
+     targets (the same target may come up more than once). */
+    template <class Callback>
+    void pauseAll(int minPriority, Callback paused)
+    {
+        for (size_t i = 0; i < m_timers.size(); i++) {
+            if (m_timers[i].slot == None) continue;
+            m_timers[i].paused = true;
+            paused(m_timers[i].target);
+        }
+        for (size_t i = 0; i < m_updates.size(); i++) {
+            if (m_updates[i].slot == None || m_updates[i].priority < minPriority) continue;
+            m_updates[i].paused = true;
+            paused(m_updates[i].target);
+        }
+    }
+
+    /** Calls the updates in order of priority, then the custom selectors that are due. Anything can be scheduled or
+     unscheduled from the callbacks; updates scheduled after the one being called are called this frame too, selectors
+     scheduled during it start with the next. */
+    void update(float dt)
+    {
+        assert(!m_bLocked);
+        m_bLocked = true;
+
+        for (m_uUpdateIndex = 0; m_uUpdateIndex < m_updates.size(); m_uUpdateIndex++) {
+            const Update &entry = m_updates[m_uUpdateIndex];
+            if (entry.slot != None && !entry.paused) {
+                Target *target = entry.target;
+                target->update(dt);
+            }
+        }
+
+        const size_t timerCount = m_timers.size();
+        for (size_t i = 0; i < timerCount; i++) {
+            Timer &timer = m_timers[i];
+            if (timer.slot == None || timer.paused) continue;
+            tick(i, dt);
+        }
+
+        sweep();
+        m_bLocked = false;
+        settle();
+    }
+
+    /** scheduled, not counting those unscheduled since the last update() */
+    inline size_t updateCount() const { return m_updates.size() - m_uDeadUpdates; }
+    inline size_t selectorCount() const { return m_timers.size() - m_uDeadTimers; }
+    inline size_t targetCount() const { return m_uHashCount; }
+
+    static const unsigned int RepeatForever = 0xfffffffe; // kCCRepeatForever
+
+private:
+    static const uint32_t None = 0xffffffff;
+
+    struct Record
+    {
+        Target *target; // NULL once free
+        uint32_t update; // slot
+        uint32_t timers; // slot of the most recently scheduled one, chained through Timer::next
+    };
+
+    struct Update
+    {
+        Target *target;
+        int priority;
+        uint32_t record;
+        uint32_t slot; // None once unscheduled
+        bool paused;
+    };
+
+    struct HasLowerPriority
+    {
+        inline bool operator()(int priority, const Update &update) const { return priority < update.priority; }
+    };
+
+    // CCTimer's state
+    struct Timer
+    {
+        Target *target;
+        Selector selector;
+        float elapsed; // -1 until its first frame
+        float interval;
+        float delay;
+        unsigned int repeat; // 0 = once, 1 is 2 x executed
+        unsigned int timesExecuted;
+        uint32_t record;
+        uint32_t slot; // None once unscheduled
+        uint32_t next; // the target's next timer
+        bool runForever;
+        bool useDelay;
+        bool paused;
+    };
+
+    struct Slot
+    {
+        uint32_t index; // in m_updates or m_timers
+        uint32_t generation;
+        bool timer;
+    };
+
+    struct Bucket
+    {
+        const Target *target; // NULL if empty
+        uint32_t record;
+    };
+
+    std::vector<Record> m_records;
+    std::vector<uint32_t> m_freeRecords;
+    std::vector<uint32_t> m_orphans; // records emptied during update(), freed at its end
+    std::vector<Target *> m_releasing;
+
+    std::vector<Update> m_updates; // by priority
+    std::vector<Timer> m_timers;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+
+    std::vector<Bucket> m_buckets;
+    unsigned int m_uHashBits;
+    size_t m_uHashCount;
+
+    size_t m_uDeadUpdates;
+    size_t m_uDeadTimers;
+    size_t m_uUpdateIndex; // the update being called
+    bool m_bLocked; // in update(): unscheduled entries stay where they are until the end
+
+    inline Handle handleOf(uint32_t slot) const
+    {
+        return Handle(slot, m_slots[slot].generation);
+    }
+
+    uint32_t newSlot(bool timer, uint32_t index)
+    {
+        uint32_t slot;
+        if (m_freeSlots.empty()) {
+            slot = (uint32_t) m_slots.size();
+            const Slot s = { index, 1, timer };
+            m_slots.push_back(s);
+        } else {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+            m_slots[slot].index = index;
+            m_slots[slot].timer = timer;
+        }
+        return slot;
+    }
+
+    inline void freeSlot(uint32_t slot)
+    {
+        if (++m_slots[slot].generation == 0) m_slots[slot].generation = 1;
+        m_freeSlots.push_back(slot);
+    }
+
+    uint32_t findTimer(uint32_t r, Selector selector) const
+    {
+        for (uint32_t slot = m_records[r].timers; slot != None; ) {
+            const Timer &timer = m_timers[m_slots[slot].index];
+            if (timer.selector == selector) return slot;
+            slot = timer.next;
+        }
+        return None;
+    }
+
+    void removeUpdate(size_t i)
+    {
+        Update &update = m_updates[i];
+        m_records[update.record].update = None;
+        freeSlot(update.slot);
+        update.slot = None;
+        m_uDeadUpdates++;
+        emptied(update.record);
+    }
+
+    void removeTimer(size_t i)
+    {
+        Timer &timer = m_timers[i];
+        const uint32_t r = timer.record;
+
+        uint32_t *link = &m_records[r].timers;
+        while (*link != timer.slot) link = &m_timers[m_slots[*link].index].next;
+        *link = timer.next;
+
+        freeSlot(timer.slot);
+        timer.slot = None;
+
+        if (m_bLocked) {
+            m_uDeadTimers++;
+        } else {
+            if (i + 1 < m_timers.size()) {
+                m_timers[i] = m_timers.back();
+                m_slots[m_timers[i].slot].index = (uint32_t) i;
+            }
+            m_timers.pop_back();
+        }
+        emptied(r);
+    }
+
+    void tick(size_t i, float dt)
+    {
+        Timer *timer = &m_timers[i];
+        if (timer->elapsed == -1) {
+            timer->elapsed = 0;
+            timer->timesExecuted = 0;
+            return;
+        }
+
+        timer->elapsed += dt;
+        if (timer->runForever && !timer->useDelay) {
+            // standard timer usage
+            if (timer->elapsed >= timer->interval) {
+                timer = fire(i);
+                timer->elapsed = 0;
+            }
+            return;
+        }
+
+        // advanced usage
+        if (timer->useDelay) {
+            if (timer->elapsed >= timer->delay) {
+                timer = fire(i);
+                timer->elapsed -= timer->delay;
+                timer->timesExecuted++;
+                timer->useDelay = false;
+            }
+        } else if (timer->elapsed >= timer->interval) {
+            timer = fire(i);
+            timer->elapsed = 0;
+            timer->timesExecuted++;
+        }
+
+        if (timer->slot != None && !timer->runForever && timer->timesExecuted > timer->repeat) {
+            removeTimer(i);
+        }
+    }
+
+    // the callback may have scheduled more, moving the timers
+    inline Timer *fire(size_t i)
+    {
+        const Timer &timer = m_timers[i];
+        Target *target = timer.target;
+        (target->*timer.selector)(timer.elapsed);
+        return &m_timers[i];
+    }
+
+    // drops what was unscheduled during update(), keeping the updates in order
+    void sweep()
+    {
+        if (m_uDeadUpdates > 0) {
+            size_t kept = 0;
+            for (size_t i = 0; i < m_updates.size(); i++) {
+                if (m_updates[i].slot == None) continue;
+                if (kept != i) {
+                    m_updates[kept] = m_updates[i];
+                    m_slots[m_updates[kept].slot].index = (uint32_t) kept;
+                }
+                kept++;
+            }
+            m_updates.resize(kept);
+            m_uDeadUpdates = 0;
+        }
+
+        if (m_uDeadTimers > 0) {
+            size_t kept = 0;
+            for (size_t i = 0; i < m_timers.size(); i++) {
+                if (m_timers[i].slot == None) continue;
+                if (kept != i) {
+                    m_timers[kept] = m_timers[i];
+                    m_slots[m_timers[kept].slot].index = (uint32_t) kept;
+                }
+                kept++;
+            }
+            m_timers.resize(kept);
+            m_uDeadTimers = 0;
+        }
+
+        for (size_t i = 0; i < m_orphans.size(); i++) {
+            const uint32_t r = m_orphans[i];
+            if (m_records[r].target && m_records[r].update == None && m_records[r].timers == None) freeRecord(r);
+        }
+        m_orphans.clear();
+    }
+
+    // Outside update(), sweeps the updates once most are tombstones, then releases the targets left with nothing
+    // scheduled. Releasing comes last as it may delete a target, which may unschedule itself again.
+    void settle()
+    {
+        if (m_bLocked) return;
+
+        if (m_uDeadUpdates > m_updates.size() / 2) sweep();
+
+        while (!m_releasing.empty()) {
+            Target *target = m_releasing.back();
+            m_releasing.pop_back();
+            target->release();
+        }
+    }
+
+// targets
+
+    uint32_t recordFor(Target *target)
+    {
+        uint32_t r = find(target);
+        if (r != None) return r;
+
+        const Record record = { target, None, None };
+        if (m_freeRecords.empty()) {
+            r = (uint32_t) m_records.size();
+            m_records.push_back(record);
+        } else {
+            r = m_freeRecords.back();
+            m_freeRecords.pop_back();
+            m_records[r] = record;
+        }
+        insert(target, r);
+        target->retain();
+        return r;
+    }
+
+    inline void emptied(uint32_t r)
+    {
+        if (m_records[r].update != None || m_records[r].timers != None) return;
+        if (m_bLocked) {
+            m_orphans.push_back(r);
+        } else {
+            freeRecord(r);
+        }
+    }
+
+    void freeRecord(uint32_t r)
+    {
+        Target *target = m_records[r].target;
+        erase(target);
+        m_records[r].target = NULL;
+        m_freeRecords.push_back(r);
+        m_releasing.push_back(target);
+    }
+
+// the hash of targets
+
+    // Fibonacci hashing of the pointer, linear probing and backward shift deletion
+    inline size_t home(const Target *target) const
+    {
+        return (size_t) (((uint64_t) (uintptr_t) target * 0x9E3779B97F4A7C15ull) >> (64 - m_uHashBits));
+    }
+
+    uint32_t find(const Target *target) const
+    {
+        if (m_uHashCount == 0 || !target) return None;
+
+        const size_t mask = m_buckets.size() - 1;
+        for (size_t i = home(target); m_buckets[i].target; i = (i + 1) & mask) {
+            if (m_buckets[i].target == target) return m_buckets[i].record;
+        }
+        return None;
+    }
+
+    void insert(const Target *target, uint32_t record)
+    {
+        if ((m_uHashCount + 1) * 2 > m_buckets.size()) rehash(std::max(m_uHashBits + 1, 4u));
+
+        const size_t mask = m_buckets.size() - 1;
+        size_t i = home(target);
+        while (m_buckets[i].target) i = (i + 1) & mask;
+        m_buckets[i].target = target;
+        m_buckets[i].record = record;
+        m_uHashCount++;
+    }
+
+    void erase(const Target *target)
+    {
+        const size_t mask = m_buckets.size() - 1;
+        size_t i = home(target);
+        while (m_buckets[i].target != target) i = (i + 1) & mask;
+
+        // pull back the ones that probed past it
+        for (size_t j = (i + 1) & mask; m_buckets[j].target; j = (j + 1) & mask) {
+            if (((j - home(m_buckets[j].target)) & mask) >= ((j - i) & mask)) {
+                m_buckets[i] = m_buckets[j];
+                i = j;
+            }
+        }
+        m_buckets[i].target = NULL;
+        m_uHashCount--;
+    }
+
+    void rehash(unsigned int bits)
+    {
+        std::vector<Bucket> old;
+        old.swap(m_buckets);
+        const Bucket empty = { NULL, None };
+        m_buckets.assign((size_t) 1 << bits, empty);
+        m_uHashBits = bits;
+        m_uHashCount = 0;
+
+        for (size_t i = 0; i < old.size(); i++) {
+            if (old[i].target) insert(old[i].target, old[i].record);
+        }
+    }
+};
+
+// end of global group
+/// @}
+
+}
+
+#endif // __SUPPORT_CCDENSESCHEDULER_H__
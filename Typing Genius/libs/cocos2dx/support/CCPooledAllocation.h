@@ -0,0 +1,140 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_CCPOOLEDALLOCATION_H__
+#define __SUPPORT_CCPOOLEDALLOCATION_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace cocos2d {
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief A free list per type, for the small objects that are made and thrown away all the time (the actions).
+
+ A class opts in with CC_POOLED_ALLOCATION(ClassName) in its body, and from then on `new` takes one of its objects
+ off the free list and `delete` (CCObject::release) puts it back. The free list grows a block of objects at a time
+ and never gives memory back, so once the busiest moment has been through, making and deleting them doesn't allocate.
+
+ A subclass that doesn't opt in itself inherits the operators but is a different size, and goes to the heap as before.
+ Not thread safe, like the rest of cocos2d-x.
+ */
+template <class T>
+class CCPooledAllocation
+{
+public:
+    static void *allocate(size_t size)
+    {
+        if (size != sizeof(T)) return ::operator new(size);
+
+        Pool &pool = sharedPool();
+        if (!pool.free) grow(pool, pool.blocks.empty() ? 16 : pool.perBlock * 2);
+
+        Node *node = pool.free;
+        pool.free = node->next;
+        pool.live++;
+        return node;
+    }
+
+    static void deallocate(void *p, size_t size)
+    {
+        if (!p) return;
+        if (size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+
+        Pool &pool = sharedPool();
+        Node *node = static_cast<Node *>(p);
+        node->next = pool.free;
+        pool.free = node;
+        pool.live--;
+    }
+
+    /** makes sure that many more can be made without allocating */
+    static void reserve(size_t count)
+    {
+        Pool &pool = sharedPool();
+        size_t available = 0;
+        for (Node *node = pool.free; node; node = node->next) available++;
+        if (count > available) grow(pool, count - available);
+    }
+
+    /** objects made and not yet deleted */
+    static size_t live() { return sharedPool().live; }
+
+private:
+    struct Node
+    {
+        Node *next;
+    };
+
+    struct Pool
+    {
+        Node *free;
+        size_t live;
+        size_t perBlock; // of the last block
+        std::vector<void *> blocks; // kept for good
+
+        Pool() : free(NULL), live(0), perBlock(0) {}
+    };
+
+    static Pool &sharedPool()
+    {
+        static Pool pool;
+        return pool;
+    }
+
+    static void grow(Pool &pool, size_t count)
+    {
+        // operator new's alignment is good for any T, and sizeof(T) keeps it from one object to the next
+        const size_t stride = sizeof(T) < sizeof(Node) ? sizeof(Node) : sizeof(T);
+        char *block = static_cast<char *>(::operator new(stride * count));
+        pool.blocks.push_back(block);
+        pool.perBlock = count;
+
+        for (size_t i = count; i-- > 0; ) {
+            Node *node = reinterpret_cast<Node *>(block + i * stride);
+            node->next = pool.free;
+            pool.free = node;
+        }
+    }
+};
+
+// end of global group
+/// @}
+
+}
+
+/** Gives a class its own CCPooledAllocation. Leaves what follows it public. */
+#define CC_POOLED_ALLOCATION(_TYPE_) \
+public: \
+    static void *operator new(size_t size) { return cocos2d::CCPooledAllocation<_TYPE_>::allocate(size); } \
+    static void operator delete(void *p, size_t size) { cocos2d::CCPooledAllocation<_TYPE_>::deallocate(p, size); }
+
+#endif // __SUPPORT_CCPOOLEDALLOCATION_H__
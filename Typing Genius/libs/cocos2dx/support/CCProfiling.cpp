@@ -34,6 +34,13 @@ bool kCCProfilerCategorySprite = false;
 bool kCCProfilerCategoryBatchSprite = false;
 bool kCCProfilerCategoryParticles = false;
 
+CCProfilingFrameListener *g_pProfilingFrameListener = NULL;
+
+void CCProfilingSetFrameListener(CCProfilingFrameListener *listener)
+{
+    g_pProfilingFrameListener = listener;
+}
+
 
 static CCProfiler* g_sSharedProfiler = NULL;
 
@@ -100,6 +100,59 @@ extern bool kCCProfilerCategorySprite;
 extern bool kCCProfilerCategoryBatchSprite;
 extern bool kCCProfilerCategoryParticles;
 
+/**
+ * Sections of every frame that can be timed by a CCProfilingFrameListener. Unlike the timers above these don't
+ * depend on CC_ENABLE_PROFILERS and aren't looked up by name: with no listener set a section costs a NULL check.
+ */
+typedef enum {
+    kCCProfilingSectionSchedulerUpdate,  // every scheduled selector and update, including the two below
+    kCCProfilingSectionActionManager,
+    kCCProfilingSectionParticleUpdate,
+    kCCProfilingSectionVisit,            // the running scene's visit (and draw), including the sorting below
+    kCCProfilingSectionSortChildren,     // reordering children whose z order changed
+    kCCProfilingSectionCount
+} ccProfilingSection;
+
+/** Told where each frame (CCDirector::drawScene) and each section in it begins and ends. Main thread only. */
+class CC_DLL CCProfilingFrameListener
+{
+public:
+    virtual ~CCProfilingFrameListener() {}
+    virtual void frameBegan() = 0;
+    virtual void frameEnded() = 0;
+    virtual void sectionBegan(ccProfilingSection section) = 0;
+    virtual void sectionEnded(ccProfilingSection section) = 0;
+};
+
+extern CCProfilingFrameListener *g_pProfilingFrameListener;
+
+/** NULL to stop; the listener isn't retained */
+extern void CCProfilingSetFrameListener(CCProfilingFrameListener *listener);
+
+/** times a section until the end of the enclosing scope */
+class CCProfilingSectionScope
+{
+public:
+    explicit CCProfilingSectionScope(ccProfilingSection section)
+    : m_eSection(section), m_pListener(g_pProfilingFrameListener)
+    {
+        if (m_pListener) m_pListener->sectionBegan(m_eSection);
+    }
+    ~CCProfilingSectionScope()
+    {
+        if (m_pListener) m_pListener->sectionEnded(m_eSection);
+    }
+
+private:
+    ccProfilingSection m_eSection;
+    CCProfilingFrameListener *m_pListener; // the one the section began with
+};
+
+#define CC_PROFILER_SECTION_CONCAT_(__a__, __b__) __a__##__b__
+#define CC_PROFILER_SECTION_CONCAT(__a__, __b__) CC_PROFILER_SECTION_CONCAT_(__a__, __b__)
+#define CC_PROFILER_SECTION(__section__) \
+    cocos2d::CCProfilingSectionScope CC_PROFILER_SECTION_CONCAT(__profilingSection, __LINE__)(__section__)
+
 // end of global group
 /// @}
 